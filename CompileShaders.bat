@@ -1,2 +1,3 @@
-forfiles /P src\Framework\Vulkan\RenderSystem\GLSLShaders /s /m *.glsl /c "cmd /c %VULKAN_SDK%\Bin\glslc.exe @fname.glsl -o ../../../../../../Assets/Shaders/@fname.spv"
+if not exist Assets\Shaders mkdir Assets\Shaders
+forfiles /P RavaFramework\src\Graphics\Vulkan\Shaders /s /m *.glsl /c "cmd /c %VULKAN_SDK%\Bin\glslc.exe @fname.glsl -o ../../../../../Assets/Shaders/@fname.spv"
 pause
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "RavaFramework.h"
+
+#include "Core/FrameAllocator.h"
+
+#include "Benchmark.h"
+
+// Counts every heap allocation of the process, the framework included
+static std::atomic<u64> s_allocationCount{0};
+
+void* operator new(size_t size) {
+  s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+  if (void* data = std::malloc(size ? size : 1)) {
+    return data;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+  size_t align = static_cast<size_t>(alignment);
+#ifdef _WIN32
+  void* data = _aligned_malloc(size ? size : 1, align);
+#else
+  void* data = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) & ~(align - 1));
+#endif
+  if (data) {
+    return data;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* data) noexcept {
+  std::free(data);
+}
+
+void operator delete(void* data, size_t) noexcept {
+  std::free(data);
+}
+
+void operator delete(void* data, std::align_val_t) noexcept {
+#ifdef _WIN32
+  _aligned_free(data);
+#else
+  std::free(data);
+#endif
+}
+
+void operator delete(void* data, size_t, std::align_val_t alignment) noexcept {
+  operator delete(data, alignment);
+}
+
+namespace Benchmark {
+static constexpr u32 WARMUP_FRAME_COUNT  = 32;
+static constexpr u32 MEASURE_FRAME_COUNT = 1000;
+static constexpr u32 ALLOCATION_COUNT    = 100000;
+static constexpr u32 REPEAT_COUNT        = 5;
+
+static void RunFrames(u32 count) {
+  for (u32 i = 0; i < count; ++i) {
+    Rava::ProcessMessage();
+    Rava::BeginFrame();
+    Rava::EndFrame();
+  }
+}
+
+void RunFrameAllocations() {
+  // Small temporaries, the pattern the frame arenas replace
+  f64 heapNs = MeasureMin(REPEAT_COUNT, []() {
+    for (u32 i = 0; i < ALLOCATION_COUNT; ++i) {
+      std::vector<u64> values(8);
+      values[i & 7] = i;
+    }
+  });
+
+  Rava::LinearArena arena;
+  f64 arenaNs = MeasureMin(REPEAT_COUNT, [&]() {
+    for (u32 i = 0; i < ALLOCATION_COUNT; ++i) {
+      std::span<u64> values = arena.AllocateArray<u64>(8);
+      values[i & 7]         = i;
+    }
+    arena.Reset();
+  });
+
+  std::print("{:>24} {:>10}\n", "", "ns/alloc");
+  std::print("{:>24} {:>10.2f}\n", "heap", heapNs / ALLOCATION_COUNT);
+  std::print("{:>24} {:>10.2f}\n", "linear arena", arenaNs / ALLOCATION_COUNT);
+
+  // Steady state frames of the headless renderer must not touch the heap
+  Rava::SetHeadless(true);
+  if (!Rava::InitFramework(256, 256)) {
+    std::print("InitFramework failed, skipping the frame allocation count\n");
+    return;
+  }
+
+  RunFrames(WARMUP_FRAME_COUNT);
+  u64 before = s_allocationCount.load();
+  RunFrames(MEASURE_FRAME_COUNT);
+  u64 allocationCount = s_allocationCount.load() - before;
+
+  std::print(
+      "{} heap allocations in {} frames ({:.3f} per frame): {}\n", allocationCount,
+      MEASURE_FRAME_COUNT, static_cast<f64>(allocationCount) / MEASURE_FRAME_COUNT,
+      allocationCount == 0 ? "PASS" : "FAIL"
+  );
+
+  Rava::ShutdownFramework();
+}
+}  // namespace Benchmark
\ No newline at end of file
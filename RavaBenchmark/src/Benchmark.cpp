@@ -0,0 +1,40 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Renderer.h"
+#include "Graphics/Vulkan/VKRenderer.h"
+
+#include "Benchmark.h"
+
+namespace Benchmark {
+static void RestoreGpuSceneSettings() {
+  Rava::SetLodThreshold(1.0f);
+  Rava::SetGpuPipelineStatistics(false);
+  Rava::SetGpuProfiler(false);
+  Rava::SetGpuScene(false);
+}
+
+VK::GpuScene* InitGpuSceneFramework(std::string_view benchmark, bool isPipelineStatisticsEnabled) {
+  Rava::SetHeadless(true);
+  Rava::SetGpuScene(true);
+  Rava::SetGpuProfiler(true);
+  Rava::SetGpuPipelineStatistics(isPipelineStatisticsEnabled);
+  if (!Rava::InitFramework(1280, 720)) {
+    std::print("InitFramework failed, skipping the {} benchmark\n", benchmark);
+    RestoreGpuSceneSettings();
+    return nullptr;
+  }
+
+  auto* renderer      = static_cast<VK::Renderer*>(Rava::Renderer::Instance.get());
+  VK::GpuScene* scene = renderer->GetGpuScene();
+  if (scene == nullptr) {
+    std::print("GpuScene is not available (shaders or device features), skipping\n");
+    ShutdownGpuSceneFramework();
+  }
+  return scene;
+}
+
+void ShutdownGpuSceneFramework() {
+  Rava::ShutdownFramework();
+  RestoreGpuSceneSettings();
+}
+}  // namespace Benchmark
\ No newline at end of file
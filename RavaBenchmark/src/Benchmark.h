@@ -0,0 +1,59 @@
+#pragma once
+
+namespace Rava {
+struct Vertex;
+}
+
+namespace VK {
+class GpuScene;
+}
+
+namespace Benchmark {
+using Clock = std::chrono::steady_clock;
+
+inline f64 ElapsedNs(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration<f64, std::nano>(end - start).count();
+}
+
+// Runs function repeatCount times and returns the fastest run in nanoseconds
+template <typename Function>
+f64 MeasureMin(u32 repeatCount, Function&& function) {
+  f64 best = std::numeric_limits<f64>::max();
+  for (u32 i = 0; i < repeatCount; ++i) {
+    auto start = Clock::now();
+    function();
+    best = std::min(best, ElapsedNs(start, Clock::now()));
+  }
+  return best;
+}
+
+// Shared by the GPU scene benchmarks. Init starts the headless framework with the GpuScene and the
+// GPU profiler, it prints why and returns null when either is not available. Shutdown also restores
+// the settings the benchmarks change.
+VK::GpuScene* InitGpuSceneFramework(std::string_view benchmark, bool isPipelineStatisticsEnabled);
+void ShutdownGpuSceneFramework();
+
+struct GeometryFrameStats {
+  f64 FrameMs     = 0.0;
+  f64 GpuMs       = 0.0;
+  u64 Triangles   = 0;  // input assembly primitives of the render pass
+  bool HasCounted = false;
+};
+
+// Averages over a fixed number of frames after a warmup, needs the GPU profiler
+GeometryFrameStats MeasureGeometryFrames();
+void CreateSphere(
+    u32 rings, u32 segments, std::vector<Rava::Vertex>& vertices, std::vector<u32>& indices
+);
+
+void RunJobSystem();
+void RunCpuProfiler();
+void RunFrameAllocations();
+void RunGpuCulling();
+void RunLod();
+void RunClusterCulling();
+void RunUploads();
+void RunFramePacing();
+void RunParallelRecording();
+void RunRenderGraph();
+}  // namespace Benchmark
\ No newline at end of file
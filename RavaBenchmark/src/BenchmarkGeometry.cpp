@@ -0,0 +1,78 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Model.h"
+
+#include "Benchmark.h"
+
+namespace Benchmark {
+static constexpr u32 WARMUP_FRAME_COUNT      = 8;
+static constexpr u32 MEASURE_FRAME_COUNT     = 32;
+static constexpr std::string_view PASS_NAME  = "SwapChainRenderPass";
+static constexpr u32 IA_PRIMITIVES_STATISTIC = 1;  // Rava::GPU_PIPELINE_STATISTIC_NAMES
+
+// UV sphere, the first and last column share positions but not UVs, so it has a seam to keep
+void CreateSphere(
+    u32 rings, u32 segments, std::vector<Rava::Vertex>& vertices, std::vector<u32>& indices
+) {
+  for (u32 ring = 0; ring <= rings; ++ring) {
+    f32 theta = glm::pi<f32>() * static_cast<f32>(ring) / rings;
+    for (u32 segment = 0; segment <= segments; ++segment) {
+      f32 phi     = glm::two_pi<f32>() * static_cast<f32>(segment % segments) / segments;
+      Vec3 normal = Vec3{std::cos(phi), 0.0f, std::sin(phi)} * std::sin(theta);
+      normal.y    = std::cos(theta);
+      if (ring == 0 || ring == rings) {
+        normal = Vec3{0.0f, ring == 0 ? 1.0f : -1.0f, 0.0f};
+      }
+      Vec2 uv{static_cast<f32>(segment) / segments, static_cast<f32>(ring) / rings};
+      vertices.push_back({normal, Vec4{1.0f}, normal, uv});
+    }
+  }
+
+  u32 stride = segments + 1;
+  for (u32 ring = 0; ring < rings; ++ring) {
+    for (u32 segment = 0; segment < segments; ++segment) {
+      u32 a = ring * stride + segment;
+      u32 b = a + 1;
+      u32 c = a + stride;
+      u32 d = c + 1;
+      if (ring != 0) {
+        indices.insert(indices.end(), {a, c, b});
+      }
+      if (ring != rings - 1) {
+        indices.insert(indices.end(), {b, c, d});
+      }
+    }
+  }
+}
+
+GeometryFrameStats MeasureGeometryFrames() {
+  for (u32 i = 0; i < WARMUP_FRAME_COUNT; ++i) {
+    Rava::BeginFrame();
+    Rava::EndFrame();
+  }
+
+  GeometryFrameStats stats;
+  Rava::GpuFrameTimings timings;
+  for (u32 i = 0; i < MEASURE_FRAME_COUNT; ++i) {
+    auto start = Clock::now();
+    Rava::BeginFrame();
+    Rava::EndFrame();
+    stats.FrameMs += ElapsedNs(start, Clock::now()) * 1e-6;
+
+    // Lags a few frames behind, those ran with the same settings after the warmup
+    if (Rava::GetGpuFrameTimings(timings)) {
+      stats.GpuMs += timings.FrameMs;
+      for (const auto& scope : timings.Scopes) {
+        if (scope.Name == PASS_NAME && !scope.PipelineStatistics.empty()) {
+          stats.Triangles  = scope.PipelineStatistics[IA_PRIMITIVES_STATISTIC];
+          stats.HasCounted = true;
+        }
+      }
+    }
+  }
+
+  stats.FrameMs /= MEASURE_FRAME_COUNT;
+  stats.GpuMs /= MEASURE_FRAME_COUNT;
+  return stats;
+}
+}  // namespace Benchmark
\ No newline at end of file
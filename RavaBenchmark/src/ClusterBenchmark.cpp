@@ -0,0 +1,80 @@
+#include "RavaFramework.h"
+
+#include "Graphics/ModelLoader/MeshletBuilder.h"
+#include "Graphics/Vulkan/VKGpuScene.h"
+
+#include "Benchmark.h"
+
+namespace Benchmark {
+static constexpr u32 DENSE_RINGS    = 512;
+static constexpr u32 DENSE_SEGMENTS = 1024;
+static constexpr u32 ROW_COUNT      = 2;
+static constexpr u32 ROW_LENGTH     = 4;
+static constexpr f32 ROW_SPACING    = 2.5f;
+
+// A few very dense spheres filling the view from up close, so whole instances are visible while
+// large parts of them face away or lie outside the frustum. Drawn whole and cluster culled.
+void RunClusterCulling() {
+  std::vector<Rava::Vertex> vertices;
+  std::vector<u32> indices;
+  CreateSphere(DENSE_RINGS, DENSE_SEGMENTS, vertices, indices);
+
+  std::vector<Rava::Meshlet> meshlets;
+  auto start = Clock::now();
+  Rava::MeshletBuilder::Build(vertices, indices, meshlets);
+  f64 buildMs = ElapsedNs(start, Clock::now()) * 1e-6;
+
+  u32 meshletVertexCount = 0;
+  for (const Rava::Meshlet& meshlet : meshlets) {
+    meshletVertexCount += meshlet.VertexCount;
+  }
+  f64 meshletCount = static_cast<f64>(meshlets.size());
+  std::print(
+      "triangles: {}, meshlets: {}, {:.1f} triangles and {:.1f} vertices each, {:.1f} ms\n",
+      indices.size() / 3, meshlets.size(), static_cast<f64>(indices.size() / 3) / meshletCount,
+      meshletVertexCount / meshletCount, buildMs
+  );
+
+  VK::GpuScene* scene = InitGpuSceneFramework("cluster culling", true);
+  if (scene == nullptr) {
+    return;
+  }
+  if (!scene->IsDrawIndirectCountSupported()) {
+    std::print("Cluster culling needs drawIndirectCount, both runs draw whole meshes\n");
+  }
+
+  u32 sphere = scene->AddMesh(vertices, indices, {}, meshlets);
+  for (u32 row = 0; row < ROW_COUNT; ++row) {
+    for (u32 x = 0; x < ROW_LENGTH; ++x) {
+      f32 offset = (static_cast<f32>(x) - (ROW_LENGTH - 1) * 0.5f) * ROW_SPACING;
+      Rava::InstanceData instance;
+      instance.Transform = glm::translate(Mat4{1.0f}, Vec3{offset, 0.0f, (row + 1) * ROW_SPACING});
+      instance.ID        = row * ROW_LENGTH + x;
+      scene->AddInstance(sphere, instance);
+    }
+  }
+
+  // Only the camera position matters for the cones, the threshold keeps the full meshes
+  Vec3 eye{0.0f, 0.5f, -0.5f};
+  f32 verticalFov = glm::radians(60.0f);
+  Mat4 projection = glm::perspective(verticalFov, 1280.0f / 720.0f, 0.1f, 100.0f);
+  Mat4 view       = glm::lookAt(eye, Vec3{0.0f, 0.0f, ROW_SPACING * 2.0f}, Vec3{0.0f, 1.0f, 0.0f});
+  scene->SetViewProjection(projection * view);
+  Rava::SetLodCamera(eye, verticalFov);
+  Rava::SetLodThreshold(0.0f);
+
+  std::print("\ninstances: {}\n", scene->GetInstanceCount());
+  std::print("{:>10} {:>12} {:>10} {:>10}\n", "clusters", "triangles", "frame ms", "gpu ms");
+  for (bool isClusterCulling : {false, true}) {
+    scene->SetClusterCulling(isClusterCulling);
+    GeometryFrameStats stats = MeasureGeometryFrames();
+    std::string triangles    = stats.HasCounted ? std::to_string(stats.Triangles) : "-";
+    std::print(
+        "{:>10} {:>12} {:>10.3f} {:>10.3f}\n", isClusterCulling ? "on" : "off", triangles,
+        stats.FrameMs, stats.GpuMs
+    );
+  }
+
+  ShutdownGpuSceneFramework();
+}
+}  // namespace Benchmark
\ No newline at end of file
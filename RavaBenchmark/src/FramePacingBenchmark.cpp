@@ -0,0 +1,68 @@
+#include "RavaFramework.h"
+
+#include "Benchmark.h"
+
+namespace Benchmark {
+static constexpr u32 WARMUP_FRAME_COUNT   = 16;
+static constexpr u32 MEASURE_FRAME_COUNT  = 240;
+static constexpr f32 TARGET_FRAME_RATES[] = {0.0f, 240.0f, 120.0f, 60.0f};
+static constexpr f64 MIN_WORK_MS          = 0.5;
+static constexpr f64 MAX_WORK_MS          = 4.0;
+
+// Uneven game logic on the CPU, busy so the frame time does not depend on the scheduler
+static void SimulateWork(f64 ms) {
+  auto end = Clock::now() + std::chrono::duration<f64, std::milli>(ms);
+  while (Clock::now() < end) {
+  }
+}
+
+// Headless frames with a varying CPU load, unpaced and at a few target frame rates. The jitter is
+// the distance of the frame interval from the target (from its median when unpaced).
+void RunFramePacing() {
+  Rava::SetHeadless(true);
+  Rava::SetGpuProfiler(true);
+  if (!Rava::InitFramework(1280, 720)) {
+    std::print("InitFramework failed, skipping the frame pacing benchmark\n");
+    return;
+  }
+
+  std::print(
+      "{:>8} {:>9} {:>9} {:>9} {:>9} {:>9} {:>8} {:>8} {:>9} {:>8} {:>8} {:>7}\n", "target",
+      "p50 ms", "p99 ms", "jit p50", "jit p95", "jit p99", "cpu ms", "gpu ms", "present", "sleep",
+      "spin", "missed"
+  );
+
+  std::mt19937 random(11);
+  std::uniform_real_distribution<f64> workMs(MIN_WORK_MS, MAX_WORK_MS);
+  for (f32 frameRate : TARGET_FRAME_RATES) {
+    Rava::SetTargetFrameRate(frameRate);
+    for (u32 i = 0; i < WARMUP_FRAME_COUNT; ++i) {
+      Rava::BeginFrame();
+      Rava::EndFrame();
+    }
+
+    Rava::ResetFramePacingStats();
+    for (u32 i = 0; i < MEASURE_FRAME_COUNT; ++i) {
+      Rava::ProcessMessage();
+      Rava::BeginFrame();
+      SimulateWork(workMs(random));
+      Rava::EndFrame();
+    }
+
+    Rava::FramePacingStats stats;
+    Rava::GetFramePacingStats(stats);
+    std::print(
+        "{:>8} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f} {:>8.3f} {:>8.3f} {:>9.3f} {:>8.3f} "
+        "{:>8.3f} {:>7}\n",
+        frameRate > 0.0f ? std::format("{:.0f} fps", frameRate) : "off", stats.Interval.P50Ms,
+        stats.Interval.P99Ms, stats.Jitter.P50Ms, stats.Jitter.P95Ms, stats.Jitter.P99Ms,
+        stats.Cpu.P50Ms, stats.Gpu.P50Ms, stats.Present.P50Ms, stats.SleepMs, stats.SpinMs,
+        stats.MissedCount
+    );
+  }
+
+  Rava::ShutdownFramework();
+  Rava::SetTargetFrameRate(0.0f);
+  Rava::SetGpuProfiler(false);
+}
+}  // namespace Benchmark
\ No newline at end of file
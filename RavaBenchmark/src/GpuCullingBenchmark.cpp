@@ -0,0 +1,142 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Vulkan/VKGpuScene.h"
+
+#include "Benchmark.h"
+
+namespace Benchmark {
+static constexpr u32 WARMUP_FRAME_COUNT     = 8;
+static constexpr u32 MEASURE_FRAME_COUNT    = 32;
+static constexpr f32 SCENE_EXTENT           = 500.0f;
+static constexpr u32 INSTANCE_COUNTS[]      = {1000, 10000, 100000, 1000000};
+static constexpr std::string_view CULL_NAME = "GpuSceneCull";
+
+struct FrameStats {
+  f64 FrameMs    = 0.0;  // wall time of a whole frame
+  f64 EndFrameMs = 0.0;  // draw recording and submission
+  f64 GpuMs      = 0.0;
+  f64 GpuCullMs  = 0.0;
+  u32 DrawCalls  = 0;
+};
+
+// Unit cube, four vertices per face so every face gets its own normal
+static void CreateCube(std::vector<Rava::Vertex>& vertices, std::vector<u32>& indices) {
+  for (u32 axis = 0; axis < 3; ++axis) {
+    for (f32 side : {-1.0f, 1.0f}) {
+      Vec3 normal{0.0f};
+      normal[axis] = side;
+      Vec3 u{0.0f};
+      Vec3 v{0.0f};
+      u[(axis + 1) % 3] = 0.5f;
+      v[(axis + 2) % 3] = 0.5f;
+
+      u32 first = static_cast<u32>(vertices.size());
+      for (Vec2 corner : {Vec2{-1, -1}, Vec2{1, -1}, Vec2{1, 1}, Vec2{-1, 1}}) {
+        Vec3 position = normal * 0.5f + u * corner.x + v * corner.y;
+        vertices.push_back({position, Vec4{1.0f}, normal, corner * 0.5f + 0.5f});
+      }
+      for (u32 index : {0u, 1u, 2u, 2u, 3u, 0u}) {
+        indices.push_back(first + index);
+      }
+    }
+  }
+}
+
+// Deterministic placement, the same instances for both cull modes
+static Rava::InstanceData CreateInstance(u32 index) {
+  u32 state = index * 747796405u + 2891336453u;
+  auto next = [&state]() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return static_cast<f32>(state) / static_cast<f32>(~0u) * 2.0f - 1.0f;
+  };
+
+  Rava::InstanceData instance;
+  instance.Transform = glm::translate(Mat4{1.0f}, Vec3{next(), next(), next()} * SCENE_EXTENT);
+  instance.Color     = Vec4{next() * 0.5f + 0.5f, next() * 0.5f + 0.5f, 0.8f, 1.0f};
+  instance.ID        = index;
+  return instance;
+}
+
+static FrameStats MeasureFrames(VK::GpuScene& scene) {
+  for (u32 i = 0; i < WARMUP_FRAME_COUNT; ++i) {
+    Rava::BeginFrame();
+    Rava::EndFrame();
+  }
+
+  FrameStats stats;
+  Rava::GpuFrameTimings timings;
+  for (u32 i = 0; i < MEASURE_FRAME_COUNT; ++i) {
+    auto start = Clock::now();
+    Rava::BeginFrame();
+    auto endFrameStart = Clock::now();
+    Rava::EndFrame();
+    auto end = Clock::now();
+
+    stats.FrameMs += ElapsedNs(start, end) * 1e-6;
+    stats.EndFrameMs += ElapsedNs(endFrameStart, end) * 1e-6;
+    stats.DrawCalls = scene.GetDrawCallCount();
+
+    // Lags a few frames behind, those ran with the same instance count after the warmup
+    if (Rava::GetGpuFrameTimings(timings)) {
+      stats.GpuMs += timings.FrameMs;
+      for (const auto& scope : timings.Scopes) {
+        if (scope.Name == CULL_NAME) {
+          stats.GpuCullMs += scope.DurationMs;
+        }
+      }
+    }
+  }
+
+  stats.FrameMs /= MEASURE_FRAME_COUNT;
+  stats.EndFrameMs /= MEASURE_FRAME_COUNT;
+  stats.GpuMs /= MEASURE_FRAME_COUNT;
+  stats.GpuCullMs /= MEASURE_FRAME_COUNT;
+  return stats;
+}
+
+static void PrintStats(u32 instanceCount, std::string_view mode, const FrameStats& stats) {
+  std::print(
+      "{:>10} {:>6} {:>10.3f} {:>10.3f} {:>10.3f} {:>10.3f} {:>10}\n", instanceCount, mode,
+      stats.FrameMs, stats.EndFrameMs, stats.GpuMs, stats.GpuCullMs, stats.DrawCalls
+  );
+}
+
+// CPU frustum culling with one draw per visible instance against compute culling and one indirect
+// draw. The CPU cost of the GPU path has to stay flat as the instance count grows.
+void RunGpuCulling() {
+  VK::GpuScene* scene = InitGpuSceneFramework("GPU culling", false);
+  if (scene == nullptr) {
+    return;
+  }
+
+  std::vector<Rava::Vertex> vertices;
+  std::vector<u32> indices;
+  CreateCube(vertices, indices);
+  u32 cube = scene->AddMesh(vertices, indices);
+
+  Mat4 projection = glm::perspective(glm::radians(60.0f), 1280.0f / 720.0f, 0.1f, 2000.0f);
+  Mat4 view       = glm::lookAt(Vec3{0.0f}, Vec3{0.0f, 0.0f, 1.0f}, Vec3{0.0f, 1.0f, 0.0f});
+  scene->SetViewProjection(projection * view);
+
+  std::print("indirect count: {}\n", scene->IsDrawIndirectCountSupported() ? "yes" : "no");
+  std::print(
+      "{:>10} {:>6} {:>10} {:>10} {:>10} {:>10} {:>10}\n", "instances", "cull", "frame ms",
+      "record ms", "gpu ms", "cull ms", "draws"
+  );
+
+  for (u32 instanceCount : INSTANCE_COUNTS) {
+    for (u32 i = scene->GetInstanceCount(); i < instanceCount; ++i) {
+      scene->AddInstance(cube, CreateInstance(i));
+    }
+
+    scene->SetCullMode(VK::CullMode::Cpu);
+    PrintStats(instanceCount, "cpu", MeasureFrames(*scene));
+    scene->SetCullMode(VK::CullMode::Gpu);
+    PrintStats(instanceCount, "gpu", MeasureFrames(*scene));
+  }
+
+  ShutdownGpuSceneFramework();
+}
+}  // namespace Benchmark
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "RavaFramework.h"
+
+#include "Core/JobSystem.h"
+
+#include "Benchmark.h"
+
+namespace Benchmark {
+static constexpr u32 EMPTY_JOB_COUNT = 100000;
+static constexpr u32 WORK_JOB_COUNT  = 4096;
+static constexpr u32 WORK_PER_JOB    = 20000;
+static constexpr u32 REPEAT_COUNT    = 5;
+static constexpr u32 SPAWNER_COUNT   = 64;
+
+static u32 Work(u32 seed) {
+  u32 value = seed;
+  for (u32 i = 0; i < WORK_PER_JOB; ++i) {
+    value = value * 1664525u + 1013904223u;
+  }
+  return value;
+}
+
+void RunJobSystem() {
+  u32 maxWorkers = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+
+  // The work is identical for every worker count, so the single threaded time is the baseline
+  std::vector<u32> results(WORK_JOB_COUNT);
+  f64 serialNs = MeasureMin(REPEAT_COUNT, [&]() {
+    for (u32 i = 0; i < WORK_JOB_COUNT; ++i) {
+      results[i] = Work(i);
+    }
+  });
+
+  std::print(
+      "{:>8} {:>14} {:>14} {:>12} {:>9}\n", "workers", "empty ns/job", "nested ns/job", "work ms",
+      "speedup"
+  );
+
+  std::vector<u32> workerCounts{0};
+  for (u32 count = 1; count < maxWorkers; count *= 2) {
+    workerCounts.push_back(count);
+  }
+  if (maxWorkers > 0) {
+    workerCounts.push_back(maxWorkers);
+  }
+
+  for (u32 workerCount : workerCounts) {
+    Rava::JobSystem jobSystem{workerCount};
+
+    // Scheduling overhead: empty jobs submitted from the main thread
+    f64 emptyNs = MeasureMin(REPEAT_COUNT, [&]() {
+      Rava::JobCounter counter;
+      for (u32 i = 0; i < EMPTY_JOB_COUNT; ++i) {
+        jobSystem.Run([]() {}, &counter);
+      }
+      jobSystem.Wait(counter);
+    });
+
+    // Same amount of empty jobs, spawned from jobs so every worker pushes into its own deque
+    f64 nestedNs = MeasureMin(REPEAT_COUNT, [&]() {
+      Rava::JobCounter counter;
+      for (u32 i = 0; i < SPAWNER_COUNT; ++i) {
+        jobSystem.Run(
+            [&]() {
+              for (u32 j = 0; j < EMPTY_JOB_COUNT / SPAWNER_COUNT; ++j) {
+                jobSystem.Run([]() {}, &counter);
+              }
+            },
+            &counter
+        );
+      }
+      jobSystem.Wait(counter);
+    });
+
+    f64 workNs = MeasureMin(REPEAT_COUNT, [&]() {
+      jobSystem.ParallelFor(WORK_JOB_COUNT, 16, [&](u32 begin, u32 end) {
+        for (u32 i = begin; i < end; ++i) {
+          results[i] = Work(i);
+        }
+      });
+    });
+
+    std::print(
+        "{:>8} {:>14.1f} {:>14.1f} {:>12.2f} {:>8.2f}x\n", workerCount, emptyNs / EMPTY_JOB_COUNT,
+        nestedNs / EMPTY_JOB_COUNT, workNs / 1e6, serialNs / workNs
+    );
+  }
+}
+}  // namespace Benchmark
\ No newline at end of file
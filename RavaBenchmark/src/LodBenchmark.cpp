@@ -0,0 +1,82 @@
+#include "RavaFramework.h"
+
+#include "Graphics/ModelLoader/MeshSimplifier.h"
+#include "Graphics/Vulkan/VKGpuScene.h"
+
+#include "Benchmark.h"
+
+namespace Benchmark {
+static constexpr u32 SPHERE_RINGS     = 128;
+static constexpr u32 SPHERE_SEGMENTS  = 256;
+static constexpr u32 GRID_WIDTH       = 16;
+static constexpr u32 GRID_DEPTH       = 64;
+static constexpr f32 GRID_SPACING     = 4.0f;
+static constexpr f32 LOD_THRESHOLDS[] = {0.0f, 0.5f, 1.0f, 2.0f};
+
+// Rows of dense spheres receding from the camera, drawn with every level forced off and with the
+// screen space error selection at a few thresholds
+void RunLod() {
+  std::vector<Rava::Vertex> vertices;
+  std::vector<u32> indices;
+  CreateSphere(SPHERE_RINGS, SPHERE_SEGMENTS, vertices, indices);
+
+  std::vector<u32> lodIndices;
+  std::vector<Rava::MeshLod> lods;
+  auto start = Clock::now();
+  Rava::MeshSimplifier::GenerateLods(vertices, indices, Rava::Mesh::MAX_LODS, lodIndices, lods);
+  f64 simplifyMs = ElapsedNs(start, Clock::now()) * 1e-6;
+
+  std::print("simplification: {:.1f} ms\n", simplifyMs);
+  std::print("{:>6} {:>10} {:>10}\n", "level", "triangles", "error");
+  std::print("{:>6} {:>10} {:>10.5f}\n", 0, indices.size() / 3, 0.0f);
+  for (u32 level = 0; level < lods.size(); ++level) {
+    const Rava::MeshLod& lod = lods[level];
+    std::print("{:>6} {:>10} {:>10.5f}\n", level + 1, lod.IndexCount / 3, lod.Error);
+  }
+
+  // The full mesh first, then the levels behind it
+  u32 baseIndexCount = static_cast<u32>(indices.size());
+  indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+  for (Rava::MeshLod& lod : lods) {
+    lod.FirstIndex += baseIndexCount;
+  }
+
+  VK::GpuScene* scene = InitGpuSceneFramework("LOD", true);
+  if (scene == nullptr) {
+    return;
+  }
+
+  u32 sphere = scene->AddMesh(vertices, indices, lods);
+  for (u32 z = 0; z < GRID_DEPTH; ++z) {
+    for (u32 x = 0; x < GRID_WIDTH; ++x) {
+      f32 offset = (static_cast<f32>(x) - GRID_WIDTH * 0.5f) * GRID_SPACING;
+      Rava::InstanceData instance;
+      instance.Transform = glm::translate(Mat4{1.0f}, Vec3{offset, 0.0f, (z + 1) * GRID_SPACING});
+      instance.ID        = z * GRID_WIDTH + x;
+      scene->AddInstance(sphere, instance);
+    }
+  }
+
+  Vec3 eye{0.0f, 3.0f, 0.0f};
+  f32 verticalFov = glm::radians(60.0f);
+  Mat4 projection = glm::perspective(verticalFov, 1280.0f / 720.0f, 0.1f, 1000.0f);
+  Mat4 view       = glm::lookAt(eye, Vec3{0.0f, 0.0f, GRID_SPACING * 8.0f}, Vec3{0.0f, 1.0f, 0.0f});
+  scene->SetViewProjection(projection * view);
+  Rava::SetLodCamera(eye, verticalFov);
+
+  std::print("\ninstances: {}\n", scene->GetInstanceCount());
+  std::print("{:>10} {:>12} {:>10} {:>10}\n", "threshold", "triangles", "frame ms", "gpu ms");
+  for (f32 threshold : LOD_THRESHOLDS) {
+    Rava::SetLodThreshold(threshold);
+    GeometryFrameStats stats = MeasureGeometryFrames();
+    std::string triangles    = stats.HasCounted ? std::to_string(stats.Triangles) : "-";
+    std::print(
+        "{:>10} {:>12} {:>10.3f} {:>10.3f}\n",
+        threshold > 0.0f ? std::format("{:.1f} px", threshold) : "off", triangles, stats.FrameMs,
+        stats.GpuMs
+    );
+  }
+
+  ShutdownGpuSceneFramework();
+}
+}  // namespace Benchmark
\ No newline at end of file
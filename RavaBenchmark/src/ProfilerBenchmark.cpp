@@ -0,0 +1,65 @@
+#include "RavaFramework.h"
+
+#include "Core/CpuProfiler.h"
+#include "Core/JobSystem.h"
+
+#include "Benchmark.h"
+
+namespace Benchmark {
+static constexpr u32 SCOPE_COUNT  = 1000000;
+static constexpr u32 REPEAT_COUNT = 5;
+
+static void RecordScopes(u32 count) {
+  for (u32 i = 0; i < count; ++i) {
+    Rava::ProfileScope scope("Benchmark");
+  }
+}
+
+void RunCpuProfiler() {
+  Rava::CpuProfiler::Create();
+  Rava::CpuProfiler& profiler = *Rava::CpuProfiler::Instance;
+
+  f64 disabledNs = MeasureMin(REPEAT_COUNT, []() { RecordScopes(SCOPE_COUNT); });
+
+  profiler.Start();
+  f64 enabledNs = MeasureMin(REPEAT_COUNT, []() { RecordScopes(SCOPE_COUNT); });
+
+  // Every thread writes its own ring, so the cost per scope should not grow with the thread count.
+  // Each thread times its own loop: the mean is the cost under contention, the slowest thread shows
+  // whether one of them is held up.
+  u32 workerCount  = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+  f64 threadMeanNs = std::numeric_limits<f64>::max();
+  f64 threadSlowNs = std::numeric_limits<f64>::max();
+  {
+    Rava::JobSystem jobSystem{workerCount};
+    u32 threadCount = jobSystem.GetThreadCount();
+    std::vector<f64> threadNs(threadCount);
+    for (u32 i = 0; i < REPEAT_COUNT; ++i) {
+      jobSystem.ParallelFor(threadCount, 1, [&](u32 first, u32) {
+        auto start = Clock::now();
+        RecordScopes(SCOPE_COUNT);
+        threadNs[first] = ElapsedNs(start, Clock::now());
+      });
+
+      f64 totalNs = 0.0;
+      f64 slowNs  = 0.0;
+      for (f64 ns : threadNs) {
+        totalNs += ns;
+        slowNs = std::max(slowNs, ns);
+      }
+      threadMeanNs = std::min(threadMeanNs, totalNs / threadCount);
+      threadSlowNs = std::min(threadSlowNs, slowNs);
+    }
+  }
+  profiler.Stop();
+
+  std::string threads = std::format("recording, {} threads", workerCount + 1);
+  std::print("{:>32} {:>10}\n", "", "ns/scope");
+  std::print("{:>32} {:>10.2f}\n", "not recording", disabledNs / SCOPE_COUNT);
+  std::print("{:>32} {:>10.2f}\n", "recording", enabledNs / SCOPE_COUNT);
+  std::print("{:>32} {:>10.2f}\n", threads + ", mean", threadMeanNs / SCOPE_COUNT);
+  std::print("{:>32} {:>10.2f}\n", threads + ", slowest", threadSlowNs / SCOPE_COUNT);
+
+  Rava::CpuProfiler::Instance.reset();
+}
+}  // namespace Benchmark
\ No newline at end of file
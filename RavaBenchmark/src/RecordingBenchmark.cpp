@@ -0,0 +1,111 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Renderer.h"
+#include "Graphics/Vulkan/VKCommandRecorder.h"
+#include "Graphics/Vulkan/VKGpuScene.h"
+#include "Graphics/Vulkan/VKRenderer.h"
+
+#include "Benchmark.h"
+
+namespace Benchmark {
+static constexpr u32 WARMUP_FRAME_COUNT  = 8;
+static constexpr u32 MEASURE_FRAME_COUNT = 32;
+static constexpr u32 GRID_WIDTH          = 50;
+static constexpr u32 GRID_HEIGHT         = 25;
+static constexpr u32 GRID_DEPTH          = 40;  // 50k instances, all in view
+static constexpr f32 GRID_SPACING        = 1.6f;
+static constexpr u32 WORKER_COUNTS[]     = {1, 3, 7, 15};
+
+struct RecordingStats {
+  f64 EndFrameMs     = 0.0;  // draw recording and submission
+  u32 DrawCalls      = 0;
+  u32 SecondaryCount = 0;
+};
+
+static RecordingStats MeasureRecording(u32 workerCount, bool isParallel) {
+  RecordingStats stats;
+  Rava::SetWorkerThreadCount(workerCount);
+  Rava::SetParallelRecording(isParallel);
+  if (!Rava::InitFramework(1280, 720)) {
+    return stats;
+  }
+
+  auto* renderer      = static_cast<VK::Renderer*>(Rava::Renderer::Instance.get());
+  VK::GpuScene* scene = renderer->GetGpuScene();
+  if (scene == nullptr) {
+    Rava::ShutdownFramework();
+    return stats;
+  }
+
+  std::vector<Rava::Vertex> vertices;
+  std::vector<u32> indices;
+  CreateSphere(4, 8, vertices, indices);
+  u32 sphere = scene->AddMesh(vertices, indices);
+  for (u32 z = 0; z < GRID_DEPTH; ++z) {
+    for (u32 y = 0; y < GRID_HEIGHT; ++y) {
+      for (u32 x = 0; x < GRID_WIDTH; ++x) {
+        Vec3 position{
+            (static_cast<f32>(x) - GRID_WIDTH * 0.5f) * GRID_SPACING,
+            (static_cast<f32>(y) - GRID_HEIGHT * 0.5f) * GRID_SPACING, 60.0f + z * GRID_SPACING
+        };
+        Rava::InstanceData instance;
+        instance.Transform = glm::translate(Mat4{1.0f}, position);
+        instance.ID        = (z * GRID_HEIGHT + y) * GRID_WIDTH + x;
+        scene->AddInstance(sphere, instance);
+      }
+    }
+  }
+
+  Mat4 projection = glm::perspective(glm::radians(60.0f), 1280.0f / 720.0f, 0.1f, 1000.0f);
+  Mat4 view       = glm::lookAt(Vec3{0.0f}, Vec3{0.0f, 0.0f, 1.0f}, Vec3{0.0f, 1.0f, 0.0f});
+  scene->SetViewProjection(projection * view);
+  scene->SetCullMode(VK::CullMode::Cpu);
+
+  for (u32 i = 0; i < WARMUP_FRAME_COUNT; ++i) {
+    Rava::BeginFrame();
+    Rava::EndFrame();
+  }
+
+  for (u32 i = 0; i < MEASURE_FRAME_COUNT; ++i) {
+    Rava::BeginFrame();
+    auto start = Clock::now();
+    Rava::EndFrame();
+    stats.EndFrameMs += ElapsedNs(start, Clock::now()) * 1e-6;
+  }
+  stats.EndFrameMs /= MEASURE_FRAME_COUNT;
+
+  stats.DrawCalls      = scene->GetDrawCallCount();
+  stats.SecondaryCount = renderer->GetCommandRecorder().GetSecondaryCount();
+
+  Rava::ShutdownFramework();
+  return stats;
+}
+
+// One draw call per instance with CPU culling, recorded inline on the main thread against secondary
+// command buffers recorded by a growing number of job threads
+void RunParallelRecording() {
+  Rava::SetHeadless(true);
+  Rava::SetGpuScene(true);
+
+  std::print(
+      "{:>8} {:>9} {:>10} {:>10} {:>12}\n", "threads", "mode", "record ms", "draws", "secondaries"
+  );
+  RecordingStats inlineStats = MeasureRecording(0, false);
+  std::print(
+      "{:>8} {:>9} {:>10.3f} {:>10} {:>12}\n", 1, "inline", inlineStats.EndFrameMs,
+      inlineStats.DrawCalls, inlineStats.SecondaryCount
+  );
+
+  for (u32 workerCount : WORKER_COUNTS) {
+    RecordingStats stats = MeasureRecording(workerCount, true);
+    std::print(
+        "{:>8} {:>9} {:>10.3f} {:>10} {:>12}\n", workerCount + 1, "parallel", stats.EndFrameMs,
+        stats.DrawCalls, stats.SecondaryCount
+    );
+  }
+
+  Rava::SetParallelRecording(true);
+  Rava::SetWorkerThreadCount(0);
+  Rava::SetGpuScene(false);
+}
+}  // namespace Benchmark
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Renderer.h"
+#include "Graphics/Vulkan/VKRenderGraph.h"
+#include "Graphics/Vulkan/VKRenderer.h"
+
+#include "Benchmark.h"
+
+namespace Benchmark {
+static constexpr u32 WARMUP_FRAME_COUNT  = 16;
+static constexpr u32 MEASURE_FRAME_COUNT = 120;
+static constexpr u32 WIDTH               = 1280;
+static constexpr u32 HEIGHT              = 720;
+static constexpr u32 SHADOW_MAP_SIZE     = 2048;
+
+// Declared in front of the swap chain render pass, composited after it
+struct SceneImages {
+  u32 Lighting = 0;
+  u32 Bloom    = 0;
+};
+
+struct GraphFrameStats {
+  VK::RenderGraphStats Graph;
+  f64 CpuMs = 0.0;
+  f64 GpuMs = 0.0;
+};
+
+static SceneImages s_sceneImages;
+
+static void ExecuteNothing(VkCommandBuffer) {}
+
+// Shadow map, depth prepass, ambient occlusion with a separable blur and the lighting into an HDR
+// target, then a bloom pass. A debug view nothing reads is culled.
+static void DeclareScenePasses(VK::RenderGraph& graph, const VK::SwapChainTargets&) {
+  VkExtent2D extent       = {WIDTH, HEIGHT};
+  VkExtent2D halfExtent   = {WIDTH / 2, HEIGHT / 2};
+  VkExtent2D shadowExtent = {SHADOW_MAP_SIZE, SHADOW_MAP_SIZE};
+
+  u32 shadowMap     = graph.CreateImage("ShadowMap", VK_FORMAT_D32_SFLOAT, shadowExtent);
+  u32 prepassDepth  = graph.CreateImage("PrepassDepth", VK_FORMAT_D32_SFLOAT, extent);
+  u32 occlusion     = graph.CreateImage("Occlusion", VK_FORMAT_R32_SFLOAT, extent);
+  u32 occlusionBlur = graph.CreateImage("OcclusionBlurX", VK_FORMAT_R32_SFLOAT, extent);
+  u32 occlusionDone = graph.CreateImage("OcclusionBlurY", VK_FORMAT_R32_SFLOAT, extent);
+  u32 lighting      = graph.CreateImage("Lighting", VK_FORMAT_R16G16B16A16_SFLOAT, extent);
+  u32 bloom         = graph.CreateImage("Bloom", VK_FORMAT_R16G16B16A16_SFLOAT, halfExtent);
+  u32 debugView     = graph.CreateImage("DebugView", VK_FORMAT_R32_SFLOAT, extent);
+
+  u32 pass = graph.AddPass("Shadow", VK::PassType::Graphics, ExecuteNothing);
+  graph.SetDepthAttachment(pass, shadowMap, VK_ATTACHMENT_LOAD_OP_CLEAR);
+
+  pass = graph.AddPass("DepthPrepass", VK::PassType::Graphics, ExecuteNothing);
+  graph.SetDepthAttachment(pass, prepassDepth, VK_ATTACHMENT_LOAD_OP_CLEAR);
+
+  pass = graph.AddPass("AmbientOcclusion", VK::PassType::Compute, ExecuteNothing);
+  graph.Read(pass, prepassDepth, VK::ResourceUsage::Sampled);
+  graph.Write(pass, occlusion, VK::ResourceUsage::StorageWrite);
+
+  pass = graph.AddPass("BlurX", VK::PassType::Compute, ExecuteNothing);
+  graph.Read(pass, occlusion, VK::ResourceUsage::Sampled);
+  graph.Write(pass, occlusionBlur, VK::ResourceUsage::StorageWrite);
+
+  pass = graph.AddPass("BlurY", VK::PassType::Compute, ExecuteNothing);
+  graph.Read(pass, occlusionBlur, VK::ResourceUsage::Sampled);
+  graph.Write(pass, occlusionDone, VK::ResourceUsage::StorageWrite);
+
+  pass = graph.AddPass("DebugView", VK::PassType::Compute, ExecuteNothing);
+  graph.Read(pass, occlusion, VK::ResourceUsage::Sampled);
+  graph.Write(pass, debugView, VK::ResourceUsage::StorageWrite);
+
+  pass = graph.AddPass("Lighting", VK::PassType::Graphics, ExecuteNothing);
+  graph.SetColorAttachment(pass, lighting, VK_ATTACHMENT_LOAD_OP_CLEAR);
+  graph.Read(pass, shadowMap, VK::ResourceUsage::Sampled);
+  graph.Read(pass, occlusionDone, VK::ResourceUsage::Sampled);
+
+  pass = graph.AddPass("Bloom", VK::PassType::Compute, ExecuteNothing);
+  graph.Read(pass, lighting, VK::ResourceUsage::Sampled);
+  graph.Write(pass, bloom, VK::ResourceUsage::StorageWrite);
+
+  s_sceneImages.Lighting = lighting;
+  s_sceneImages.Bloom    = bloom;
+}
+
+// Over what the swap chain render pass drew, the only pass the scene passes are kept for
+static void DeclareCompositePass(VK::RenderGraph& graph, const VK::SwapChainTargets& targets) {
+  u32 pass = graph.AddPass("Composite", VK::PassType::Graphics, ExecuteNothing);
+  graph.SetColorAttachment(pass, targets.Color, VK_ATTACHMENT_LOAD_OP_LOAD);
+  graph.Read(pass, s_sceneImages.Lighting, VK::ResourceUsage::Sampled);
+  graph.Read(pass, s_sceneImages.Bloom, VK::ResourceUsage::Sampled);
+}
+
+static GraphFrameStats MeasureGraph(bool isDynamicRendering, bool isAliasingEnabled) {
+  GraphFrameStats stats;
+  Rava::SetDynamicRendering(isDynamicRendering);
+  if (!Rava::InitFramework(WIDTH, HEIGHT)) {
+    return stats;
+  }
+
+  auto* renderer = static_cast<VK::Renderer*>(Rava::Renderer::Instance.get());
+  renderer->GetRenderGraph().SetAliasingEnabled(isAliasingEnabled);
+  renderer->AddGraphSetup(DeclareScenePasses);
+  renderer->AddGraphSetup(DeclareCompositePass, true);
+
+  for (u32 i = 0; i < WARMUP_FRAME_COUNT; ++i) {
+    Rava::BeginFrame();
+    Rava::EndFrame();
+  }
+
+  Rava::ResetFramePacingStats();
+  for (u32 i = 0; i < MEASURE_FRAME_COUNT; ++i) {
+    Rava::BeginFrame();
+    Rava::EndFrame();
+  }
+
+  Rava::FramePacingStats pacing;
+  Rava::GetFramePacingStats(pacing);
+  stats.Graph = renderer->GetRenderGraph().GetStats();
+  stats.CpuMs = pacing.Cpu.P50Ms;
+  stats.GpuMs = pacing.Gpu.P50Ms;
+
+  Rava::ShutdownFramework();
+  return stats;
+}
+
+// The same frame with the transient images placed in shared memory and each in its own memory,
+// with render pass objects and with dynamic rendering where the device supports it. Nothing is
+// drawn, the GPU time is that of the clears, barriers and layout transitions.
+void RunRenderGraph() {
+  Rava::SetHeadless(true);
+  Rava::SetGpuProfiler(true);
+
+  std::print(
+      "{:>8} {:>9} {:>7} {:>7} {:>9} {:>9} {:>11} {:>8} {:>13} {:>13} {:>13} {:>8} {:>8}\n",
+      "dynamic", "aliasing", "passes", "culled", "barriers", "images", "transients", "buckets",
+      "requested MB", "allocated MB", "render passes", "cpu ms", "gpu ms"
+  );
+  for (bool isDynamicRendering : {false, true}) {
+    for (bool isAliasingEnabled : {false, true}) {
+      GraphFrameStats stats = MeasureGraph(isDynamicRendering, isAliasingEnabled);
+      std::print(
+          "{:>8} {:>9} {:>7} {:>7} {:>9} {:>9} {:>11} {:>8} {:>13.2f} {:>13.2f} {:>13} {:>8.3f} "
+          "{:>8.3f}\n",
+          isDynamicRendering ? "on" : "off", isAliasingEnabled ? "on" : "off",
+          stats.Graph.PassCount, stats.Graph.CulledPassCount, stats.Graph.BarrierBatchCount,
+          stats.Graph.ImageBarrierCount, stats.Graph.TransientCount, stats.Graph.MemoryBucketCount,
+          stats.Graph.TransientBytes / (1024.0 * 1024.0),
+          stats.Graph.AllocatedBytes / (1024.0 * 1024.0), stats.Graph.RenderPassCount,
+          stats.CpuMs, stats.GpuMs
+      );
+    }
+  }
+
+  Rava::SetDynamicRendering(true);
+  Rava::SetGpuProfiler(false);
+}
+}  // namespace Benchmark
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Renderer.h"
+#include "Graphics/Vulkan/VKAllocator.h"
+#include "Graphics/Vulkan/VKContext.h"
+#include "Graphics/Vulkan/VKRenderer.h"
+#include "Graphics/Vulkan/VKStagingRing.h"
+
+#include "Benchmark.h"
+
+namespace Benchmark {
+static constexpr u32 FRAME_COUNT            = 64;
+static constexpr u32 UPLOADS_PER_FRAME      = 256;
+static constexpr u32 MIN_UPLOAD_SIZE        = 256;
+static constexpr u32 MAX_UPLOAD_SIZE        = 128 * 1024;
+static constexpr u32 OVERSIZED_UPLOAD_SIZE  = 12u << 20;  // above a quarter of the default ring
+static constexpr u32 OVERSIZED_FRAME_STRIDE = 16;
+static constexpr VkDeviceSize DST_SIZE      = 64ull << 20;
+
+struct UploadRequest {
+  u32 Frame           = 0;
+  VkDeviceSize Offset = 0;
+  VkDeviceSize Size   = 0;
+};
+
+// Mostly small, scattered uploads like instance data and streamed geometry, with an occasional
+// large one like a texture
+static std::vector<UploadRequest> CreateRequests() {
+  std::mt19937 random(7);
+  std::uniform_int_distribution<u32> sizes(MIN_UPLOAD_SIZE, MAX_UPLOAD_SIZE);
+  std::vector<UploadRequest> requests;
+  for (u32 frame = 0; frame < FRAME_COUNT; ++frame) {
+    for (u32 i = 0; i < UPLOADS_PER_FRAME; ++i) {
+      VkDeviceSize size = sizes(random) & ~3u;
+      std::uniform_int_distribution<VkDeviceSize> offsets(0, (DST_SIZE - size) / 4);
+      requests.push_back({frame, offsets(random) * 4, size});
+    }
+    if (frame % OVERSIZED_FRAME_STRIDE == 0) {
+      requests.push_back({frame, 0, OVERSIZED_UPLOAD_SIZE});
+    }
+  }
+  return requests;
+}
+
+// A staging buffer and a queue wait per upload, what the ring replaces
+static f64 RunNaive(
+    VK::Context& context, VkBuffer dstBuffer, std::span<const UploadRequest> requests,
+    std::span<const u8> data
+) {
+  auto start = Clock::now();
+  for (const UploadRequest& request : requests) {
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VK::Allocation stagingMemory;
+    context.CreateBuffer(
+        request.Size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
+        stagingMemory
+    );
+    memcpy(stagingMemory.Mapped, data.data(), request.Size);
+    context.CopyBuffer(stagingBuffer, dstBuffer, request.Size, request.Offset);
+    context.DestroyBuffer(stagingBuffer, stagingMemory);
+  }
+  return ElapsedNs(start, Clock::now()) * 1e-6;
+}
+
+// The uploads of a frame are recorded between BeginFrame and EndFrame, which submits them
+static f64 RunRing(
+    VK::StagingRing& stagingRing, VkBuffer dstBuffer, std::span<const UploadRequest> requests,
+    std::span<const u8> data
+) {
+  auto start  = Clock::now();
+  size_t next = 0;
+  for (u32 frame = 0; frame < FRAME_COUNT; ++frame) {
+    Rava::ProcessMessage();
+    Rava::BeginFrame();
+    for (; next < requests.size() && requests[next].Frame == frame; ++next) {
+      stagingRing.UploadBuffer(
+          dstBuffer, requests[next].Offset, data.data(), requests[next].Size,
+          VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT
+      );
+    }
+    Rava::EndFrame();
+  }
+  stagingRing.Wait(stagingRing.Submit());
+  return ElapsedNs(start, Clock::now()) * 1e-6;
+}
+
+void RunUploads() {
+  Rava::SetHeadless(true);
+  if (!Rava::InitFramework(1280, 720)) {
+    std::print("InitFramework failed, skipping the upload benchmark\n");
+    return;
+  }
+
+  auto* renderer               = static_cast<VK::Renderer*>(Rava::Renderer::Instance.get());
+  VK::Context& context         = *renderer->GetContext();
+  VK::StagingRing& stagingRing = context.GetStagingRing();
+
+  VkBuffer dstBuffer = VK_NULL_HANDLE;
+  VK::Allocation dstMemory;
+  context.CreateBuffer(
+      DST_SIZE, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, dstBuffer, dstMemory
+  );
+
+  std::vector<UploadRequest> requests = CreateRequests();
+  std::vector<u8> data(OVERSIZED_UPLOAD_SIZE);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<u8>(i);
+  }
+  u64 totalBytes = 0;
+  for (const UploadRequest& request : requests) {
+    totalBytes += request.Size;
+  }
+
+  f64 naiveMs = RunNaive(context, dstBuffer, requests, data);
+  stagingRing.ResetStats();
+  f64 ringMs                    = RunRing(stagingRing, dstBuffer, requests, data);
+  const VK::StagingStats& stats = stagingRing.GetStats();
+
+  f64 totalMb = static_cast<f64>(totalBytes) / (1024.0 * 1024.0);
+  std::print(
+      "uploads: {} over {} frames, {:.1f} MB, ring: {} MB\n", requests.size(), FRAME_COUNT,
+      totalMb, stagingRing.GetSize() >> 20
+  );
+  std::print(
+      "{:>8} {:>10} {:>10} {:>9} {:>10} {:>8} {:>10} {:>12}\n", "path", "ms", "MB/s", "submits",
+      "dedicated", "stalls", "stall ms", "max stall ms"
+  );
+  std::print(
+      "{:>8} {:>10.2f} {:>10.1f} {:>9} {:>10} {:>8} {:>10} {:>12}\n", "naive", naiveMs,
+      totalMb / (naiveMs * 1e-3), requests.size(), requests.size(), requests.size(), "-", "-"
+  );
+  std::print(
+      "{:>8} {:>10.2f} {:>10.1f} {:>9} {:>10} {:>8} {:>10.2f} {:>12.2f}\n", "ring", ringMs,
+      totalMb / (ringMs * 1e-3), stats.SubmitCount, stats.DedicatedCount, stats.StallCount,
+      stats.StallMs, stats.MaxStallMs
+  );
+  std::print(
+      "ring skipped {} KB at its end, the frame loop itself is part of the ring time\n",
+      stats.Wasted >> 10
+  );
+
+  vkDeviceWaitIdle(context.GetLogicalDevice());
+  context.DestroyBuffer(dstBuffer, dstMemory);
+  Rava::ShutdownFramework();
+}
+}  // namespace Benchmark
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "RavaFramework.h"
+
+#include "Benchmark.h"
+
+struct BenchmarkEntry {
+  std::string_view Name;
+  void (*Run)();
+};
+
+static const BenchmarkEntry s_benchmarks[] = {
+    {"JobSystem", Benchmark::RunJobSystem},
+    {"CpuProfiler", Benchmark::RunCpuProfiler},
+    {"FrameAllocations", Benchmark::RunFrameAllocations},
+    {"GpuCulling", Benchmark::RunGpuCulling},
+    {"Lod", Benchmark::RunLod},
+    {"ClusterCulling", Benchmark::RunClusterCulling},
+    {"Uploads", Benchmark::RunUploads},
+    {"FramePacing", Benchmark::RunFramePacing},
+    {"ParallelRecording", Benchmark::RunParallelRecording},
+    {"RenderGraph", Benchmark::RunRenderGraph},
+};
+
+// Usage: RavaBenchmark [name...], runs every benchmark when no name is given
+int main(int argc, char** argv) {
+  for (const auto& benchmark : s_benchmarks) {
+    bool isSelected = argc <= 1;
+    for (int i = 1; i < argc; ++i) {
+      isSelected |= benchmark.Name == argv[i];
+    }
+
+    if (isSelected) {
+      std::print("=== {} ===\n", benchmark.Name);
+      benchmark.Run();
+      std::print("\n");
+    }
+  }
+}
\ No newline at end of file
@@ -8,4 +8,29 @@ extern std::string_view WindowTitle;
 extern bool IsFullscreen;
 extern bool IsResizeable;
 extern Color ClearColor;
+extern bool IsHeadless;
+extern bool IsFrameReadbackEnabled;
+extern std::string_view PipelineCachePath;
+extern std::string_view MeshCacheDirectory;
+extern bool IsMeshOptimizationEnabled;
+extern u32 WorkerThreadCount;
+extern bool IsGpuProfilerEnabled;
+extern bool IsGpuPipelineStatisticsEnabled;
+extern std::string_view GpuProfileDumpPath;
+extern bool IsCpuProfilerEnabled;
+extern std::string_view CpuTracePath;
+extern std::string_view ShaderDirectory;
+extern bool IsGpuSceneEnabled;
+extern u32 GeometryPoolVertexCount;
+extern u32 GeometryPoolIndexCount;
+extern VertexFormat SelectedVertexFormat;
+extern u32 LodLevelCount;
+extern f32 LodErrorThreshold;
+extern bool IsMeshletGenerationEnabled;
+extern u32 StagingRingSize;
+extern u32 FramesInFlight;
+extern LatencyMode SelectedLatencyMode;
+extern f32 TargetFrameRate;
+extern bool IsParallelRecordingEnabled;
+extern bool IsDynamicRenderingEnabled;
 }  // namespace Config
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "RavaFramework.h"
+
+#include "Core/CpuProfiler.h"
+
+namespace Rava {
+static constexpr u32 EVENT_CAPACITY = 16384;  // per thread, power of two
+
+struct Event {
+  // Atomics so SaveTrace can read a ring its thread is still writing, relaxed stores are plain
+  // moves on x64
+  std::atomic<const char*> Name{nullptr};
+  std::atomic<u64> Begin{0};
+  std::atomic<u64> End{0};
+};
+
+struct ThreadProfile {
+  alignas(64) std::atomic<u64> Head{0};
+  std::array<Event, EVENT_CAPACITY> Events;
+  std::string Name;
+  u32 ThreadIndex = 0;
+};
+
+static thread_local ThreadProfile* t_events = nullptr;
+static thread_local u32 t_generation        = 0;
+
+// Scope and thread names go into JSON strings
+static std::string EscapeJson(std::string_view text) {
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (static_cast<u8>(c) < 0x20) {
+      escaped += std::format("\\u{:04x}", static_cast<u32>(c));
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+Unique<CpuProfiler> CpuProfiler::Instance = nullptr;
+std::atomic<bool> CpuProfiler::s_isRecording{false};
+std::atomic<u32> CpuProfiler::s_generation{0};
+
+CpuProfiler::CpuProfiler() : _startTicks(Now()), _startTime(std::chrono::steady_clock::now()) {
+  // Invalidates the rings cached by threads of a previous instance
+  s_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+CpuProfiler::~CpuProfiler() {
+  s_isRecording.store(false, std::memory_order_relaxed);
+  s_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool CpuProfiler::Create() {
+  Instance = std::make_unique<CpuProfiler>();
+  SetThreadName("Main");
+  return true;
+}
+
+void CpuProfiler::Start() {
+  s_isRecording.store(true, std::memory_order_relaxed);
+}
+
+void CpuProfiler::Stop() {
+  s_isRecording.store(false, std::memory_order_relaxed);
+}
+
+void CpuProfiler::SetThreadName(std::string_view name) {
+  if (ThreadProfile* events = GetThreadProfile()) {
+    std::lock_guard lock(Instance->_mutex);
+    events->Name = name;
+  }
+}
+
+void CpuProfiler::Record(const char* name, u64 begin, u64 end) {
+  ThreadProfile* events = t_events;
+  if (events == nullptr || t_generation != s_generation.load(std::memory_order_relaxed)) {
+    events = GetThreadProfile();
+    if (events == nullptr) {
+      return;
+    }
+  }
+
+  u64 head     = events->Head.load(std::memory_order_relaxed);
+  Event& event = events->Events[head & (EVENT_CAPACITY - 1)];
+  event.Name.store(name, std::memory_order_relaxed);
+  event.Begin.store(begin, std::memory_order_relaxed);
+  event.End.store(end, std::memory_order_relaxed);
+  events->Head.store(head + 1, std::memory_order_release);
+}
+
+ThreadProfile* CpuProfiler::GetThreadProfile() {
+  u32 generation = s_generation.load(std::memory_order_relaxed);
+  if (t_events != nullptr && t_generation == generation) {
+    return t_events;
+  }
+  if (!Instance) {
+    return nullptr;
+  }
+
+  std::lock_guard lock(Instance->_mutex);
+  auto& events        = Instance->_threads.emplace_back(std::make_unique<ThreadProfile>());
+  events->ThreadIndex = static_cast<u32>(Instance->_threads.size());
+  events->Name        = std::format("Thread {}", events->ThreadIndex);
+
+  t_events     = events.get();
+  t_generation = generation;
+  return t_events;
+}
+
+bool CpuProfiler::SaveTrace(std::string_view path) const {
+  std::ofstream file(std::filesystem::path(path), std::ios::trunc);
+  if (!file) {
+    std::print("CpuProfiler: failed to open {}\n", path);
+    return false;
+  }
+
+  // Calibrates the tick rate over the whole lifetime of the profiler
+  auto elapsed      = std::chrono::steady_clock::now() - _startTime;
+  u64 ticks         = Now() - _startTicks;
+  f64 elapsedUs     = std::chrono::duration<f64, std::micro>(elapsed).count();
+  f64 microsPerTick = ticks > 0 && elapsedUs > 0.0 ? elapsedUs / static_cast<f64>(ticks) : 1e-3;
+
+  auto toUs = [&](u64 value) {
+    return static_cast<f64>(static_cast<i64>(value - _startTicks)) * microsPerTick;
+  };
+
+  std::lock_guard lock(_mutex);
+  file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+  bool isFirst = true;
+
+  for (const auto& events : _threads) {
+    file << std::format(
+        "{}{{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": {}, "
+        "\"args\": {{\"name\": \"{}\"}}}}",
+        isFirst ? "" : ",\n", events->ThreadIndex, EscapeJson(events->Name)
+    );
+    isFirst = false;
+
+    u64 head  = events->Head.load(std::memory_order_acquire);
+    u64 first = head > EVENT_CAPACITY ? head - EVENT_CAPACITY : 0;
+
+    std::vector<std::tuple<const char*, u64, u64>> copies;
+    copies.reserve(head - first);
+    for (u64 i = first; i < head; ++i) {
+      const Event& event = events->Events[i & (EVENT_CAPACITY - 1)];
+      copies.emplace_back(
+          event.Name.load(std::memory_order_relaxed), event.Begin.load(std::memory_order_relaxed),
+          event.End.load(std::memory_order_relaxed)
+      );
+    }
+
+    // Skip the slots the owning thread wrote over while they were copied
+    std::atomic_thread_fence(std::memory_order_acquire);
+    u64 newHead = events->Head.load(std::memory_order_relaxed);
+    u64 skip    = newHead - first > EVENT_CAPACITY ? newHead - first - EVENT_CAPACITY : 0;
+
+    for (u64 i = std::min<u64>(skip, copies.size()); i < copies.size(); ++i) {
+      auto [name, begin, end] = copies[i];
+      file << std::format(
+          ",\n{{\"name\": \"{}\", \"ph\": \"X\", \"pid\": 1, \"tid\": {}, \"ts\": {:.3f}, "
+          "\"dur\": {:.3f}}}",
+          EscapeJson(name), events->ThreadIndex, toUs(begin),
+          static_cast<f64>(end - begin) * microsPerTick
+      );
+    }
+  }
+
+  file << "\n]}\n";
+  std::print("CpuProfiler: saved trace to {}\n", path);
+  return true;
+}
+}  // namespace Rava
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#if defined(_M_X64) || defined(__x86_64__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define RV_PROFILER_RDTSC
+#endif
+
+namespace Rava {
+struct ThreadProfile;
+
+// Records named CPU scopes into a lock-free ring per thread and exports them as a Chrome trace
+// (chrome://tracing, ui.perfetto.dev). Every thread only writes its own ring, so a recorded scope
+// costs two timestamp reads and a few stores. While not recording a scope is a single load.
+// Scope names are not copied, they have to be string literals or live for the whole run.
+class CpuProfiler {
+public:
+  static Unique<CpuProfiler> Instance;
+
+public:
+  CpuProfiler();
+  ~CpuProfiler();
+
+  NO_COPY(CpuProfiler)
+  NO_MOVE(CpuProfiler)
+
+  static bool Create();
+
+  void Start();
+  void Stop();
+  // Writes the events still held by the rings. Threads that keep recording while it runs only
+  // lose the events they overwrite.
+  bool SaveTrace(std::string_view path) const;
+
+  // Shown as the track name in the trace
+  static void SetThreadName(std::string_view name);
+  static void Record(const char* name, u64 begin, u64 end);
+
+  static inline bool IsRecording() { return s_isRecording.load(std::memory_order_relaxed); }
+
+  // Invariant TSC ticks on x64, steady clock nanoseconds elsewhere
+  static inline u64 Now() {
+#ifdef RV_PROFILER_RDTSC
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+  }
+
+private:
+  static std::atomic<bool> s_isRecording;
+  static std::atomic<u32> s_generation;
+
+  mutable std::mutex _mutex;
+  std::vector<Unique<ThreadProfile>> _threads;
+  u64 _startTicks = 0;
+  std::chrono::steady_clock::time_point _startTime;
+
+private:
+  static ThreadProfile* GetThreadProfile();
+};
+
+class ProfileScope {
+public:
+  inline explicit ProfileScope(const char* name) : _name(name) {
+    if (CpuProfiler::IsRecording()) {
+      _begin = CpuProfiler::Now();
+    }
+  }
+
+  inline ~ProfileScope() {
+    if (_begin != 0) {
+      CpuProfiler::Record(_name, _begin, CpuProfiler::Now());
+    }
+  }
+
+  NO_COPY(ProfileScope)
+  NO_MOVE(ProfileScope)
+
+private:
+  const char* _name;
+  u64 _begin = 0;
+};
+}  // namespace Rava
+
+// Compiled out in release builds unless RV_ENABLE_PROFILER is defined
+#if defined(RV_RELEASE) && !defined(RV_ENABLE_PROFILER)
+#define RV_PROFILE_SCOPE(name)
+#else
+#define RV_PROFILE_CONCAT_IMPL(a, b) a##b
+#define RV_PROFILE_CONCAT(a, b)      RV_PROFILE_CONCAT_IMPL(a, b)
+#define RV_PROFILE_SCOPE(name) \
+  ::Rava::ProfileScope RV_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#endif
+#define RV_PROFILE_FUNCTION() RV_PROFILE_SCOPE(__FUNCTION__)
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "RavaFramework.h"
+
+#include "Core/FrameAllocator.h"
+
+namespace Rava {
+static constexpr size_t SCRATCH_CHUNK_SIZE = 256 * 1024;
+
+// Offset into data that is aligned in memory, not just relative to the chunk
+static size_t AlignOffset(const u8* data, size_t offset, size_t alignment) {
+  uintptr_t address = reinterpret_cast<uintptr_t>(data) + offset;
+  return offset + ((alignment - address % alignment) % alignment);
+}
+
+LinearArena::LinearArena(size_t chunkSize) : _chunkSize(chunkSize) {}
+
+LinearArena::~LinearArena() {
+  for (const Chunk& chunk : _chunks) {
+    ::operator delete(chunk.Data, std::align_val_t{alignof(std::max_align_t)});
+  }
+}
+
+void* LinearArena::Allocate(size_t size, size_t alignment) {
+  assert(std::has_single_bit(alignment));
+  size = std::max<size_t>(size, 1);
+
+  // Current chunk first, then the chunks left behind by a rewind
+  for (u32 i = _chunkIndex; i < _chunks.size(); ++i) {
+    const Chunk& chunk = _chunks[i];
+    size_t offset      = AlignOffset(chunk.Data, i == _chunkIndex ? _offset : 0, alignment);
+    if (offset + size <= chunk.Size) {
+      _chunkIndex = i;
+      _offset     = offset + size;
+      return chunk.Data + offset;
+    }
+  }
+
+  // Grows geometrically so the first frames need few chunks
+  AddChunk(std::max({_chunkSize, size + alignment, _capacity}));
+  const Chunk& chunk = _chunks.back();
+  size_t offset      = AlignOffset(chunk.Data, 0, alignment);
+  _chunkIndex        = static_cast<u32>(_chunks.size() - 1);
+  _offset            = offset + size;
+  return chunk.Data + offset;
+}
+
+void LinearArena::Reset() {
+  _chunkIndex = 0;
+  _offset     = 0;
+
+  if (_chunks.size() <= 1) {
+    return;
+  }
+
+  // Everything needed this time fits into one chunk next time
+  size_t capacity = _capacity;
+  for (const Chunk& chunk : _chunks) {
+    ::operator delete(chunk.Data, std::align_val_t{alignof(std::max_align_t)});
+  }
+  _chunks.clear();
+  _capacity = 0;
+  AddChunk(capacity);
+}
+
+void LinearArena::Rewind(Marker marker) {
+  assert(marker.ChunkIndex < _chunks.size() || (marker.ChunkIndex == 0 && marker.Offset == 0));
+  _chunkIndex = marker.ChunkIndex;
+  _offset     = marker.Offset;
+}
+
+void LinearArena::AddChunk(size_t size) {
+  Chunk chunk;
+  chunk.Data = static_cast<u8*>(::operator new(size, std::align_val_t{alignof(std::max_align_t)}));
+  chunk.Size = size;
+  _chunks.push_back(chunk);
+  _capacity += size;
+}
+
+struct FrameArena {
+  LinearArena Arena;
+  ArenaResource Resource{Arena};
+};
+
+struct FrameArenas {
+  Unique<FrameArena[]> Frames;
+};
+
+static thread_local FrameArenas* t_frameArenas = nullptr;
+static thread_local u32 t_frameGeneration      = 0;
+
+static thread_local LinearArena t_scratchArena{SCRATCH_CHUNK_SIZE};
+static thread_local u32 t_scratchDepth = 0;
+
+Unique<FrameAllocator> FrameAllocator::Instance = nullptr;
+std::atomic<u32> FrameAllocator::s_generation{0};
+
+FrameAllocator::FrameAllocator(u32 frameCount) : _frameCount(frameCount) {
+  // Invalidates the arenas cached by threads of a previous instance
+  s_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+FrameAllocator::~FrameAllocator() {
+  s_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool FrameAllocator::Create(u32 frameCount) {
+  Instance = std::make_unique<FrameAllocator>(frameCount);
+  return true;
+}
+
+void* FrameAllocator::Allocate(size_t size, size_t alignment) {
+  FrameArenas* arenas = GetThreadArenas();
+  assert(arenas && "FrameAllocator was not created");
+  return arenas->Frames[Instance->GetFrameIndex()].Arena.Allocate(size, alignment);
+}
+
+std::pmr::memory_resource* FrameAllocator::GetResource() {
+  FrameArenas* arenas = GetThreadArenas();
+  assert(arenas && "FrameAllocator was not created");
+  return &arenas->Frames[Instance->GetFrameIndex()].Resource;
+}
+
+void FrameAllocator::BeginFrame(u32 frameIndex) {
+  assert(frameIndex < _frameCount);
+  // Still the slot of everything allocated before the first frame
+  if (frameIndex == GetFrameIndex()) {
+    return;
+  }
+
+  std::lock_guard lock(_mutex);
+  for (auto& arenas : _threads) {
+    arenas->Frames[frameIndex].Arena.Reset();
+  }
+  _frameIndex.store(frameIndex, std::memory_order_relaxed);
+}
+
+FrameArenas* FrameAllocator::GetThreadArenas() {
+  u32 generation = s_generation.load(std::memory_order_relaxed);
+  if (t_frameArenas != nullptr && t_frameGeneration == generation) {
+    return t_frameArenas;
+  }
+  if (!Instance) {
+    return nullptr;
+  }
+
+  std::lock_guard lock(Instance->_mutex);
+  u32 frameCount = Instance->_frameCount;
+  auto& arenas   = Instance->_threads.emplace_back(std::make_unique<FrameArenas>());
+  arenas->Frames = std::make_unique<FrameArena[]>(frameCount);
+
+  t_frameArenas     = arenas.get();
+  t_frameGeneration = generation;
+  return t_frameArenas;
+}
+
+ScratchScope::ScratchScope()
+    : _arena(t_scratchArena), _marker(t_scratchArena.GetMarker()), _resource(t_scratchArena) {
+  ++t_scratchDepth;
+}
+
+ScratchScope::~ScratchScope() {
+  // The outermost scope also merges the chunks the scratch memory grew into
+  if (--t_scratchDepth == 0) {
+    _arena.Reset();
+  } else {
+    _arena.Rewind(_marker);
+  }
+}
+}  // namespace Rava
\ No newline at end of file
@@ -0,0 +1,150 @@
+#pragma once
+
+namespace Rava {
+struct FrameArenas;
+
+// Bump allocator over a list of chunks. Reset keeps the memory and merges the chunks into a single
+// one of the combined size, so an arena that is reset every frame settles on one chunk and stops
+// touching the heap. Nothing is destructed, only use it for trivially destructible data or through
+// containers that are gone before the arena is reset.
+class LinearArena {
+public:
+  static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+  struct Marker {
+    u32 ChunkIndex = 0;
+    size_t Offset  = 0;
+  };
+
+public:
+  explicit LinearArena(size_t chunkSize = DEFAULT_CHUNK_SIZE);
+  ~LinearArena();
+
+  NO_COPY(LinearArena)
+  NO_MOVE(LinearArena)
+
+  void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+  template <typename T>
+  std::span<T> AllocateArray(size_t count) {
+    static_assert(std::is_trivially_destructible_v<T>);
+    T* data = static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+    std::uninitialized_value_construct_n(data, count);
+    return {data, count};
+  }
+
+  void Reset();
+  inline Marker GetMarker() const { return {_chunkIndex, _offset}; }
+  // Frees everything allocated after the marker was taken
+  void Rewind(Marker marker);
+
+  inline size_t GetCapacity() const { return _capacity; }
+  inline size_t GetChunkCount() const { return _chunks.size(); }
+
+private:
+  struct Chunk {
+    u8* Data    = nullptr;
+    size_t Size = 0;
+  };
+
+  std::vector<Chunk> _chunks;
+  u32 _chunkIndex   = 0;
+  size_t _offset    = 0;
+  size_t _chunkSize = 0;
+  size_t _capacity  = 0;
+
+private:
+  void AddChunk(size_t size);
+};
+
+// std::pmr view of an arena, deallocation is a no-op
+class ArenaResource final : public std::pmr::memory_resource {
+public:
+  explicit ArenaResource(LinearArena& arena) : _arena(&arena) {}
+
+private:
+  LinearArena* _arena;
+
+private:
+  void* do_allocate(size_t size, size_t alignment) override {
+    return _arena->Allocate(size, alignment);
+  }
+  void do_deallocate(void*, size_t, size_t) override {}
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+// Memory that stays valid until the frame slot it was allocated in comes around again, so data
+// handed to the GPU or to jobs of the frame outlives it by frameCount - 1 frames. Every thread
+// bumps its own arenas, BeginFrame moves all threads to the slot of the new frame and resets it.
+class FrameAllocator {
+public:
+  static Unique<FrameAllocator> Instance;
+
+public:
+  FrameAllocator(u32 frameCount);
+  ~FrameAllocator();
+
+  NO_COPY(FrameAllocator)
+  NO_MOVE(FrameAllocator)
+
+  static bool Create(u32 frameCount);
+
+  // Any thread
+  static void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+  static std::pmr::memory_resource* GetResource();
+
+  template <typename T>
+  static std::span<T> AllocateArray(size_t count) {
+    static_assert(std::is_trivially_destructible_v<T>);
+    T* data = static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+    std::uninitialized_value_construct_n(data, count);
+    return {data, count};
+  }
+
+  // Main thread, once the frame that last used the slot has finished on the GPU
+  void BeginFrame(u32 frameIndex);
+
+  inline u32 GetFrameIndex() const { return _frameIndex.load(std::memory_order_relaxed); }
+  inline u32 GetFrameCount() const { return _frameCount; }
+
+private:
+  static std::atomic<u32> s_generation;
+
+  u32 _frameCount = 0;
+  std::atomic<u32> _frameIndex{0};
+  std::mutex _mutex;
+  std::vector<Unique<FrameArenas>> _threads;
+
+private:
+  static FrameArenas* GetThreadArenas();
+};
+
+// Stack-like temporary memory of the calling thread. Everything allocated through the scope is
+// freed when it ends. Scopes nest, an inner scope has to end before the outer one.
+class ScratchScope {
+public:
+  ScratchScope();
+  ~ScratchScope();
+
+  NO_COPY(ScratchScope)
+  NO_MOVE(ScratchScope)
+
+  inline void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    return _arena.Allocate(size, alignment);
+  }
+
+  template <typename T>
+  std::span<T> AllocateArray(size_t count) {
+    return _arena.AllocateArray<T>(count);
+  }
+
+  inline std::pmr::memory_resource* GetResource() { return &_resource; }
+
+private:
+  LinearArena& _arena;
+  LinearArena::Marker _marker;
+  ArenaResource _resource;
+};
+}  // namespace Rava
\ No newline at end of file
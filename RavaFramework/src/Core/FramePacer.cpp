@@ -0,0 +1,224 @@
+#include "RavaFramework.h"
+
+#include "Core/FramePacer.h"
+
+#include "Core/Config.h"
+#include "Core/CpuProfiler.h"
+
+#if defined(_WIN32) && !defined(CREATE_WAITABLE_TIMER_HIGH_RESOLUTION)
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+namespace Rava {
+Unique<FramePacer> FramePacer::Instance = nullptr;
+
+template <typename Duration>
+static f64 ToMs(Duration duration) {
+  return std::chrono::duration<f64, std::milli>(duration).count();
+}
+
+// Nearest rank percentiles, sorts the samples
+static FrameTimeStats ComputeStats(std::vector<f64>& samples) {
+  FrameTimeStats stats;
+  if (samples.empty()) {
+    return stats;
+  }
+
+  std::ranges::sort(samples);
+  auto percentile = [&](f64 fraction) {
+    size_t rank = static_cast<size_t>(std::ceil(fraction * samples.size()));
+    return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+  };
+
+  f64 sum = 0.0;
+  for (f64 sample : samples) {
+    sum += sample;
+  }
+  stats.AverageMs   = sum / samples.size();
+  stats.P50Ms       = percentile(0.50);
+  stats.P95Ms       = percentile(0.95);
+  stats.P99Ms       = percentile(0.99);
+  stats.MaxMs       = samples.back();
+  stats.SampleCount = static_cast<u32>(samples.size());
+  return stats;
+}
+
+void FramePacer::History::Push(f64 ms) {
+  if (Samples.size() < HISTORY_SIZE) {
+    Samples.push_back(ms);
+    return;
+  }
+  Samples[Next] = ms;
+  Next          = (Next + 1) % HISTORY_SIZE;
+}
+
+void FramePacer::History::Clear() {
+  Samples.clear();
+  Next = 0;
+}
+
+FramePacer::FramePacer() {
+#ifdef _WIN32
+  _timer = CreateWaitableTimerExW(
+      nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS
+  );
+#endif
+}
+
+FramePacer::~FramePacer() {
+#ifdef _WIN32
+  if (_timer != nullptr) {
+    CloseHandle(_timer);
+  }
+#endif
+}
+
+bool FramePacer::Create() {
+  Instance = std::make_unique<FramePacer>();
+  return true;
+}
+
+void FramePacer::BeginFrame() {
+  Clock::time_point now = Clock::now();
+  if (_frameCount > 0) {
+    _intervals.Push(ToMs(now - _frameBegin));
+  }
+  _frameBegin = now;
+  ++_frameCount;
+}
+
+void FramePacer::EndFrame() {
+  RV_PROFILE_FUNCTION();
+  Clock::time_point now = Clock::now();
+  _cpuTimes.Push(ToMs(now - _frameBegin));
+
+  if (Config::TargetFrameRate <= 0.0f) {
+    _targetMs = 0.0;
+    _deadline = {};
+    return;
+  }
+
+  _targetMs   = 1000.0 / Config::TargetFrameRate;
+  auto period = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<f64, std::milli>(_targetMs)
+  );
+
+  // The next frame is due one period after the previous deadline, so a late frame is made up by
+  // the following ones. Being late by more than a period starts over from now instead of rushing
+  // several frames out back to back.
+  Clock::time_point deadline = _deadline + period;
+  if (_deadline == Clock::time_point{}) {
+    deadline = now;
+  } else if (now > deadline) {
+    ++_missedCount;
+    if (now - deadline > period) {
+      deadline = now;
+    }
+  }
+
+  WaitUntil(deadline);
+  _deadline = deadline;
+}
+
+void FramePacer::MarkAcquired() {
+  _acquired = Clock::now();
+}
+
+void FramePacer::MarkPresented() {
+  _presentTimes.Push(ToMs(Clock::now() - _acquired));
+}
+
+void FramePacer::RecordGpuFrame(u64 frameNumber, f64 frameMs) {
+  if (frameNumber == _lastGpuFrame) {
+    return;
+  }
+  _gpuTimes.Push(frameMs);
+  _lastGpuFrame = frameNumber;
+}
+
+FramePacingStats FramePacer::GetStats() const {
+  FramePacingStats stats;
+  stats.TargetMs    = _targetMs;
+  stats.FrameCount  = _frameCount;
+  stats.MissedCount = _missedCount;
+
+  std::vector<f64> samples = _intervals.Samples;
+  stats.Interval           = ComputeStats(samples);
+
+  // Distance from the target, or from the typical interval while the frame rate is not limited
+  f64 reference = _targetMs > 0.0 ? _targetMs : stats.Interval.P50Ms;
+  for (f64& sample : samples) {
+    sample = std::abs(sample - reference);
+  }
+  stats.Jitter = ComputeStats(samples);
+
+  samples       = _cpuTimes.Samples;
+  stats.Cpu     = ComputeStats(samples);
+  samples       = _gpuTimes.Samples;
+  stats.Gpu     = ComputeStats(samples);
+  samples       = _presentTimes.Samples;
+  stats.Present = ComputeStats(samples);
+
+  if (_frameCount > 0) {
+    stats.SleepMs = _sleptMs / _frameCount;
+    stats.SpinMs  = _spunMs / _frameCount;
+  }
+  return stats;
+}
+
+void FramePacer::ResetStats() {
+  _intervals.Clear();
+  _cpuTimes.Clear();
+  _gpuTimes.Clear();
+  _presentTimes.Clear();
+  _frameCount  = 0;
+  _missedCount = 0;
+  _sleptMs     = 0.0;
+  _spunMs      = 0.0;
+}
+
+void FramePacer::WaitUntil(Clock::time_point deadline) {
+  RV_PROFILE_FUNCTION();
+  Clock::time_point now = Clock::now();
+  while (true) {
+    // Mean plus one standard deviation, an overslept frame costs more than a few more yields
+    f64 estimateMs = _sleepMeanMs + std::sqrt(_sleepM2 / _sleepCount);
+    if (ToMs(deadline - now) <= estimateMs) {
+      break;
+    }
+
+    SleepOnce();
+    Clock::time_point woken = Clock::now();
+    f64 sleptMs             = ToMs(woken - now);
+    now                     = woken;
+    _sleptMs               += sleptMs;
+
+    ++_sleepCount;
+    f64 delta     = sleptMs - _sleepMeanMs;
+    _sleepMeanMs += delta / _sleepCount;
+    _sleepM2     += delta * (sleptMs - _sleepMeanMs);
+  }
+
+  Clock::time_point spinBegin = now;
+  while (now < deadline) {
+    std::this_thread::yield();
+    now = Clock::now();
+  }
+  _spunMs += ToMs(now - spinBegin);
+}
+
+void FramePacer::SleepOnce() {
+#ifdef _WIN32
+  // Sleep rounds up to the 15.6 ms scheduler tick unless the timer resolution was raised
+  if (_timer != nullptr) {
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = -10000;  // relative, in 100 ns units
+    if (SetWaitableTimerEx(_timer, &dueTime, 0, nullptr, nullptr, nullptr, 0)) {
+      WaitForSingleObject(_timer, INFINITE);
+      return;
+    }
+  }
+#endif
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+}  // namespace Rava
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+namespace Rava {
+// Measures every frame on the CPU, takes the GPU frame time from the GPU profiler, and limits the
+// frame rate to Config::TargetFrameRate. The wait sleeps in 1 ms steps while the remaining time
+// covers a pessimistic estimate of the sleep, then spins with yields for the rest, so frames start
+// on time without keeping a core busy. Main thread only.
+class FramePacer {
+public:
+  static Unique<FramePacer> Instance;
+  static constexpr u32 HISTORY_SIZE = 1024;  // latest frames the statistics cover
+
+public:
+  FramePacer();
+  ~FramePacer();
+
+  NO_COPY(FramePacer)
+  NO_MOVE(FramePacer)
+
+  static bool Create();
+
+  // Rava::BeginFrame and Rava::EndFrame. EndFrame waits until the next frame is due, so the input
+  // of the next frame is polled after the wait rather than before it.
+  void BeginFrame();
+  void EndFrame();
+
+  // From the renderer, around the acquire and the present (the submit when headless)
+  void MarkAcquired();
+  void MarkPresented();
+  // Frames are resolved a few frames late, the same frame is only counted once
+  void RecordGpuFrame(u64 frameNumber, f64 frameMs);
+
+  FramePacingStats GetStats() const;
+  void ResetStats();
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  // Ring of the latest HISTORY_SIZE samples in milliseconds
+  struct History {
+    std::vector<f64> Samples;
+    u32 Next = 0;
+
+    void Push(f64 ms);
+    void Clear();
+  };
+
+  History _intervals;
+  History _cpuTimes;
+  History _gpuTimes;
+  History _presentTimes;
+  Clock::time_point _frameBegin;
+  Clock::time_point _acquired;
+  Clock::time_point _deadline;  // of the current frame, unset while the frame rate is not limited
+  f64 _targetMs     = 0.0;
+  u64 _frameCount   = 0;
+  u64 _missedCount  = 0;
+  u64 _lastGpuFrame = ~0ull;
+  f64 _sleptMs      = 0.0;
+  f64 _spunMs       = 0.0;
+
+  // Mean and squared deviations (Welford) of how long a 1 ms sleep really takes, which depends on
+  // the timer resolution of the OS and the load of the machine
+  f64 _sleepMeanMs = 2.0;
+  f64 _sleepM2     = 0.0;
+  u64 _sleepCount  = 1;
+
+#ifdef _WIN32
+  HANDLE _timer = nullptr;  // high resolution waitable timer, nullptr before Windows 10 1803
+#endif
+
+private:
+  void WaitUntil(Clock::time_point deadline);
+  void SleepOnce();
+};
+}  // namespace Rava
\ No newline at end of file
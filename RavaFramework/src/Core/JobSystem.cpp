@@ -0,0 +1,344 @@
+#include "RavaFramework.h"
+
+#include "Core/JobSystem.h"
+
+#include "Core/CpuProfiler.h"
+
+namespace Rava {
+static constexpr u32 JOB_CAPACITY   = 4096;  // per worker, power of two
+static constexpr u32 INVALID_WORKER = ~0u;
+
+static thread_local u32 t_workerIndex = INVALID_WORKER;
+
+struct Job {
+  JobFunction Function;
+  JobCounter* Counter = nullptr;
+  std::atomic<bool> IsPending{false};
+  bool IsHeapAllocated = false;
+};
+
+// Chase-Lev work-stealing deque (Le et al. 2013, "Correct and Efficient Work-Stealing for Weak
+// Memory Models"). The owner pushes and pops at the bottom, thieves steal from the top.
+class JobDeque {
+public:
+  bool Push(Job* job) {
+    i64 bottom = _bottom.load(std::memory_order_relaxed);
+    i64 top    = _top.load(std::memory_order_acquire);
+    if (bottom - top >= static_cast<i64>(JOB_CAPACITY)) {
+      return false;
+    }
+
+    _jobs[bottom & (JOB_CAPACITY - 1)].store(job, std::memory_order_relaxed);
+    _bottom.store(bottom + 1, std::memory_order_release);
+    return true;
+  }
+
+  Job* Pop() {
+    i64 bottom = _bottom.load(std::memory_order_relaxed) - 1;
+    _bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    i64 top = _top.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+      _bottom.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    Job* job = _jobs[bottom & (JOB_CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (top == bottom) {
+      // Last job, race against thieves for it
+      if (!_top.compare_exchange_strong(
+              top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+          )) {
+        job = nullptr;
+      }
+      _bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+  }
+
+  Job* Steal() {
+    i64 top = _top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    i64 bottom = _bottom.load(std::memory_order_acquire);
+
+    if (top >= bottom) {
+      return nullptr;
+    }
+
+    Job* job = _jobs[top & (JOB_CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (!_top.compare_exchange_strong(
+            top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+        )) {
+      return nullptr;
+    }
+    return job;
+  }
+
+private:
+  alignas(64) std::atomic<i64> _top{0};
+  alignas(64) std::atomic<i64> _bottom{0};
+  alignas(64) std::array<std::atomic<Job*>, JOB_CAPACITY> _jobs{};
+};
+
+struct JobSystem::Worker {
+  JobDeque Deque;
+  // Ring of job storage, only the owning thread allocates from it
+  std::array<Job, JOB_CAPACITY> Jobs{};
+  u32 NextJob     = 0;
+  u32 RandomState = 0;
+};
+
+Unique<JobSystem> JobSystem::Instance = nullptr;
+
+JobSystem::JobSystem(u32 workerThreadCount) : _mainThreadId(std::this_thread::get_id()) {
+  _workers.resize(workerThreadCount + 1);
+  for (u32 i = 0; i < _workers.size(); ++i) {
+    _workers[i]              = std::make_unique<Worker>();
+    _workers[i]->RandomState = 0x9E3779B9u * (i + 1);
+  }
+
+  t_workerIndex = 0;
+
+  _threads.reserve(workerThreadCount);
+  for (u32 i = 1; i <= workerThreadCount; ++i) {
+    _threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+  }
+}
+
+JobSystem::~JobSystem() {
+  _isRunning.store(false, std::memory_order_release);
+  _queuedJobCount.fetch_add(1);
+  _queuedJobCount.notify_all();
+
+  for (auto& thread : _threads) {
+    thread.join();
+  }
+
+  t_workerIndex = INVALID_WORKER;
+}
+
+bool JobSystem::Create(u32 workerThreadCount) {
+  if (workerThreadCount == 0) {
+    workerThreadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+  }
+
+  Instance = std::make_unique<JobSystem>(workerThreadCount);
+  std::print("JobSystem: {} worker threads\n", Instance->GetWorkerThreadCount());
+  return true;
+}
+
+void JobSystem::Run(JobFunction function, JobCounter* counter, JobCounter* dependency) {
+  assert(t_workerIndex != INVALID_WORKER && "Jobs can only be run from the main thread or a job");
+
+  if (counter) {
+    counter->_count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  Job* job = AllocateJob(std::move(function), counter);
+
+  if (dependency) {
+    std::lock_guard lock(dependency->_mutex);
+    if (!dependency->IsDone()) {
+      dependency->_continuations.push_back(job);
+      return;
+    }
+  }
+
+  Schedule(job);
+}
+
+void JobSystem::RunOnMainThread(JobFunction function, JobCounter* counter) {
+  if (counter) {
+    counter->_count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  std::lock_guard lock(_mainThreadMutex);
+  _mainThreadJobs.emplace_back(std::move(function), counter);
+}
+
+void JobSystem::Wait(const JobCounter& counter) {
+  while (!counter.IsDone()) {
+    if (Job* job = FindJob()) {
+      Execute(job);
+      continue;
+    }
+
+    if (IsMainThread()) {
+      ProcessMainThreadJobs();
+    }
+    std::this_thread::yield();
+  }
+
+  // The thread that finished the last job may still hold the lock
+  std::lock_guard lock(counter._mutex);
+}
+
+void JobSystem::ParallelFor(
+    u32 count, u32 batchSize, const std::function<void(u32 begin, u32 end)>& function
+) {
+  if (count == 0) {
+    return;
+  }
+  batchSize = std::max(batchSize, 1u);
+
+  JobCounter counter;
+  for (u32 begin = 0; begin < count; begin += batchSize) {
+    u32 end = std::min(begin + batchSize, count);
+    Run([&function, begin, end]() { function(begin, end); }, &counter);
+  }
+  Wait(counter);
+}
+
+void JobSystem::ProcessMainThreadJobs() {
+  std::vector<std::pair<JobFunction, JobCounter*>> jobs;
+  {
+    std::lock_guard lock(_mainThreadMutex);
+    jobs.swap(_mainThreadJobs);
+  }
+
+  for (auto& [function, counter] : jobs) {
+    function();
+    if (counter) {
+      FinishCounter(counter);
+    }
+  }
+}
+
+bool JobSystem::IsMainThread() const {
+  return std::this_thread::get_id() == _mainThreadId;
+}
+
+u32 JobSystem::GetWorkerIndex() {
+  assert(t_workerIndex != INVALID_WORKER && "Not a job system thread");
+  return t_workerIndex;
+}
+
+void JobSystem::WorkerLoop(u32 workerIndex) {
+  t_workerIndex = workerIndex;
+  CpuProfiler::SetThreadName(std::format("Worker {}", workerIndex));
+
+#ifdef _WIN32
+  std::wstring name = L"Rava Worker " + std::to_wstring(workerIndex);
+  SetThreadDescription(GetCurrentThread(), name.c_str());
+#endif
+
+  while (_isRunning.load(std::memory_order_acquire)) {
+    if (Job* job = FindJob()) {
+      Execute(job);
+      continue;
+    }
+
+    // A job is being pushed or was just taken by another thread
+    if (_queuedJobCount.load(std::memory_order_relaxed) != 0) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    _sleepingWorkerCount.fetch_add(1);
+    _queuedJobCount.wait(0);
+    _sleepingWorkerCount.fetch_sub(1);
+  }
+}
+
+Job* JobSystem::AllocateJob(JobFunction&& function, JobCounter* counter) {
+  Worker& worker = *_workers[t_workerIndex];
+  Job* job       = &worker.Jobs[worker.NextJob++ & (JOB_CAPACITY - 1)];
+
+  // The ring wrapped around onto a job that has not run yet. It may be parked on a counter that
+  // depends on the caller, so waiting for the slot could deadlock.
+  if (job->IsPending.load(std::memory_order_acquire)) {
+    job                  = new Job();
+    job->IsHeapAllocated = true;
+  }
+
+  job->Function = std::move(function);
+  job->Counter  = counter;
+  job->IsPending.store(true, std::memory_order_relaxed);
+  return job;
+}
+
+void JobSystem::Schedule(Job* job) {
+  _queuedJobCount.fetch_add(1);
+  if (!_workers[t_workerIndex]->Deque.Push(job)) {
+    _queuedJobCount.fetch_sub(1);
+    Execute(job);
+    return;
+  }
+
+  if (_sleepingWorkerCount.load() != 0) {
+    _queuedJobCount.notify_one();
+  }
+}
+
+Job* JobSystem::FindJob() {
+  Worker& self = *_workers[t_workerIndex];
+  if (Job* job = self.Deque.Pop()) {
+    _queuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+  }
+
+  // xorshift32, spreads thieves over victims
+  self.RandomState ^= self.RandomState << 13;
+  self.RandomState ^= self.RandomState >> 17;
+  self.RandomState ^= self.RandomState << 5;
+
+  u32 workerCount = static_cast<u32>(_workers.size());
+  u32 start       = self.RandomState % workerCount;
+  for (u32 i = 0; i < workerCount; ++i) {
+    u32 victim = (start + i) % workerCount;
+    if (victim == t_workerIndex) {
+      continue;
+    }
+    if (Job* job = _workers[victim]->Deque.Steal()) {
+      _queuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+void JobSystem::Execute(Job* job) {
+  {
+    RV_PROFILE_SCOPE("Job");
+    job->Function();
+  }
+  job->Function = nullptr;
+
+  JobCounter* counter = job->Counter;
+  if (job->IsHeapAllocated) {
+    delete job;
+  } else {
+    job->IsPending.store(false, std::memory_order_release);
+  }
+
+  if (counter) {
+    FinishCounter(counter);
+  }
+}
+
+void JobSystem::FinishCounter(JobCounter* counter) {
+  u32 count = counter->_count.load(std::memory_order_relaxed);
+  while (count > 1) {
+    if (counter->_count.compare_exchange_weak(
+            count, count - 1, std::memory_order_acq_rel, std::memory_order_relaxed
+        )) {
+      return;
+    }
+  }
+
+  // Possibly the last job: reaching zero and taking the continuations happen under the lock so
+  // Wait can not return (and the owner destroy the counter) while this thread still touches it
+  std::vector<Job*> continuations;
+  {
+    std::lock_guard lock(counter->_mutex);
+    if (counter->_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      continuations.swap(counter->_continuations);
+    }
+  }
+
+  for (Job* job : continuations) {
+    Schedule(job);
+  }
+}
+}  // namespace Rava
\ No newline at end of file
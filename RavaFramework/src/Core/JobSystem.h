@@ -0,0 +1,90 @@
+#pragma once
+
+namespace Rava {
+using JobFunction = std::function<void()>;
+
+struct Job;
+
+// Counts unfinished jobs. Jobs that name a counter as their dependency are parked on it and
+// scheduled once it reaches zero. A counter must outlive every job that references it.
+class JobCounter {
+public:
+  JobCounter() = default;
+
+  NO_COPY(JobCounter)
+  NO_MOVE(JobCounter)
+
+  inline bool IsDone() const { return _count.load(std::memory_order_acquire) == 0; }
+
+private:
+  friend class JobSystem;
+
+  std::atomic<u32> _count{0};
+  mutable std::mutex _mutex;
+  std::vector<Job*> _continuations;
+};
+
+// Work-stealing scheduler. Every worker owns a Chase-Lev deque, pushes and pops at the bottom and
+// steals from the top of the others. The thread that creates the system (the main thread) takes
+// part as worker 0 while it waits, and is the only one running RunOnMainThread jobs (GLFW calls).
+// Run, Wait and ParallelFor must be called from the main thread or from inside a job.
+class JobSystem {
+public:
+  static Unique<JobSystem> Instance;
+
+public:
+  // Without worker threads every job runs on the main thread while it waits
+  JobSystem(u32 workerThreadCount);
+  ~JobSystem();
+
+  NO_COPY(JobSystem)
+  NO_MOVE(JobSystem)
+
+  // workerThreadCount of 0 spawns one worker per hardware thread besides the main thread
+  static bool Create(u32 workerThreadCount);
+
+  void Run(JobFunction function, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+  void RunOnMainThread(JobFunction function, JobCounter* counter = nullptr);
+
+  // Executes other jobs until the counter reaches zero
+  void Wait(const JobCounter& counter);
+  // Splits [0, count) into jobs of batchSize elements and waits for all of them
+  void ParallelFor(
+      u32 count, u32 batchSize, const std::function<void(u32 begin, u32 end)>& function
+  );
+
+  // Called once per frame by the main loop, and while the main thread waits
+  void ProcessMainThreadJobs();
+
+  bool IsMainThread() const;
+  // Of the calling thread in [0, GetThreadCount()), 0 on the main thread. Only for the main thread
+  // and jobs.
+  static u32 GetWorkerIndex();
+  inline u32 GetWorkerThreadCount() const { return static_cast<u32>(_threads.size()); }
+  // Worker threads plus the main thread
+  inline u32 GetThreadCount() const { return static_cast<u32>(_workers.size()); }
+
+private:
+  struct Worker;
+
+  std::vector<Unique<Worker>> _workers;
+  std::vector<std::thread> _threads;
+  std::atomic<bool> _isRunning{true};
+  // Jobs sitting in a deque, workers sleep on it while it is zero
+  std::atomic<u32> _queuedJobCount{0};
+  std::atomic<u32> _sleepingWorkerCount{0};
+
+  std::mutex _mainThreadMutex;
+  std::vector<std::pair<JobFunction, JobCounter*>> _mainThreadJobs;
+  std::thread::id _mainThreadId;
+
+private:
+  void WorkerLoop(u32 workerIndex);
+
+  Job* AllocateJob(JobFunction&& function, JobCounter* counter);
+  void Schedule(Job* job);
+  Job* FindJob();
+  void Execute(Job* job);
+  void FinishCounter(JobCounter* counter);
+};
+}  // namespace Rava
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "RavaFramework.h"
+
+#include "Core/MappedFile.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Rava {
+MappedFile::~MappedFile() {
+  Close();
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::filesystem::path& path) {
+  Close();
+
+  _file = CreateFileW(
+      path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+  );
+  if (_file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(_file, &fileSize) || fileSize.QuadPart == 0) {
+    Close();
+    return false;
+  }
+
+  _mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (_mapping == nullptr) {
+    Close();
+    return false;
+  }
+
+  _data = static_cast<const u8*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+  if (_data == nullptr) {
+    Close();
+    return false;
+  }
+  _size = static_cast<size_t>(fileSize.QuadPart);
+  return true;
+}
+
+void MappedFile::Close() {
+  if (_data != nullptr) {
+    UnmapViewOfFile(_data);
+  }
+  if (_mapping != nullptr) {
+    CloseHandle(_mapping);
+  }
+  if (_file != INVALID_HANDLE_VALUE) {
+    CloseHandle(_file);
+  }
+  _data    = nullptr;
+  _size    = 0;
+  _mapping = nullptr;
+  _file    = INVALID_HANDLE_VALUE;
+}
+#else
+bool MappedFile::Open(const std::filesystem::path& path) {
+  Close();
+
+  _file = open(path.c_str(), O_RDONLY);
+  if (_file < 0) {
+    return false;
+  }
+
+  struct stat fileStat;
+  if (fstat(_file, &fileStat) != 0 || fileStat.st_size == 0) {
+    Close();
+    return false;
+  }
+
+  size_t size = static_cast<size_t>(fileStat.st_size);
+  void* data  = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, _file, 0);
+  if (data == MAP_FAILED) {
+    Close();
+    return false;
+  }
+  madvise(data, size, MADV_SEQUENTIAL);
+
+  _data = static_cast<const u8*>(data);
+  _size = size;
+  return true;
+}
+
+void MappedFile::Close() {
+  if (_data != nullptr) {
+    munmap(const_cast<u8*>(_data), _size);
+  }
+  if (_file >= 0) {
+    close(_file);
+  }
+  _data = nullptr;
+  _size = 0;
+  _file = -1;
+}
+#endif
+}  // namespace Rava
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+namespace Rava {
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  NO_COPY(MappedFile)
+
+  bool Open(const std::filesystem::path& path);
+  void Close();
+
+  inline const u8* Data() const { return _data; }
+  inline size_t Size() const { return _size; }
+  inline bool IsOpen() const { return _data != nullptr; }
+
+private:
+  const u8* _data = nullptr;
+  size_t _size    = 0;
+
+#ifdef _WIN32
+  HANDLE _file    = INVALID_HANDLE_VALUE;
+  HANDLE _mapping = nullptr;
+#else
+  int _file = -1;
+#endif
+};
+}  // namespace Rava
\ No newline at end of file
@@ -11,4 +11,21 @@ static std::string GetPathWithoutFileName(const std::filesystem::path& path) {
   }
   return pathWithoutFilename;
 }
+
+static constexpr u64 FNV1A_OFFSET_BASIS = 14695981039346656037ull;
+
+static u64 HashFNV1a(const void* data, size_t size, u64 hash = FNV1A_OFFSET_BASIS) {
+  const u8* bytes = static_cast<const u8*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+template <typename T>
+static u64 HashValue(const T& value, u64 hash = FNV1A_OFFSET_BASIS) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  return HashFNV1a(&value, sizeof(T), hash);
+}
 }
\ No newline at end of file
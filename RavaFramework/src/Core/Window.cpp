@@ -1,6 +1,7 @@
 #include "RavaFramework.h"
 
 #include "Core/Config.h"
+#include "Core/CpuProfiler.h"
 #include "Core/Window.h"
 
 namespace Rava {
@@ -66,6 +67,7 @@ void Window::ShowWindow() {
 }
 
 bool Window::ProcessMessage() const {
+  RV_PROFILE_FUNCTION();
   glfwPollEvents();
   return !glfwWindowShouldClose(_glfwWindow);
 }
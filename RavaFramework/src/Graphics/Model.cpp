@@ -1,26 +1,145 @@
 #include "RavaFramework.h"
 
-#include "Core/Config.h "
+#include "Core/Config.h"
+#include "Core/CpuProfiler.h"
+#include "Core/JobSystem.h"
 
 #include "Graphics/Model.h"
+#include "Graphics/ModelLoader/MeshCache.h"
 #include "Graphics/ModelLoader/ufbxLoader.h"
 #include "Graphics/Vulkan/VKModel.h"
+#include "Graphics/Vulkan/VKRenderer.h"
+#include "Graphics/Vulkan/VKUploader.h"
 
 namespace Rava {
-Unique<Model> Model::Create(std::string_view filepath) {
-  ufbxLoader loader{filepath.data()};
+static constexpr f32 MIN_LOD_DISTANCE = 1e-3f;
+
+static JobCounter s_asyncLoadCounter;
+
+Vec4 ComputeBoundingSphere(std::span<const Vertex> vertices) {
+  Vec3 min{std::numeric_limits<f32>::max()};
+  Vec3 max{std::numeric_limits<f32>::lowest()};
+  for (const Vertex& vertex : vertices) {
+    min = glm::min(min, vertex.Position);
+    max = glm::max(max, vertex.Position);
+  }
+
+  Vec3 center    = (min + max) * 0.5f;
+  f32 radiusSqrd = 0.0f;
+  for (const Vertex& vertex : vertices) {
+    Vec3 offset = vertex.Position - center;
+    radiusSqrd  = std::max(radiusSqrd, glm::dot(offset, offset));
+  }
+  return Vec4(center, std::sqrt(radiusSqrd));
+}
+
+f32 ComputeLodPixelScale(const LodCamera& camera, const Mat4& transform, const Vec4& sphere) {
+  if (camera.ProjectionScale <= 0.0f) {
+    return 0.0f;
+  }
+
+  // The largest axis scale, like the bounding sphere in the GpuScene culling
+  Mat3 axes    = Mat3(transform);
+  f32 scale    = std::max({glm::length(axes[0]), glm::length(axes[1]), glm::length(axes[2])});
+  Vec3 center  = Vec3(transform * Vec4(Vec3(sphere), 1.0f));
+  f32 distance = glm::length(center - camera.Position) - sphere.w * scale;
+  return scale * camera.ProjectionScale / std::max(distance, MIN_LOD_DISTANCE);
+}
+
+u32 SelectLod(std::span<const MeshLod> lods, f32 pixelScale, f32 threshold) {
+  for (u32 level = static_cast<u32>(lods.size()); level > 0; --level) {
+    if (lods[level - 1].Error * pixelScale < threshold) {
+      return level;
+    }
+  }
+  return 0;
+}
+
+// The returned data points into either the cache or the loader, both have to outlive it
+static bool LoadModelData(
+    std::string_view filepath, ufbxLoader& loader, MeshCache& cache, ModelData& data
+) {
+  if (cache.Load(filepath, loader.GetOptionsHash())) {
+    data = cache.GetModelData();
+    return true;
+  }
+
   if (!loader.LoadModel()) {
-    std::print("Failed to load Model file {0}", filepath.data());
+    std::print("Failed to load Model file {0}\n", filepath);
+    return false;
+  }
+
+  data = loader.GetModelData();
+  return true;
+}
+
+Unique<Model> Model::Create(std::string_view filepath) {
+  RV_PROFILE_FUNCTION();
+  ufbxLoader loader{std::string(filepath)};
+  MeshCache cache;
+  ModelData data;
+  if (!LoadModelData(filepath, loader, cache, data)) {
     return nullptr;
   }
 
-  Unique<Model> model;
+  return Create(data);
+}
+
+Unique<Model> Model::Create(const ModelData& data) {
   switch (Config::SelectedAPI) {
-    case RendererAPI::Vulkan:
-      // model = std::make_shared<VK::Renderer>();
-       return std::make_unique<VK::Model>(loader);
+    case RendererAPI::Vulkan: {
+      auto* renderer = static_cast<VK::Renderer*>(Renderer::Instance.get());
+      auto model
+          = std::make_unique<VK::Model>(renderer->GetContext(), renderer->GetGeometryPool(), data);
+      return model->IsValid() ? std::move(model) : nullptr;
+    }
     default:
-      model = nullptr;
+      return nullptr;
+  }
+}
+
+Shared<AsyncModel> Model::CreateAsync(std::string_view filepath) {
+  auto asyncModel = std::make_shared<AsyncModel>();
+
+  JobSystem::Instance->Run(
+      [asyncModel, filepath = std::string(filepath)]() {
+        RV_PROFILE_SCOPE("Model::CreateAsync");
+        ufbxLoader loader{filepath};
+        MeshCache cache;
+        ModelData data;
+        if (!LoadModelData(filepath, loader, cache, data)) {
+          asyncModel->SetFailed();
+          return;
+        }
+
+        switch (Config::SelectedAPI) {
+          case RendererAPI::Vulkan: {
+            auto* renderer = static_cast<VK::Renderer*>(Renderer::Instance.get());
+            renderer->GetUploader().UploadModel(asyncModel, data);
+            break;
+          }
+          default:
+            asyncModel->SetFailed();
+        }
+      },
+      &s_asyncLoadCounter
+  );
+
+  return asyncModel;
+}
+
+void Model::WaitAsyncLoads() {
+  if (JobSystem::Instance) {
+    JobSystem::Instance->Wait(s_asyncLoadCounter);
   }
 }
+
+void AsyncModel::SetReady(Unique<Model> model) {
+  _model = std::move(model);
+  _state.store(LoadState::Ready, std::memory_order_release);
+}
+
+void AsyncModel::SetFailed() {
+  _state.store(LoadState::Failed, std::memory_order_release);
+}
 }  // namespace Rava
\ No newline at end of file
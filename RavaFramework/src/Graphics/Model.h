@@ -3,7 +3,7 @@
 namespace Rava {
 struct Vertex {
   glm::vec3 Position;
-  glm::vec3 Color;
+  glm::vec4 Color;  // linear, alpha of the source asset
   glm::vec3 Normal;
   glm::vec2 UV;
   bool operator==(const Vertex& other) const {
@@ -13,16 +13,119 @@ struct Vertex {
 };
 
 struct Mesh {
+  static constexpr u32 MAX_LODS = 4;
+
   u32 FirstVertex;
   u32 VertexCount;  
   u32 FirstIndex;
   u32 IndexCount;
+  // Simplified versions in ModelData::Lods, from finest to coarsest
+  u32 FirstLod = 0;
+  u32 LodCount = 0;
+  // Clusters of the full mesh in ModelData::Meshlets, they split its index range without gaps
+  u32 FirstMeshlet = 0;
+  u32 MeshletCount = 0;
+};
+
+// Simplified index range of a Mesh, drawn with the vertices of its mesh
+struct MeshLod {
+  u32 FirstIndex = 0;
+  u32 IndexCount = 0;
+  f32 Error      = 0.0f;  // how far the surface may be off the full mesh, in mesh space units
+};
+
+// Small cluster of neighbouring triangles, culled on its own. The cone bounds the normals of its
+// triangles: the whole cluster faces away from a camera at c when
+// dot(center - c, axis) >= cutoff * length(center - c) + radius. A cutoff of 1 never culls.
+struct Meshlet {
+  u32 FirstIndex  = 0;
+  u32 IndexCount  = 0;
+  u32 VertexCount = 0;  // unique vertices referenced by the range
+  u32 Padding     = 0;
+  Vec4 BoundingSphere{0.0f};
+  Vec4 Cone{0.0f, 0.0f, 0.0f, 1.0f};  // axis and cutoff
+};
+
+// Camera of the LOD selection. ProjectionScale turns a length at distance 1 into pixels, it is the
+// viewport height divided by 2 * tan(verticalFov / 2). 0 disables the selection.
+struct LodCamera {
+  Vec3 Position{0.0f};
+  f32 ProjectionScale = 0.0f;
 };
 
+// Center of the bounds and the farthest vertex from it, not minimal but cheap and conservative
+Vec4 ComputeBoundingSphere(std::span<const Vertex> vertices);
+// Pixels covered by one mesh space unit of an instance, measured at the point of its bounding
+// sphere closest to the camera
+f32 ComputeLodPixelScale(const LodCamera& camera, const Mat4& transform, const Vec4& sphere);
+// The coarsest level whose error stays below threshold pixels, 0 is the full mesh and level n is
+// lods[n - 1]
+u32 SelectLod(std::span<const MeshLod> lods, f32 pixelScale, f32 threshold);
+
+// Per instance vertex data of instanced draws
+struct InstanceData {
+  Mat4 Transform{1.0f};
+  Vec4 Color{1.0f};
+  u32 ID = 0;
+  u32 Padding[3]{};
+};
+
+// Non-owning view of imported geometry, backed either by a loader or by a mapped mesh cache
+struct ModelData {
+  std::span<const Vertex> Vertices;
+  std::span<const u32> Indices;
+  std::span<const Mesh> Meshes;
+  std::span<const MeshLod> Lods;
+  std::span<const Meshlet> Meshlets;
+};
+
+class AsyncModel;
+
 class Model {
 public:
+  static constexpr u32 ALL_MESHES = ~0u;
+
+public:
+  virtual ~Model() = default;
+
   static Unique<Model> Create(std::string_view file);
+  static Unique<Model> Create(const ModelData& data);
+  // Parses on a worker thread and uploads on the transfer queue, never blocks the caller
+  static Shared<AsyncModel> CreateAsync(std::string_view file);
+  // Blocks until every CreateAsync job has handed its model to the renderer
+  static void WaitAsyncLoads();
 
   virtual void Draw() = 0;
+
+  // Queues instances for the current frame, main thread only. Submissions of the same model and
+  // mesh are merged and drawn with one instanced draw per mesh when the swap chain render pass
+  // ends. The model has to stay alive until the frame has finished on the GPU.
+  virtual void Submit(std::span<const InstanceData> instances, u32 meshIndex = ALL_MESHES) = 0;
+  inline void Submit(const InstanceData& instance, u32 meshIndex = ALL_MESHES) {
+    Submit({&instance, 1}, meshIndex);
+  }
+};
+
+enum class LoadState {
+  Loading,
+  Ready,
+  Failed,
+};
+
+// Handle returned by Model::CreateAsync. The model becomes drawable once the renderer has
+// acquired its buffers at the start of a frame, until then Get returns nullptr.
+class AsyncModel {
+public:
+  inline LoadState GetState() const { return _state.load(std::memory_order_acquire); }
+  inline bool IsReady() const { return GetState() == LoadState::Ready; }
+  inline Model* Get() const { return IsReady() ? _model.get() : nullptr; }
+
+  // Called by the loader
+  void SetReady(Unique<Model> model);
+  void SetFailed();
+
+private:
+  Unique<Model> _model;
+  std::atomic<LoadState> _state{LoadState::Loading};
 };
 }  // namespace Rava
\ No newline at end of file
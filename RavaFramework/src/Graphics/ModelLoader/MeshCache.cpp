@@ -0,0 +1,168 @@
+#include "RavaFramework.h"
+
+#include "Graphics/ModelLoader/MeshCache.h"
+
+#include "Core/Config.h"
+#include "Core/CpuProfiler.h"
+#include "Core/Utils.h"
+
+namespace Rava {
+static constexpr u64 MESH_CACHE_ALIGNMENT = 16;
+
+static u64 AlignOffset(u64 offset) {
+  return (offset + MESH_CACHE_ALIGNMENT - 1) & ~(MESH_CACHE_ALIGNMENT - 1);
+}
+
+std::filesystem::path MeshCache::GetCachePath(const std::filesystem::path& sourcePath) {
+  std::string key  = std::filesystem::weakly_canonical(sourcePath).generic_string();
+  u64 pathHash     = HashFNV1a(key.data(), key.size());
+  std::string name = std::format("{:016x}.rvmesh", pathHash);
+  return std::filesystem::path(Config::MeshCacheDirectory) / name;
+}
+
+bool MeshCache::FillSourceKey(const std::filesystem::path& sourcePath, MeshCacheHeader& header) {
+  std::error_code error;
+  auto writeTime = std::filesystem::last_write_time(sourcePath, error);
+  if (error) {
+    return false;
+  }
+  auto size = std::filesystem::file_size(sourcePath, error);
+  if (error) {
+    return false;
+  }
+
+  std::string key        = std::filesystem::weakly_canonical(sourcePath).generic_string();
+  header.SourcePathHash  = HashFNV1a(key.data(), key.size());
+  header.SourceWriteTime = static_cast<i64>(writeTime.time_since_epoch().count());
+  header.SourceSize      = static_cast<u64>(size);
+  return true;
+}
+
+bool MeshCache::Write(std::string_view sourcePath, u64 optionsHash, const ModelData& data) {
+  RV_PROFILE_FUNCTION();
+  if (Config::MeshCacheDirectory.empty()) {
+    return false;
+  }
+
+  MeshCacheHeader header{};
+  header.Magic       = MAGIC;
+  header.Version     = VERSION;
+  header.OptionsHash = optionsHash;
+  header.MeshCount   = static_cast<u32>(data.Meshes.size());
+  header.VertexCount = static_cast<u32>(data.Vertices.size());
+  header.IndexCount  = static_cast<u32>(data.Indices.size());
+  header.LodCount     = static_cast<u32>(data.Lods.size());
+  header.MeshletCount = static_cast<u32>(data.Meshlets.size());
+  header.VertexSize   = sizeof(Vertex);
+  if (!FillSourceKey(sourcePath, header)) {
+    return false;
+  }
+
+  header.MeshesOffset   = AlignOffset(sizeof(MeshCacheHeader));
+  header.VerticesOffset = AlignOffset(header.MeshesOffset + data.Meshes.size_bytes());
+  header.IndicesOffset  = AlignOffset(header.VerticesOffset + data.Vertices.size_bytes());
+  header.LodsOffset     = AlignOffset(header.IndicesOffset + data.Indices.size_bytes());
+  header.MeshletsOffset = AlignOffset(header.LodsOffset + data.Lods.size_bytes());
+
+  std::filesystem::path cachePath = GetCachePath(sourcePath);
+  std::error_code error;
+  std::filesystem::create_directories(cachePath.parent_path(), error);
+
+  // Write next to the target first so a concurrent reader never maps a half written file
+  std::filesystem::path tempPath = cachePath;
+  tempPath += ".tmp";
+  {
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      std::print("MeshCache::Write: cannot open {}\n", tempPath.string());
+      return false;
+    }
+
+    auto writeAt = [&file](u64 offset, const void* bytes, size_t size) {
+      static constexpr char padding[MESH_CACHE_ALIGNMENT] = {};
+      u64 position = static_cast<u64>(file.tellp());
+      file.write(padding, static_cast<std::streamsize>(offset - position));
+      file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+    };
+    writeAt(0, &header, sizeof(header));
+    writeAt(header.MeshesOffset, data.Meshes.data(), data.Meshes.size_bytes());
+    writeAt(header.VerticesOffset, data.Vertices.data(), data.Vertices.size_bytes());
+    writeAt(header.IndicesOffset, data.Indices.data(), data.Indices.size_bytes());
+    writeAt(header.LodsOffset, data.Lods.data(), data.Lods.size_bytes());
+    writeAt(header.MeshletsOffset, data.Meshlets.data(), data.Meshlets.size_bytes());
+
+    if (!file) {
+      std::print("MeshCache::Write: failed writing {}\n", tempPath.string());
+      return false;
+    }
+  }
+
+  std::filesystem::rename(tempPath, cachePath, error);
+  if (error) {
+    std::filesystem::remove(tempPath, error);
+    return false;
+  }
+  return true;
+}
+
+bool MeshCache::Load(std::string_view sourcePath, u64 optionsHash) {
+  RV_PROFILE_FUNCTION();
+  _header = nullptr;
+  if (Config::MeshCacheDirectory.empty()) {
+    return false;
+  }
+
+  MeshCacheHeader expected{};
+  if (!FillSourceKey(sourcePath, expected)) {
+    return false;
+  }
+
+  if (!_file.Open(GetCachePath(sourcePath)) || _file.Size() < sizeof(MeshCacheHeader)) {
+    return false;
+  }
+
+  const auto* header = reinterpret_cast<const MeshCacheHeader*>(_file.Data());
+  bool isCurrent = header->Magic == MAGIC && header->Version == VERSION
+                && header->VertexSize == sizeof(Vertex) && header->OptionsHash == optionsHash
+                && header->SourcePathHash == expected.SourcePathHash
+                && header->SourceWriteTime == expected.SourceWriteTime
+                && header->SourceSize == expected.SourceSize;
+
+  u64 meshesEnd   = header->MeshesOffset + static_cast<u64>(header->MeshCount) * sizeof(Mesh);
+  u64 verticesEnd = header->VerticesOffset + static_cast<u64>(header->VertexCount) * sizeof(Vertex);
+  u64 indicesEnd  = header->IndicesOffset + static_cast<u64>(header->IndexCount) * sizeof(u32);
+  u64 lodsEnd     = header->LodsOffset + static_cast<u64>(header->LodCount) * sizeof(MeshLod);
+  u64 meshletsEnd
+      = header->MeshletsOffset + static_cast<u64>(header->MeshletCount) * sizeof(Meshlet);
+  bool isComplete = meshesEnd <= header->VerticesOffset && verticesEnd <= header->IndicesOffset
+                 && indicesEnd <= header->LodsOffset && lodsEnd <= header->MeshletsOffset
+                 && meshletsEnd <= _file.Size();
+
+  if (!isCurrent || !isComplete) {
+    _file.Close();
+    return false;
+  }
+
+  _header = header;
+  return true;
+}
+
+ModelData MeshCache::GetModelData() const {
+  if (_header == nullptr) {
+    return {};
+  }
+
+  const u8* base = _file.Data();
+  ModelData data;
+  data.Meshes = {reinterpret_cast<const Mesh*>(base + _header->MeshesOffset), _header->MeshCount};
+  data.Vertices
+      = {reinterpret_cast<const Vertex*>(base + _header->VerticesOffset), _header->VertexCount};
+  data.Indices = {reinterpret_cast<const u32*>(base + _header->IndicesOffset), _header->IndexCount};
+  data.Lods    = {reinterpret_cast<const MeshLod*>(base + _header->LodsOffset), _header->LodCount};
+
+  data.Meshlets = {
+      reinterpret_cast<const Meshlet*>(base + _header->MeshletsOffset), _header->MeshletCount
+  };
+  return data;
+}
+}  // namespace Rava
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Core/MappedFile.h"
+#include "Graphics/Model.h"
+
+namespace Rava {
+// On-disk layout, all offsets are from the start of the file:
+//   MeshCacheHeader | Mesh[MeshCount] | Vertex[VertexCount] | u32[IndexCount] | MeshLod[LodCount]
+//   | Meshlet[MeshletCount]
+struct MeshCacheHeader {
+  u32 Magic;
+  u32 Version;
+  u64 SourcePathHash;
+  i64 SourceWriteTime;
+  u64 SourceSize;
+  u64 OptionsHash;
+  u32 MeshCount;
+  u32 VertexCount;
+  u32 IndexCount;
+  u32 VertexSize;
+  u64 MeshesOffset;
+  u64 VerticesOffset;
+  u64 IndicesOffset;
+  u32 LodCount;
+  u64 LodsOffset;
+  u32 MeshletCount;
+  u64 MeshletsOffset;
+};
+
+// Versioned binary copy of imported geometry, keyed by source path, mtime, size and load options.
+// A warm load maps the file and hands the geometry to the renderer without parsing.
+class MeshCache {
+public:
+  static constexpr u32 MAGIC   = 0x434D5652;  // "RVMC"
+  static constexpr u32 VERSION = 4;
+
+public:
+  MeshCache() = default;
+
+  NO_COPY(MeshCache)
+
+  static bool Write(std::string_view sourcePath, u64 optionsHash, const ModelData& data);
+
+  bool Load(std::string_view sourcePath, u64 optionsHash);
+  ModelData GetModelData() const;
+
+private:
+  MappedFile _file;
+  const MeshCacheHeader* _header = nullptr;
+
+private:
+  static std::filesystem::path GetCachePath(const std::filesystem::path& sourcePath);
+  static bool FillSourceKey(const std::filesystem::path& sourcePath, MeshCacheHeader& header);
+};
+}  // namespace Rava
\ No newline at end of file
@@ -0,0 +1,256 @@
+#include "RavaFramework.h"
+
+#include "Graphics/ModelLoader/MeshOptimizer.h"
+
+#include "Core/FrameAllocator.h"
+#include "Graphics/Model.h"
+
+namespace Rava {
+static constexpr u32 INVALID_VERTEX = ~0u;
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(
+    std::span<const u32> indices, u32 vertexCount, u32 cacheSize
+) {
+  VertexCacheStats stats;
+  u32 triangleCount = static_cast<u32>(indices.size() / 3);
+  if (triangleCount == 0 || vertexCount == 0) {
+    return stats;
+  }
+
+  // A vertex is cached while fewer than cacheSize others were inserted after it
+  ScratchScope scratch;
+  std::span<u32> timestamps  = scratch.AllocateArray<u32>(vertexCount);
+  std::span<u8> isReferenced = scratch.AllocateArray<u8>(vertexCount);
+  u32 time                   = cacheSize + 1;
+  u32 transformedCount       = 0;
+  u32 referencedCount        = 0;
+  for (u32 index : indices) {
+    if (time - timestamps[index] > cacheSize) {
+      timestamps[index] = time++;
+      ++transformedCount;
+    }
+    if (!isReferenced[index]) {
+      isReferenced[index] = 1;
+      ++referencedCount;
+    }
+  }
+
+  stats.ACMR = static_cast<f32>(transformedCount) / static_cast<f32>(triangleCount);
+  stats.ATVR = static_cast<f32>(transformedCount) / static_cast<f32>(referencedCount);
+  return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(
+    std::span<u32> indices, u32 vertexCount, std::vector<u32>& clusters, u32 cacheSize
+) {
+  clusters.clear();
+  u32 triangleCount = static_cast<u32>(indices.size() / 3);
+  if (triangleCount == 0) {
+    return;
+  }
+
+  ScratchScope scratch;
+
+  // Triangles around every vertex, liveCounts tracks how many of them are not emitted yet
+  std::span<u32> liveCounts       = scratch.AllocateArray<u32>(vertexCount);
+  std::span<u32> adjacencyOffsets = scratch.AllocateArray<u32>(vertexCount + 1);
+  std::span<u32> adjacency        = scratch.AllocateArray<u32>(indices.size());
+  for (u32 index : indices) {
+    ++liveCounts[index];
+  }
+  for (u32 vertex = 0; vertex < vertexCount; ++vertex) {
+    adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + liveCounts[vertex];
+  }
+  for (u32 triangle = 0; triangle < triangleCount; ++triangle) {
+    for (u32 corner = 0; corner < 3; ++corner) {
+      u32 vertex = indices[triangle * 3 + corner];
+      adjacency[adjacencyOffsets[vertex]++] = triangle;
+    }
+  }
+  // The fill above advanced every offset to the start of the next vertex, shift them back
+  for (u32 vertex = vertexCount; vertex > 0; --vertex) {
+    adjacencyOffsets[vertex] = adjacencyOffsets[vertex - 1];
+  }
+  adjacencyOffsets[0] = 0;
+
+  std::span<u32> timestamps = scratch.AllocateArray<u32>(vertexCount);
+  std::span<u8> isEmitted   = scratch.AllocateArray<u8>(triangleCount);
+  std::span<u32> output     = scratch.AllocateArray<u32>(indices.size());
+  std::pmr::vector<u32> deadEnds(scratch.GetResource());
+  std::pmr::vector<u32> candidates(scratch.GetResource());
+  deadEnds.reserve(indices.size());
+
+  u32 time        = cacheSize + 1;
+  u32 outputCount = 0;
+  u32 cursor      = 0;  // next input index to restart from once the dead end stack is empty
+
+  // Recently used vertices that still have triangles first, then the input order
+  auto skipDeadEnd = [&]() {
+    while (!deadEnds.empty()) {
+      u32 vertex = deadEnds.back();
+      deadEnds.pop_back();
+      if (liveCounts[vertex] > 0) {
+        return vertex;
+      }
+    }
+    for (; cursor < indices.size(); ++cursor) {
+      if (liveCounts[indices[cursor]] > 0) {
+        return indices[cursor];
+      }
+    }
+    return INVALID_VERTEX;
+  };
+
+  u32 fanningVertex = indices[0];
+  clusters.push_back(0);
+  while (fanningVertex != INVALID_VERTEX) {
+    candidates.clear();
+    u32 adjacencyEnd = adjacencyOffsets[fanningVertex + 1];
+    for (u32 i = adjacencyOffsets[fanningVertex]; i < adjacencyEnd; ++i) {
+      u32 triangle = adjacency[i];
+      if (isEmitted[triangle]) {
+        continue;
+      }
+
+      for (u32 corner = 0; corner < 3; ++corner) {
+        u32 vertex            = indices[triangle * 3 + corner];
+        output[outputCount++] = vertex;
+        deadEnds.push_back(vertex);
+        candidates.push_back(vertex);
+        --liveCounts[vertex];
+        if (time - timestamps[vertex] > cacheSize) {
+          timestamps[vertex] = time++;
+        }
+      }
+      isEmitted[triangle] = 1;
+    }
+
+    // The oldest candidate that is still cached after its remaining triangles were emitted
+    u32 nextVertex   = INVALID_VERTEX;
+    i64 bestPriority = -1;
+    for (u32 vertex : candidates) {
+      if (liveCounts[vertex] == 0) {
+        continue;
+      }
+
+      i64 priority = 0;
+      u32 age      = time - timestamps[vertex];
+      if (age + 2 * liveCounts[vertex] <= cacheSize) {
+        priority = age;
+      }
+      if (priority > bestPriority) {
+        bestPriority = priority;
+        nextVertex   = vertex;
+      }
+    }
+
+    if (nextVertex == INVALID_VERTEX) {
+      nextVertex = skipDeadEnd();
+      if (nextVertex != INVALID_VERTEX) {
+        clusters.push_back(outputCount / 3);
+      }
+    }
+    fanningVertex = nextVertex;
+  }
+
+  assert(outputCount == indices.size() && "Tipsify has to emit every triangle");
+  std::ranges::copy(output, indices.begin());
+}
+
+void MeshOptimizer::OptimizeOverdraw(
+    std::span<u32> indices, std::span<const Vertex> vertices, std::span<const u32> clusters
+) {
+  u32 triangleCount = static_cast<u32>(indices.size() / 3);
+  u32 clusterCount  = static_cast<u32>(clusters.size());
+  if (clusterCount < 2) {
+    return;
+  }
+
+  struct Cluster {
+    u32 FirstTriangle = 0;
+    u32 TriangleCount = 0;
+    Vec3 Center{0.0f};  // area weighted sum of the triangle centers
+    Vec3 Normal{0.0f};  // area weighted sum of the triangle normals
+    f32 Area        = 0.0f;
+    f32 Outwardness = 0.0f;
+  };
+
+  ScratchScope scratch;
+  std::span<Cluster> clusterInfos = scratch.AllocateArray<Cluster>(clusterCount);
+  Vec3 meshCenter{0.0f};
+  f32 meshArea = 0.0f;
+  for (u32 i = 0; i < clusterCount; ++i) {
+    Cluster& cluster      = clusterInfos[i];
+    cluster.FirstTriangle = clusters[i];
+    cluster.TriangleCount = (i + 1 < clusterCount ? clusters[i + 1] : triangleCount) - clusters[i];
+
+    for (u32 t = cluster.FirstTriangle; t < cluster.FirstTriangle + cluster.TriangleCount; ++t) {
+      const Vec3& a = vertices[indices[t * 3 + 0]].Position;
+      const Vec3& b = vertices[indices[t * 3 + 1]].Position;
+      const Vec3& c = vertices[indices[t * 3 + 2]].Position;
+      Vec3 normal   = glm::cross(b - a, c - a);  // length is twice the area
+      f32 area      = glm::length(normal) * 0.5f;
+      cluster.Center += (a + b + c) * (area / 3.0f);
+      cluster.Normal += normal;
+      cluster.Area += area;
+    }
+    meshCenter += cluster.Center;
+    meshArea += cluster.Area;
+  }
+
+  if (meshArea <= 0.0f) {
+    return;
+  }
+  meshCenter /= meshArea;
+
+  for (Cluster& cluster : clusterInfos) {
+    f32 normalLength = glm::length(cluster.Normal);
+    if (cluster.Area > 0.0f && normalLength > 0.0f) {
+      Vec3 center         = cluster.Center / cluster.Area;
+      cluster.Outwardness = glm::dot(center - meshCenter, cluster.Normal / normalLength);
+    }
+  }
+
+  std::stable_sort(clusterInfos.begin(), clusterInfos.end(), [](const auto& a, const auto& b) {
+    return a.Outwardness > b.Outwardness;
+  });
+
+  std::span<u32> sorted = scratch.AllocateArray<u32>(indices.size());
+  u32 outputCount       = 0;
+  for (const Cluster& cluster : clusterInfos) {
+    auto first = indices.begin() + cluster.FirstTriangle * 3;
+    std::copy(first, first + cluster.TriangleCount * 3, sorted.begin() + outputCount);
+    outputCount += cluster.TriangleCount * 3;
+  }
+  std::ranges::copy(sorted, indices.begin());
+}
+
+u32 MeshOptimizer::OptimizeVertexFetch(std::span<u32> indices, std::span<Vertex> vertices) {
+  ScratchScope scratch;
+  std::span<u32> remap = scratch.AllocateArray<u32>(vertices.size());
+  std::ranges::fill(remap, INVALID_VERTEX);
+
+  u32 referencedCount = 0;
+  for (u32& index : indices) {
+    if (remap[index] == INVALID_VERTEX) {
+      remap[index] = referencedCount++;
+    }
+    index = remap[index];
+  }
+
+  // Unreferenced vertices keep their relative order behind the referenced ones
+  u32 unreferencedCount = referencedCount;
+  for (u32& target : remap) {
+    if (target == INVALID_VERTEX) {
+      target = unreferencedCount++;
+    }
+  }
+
+  std::span<Vertex> original = scratch.AllocateArray<Vertex>(vertices.size());
+  std::ranges::copy(vertices, original.begin());
+  for (size_t i = 0; i < original.size(); ++i) {
+    vertices[remap[i]] = original[i];
+  }
+  return referencedCount;
+}
+}  // namespace Rava
\ No newline at end of file
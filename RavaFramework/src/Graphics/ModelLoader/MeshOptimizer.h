@@ -0,0 +1,41 @@
+#pragma once
+
+namespace Rava {
+struct Vertex;
+
+// Post transform cache efficiency of an index buffer, simulated with a FIFO cache
+struct VertexCacheStats {
+  f32 ACMR = 0.0f;  // transformed vertices per triangle, 0.5 at best and 3 at worst
+  f32 ATVR = 0.0f;  // transformed vertices per referenced vertex, 1 at best
+};
+
+// Import time reordering of one mesh part, the indices are local to its vertices. The stages are
+// meant to run in order: cache, overdraw (optional, needs the clusters of the cache stage), fetch.
+class MeshOptimizer {
+public:
+  static constexpr u32 CACHE_SIZE = 16;
+
+public:
+  static VertexCacheStats AnalyzeVertexCache(
+      std::span<const u32> indices, u32 vertexCount, u32 cacheSize = CACHE_SIZE
+  );
+
+  // Tipsify (Sander, Nehab and Barczak 2007): fans around the vertex that is most likely still in
+  // the cache. The first triangle of every cluster goes to clusters, a cluster ends where the fan
+  // ran into a dead end and the cache started over.
+  static void OptimizeVertexCache(
+      std::span<u32> indices, u32 vertexCount, std::vector<u32>& clusters,
+      u32 cacheSize = CACHE_SIZE
+  );
+
+  // Draws the clusters facing away from the mesh center first, they tend to occlude the others.
+  // Clusters stay intact, so the cache efficiency of the previous stage is kept.
+  static void OptimizeOverdraw(
+      std::span<u32> indices, std::span<const Vertex> vertices, std::span<const u32> clusters
+  );
+
+  // Orders the vertices by first use so vertex fetch walks the buffer forward. Returns the number
+  // of referenced vertices, the rest is moved past it.
+  static u32 OptimizeVertexFetch(std::span<u32> indices, std::span<Vertex> vertices);
+};
+}  // namespace Rava
\ No newline at end of file
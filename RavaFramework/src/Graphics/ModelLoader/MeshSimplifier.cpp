@@ -0,0 +1,451 @@
+#include "RavaFramework.h"
+
+#include "Graphics/ModelLoader/MeshSimplifier.h"
+
+#include "Core/FrameAllocator.h"
+#include "Graphics/Model.h"
+
+namespace Rava {
+static constexpr u32 INVALID_VERTEX   = ~0u;
+static constexpr u32 MULTIPLE_VERTEX  = ~1u;    // more than one open edge leaves or enters
+static constexpr f64 BORDER_WEIGHT    = 10.0;   // of the planes that keep open edges in place
+static constexpr f32 MIN_FLIP_COSINE  = 0.25f;  // between a triangle normal before and after
+static constexpr f32 MAX_LOD_FRACTION = 0.75f;  // of the previous level, above it the chain ends
+static constexpr f32 UNLIMITED_ERROR  = std::numeric_limits<f32>::max();
+
+enum class VertexKind : u8 { Manifold, Border, Seam, Locked };
+
+// Sum of squared distances to planes, weighted by the area they stand for. The 4x4 matrix is
+// symmetric, A is its upper 3x3 block, B the column next to it and C the corner.
+struct Quadric {
+  f64 A00    = 0.0;
+  f64 A11    = 0.0;
+  f64 A22    = 0.0;
+  f64 A10    = 0.0;
+  f64 A20    = 0.0;
+  f64 A21    = 0.0;
+  f64 B0     = 0.0;
+  f64 B1     = 0.0;
+  f64 B2     = 0.0;
+  f64 C      = 0.0;
+  f64 Weight = 0.0;
+};
+
+struct Collapse {
+  u32 From  = 0;
+  u32 To    = 0;
+  f32 Error = 0.0f;  // squared distance
+};
+
+// Edges of the index buffer, stored per start vertex
+struct EdgeAdjacency {
+  std::span<u32> Offsets;
+  std::span<u32> Targets;
+
+  bool HasEdge(u32 from, u32 to) const {
+    for (u32 i = Offsets[from]; i < Offsets[from + 1]; ++i) {
+      if (Targets[i] == to) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+// Plane n.p + d = 0, n normalized
+static void AddPlane(Quadric& quadric, const Vec3& normal, f32 distance, f64 weight) {
+  f64 a = normal.x;
+  f64 b = normal.y;
+  f64 c = normal.z;
+  f64 d = distance;
+  quadric.A00 += weight * a * a;
+  quadric.A11 += weight * b * b;
+  quadric.A22 += weight * c * c;
+  quadric.A10 += weight * a * b;
+  quadric.A20 += weight * a * c;
+  quadric.A21 += weight * b * c;
+  quadric.B0 += weight * a * d;
+  quadric.B1 += weight * b * d;
+  quadric.B2 += weight * c * d;
+  quadric.C += weight * d * d;
+  quadric.Weight += weight;
+}
+
+static void AddQuadric(Quadric& quadric, const Quadric& other) {
+  quadric.A00 += other.A00;
+  quadric.A11 += other.A11;
+  quadric.A22 += other.A22;
+  quadric.A10 += other.A10;
+  quadric.A20 += other.A20;
+  quadric.A21 += other.A21;
+  quadric.B0 += other.B0;
+  quadric.B1 += other.B1;
+  quadric.B2 += other.B2;
+  quadric.C += other.C;
+  quadric.Weight += other.Weight;
+}
+
+// Weighted mean of the squared plane distances
+static f32 EvaluateQuadric(const Quadric& quadric, const Vec3& position) {
+  if (quadric.Weight <= 0.0) {
+    return 0.0f;
+  }
+
+  f64 x  = position.x;
+  f64 y  = position.y;
+  f64 z  = position.z;
+  f64 rx = quadric.A00 * x + quadric.A10 * y + quadric.A20 * z;
+  f64 ry = quadric.A10 * x + quadric.A11 * y + quadric.A21 * z;
+  f64 rz = quadric.A20 * x + quadric.A21 * y + quadric.A22 * z;
+  f64 r  = rx * x + ry * y + rz * z;
+  r += 2.0 * (quadric.B0 * x + quadric.B1 * y + quadric.B2 * z) + quadric.C;
+  return static_cast<f32>(std::abs(r) / quadric.Weight);
+}
+
+// Vertices that only differ in their attributes share a position: remap points at the first of
+// them and wedges links them in a circle
+static void BuildPositionRemap(
+    std::span<const Vertex> vertices, std::span<u32> remap, std::span<u32> wedges
+) {
+  ScratchScope scratch;
+  std::span<u32> order = scratch.AllocateArray<u32>(vertices.size());
+  for (u32 i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  auto positionKey = [&](u32 vertex) {
+    const Vec3& position = vertices[vertex].Position;
+    return std::tuple(position.x, position.y, position.z, vertex);
+  };
+  std::ranges::sort(order, [&](u32 a, u32 b) { return positionKey(a) < positionKey(b); });
+
+  for (size_t first = 0; first < order.size();) {
+    size_t last = first + 1;
+    while (last < order.size()
+           && vertices[order[last]].Position == vertices[order[first]].Position) {
+      ++last;
+    }
+    for (size_t i = first; i < last; ++i) {
+      remap[order[i]]  = order[first];
+      wedges[order[i]] = order[i + 1 < last ? i + 1 : first];
+    }
+    first = last;
+  }
+}
+
+static void BuildEdgeAdjacency(
+    std::span<const u32> indices, ScratchScope& scratch, EdgeAdjacency& adjacency
+) {
+  u32 vertexCount   = static_cast<u32>(adjacency.Offsets.size() - 1);
+  adjacency.Targets = scratch.AllocateArray<u32>(indices.size());
+  for (u32 index : indices) {
+    ++adjacency.Offsets[index + 1];
+  }
+  for (u32 vertex = 0; vertex < vertexCount; ++vertex) {
+    adjacency.Offsets[vertex + 1] += adjacency.Offsets[vertex];
+  }
+
+  std::span<u32> fill = scratch.AllocateArray<u32>(vertexCount);
+  std::copy_n(adjacency.Offsets.begin(), vertexCount, fill.begin());
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    for (u32 corner = 0; corner < 3; ++corner) {
+      u32 from                        = indices[i + corner];
+      u32 to                          = indices[i + (corner + 1) % 3];
+      adjacency.Targets[fill[from]++] = to;
+    }
+  }
+}
+
+static bool IsPositionallyOpen(
+    u32 from, u32 to, const EdgeAdjacency& edges, std::span<const u32> remap,
+    std::span<const u32> wedges
+) {
+  // Open when no vertex at the position of to has an edge back to the position of from
+  u32 wedge = to;
+  do {
+    for (u32 i = edges.Offsets[wedge]; i < edges.Offsets[wedge + 1]; ++i) {
+      if (remap[edges.Targets[i]] == remap[from]) {
+        return false;
+      }
+    }
+    wedge = wedges[wedge];
+  } while (wedge != to);
+  return true;
+}
+
+static bool HasSingleLoop(u32 vertex, std::span<const u32> loops, std::span<const u32> loopbacks) {
+  return loops[vertex] < MULTIPLE_VERTEX && loopbacks[vertex] < MULTIPLE_VERTEX;
+}
+
+static VertexKind ClassifyVertex(
+    u32 vertex, const EdgeAdjacency& edges, std::span<const u32> remap,
+    std::span<const u32> wedges, std::span<const u32> loops, std::span<const u32> loopbacks
+) {
+  u32 twin    = wedges[vertex];
+  bool isOpen = loops[vertex] != INVALID_VERTEX || loopbacks[vertex] != INVALID_VERTEX;
+  if (twin == vertex) {
+    if (!isOpen) {
+      return VertexKind::Manifold;
+    }
+    if (HasSingleLoop(vertex, loops, loopbacks)
+        && IsPositionallyOpen(vertex, loops[vertex], edges, remap, wedges)
+        && IsPositionallyOpen(loopbacks[vertex], vertex, edges, remap, wedges)) {
+      return VertexKind::Border;
+    }
+    return VertexKind::Locked;
+  }
+
+  // A seam splits the position into two vertices whose open edges run the opposite way
+  if (wedges[twin] == vertex && HasSingleLoop(vertex, loops, loopbacks)
+      && HasSingleLoop(twin, loops, loopbacks)
+      && remap[loops[vertex]] == remap[loopbacks[twin]]
+      && remap[loopbacks[vertex]] == remap[loops[twin]]) {
+    return VertexKind::Seam;
+  }
+  return VertexKind::Locked;
+}
+
+static bool CanCollapse(
+    u32 from, u32 to, std::span<const VertexKind> kinds, std::span<const u32> wedges,
+    std::span<const u32> loops, std::span<const u32> loopbacks
+) {
+  switch (kinds[from]) {
+    case VertexKind::Manifold:
+      return true;
+    case VertexKind::Border:
+      return kinds[to] == VertexKind::Border && (loops[from] == to || loopbacks[from] == to);
+    case VertexKind::Seam: {
+      // Both sides of the seam have to move along the same edge
+      if (kinds[to] != VertexKind::Seam) {
+        return false;
+      }
+      u32 fromTwin = wedges[from];
+      u32 toTwin   = wedges[to];
+      if (loops[from] == to) {
+        return loopbacks[fromTwin] == toTwin;
+      }
+      return loopbacks[from] == to && loops[fromTwin] == toTwin;
+    }
+    default:
+      return false;
+  }
+}
+
+f32 MeshSimplifier::Simplify(
+    std::span<const Vertex> vertices, std::span<const u32> indices, u32 targetIndexCount,
+    f32 maxError, std::vector<u32>& result
+) {
+  result.assign(indices.begin(), indices.end());
+  u32 vertexCount = static_cast<u32>(vertices.size());
+  if (result.size() <= targetIndexCount || vertexCount == 0) {
+    return 0.0f;
+  }
+
+  ScratchScope scratch;
+  std::span<u32> remap  = scratch.AllocateArray<u32>(vertexCount);
+  std::span<u32> wedges = scratch.AllocateArray<u32>(vertexCount);
+  BuildPositionRemap(vertices, remap, wedges);
+
+  // Per position, stored at the vertex remap points at
+  std::span<Quadric> quadrics = scratch.AllocateArray<Quadric>(vertexCount);
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    const Vec3& a = vertices[indices[i + 0]].Position;
+    const Vec3& b = vertices[indices[i + 1]].Position;
+    const Vec3& c = vertices[indices[i + 2]].Position;
+    Vec3 normal   = glm::cross(b - a, c - a);
+    f32 length    = glm::length(normal);
+    if (length == 0.0f) {
+      continue;
+    }
+    normal /= length;
+    for (u32 corner = 0; corner < 3; ++corner) {
+      AddPlane(quadrics[remap[indices[i + corner]]], normal, -glm::dot(normal, a), length * 0.5);
+    }
+  }
+
+  f32 maxErrorSquared = maxError * maxError;
+  f32 resultError     = 0.0f;
+  for (bool isFirstPass = true; result.size() > targetIndexCount; isFirstPass = false) {
+    ScratchScope passScratch;
+
+    EdgeAdjacency edges;
+    edges.Offsets = passScratch.AllocateArray<u32>(vertexCount + 1);
+    BuildEdgeAdjacency(result, passScratch, edges);
+
+    // Triangles around every position
+    std::span<u32> triangleOffsets = passScratch.AllocateArray<u32>(vertexCount + 1);
+    std::span<u32> triangles       = passScratch.AllocateArray<u32>(result.size());
+    for (u32 index : result) {
+      ++triangleOffsets[remap[index] + 1];
+    }
+    for (u32 vertex = 0; vertex < vertexCount; ++vertex) {
+      triangleOffsets[vertex + 1] += triangleOffsets[vertex];
+    }
+    std::span<u32> fill = passScratch.AllocateArray<u32>(vertexCount);
+    std::copy_n(triangleOffsets.begin(), vertexCount, fill.begin());
+    for (size_t i = 0; i < result.size(); ++i) {
+      triangles[fill[remap[result[i]]]++] = static_cast<u32>(i / 3);
+    }
+
+    // The open edges, which have no edge running the other way. loops follows them forward and
+    // loopbacks backward.
+    std::span<u32> loops     = passScratch.AllocateArray<u32>(vertexCount);
+    std::span<u32> loopbacks = passScratch.AllocateArray<u32>(vertexCount);
+    std::ranges::fill(loops, INVALID_VERTEX);
+    std::ranges::fill(loopbacks, INVALID_VERTEX);
+    for (size_t i = 0; i < result.size(); i += 3) {
+      for (u32 corner = 0; corner < 3; ++corner) {
+        u32 from = result[i + corner];
+        u32 to   = result[i + (corner + 1) % 3];
+        if (edges.HasEdge(to, from)) {
+          continue;
+        }
+        loops[from]   = loops[from] == INVALID_VERTEX ? to : MULTIPLE_VERTEX;
+        loopbacks[to] = loopbacks[to] == INVALID_VERTEX ? from : MULTIPLE_VERTEX;
+
+        // Planes standing on the open edges keep borders and seams from drifting
+        if (isFirstPass) {
+          const Vec3& a = vertices[from].Position;
+          const Vec3& b = vertices[to].Position;
+          const Vec3& c = vertices[result[i + (corner + 2) % 3]].Position;
+          Vec3 edge     = b - a;
+          Vec3 normal   = glm::cross(edge, glm::cross(edge, c - a));
+          f32 length    = glm::length(normal);
+          if (length == 0.0f) {
+            continue;
+          }
+          normal /= length;
+          f64 weight = glm::dot(edge, edge) * BORDER_WEIGHT;
+          AddPlane(quadrics[remap[from]], normal, -glm::dot(normal, a), weight);
+          AddPlane(quadrics[remap[to]], normal, -glm::dot(normal, a), weight);
+        }
+      }
+    }
+
+    std::span<VertexKind> kinds = passScratch.AllocateArray<VertexKind>(vertexCount);
+    for (u32 vertex = 0; vertex < vertexCount; ++vertex) {
+      kinds[vertex] = ClassifyVertex(vertex, edges, remap, wedges, loops, loopbacks);
+    }
+
+    std::pmr::vector<Collapse> collapses(passScratch.GetResource());
+    collapses.reserve(result.size() * 2);
+    for (size_t i = 0; i < result.size(); i += 3) {
+      for (u32 corner = 0; corner < 3; ++corner) {
+        u32 a = result[i + corner];
+        u32 b = result[i + (corner + 1) % 3];
+        for (auto [from, to] : {std::pair(a, b), std::pair(b, a)}) {
+          if (remap[from] != remap[to] && CanCollapse(from, to, kinds, wedges, loops, loopbacks)) {
+            f32 error = EvaluateQuadric(quadrics[remap[from]], vertices[to].Position);
+            collapses.push_back({from, to, error});
+          }
+        }
+      }
+    }
+    std::ranges::sort(collapses, [](const Collapse& a, const Collapse& b) {
+      return std::tie(a.Error, a.From, a.To) < std::tie(b.Error, b.From, b.To);
+    });
+
+    // Cheapest first, every position moves or is moved onto at most once per pass
+    std::span<u32> collapseRemap = passScratch.AllocateArray<u32>(vertexCount);
+    std::span<u8> isTouched      = passScratch.AllocateArray<u8>(vertexCount);
+    for (u32 vertex = 0; vertex < vertexCount; ++vertex) {
+      collapseRemap[vertex] = vertex;
+    }
+
+    auto resolve = [&](u32 index) { return vertices[collapseRemap[index]].Position; };
+    auto isFlipping = [&](u32 fromPosition, u32 toPosition, const Vec3& target) {
+      for (u32 i = triangleOffsets[fromPosition]; i < triangleOffsets[fromPosition + 1]; ++i) {
+        const u32* corners = &result[triangles[i] * 3];
+        if (remap[corners[0]] == toPosition || remap[corners[1]] == toPosition
+            || remap[corners[2]] == toPosition) {
+          continue;  // collapses away
+        }
+
+        Vec3 before[3] = {resolve(corners[0]), resolve(corners[1]), resolve(corners[2])};
+        Vec3 after[3]  = {before[0], before[1], before[2]};
+        for (u32 corner = 0; corner < 3; ++corner) {
+          if (remap[corners[corner]] == fromPosition) {
+            after[corner] = target;
+          }
+        }
+        Vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+        Vec3 normalAfter  = glm::cross(after[1] - after[0], after[2] - after[0]);
+        f32 limit = MIN_FLIP_COSINE * glm::length(normalBefore) * glm::length(normalAfter);
+        if (glm::dot(normalBefore, normalAfter) < limit) {
+          return true;
+        }
+      }
+      return false;
+    };
+
+    size_t triangleGoal = (result.size() - targetIndexCount) / 3;
+    size_t removedCount = 0;
+    for (const Collapse& collapse : collapses) {
+      if (removedCount >= triangleGoal || collapse.Error > maxErrorSquared) {
+        break;
+      }
+
+      u32 fromPosition = remap[collapse.From];
+      u32 toPosition   = remap[collapse.To];
+      if (isTouched[fromPosition] || isTouched[toPosition]
+          || isFlipping(fromPosition, toPosition, vertices[collapse.To].Position)) {
+        continue;
+      }
+
+      collapseRemap[collapse.From] = collapse.To;
+      if (kinds[collapse.From] == VertexKind::Seam) {
+        collapseRemap[wedges[collapse.From]] = wedges[collapse.To];
+      }
+      AddQuadric(quadrics[toPosition], quadrics[fromPosition]);
+      isTouched[fromPosition] = 1;
+      isTouched[toPosition]   = 1;
+      removedCount += kinds[collapse.From] == VertexKind::Border ? 1 : 2;
+      resultError = std::max(resultError, collapse.Error);
+    }
+
+    if (removedCount == 0) {
+      break;
+    }
+
+    size_t writeCount = 0;
+    for (size_t i = 0; i < result.size(); i += 3) {
+      u32 a = collapseRemap[result[i + 0]];
+      u32 b = collapseRemap[result[i + 1]];
+      u32 c = collapseRemap[result[i + 2]];
+      if (remap[a] == remap[b] || remap[b] == remap[c] || remap[c] == remap[a]) {
+        continue;
+      }
+      result[writeCount++] = a;
+      result[writeCount++] = b;
+      result[writeCount++] = c;
+    }
+    result.resize(writeCount);
+  }
+  return std::sqrt(resultError);
+}
+
+void MeshSimplifier::GenerateLods(
+    std::span<const Vertex> vertices, std::span<const u32> indices, u32 levelCount,
+    std::vector<u32>& lodIndices, std::vector<MeshLod>& lods
+) {
+  lodIndices.clear();
+  lods.clear();
+
+  // Every level starts from the full mesh, so its error is measured against it
+  std::vector<u32> level;
+  size_t previousCount = indices.size();
+  for (u32 i = 0; i < levelCount; ++i) {
+    u32 targetCount = static_cast<u32>(previousCount / 6 * 3);
+    f32 error       = Simplify(vertices, indices, targetCount, UNLIMITED_ERROR, level);
+    if (level.empty() || level.size() > previousCount * MAX_LOD_FRACTION) {
+      break;
+    }
+
+    MeshLod& lod   = lods.emplace_back();
+    lod.FirstIndex = static_cast<u32>(lodIndices.size());
+    lod.IndexCount = static_cast<u32>(level.size());
+    lod.Error      = lods.size() > 1 ? std::max(error, lods[lods.size() - 2].Error) : error;
+    lodIndices.insert(lodIndices.end(), level.begin(), level.end());
+    previousCount = level.size();
+  }
+}
+}  // namespace Rava
@@ -0,0 +1,28 @@
+#pragma once
+
+namespace Rava {
+struct Vertex;
+struct MeshLod;
+
+// Quadric error metric simplification (Garland and Heckbert 1997) by half edge collapse: a vertex
+// moves onto a neighbour, so no new vertices are made and the LODs share the vertices of the full
+// mesh. Vertices on an open border only move along it, vertices on a UV or normal seam only move
+// along the seam together with their twin on the other side, everything else is locked.
+class MeshSimplifier {
+public:
+  // Writes at most about targetIndexCount indices to result, never collapsing edges with an error
+  // above maxError. Returns the largest error of the collapses, in mesh space units.
+  static f32 Simplify(
+      std::span<const Vertex> vertices, std::span<const u32> indices, u32 targetIndexCount,
+      f32 maxError, std::vector<u32>& result
+  );
+
+  // Up to levelCount levels with half the triangles of the previous one each, the chain ends early
+  // when a level can not be reduced any further. The ranges of lods point into lodIndices and their
+  // errors are against the full mesh.
+  static void GenerateLods(
+      std::span<const Vertex> vertices, std::span<const u32> indices, u32 levelCount,
+      std::vector<u32>& lodIndices, std::vector<MeshLod>& lods
+  );
+};
+}  // namespace Rava
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include "RavaFramework.h"
+
+#include "Graphics/ModelLoader/MeshletBuilder.h"
+
+#include "Core/FrameAllocator.h"
+#include "Graphics/Model.h"
+
+namespace Rava {
+static constexpr u32 INVALID_TRIANGLE = ~0u;
+static constexpr f32 MIN_CONE_COSINE  = 0.1f;  // below it the normals spread too far to ever cull
+
+// Sphere and normal cone of the triangles in indices, vertices are the meshlet's unique ones
+static void ComputeMeshletBounds(
+    std::span<const Vertex> vertices, std::span<const u32> indices,
+    std::span<const u32> meshletVertices, Meshlet& meshlet
+) {
+  Vec3 min = vertices[meshletVertices[0]].Position;
+  Vec3 max = min;
+  for (u32 vertex : meshletVertices) {
+    min = glm::min(min, vertices[vertex].Position);
+    max = glm::max(max, vertices[vertex].Position);
+  }
+  Vec3 center = (min + max) * 0.5f;
+  f32 radius  = 0.0f;
+  for (u32 vertex : meshletVertices) {
+    radius = std::max(radius, glm::length(vertices[vertex].Position - center));
+  }
+  meshlet.BoundingSphere = Vec4(center, radius);
+
+  // The axis averages the face normals, the cutoff is the sine of the widest angle to it
+  Vec3 normalSum{0.0f};
+  std::array<Vec3, MeshletBuilder::MAX_TRIANGLES> normals;
+  u32 normalCount = 0;
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    const Vec3& p0 = vertices[indices[i]].Position;
+    const Vec3& p1 = vertices[indices[i + 1]].Position;
+    const Vec3& p2 = vertices[indices[i + 2]].Position;
+    Vec3 normal    = glm::cross(p1 - p0, p2 - p0);
+    f32 length     = glm::length(normal);
+    if (length > 0.0f) {
+      normals[normalCount] = normal / length;
+      normalSum += normals[normalCount++];
+    }
+  }
+
+  f32 axisLength = glm::length(normalSum);
+  if (normalCount == 0 || axisLength == 0.0f) {
+    meshlet.Cone = Vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    return;
+  }
+
+  Vec3 axis     = normalSum / axisLength;
+  f32 minCosine = 1.0f;
+  for (u32 i = 0; i < normalCount; ++i) {
+    minCosine = std::min(minCosine, glm::dot(normals[i], axis));
+  }
+  if (minCosine <= MIN_CONE_COSINE) {
+    meshlet.Cone = Vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    return;
+  }
+  meshlet.Cone = Vec4(axis, std::sqrt(1.0f - minCosine * minCosine));
+}
+
+void MeshletBuilder::Build(
+    std::span<const Vertex> vertices, std::span<u32> indices, std::vector<Meshlet>& meshlets
+) {
+  meshlets.clear();
+  u32 triangleCount = static_cast<u32>(indices.size() / 3);
+  if (triangleCount == 0) {
+    return;
+  }
+
+  ScratchScope scratch;
+  u32 vertexCount = static_cast<u32>(vertices.size());
+
+  // Triangles around every vertex
+  std::span<u32> adjacencyOffsets = scratch.AllocateArray<u32>(vertexCount + 1);
+  std::span<u32> adjacency        = scratch.AllocateArray<u32>(indices.size());
+  for (u32 index : indices) {
+    ++adjacencyOffsets[index + 1];
+  }
+  for (u32 vertex = 0; vertex < vertexCount; ++vertex) {
+    adjacencyOffsets[vertex + 1] += adjacencyOffsets[vertex];
+  }
+  std::span<u32> fill = scratch.AllocateArray<u32>(vertexCount);
+  for (u32 triangle = 0; triangle < triangleCount; ++triangle) {
+    for (u32 corner = 0; corner < 3; ++corner) {
+      u32 vertex = indices[triangle * 3 + corner];
+      adjacency[adjacencyOffsets[vertex] + fill[vertex]++] = triangle;
+    }
+  }
+
+  // The meshlet a vertex was last added to, counted from 1 so the array never needs clearing
+  std::span<u32> vertexMeshlets = scratch.AllocateArray<u32>(vertexCount);
+  std::span<u8> isEmitted       = scratch.AllocateArray<u8>(triangleCount);
+  std::span<u32> output         = scratch.AllocateArray<u32>(indices.size());
+  std::array<u32, MAX_VERTICES> meshletVertices;
+
+  u32 outputCount = 0;
+  u32 cursor      = 0;  // first triangle that may not be emitted yet, in input order
+  while (outputCount < indices.size()) {
+    Meshlet& meshlet   = meshlets.emplace_back();
+    meshlet.FirstIndex = outputCount;
+    u32 meshletId      = static_cast<u32>(meshlets.size());
+
+    auto newVertexCount = [&](u32 triangle) {
+      u32 count = 0;
+      for (u32 corner = 0; corner < 3; ++corner) {
+        count += vertexMeshlets[indices[triangle * 3 + corner]] != meshletId;
+      }
+      return count;
+    };
+
+    // Seeds at the first triangle left in input order, which the vertex cache order made local
+    while (isEmitted[cursor]) {
+      ++cursor;
+    }
+    u32 triangle = cursor;
+    Vec3 positionSum{0.0f};
+    while (triangle != INVALID_TRIANGLE) {
+      for (u32 corner = 0; corner < 3; ++corner) {
+        u32 vertex = indices[triangle * 3 + corner];
+        if (vertexMeshlets[vertex] != meshletId) {
+          vertexMeshlets[vertex]                 = meshletId;
+          meshletVertices[meshlet.VertexCount++] = vertex;
+          positionSum += vertices[vertex].Position;
+        }
+        output[outputCount++] = vertex;
+      }
+      isEmitted[triangle] = 1;
+      meshlet.IndexCount += 3;
+
+      // The neighbour adding the fewest vertices that still fits, the one closest to the center on
+      // a tie. Without the distance the meshlets grow into long strips along the input order.
+      triangle = INVALID_TRIANGLE;
+      if (meshlet.IndexCount / 3 == MAX_TRIANGLES) {
+        break;
+      }
+      Vec3 center      = positionSum / static_cast<f32>(meshlet.VertexCount);
+      u32 bestCount    = 4;
+      f32 bestDistance = 0.0f;
+      for (u32 i = 0; i < meshlet.VertexCount; ++i) {
+        u32 vertex = meshletVertices[i];
+        for (u32 j = adjacencyOffsets[vertex]; j < adjacencyOffsets[vertex + 1]; ++j) {
+          u32 candidate = adjacency[j];
+          if (isEmitted[candidate]) {
+            continue;
+          }
+          u32 count = newVertexCount(candidate);
+          if (count > bestCount || meshlet.VertexCount + count > MAX_VERTICES) {
+            continue;
+          }
+
+          Vec3 offset = vertices[indices[candidate * 3]].Position
+                      + vertices[indices[candidate * 3 + 1]].Position
+                      + vertices[indices[candidate * 3 + 2]].Position - center * 3.0f;
+          f32 distance = glm::dot(offset, offset);
+          if (count < bestCount || distance < bestDistance) {
+            bestCount    = count;
+            bestDistance = distance;
+            triangle     = candidate;
+          }
+        }
+      }
+    }
+
+    ComputeMeshletBounds(
+        vertices, {output.data() + meshlet.FirstIndex, meshlet.IndexCount},
+        {meshletVertices.data(), meshlet.VertexCount}, meshlet
+    );
+  }
+
+  std::ranges::copy(output, indices.begin());
+}
+}  // namespace Rava
\ No newline at end of file
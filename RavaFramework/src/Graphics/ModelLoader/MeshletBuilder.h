@@ -0,0 +1,23 @@
+#pragma once
+
+namespace Rava {
+struct Vertex;
+struct Meshlet;
+
+// Splits a mesh into meshlets of at most MAX_VERTICES unique vertices and MAX_TRIANGLES triangles.
+// A meshlet grows from its first triangle over the neighbours that add the fewest new vertices, so
+// it stays compact and its bounds tight. Meshlets are plain index ranges, drawn without mesh
+// shaders by the cluster culling of GpuScene.
+class MeshletBuilder {
+public:
+  static constexpr u32 MAX_VERTICES  = 64;
+  static constexpr u32 MAX_TRIANGLES = 124;
+
+public:
+  // Reorders the triangles of indices so every meshlet is one contiguous range, the FirstIndex of
+  // the meshlets points into indices
+  static void Build(
+      std::span<const Vertex> vertices, std::span<u32> indices, std::vector<Meshlet>& meshlets
+  );
+};
+}  // namespace Rava
\ No newline at end of file
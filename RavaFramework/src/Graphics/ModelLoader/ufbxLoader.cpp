@@ -1,17 +1,48 @@
 #include "RavaFramework.h"
 
 #include <ufbx/ufbx.h>
+#include "Core/Config.h"
+#include "Core/CpuProfiler.h"
+#include "Core/FrameAllocator.h"
+#include "Core/JobSystem.h"
 #include "Core/Utils.h"
 
 #include "Graphics/Model.h"
+#include "Graphics/ModelLoader/MeshCache.h"
+#include "Graphics/ModelLoader/MeshOptimizer.h"
+#include "Graphics/ModelLoader/MeshSimplifier.h"
+#include "Graphics/ModelLoader/MeshletBuilder.h"
 #include "Graphics/ModelLoader/ufbxLoader.h"
 
 namespace Rava {
-ufbxLoader::ufbxLoader(const std::string& filepath) : _filepath(filepath) {
-  _path = GetPathWithoutFileName(filepath);
+// Bump whenever LoadModel produces different output for the same input, invalidates mesh caches
+static constexpr u32 LOADER_VERSION = 4;
+
+// One material part of a mesh node, the unit of work LoadModel spreads over the job system
+struct ufbxLoader::MeshPart {
+  const ufbx_node* Node = nullptr;
+  u32 PartIndex         = 0;
+  u32 FirstIndex        = 0;
+  u32 IndexCount        = 0;
+  std::vector<Vertex> Vertices;
+  std::string Error;
+  bool IsOptimized = false;
+  VertexCacheStats CacheStatsBefore;
+  VertexCacheStats CacheStatsAfter;
+  std::vector<u32> LodIndices;    // local to the part's vertices like its indices
+  std::vector<MeshLod> Lods;      // FirstIndex points into LodIndices
+  std::vector<Meshlet> Meshlets;  // FirstIndex local to the part's slice of Indices
+};
+
+static void ParallelFor(u32 count, const std::function<void(u32 begin, u32 end)>& function) {
+  if (JobSystem::Instance) {
+    JobSystem::Instance->ParallelFor(count, 1, function);
+  } else {
+    function(0, count);
+  }
 }
 
-bool ufbxLoader::LoadModel(const u32 instanceCount) {
+static ufbx_load_opts GetLoadOptions() {
   ufbx_load_opts loadOptions{};
   loadOptions.ignore_animation              = true;
   loadOptions.load_external_files           = true;
@@ -19,6 +50,16 @@ bool ufbxLoader::LoadModel(const u32 instanceCount) {
   loadOptions.generate_missing_normals      = true;
   loadOptions.target_axes                   = ufbx_axes_left_handed_y_up;
   loadOptions.target_unit_meters            = 1.0f;
+  return loadOptions;
+}
+
+ufbxLoader::ufbxLoader(const std::string& filepath) : _filepath(filepath) {
+  _path = GetPathWithoutFileName(filepath);
+}
+
+bool ufbxLoader::LoadModel() {
+  RV_PROFILE_FUNCTION();
+  ufbx_load_opts loadOptions = GetLoadOptions();
 
   ufbx_error ufbxError;
 
@@ -36,53 +77,132 @@ bool ufbxLoader::LoadModel(const u32 instanceCount) {
     return false;
   }
 
-  LoadNode(_ufbxScene->root_node);
+  // Parts are gathered in node order and every part gets a fixed slice of Indices up front, so the
+  // result does not depend on which thread processed which part
+  std::vector<MeshPart> meshParts;
+  CollectMeshParts(_ufbxScene->root_node, meshParts);
+
+  u32 indexCount = 0;
+  for (auto& meshPart : meshParts) {
+    meshPart.FirstIndex = indexCount;
+    indexCount += meshPart.IndexCount;
+  }
+  Indices.resize(indexCount);
+
+  ParallelFor(static_cast<u32>(meshParts.size()), [&](u32 begin, u32 end) {
+    for (u32 i = begin; i < end; ++i) {
+      u32* indices = Indices.data() + meshParts[i].FirstIndex;
+      LoadMeshPart(meshParts[i], indices);
+      GenerateLods(meshParts[i], {indices, meshParts[i].IndexCount});
+      BuildMeshlets(meshParts[i], {indices, meshParts[i].IndexCount});
+    }
+  });
+
+  u32 vertexCount = 0;
+  Meshes.resize(meshParts.size());
+  for (size_t i = 0; i < meshParts.size(); ++i) {
+    if (!meshParts[i].Error.empty()) {
+      std::print("{0}", meshParts[i].Error);
+    }
+    if (meshParts[i].IsOptimized) {
+      const VertexCacheStats& before = meshParts[i].CacheStatsBefore;
+      const VertexCacheStats& after  = meshParts[i].CacheStatsAfter;
+      std::print(
+          "{0} part {1}: ACMR {2:.3f} -> {3:.3f}, ATVR {4:.3f} -> {5:.3f}\n",
+          meshParts[i].Node->name.data, meshParts[i].PartIndex, before.ACMR, after.ACMR,
+          before.ATVR, after.ATVR
+      );
+    }
+
+    Mesh& mesh       = Meshes[i];
+    mesh.FirstVertex = vertexCount;
+    mesh.VertexCount = static_cast<u32>(meshParts[i].Vertices.size());
+    mesh.FirstIndex  = meshParts[i].FirstIndex;
+    mesh.IndexCount  = meshParts[i].IndexCount;
+    vertexCount += mesh.VertexCount;
+
+    // The levels go behind all base ranges, in mesh order
+    mesh.FirstLod = static_cast<u32>(Lods.size());
+    mesh.LodCount = static_cast<u32>(meshParts[i].Lods.size());
+    for (MeshLod lod : meshParts[i].Lods) {
+      lod.FirstIndex += static_cast<u32>(Indices.size());
+      Lods.push_back(lod);
+    }
+    Indices.insert(Indices.end(), meshParts[i].LodIndices.begin(), meshParts[i].LodIndices.end());
+
+    mesh.FirstMeshlet = static_cast<u32>(Meshlets.size());
+    mesh.MeshletCount = static_cast<u32>(meshParts[i].Meshlets.size());
+    for (Meshlet meshlet : meshParts[i].Meshlets) {
+      meshlet.FirstIndex += mesh.FirstIndex;
+      Meshlets.push_back(meshlet);
+    }
+  }
+
+  Vertices.resize(vertexCount);
+  ParallelFor(static_cast<u32>(meshParts.size()), [&](u32 begin, u32 end) {
+    for (u32 i = begin; i < end; ++i) {
+      std::ranges::copy(meshParts[i].Vertices, Vertices.begin() + Meshes[i].FirstVertex);
+    }
+  });
 
   ufbx_free_scene(_ufbxScene);
+  _ufbxScene = nullptr;
+
+  MeshCache::Write(_filepath, GetOptionsHash(), GetModelData());
   return true;
 }
 
-void ufbxLoader::LoadNode(const ufbx_node* fbxNode) {
+ModelData ufbxLoader::GetModelData() const {
+  return {Vertices, Indices, Meshes, Lods, Meshlets};
+}
+
+u64 ufbxLoader::GetOptionsHash() const {
+  ufbx_load_opts loadOptions = GetLoadOptions();
+
+  u64 hash = HashValue(LOADER_VERSION);
+  hash     = HashValue(loadOptions.ignore_animation, hash);
+  hash     = HashValue(loadOptions.generate_missing_normals, hash);
+  hash     = HashValue(loadOptions.target_axes, hash);
+  hash     = HashValue(loadOptions.target_unit_meters, hash);
+  hash     = HashValue(Config::IsMeshOptimizationEnabled, hash);
+  hash     = HashValue(Config::LodLevelCount, hash);
+  hash     = HashValue(Config::IsMeshletGenerationEnabled, hash);
+  return hash;
+}
+
+void ufbxLoader::CollectMeshParts(
+    const ufbx_node* fbxNode, std::vector<MeshPart>& meshParts
+) const {
   ufbx_mesh* fbxMesh = fbxNode->mesh;
   if (fbxMesh) {
-    u32 meshCount = static_cast<u32>(fbxMesh->material_parts.count);
-    if (meshCount > 0) {
-      Vertices.clear();
-      Indices.clear();
-      Meshes.clear();
-
-      Meshes.resize(meshCount);
-      for (u32 meshIndex = 0; meshIndex < meshCount; ++meshIndex) {
-        LoadMesh(fbxNode, meshIndex);
-      }
+    u32 partCount = static_cast<u32>(fbxMesh->material_parts.count);
+    for (u32 partIndex = 0; partIndex < partCount; ++partIndex) {
+      MeshPart& meshPart = meshParts.emplace_back();
+      meshPart.Node      = fbxNode;
+      meshPart.PartIndex = partIndex;
+      meshPart.IndexCount
+          = static_cast<u32>(fbxMesh->material_parts[partIndex].num_triangles * 3);
     }
   }
 
   u32 childCount = static_cast<u32>(fbxNode->children.count);
   for (u32 childIndex = 0; childIndex < childCount; ++childIndex) {
-    LoadNode(fbxNode->children[childIndex]);
+    CollectMeshParts(fbxNode->children[childIndex], meshParts);
   }
 }
 
-void ufbxLoader::LoadMesh(const ufbx_node* fbxNode, const u32 meshIndex) {
+void ufbxLoader::LoadMeshPart(MeshPart& meshPart, u32* indices) const {
+  const ufbx_node* fbxNode          = meshPart.Node;
   ufbx_mesh* fbxMesh                = fbxNode->mesh;
-  const ufbx_mesh_part& fbxMeshPart = fbxNode->mesh->material_parts[meshIndex];
+  const ufbx_mesh_part& fbxMeshPart = fbxMesh->material_parts[meshPart.PartIndex];
   size_t faceCount                  = fbxMeshPart.num_faces;
 
   if (!fbxMeshPart.num_triangles) {
-    std::print("ufbxLoader::LoadMesh: only triangle meshes are supported!");
+    meshPart.Error = "ufbxLoader::LoadMesh: only triangle meshes are supported!";
     return;
   }
 
-  size_t numVerticesBefore = Vertices.size();
-  size_t numIndicesBefore  = Indices.size();
-
-  Mesh& mesh       = Meshes[meshIndex];
-  mesh.FirstVertex = static_cast<u32>(numVerticesBefore);
-  mesh.FirstIndex  = static_cast<u32>(numIndicesBefore);
-  mesh.IndexCount  = 0;
-
-  ufbx_material_map& baseColorMap = fbxNode->materials[meshIndex]->pbr.base_color;
+  ufbx_material_map& baseColorMap = fbxNode->materials[meshPart.PartIndex]->pbr.base_color;
   glm::vec4 diffuseColor          = baseColorMap.has_value
                                       ? glm::vec4(
                                    baseColorMap.value_vec4.x, baseColorMap.value_vec4.y,
@@ -91,22 +211,30 @@ void ufbxLoader::LoadMesh(const ufbx_node* fbxNode, const u32 meshIndex) {
                                       : glm::vec4(1.0f);
 
 #pragma region Vertices
-  bool hasUVs                 = fbxMesh->uv_sets.count;
-  bool hasVertexColors        = fbxMesh->vertex_color.exists;
+  bool hasUVs          = fbxMesh->uv_sets.count;
+  bool hasVertexColors = fbxMesh->vertex_color.exists;
+
+  // Unindexed triangle list, deduplicated in place below
+  std::vector<Vertex>& vertices = meshPart.Vertices;
+  vertices.resize(meshPart.IndexCount);
+  u32 meshAllVertices = 0;
+
+  size_t triangleIndexCount = fbxMesh->max_face_triangles * 3;
+  Rava::ScratchScope scratch;
+  std::span<u32> verticesPerFaceIndexBuffer = scratch.AllocateArray<u32>(triangleIndexCount);
 
   for (size_t fbxFaceIndex = 0; fbxFaceIndex < faceCount; ++fbxFaceIndex) {
-    ufbx_face& fbxFace        = fbxMesh->faces[fbxMeshPart.face_indices.data[fbxFaceIndex]];
-    size_t triangleIndexCount = fbxMesh->max_face_triangles * 3;
-    std::vector<u32> verticesPerFaceIndexBuffer(triangleIndexCount);
+    ufbx_face& fbxFace   = fbxMesh->faces[fbxMeshPart.face_indices.data[fbxFaceIndex]];
     size_t triangleCount = ufbx_triangulate_face(
         verticesPerFaceIndexBuffer.data(), triangleIndexCount, fbxMesh, fbxFace
     );
     size_t vertexCountPerFace = triangleCount * 3;
+    assert(meshAllVertices + vertexCountPerFace <= vertices.size());
 
     for (u32 vertexPerFace = 0; vertexPerFace < vertexCountPerFace; ++vertexPerFace) {
       u32 vertexPerFaceIndex = verticesPerFaceIndexBuffer[vertexPerFace];
 
-      Vertex vertex{};
+      Vertex& vertex = vertices[meshAllVertices++];
 
       u32 fbxVertexIndex     = fbxMesh->vertex_indices[vertexPerFaceIndex];
       ufbx_vec3& positionFbx = fbxMesh->vertices[fbxVertexIndex];
@@ -140,39 +268,80 @@ void ufbxLoader::LoadMesh(const ufbx_node* fbxNode, const u32 meshIndex) {
       } else {
         vertex.Color = diffuseColor;
       }
-
-      Vertices.push_back(vertex);
     }
   }
 #pragma endregion
 
 #pragma region Indices
-  u32 meshAllVertices = static_cast<u32>(Vertices.size() - numVerticesBefore);
-
   ufbx_vertex_stream stream{};
-  stream.data         = &Vertices[numVerticesBefore];
+  stream.data         = vertices.data();
   stream.vertex_count = meshAllVertices;
   stream.vertex_size  = sizeof(Vertex);
 
-  Indices.resize(numIndicesBefore + meshAllVertices);
-
   ufbx_error ufbxError;
-  size_t vertexCount = ufbx_generate_indices(
-      &stream, 1, &Indices[numIndicesBefore], meshAllVertices, nullptr, &ufbxError
-  );
+  size_t vertexCount
+      = ufbx_generate_indices(&stream, 1, indices, meshAllVertices, nullptr, &ufbxError);
 
   if (ufbxError.type != UFBX_ERROR_NONE) {
     char errorBuffer[512];
     ufbx_format_error(errorBuffer, sizeof(errorBuffer), &ufbxError);
-    std::print(
+    meshPart.Error = std::format(
         "ufbxBuilder: creation of index buffer failed, file: {0}, error: {1},  node: {2}",
         _filepath, errorBuffer, fbxNode->name.data
     );
   }
 
-  Vertices.resize(numVerticesBefore + vertexCount);
-  mesh.VertexCount = static_cast<u32>(vertexCount);
-  mesh.IndexCount  = meshAllVertices;
+  vertices.resize(vertexCount);
+  meshPart.IndexCount = meshAllVertices;
+#pragma endregion
+
+#pragma region Optimization
+  if (!Config::IsMeshOptimizationEnabled || !meshPart.Error.empty()) {
+    return;
+  }
+
+  // Face order from the file caches poorly: reorder the triangles for the post transform cache and
+  // overdraw, then the vertices in the order the new triangles use them
+  std::span<u32> partIndices{indices, meshPart.IndexCount};
+  u32 partVertexCount       = static_cast<u32>(vertices.size());
+  meshPart.CacheStatsBefore = MeshOptimizer::AnalyzeVertexCache(partIndices, partVertexCount);
+
+  std::vector<u32> clusters;
+  MeshOptimizer::OptimizeVertexCache(partIndices, partVertexCount, clusters);
+  MeshOptimizer::OptimizeOverdraw(partIndices, vertices, clusters);
+  MeshOptimizer::OptimizeVertexFetch(partIndices, vertices);
+
+  meshPart.CacheStatsAfter = MeshOptimizer::AnalyzeVertexCache(partIndices, partVertexCount);
+  meshPart.IsOptimized     = true;
 #pragma endregion
 }
+
+void ufbxLoader::GenerateLods(MeshPart& meshPart, std::span<const u32> indices) const {
+  if (Config::LodLevelCount == 0 || !meshPart.Error.empty()) {
+    return;
+  }
+
+  MeshSimplifier::GenerateLods(
+      meshPart.Vertices, indices, Config::LodLevelCount, meshPart.LodIndices, meshPart.Lods
+  );
+
+  // The levels reuse the vertex order of the full mesh, only their triangles are reordered
+  if (Config::IsMeshOptimizationEnabled) {
+    std::vector<u32> clusters;
+    u32 vertexCount = static_cast<u32>(meshPart.Vertices.size());
+    for (const MeshLod& lod : meshPart.Lods) {
+      std::span<u32> lodIndices{meshPart.LodIndices.data() + lod.FirstIndex, lod.IndexCount};
+      MeshOptimizer::OptimizeVertexCache(lodIndices, vertexCount, clusters);
+    }
+  }
+}
+
+void ufbxLoader::BuildMeshlets(MeshPart& meshPart, std::span<u32> indices) const {
+  if (!Config::IsMeshletGenerationEnabled || !meshPart.Error.empty()) {
+    return;
+  }
+
+  // Meshlets grow from the first triangle left in index order, which the cache order made local
+  MeshletBuilder::Build(meshPart.Vertices, indices, meshPart.Meshlets);
+}
 }  // namespace Rava
\ No newline at end of file
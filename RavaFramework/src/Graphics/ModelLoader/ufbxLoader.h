@@ -1,19 +1,30 @@
 #pragma once
 
+struct ufbx_scene;
+struct ufbx_node;
+
 namespace Rava {
 struct Vertex;
 struct Mesh;
+struct MeshLod;
+struct Meshlet;
+struct ModelData;
 class ufbxLoader {
 public:
   std::vector<u32> Indices{};
   std::vector<Vertex> Vertices{};
   std::vector<Mesh> Meshes{};
+  std::vector<MeshLod> Lods{};
+  std::vector<Meshlet> Meshlets{};
 
 public:
   ufbxLoader() = delete;
   ufbxLoader(const std::string& filepath);
 
-  bool LoadModel(const u32 instanceCount = 1);
+  bool LoadModel();
+
+  ModelData GetModelData() const;
+  u64 GetOptionsHash() const;
 
 private:
   std::string _filepath;
@@ -22,7 +33,14 @@ private:
   ufbx_scene* _ufbxScene = nullptr;
 
 private:
-  void LoadNode(const ufbx_node* fbxNode);
-  void LoadMesh(const ufbx_node* fbxNode, const u32 meshIndex);
+  struct MeshPart;
+
+  void CollectMeshParts(const ufbx_node* fbxNode, std::vector<MeshPart>& meshParts) const;
+  // Thread safe, writes the part's indices to indices and its unique vertices to the part
+  void LoadMeshPart(MeshPart& meshPart, u32* indices) const;
+  // Thread safe, simplified levels of the part after it was loaded and optimized
+  void GenerateLods(MeshPart& meshPart, std::span<const u32> indices) const;
+  // Thread safe, reorders the full mesh triangles into meshlets, last since it changes their order
+  void BuildMeshlets(MeshPart& meshPart, std::span<u32> indices) const;
 };
 }  // namespace Rava
\ No newline at end of file
@@ -16,6 +16,17 @@ public:
   virtual void EndSwapChainRenderPass()   = 0;
 
   virtual void WaitDeviceIdle() = 0;
+  // Blocks until the frames in flight leave room for the next one, BeginFrame does it as well
+  virtual void WaitForFrameSlot() = 0;
+  virtual void SavePipelineCache() = 0;
+
+  virtual bool GetFramePixels(std::vector<u8>& pixels) const = 0;
+
+  virtual void BeginGpuScope(std::string_view name)               = 0;
+  virtual void EndGpuScope()                                      = 0;
+  virtual bool GetGpuFrameTimings(GpuFrameTimings& timings) const = 0;
+
+  virtual void SetLodCamera(const Vec3& position, f32 verticalFov) = 0;
 
   virtual bool IsInitialized() const { return _initialized; }
 
@@ -0,0 +1,98 @@
+#include "RavaFramework.h"
+
+#include "Graphics/VertexPacking.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include "Graphics/Model.h"
+
+namespace Rava {
+static_assert(sizeof(PackedVertex) == 20, "PackedVertex has to match its attribute formats");
+static_assert(sizeof(VertexQuantization) == 32, "VertexQuantization is read as two vec4");
+
+static u16 PackUnorm16(f32 value) {
+  return static_cast<u16>(std::round(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+static i16 PackSnorm16(f32 value) {
+  return static_cast<i16>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+static u8 PackUnorm8(f32 value) {
+  return static_cast<u8>(std::round(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+// Projects the unit sphere onto an octahedron and unfolds it into [-1, 1]^2 (Cigolle et al. 2014)
+static Vec2 EncodeOctahedral(const Vec3& normal) {
+  f32 length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+  if (length == 0.0f) {
+    return Vec2{0.0f};
+  }
+
+  Vec3 n = normal / length;
+  if (n.z >= 0.0f) {
+    return Vec2{n.x, n.y};
+  }
+  // The lower hemisphere folds over the diagonals
+  return Vec2{
+      (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+      (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f),
+  };
+}
+
+VertexQuantization ComputeVertexQuantization(std::span<const Vertex> vertices) {
+  VertexQuantization quantization;
+  if (vertices.empty()) {
+    return quantization;
+  }
+
+  Vec3 min = vertices[0].Position;
+  Vec3 max = vertices[0].Position;
+  for (const Vertex& vertex : vertices) {
+    min = glm::min(min, vertex.Position);
+    max = glm::max(max, vertex.Position);
+  }
+
+  quantization.Offset = Vec4{min, 0.0f};
+  quantization.Scale  = Vec4{max - min, 0.0f};
+  return quantization;
+}
+
+void PackVertices(
+    std::span<const Vertex> vertices, const VertexQuantization& quantization,
+    std::span<PackedVertex> packed
+) {
+  assert(packed.size() >= vertices.size());
+  Vec3 offset = quantization.Offset;
+  Vec3 scale  = quantization.Scale;
+  // A flat axis has a scale of 0, every position lands on the offset
+  Vec3 inverseScale{
+      scale.x > 0.0f ? 1.0f / scale.x : 0.0f,
+      scale.y > 0.0f ? 1.0f / scale.y : 0.0f,
+      scale.z > 0.0f ? 1.0f / scale.z : 0.0f,
+  };
+
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    const Vertex& vertex = vertices[i];
+    PackedVertex& result = packed[i];
+
+    Vec3 position      = (vertex.Position - offset) * inverseScale;
+    result.Position[0] = PackUnorm16(position.x);
+    result.Position[1] = PackUnorm16(position.y);
+    result.Position[2] = PackUnorm16(position.z);
+    result.Position[3] = 0;
+
+    result.Color[0] = PackUnorm8(vertex.Color.r);
+    result.Color[1] = PackUnorm8(vertex.Color.g);
+    result.Color[2] = PackUnorm8(vertex.Color.b);
+    result.Color[3] = PackUnorm8(vertex.Color.a);
+
+    Vec2 normal      = EncodeOctahedral(vertex.Normal);
+    result.Normal[0] = PackSnorm16(normal.x);
+    result.Normal[1] = PackSnorm16(normal.y);
+
+    result.UV[0] = glm::packHalf1x16(vertex.UV.x);
+    result.UV[1] = glm::packHalf1x16(vertex.UV.y);
+  }
+}
+}  // namespace Rava
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+namespace Rava {
+struct Vertex;
+
+// Compact layout of VertexFormat::Packed. Positions are 16 bit unorm inside the bounds of their
+// mesh, colors unorm8 RGBA, normals octahedral snorm16 and UVs half floats.
+struct PackedVertex {
+  u16 Position[4];  // xyz, w is unused padding
+  u8 Color[4];
+  i16 Normal[2];
+  u16 UV[2];
+};
+
+// Position = Offset + packed position * Scale, one per mesh. Vec4 so it can be read as a vertex
+// attribute and from std430 buffers alike.
+struct VertexQuantization {
+  Vec4 Offset{0.0f};
+  Vec4 Scale{1.0f};
+};
+
+// Bounding box of the positions
+VertexQuantization ComputeVertexQuantization(std::span<const Vertex> vertices);
+void PackVertices(
+    std::span<const Vertex> vertices, const VertexQuantization& quantization,
+    std::span<PackedVertex> packed
+);
+}  // namespace Rava
\ No newline at end of file
@@ -0,0 +1,82 @@
+#version 460
+#pragma shader_stage(compute)
+#extension GL_GOOGLE_include_directive : require
+
+#include "GpuScene.inc"
+#include "CullConstants.inc"
+
+layout(local_size_x = CULL_GROUP_SIZE) in;
+
+layout(std430, set = 0, binding = 0) readonly buffer Meshes {
+  GpuMesh meshes[];
+};
+layout(std430, set = 0, binding = 1) readonly buffer Instances {
+  GpuInstance instances[];
+};
+layout(std430, set = 0, binding = 6) buffer ClusterCounts {
+  uint clusterDrawCount;
+  uint clusterDrawCapacity;
+  uint clusterInstanceCount;
+};
+layout(std430, set = 0, binding = 7) readonly buffer ClusterInstances {
+  uint clusterInstances[];
+};
+layout(std430, set = 0, binding = 8) readonly buffer Meshlets {
+  GpuMeshlet meshlets[];
+};
+layout(std430, set = 0, binding = 9) writeonly buffer ClusterDraws {
+  DrawIndexedIndirectCommand clusterDraws[];
+};
+
+// Relative difference of the axis scales up to which the normal cones still hold
+#define MAX_CONE_SCALE_SKEW 1e-3
+
+// A workgroup per instance that Cull.comp found visible, its threads walk the meshlets of the mesh.
+// The instance count is only known on the GPU, so the groups stride over the list. Surviving
+// meshlets become draws of one instance whose first instance is the instance slot itself.
+void main() {
+  uint instanceCount = clusterInstanceCount;
+  for (uint i = gl_WorkGroupID.x; i < instanceCount; i += gl_NumWorkGroups.x) {
+    uint instanceIndex = clusterInstances[i];
+    mat4 transform     = instances[instanceIndex].Transform;
+    GpuMesh mesh       = meshes[instances[instanceIndex].MeshIndex];
+
+    mat3 axes      = mat3(transform);
+    vec3 scales    = vec3(length(axes[0]), length(axes[1]), length(axes[2]));
+    float maxScale = max(scales.x, max(scales.y, scales.z));
+    float minScale = min(scales.x, min(scales.y, scales.z));
+
+    // Cones are only valid under uniform scaling and need the camera position
+    bool isConeCulling = cullConstants.LodCamera.w > 0.0
+                      && maxScale - minScale <= maxScale * MAX_CONE_SCALE_SKEW;
+
+    for (uint m = gl_LocalInvocationID.x; m < mesh.MeshletCount; m += CULL_GROUP_SIZE) {
+      GpuMeshlet meshlet = meshlets[mesh.FirstMeshlet + m];
+      vec3 center        = (transform * vec4(meshlet.BoundingSphere.xyz, 1.0)).xyz;
+      float radius       = meshlet.BoundingSphere.w * maxScale;
+
+      bool isVisible = true;
+      for (int p = 0; p < 6 && isVisible; ++p) {
+        vec4 plane = cullConstants.FrustumPlanes[p];
+        isVisible  = dot(plane.xyz, center) + plane.w >= -radius;
+      }
+      // A cutoff of 1 marks normals too spread out for a cone
+      if (isVisible && isConeCulling && meshlet.Cone.w < 1.0) {
+        vec3 axis = normalize(axes * meshlet.Cone.xyz);
+        vec3 view = center - cullConstants.LodCamera.xyz;
+        isVisible = dot(view, axis) < meshlet.Cone.w * length(view) + radius;
+      }
+      if (!isVisible) {
+        continue;
+      }
+
+      uint drawIndex = atomicAdd(clusterDrawCount, 1);
+      if (drawIndex < clusterDrawCapacity) {
+        clusterDraws[drawIndex] = DrawIndexedIndirectCommand(
+            meshlet.IndexCount, 1, mesh.FirstIndex + meshlet.FirstIndex, mesh.VertexOffset,
+            instanceIndex
+        );
+      }
+    }
+  }
+}
\ No newline at end of file
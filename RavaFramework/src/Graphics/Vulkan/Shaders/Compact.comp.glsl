@@ -0,0 +1,43 @@
+#version 460
+#pragma shader_stage(compute)
+#extension GL_GOOGLE_include_directive : require
+
+#include "GpuScene.inc"
+#include "CullConstants.inc"
+
+layout(local_size_x = CULL_GROUP_SIZE) in;
+
+layout(std430, set = 0, binding = 0) readonly buffer Meshes {
+  GpuMesh meshes[];
+};
+layout(std430, set = 0, binding = 3) readonly buffer MeshCounters {
+  uint meshCounters[];
+};
+layout(std430, set = 0, binding = 4) writeonly buffer DrawCommands {
+  DrawIndexedIndirectCommand drawCommands[];
+};
+layout(std430, set = 0, binding = 5) buffer DrawCount {
+  uint drawCount;
+};
+
+// One thread per mesh turns the culled instance counts into draw commands
+void main() {
+  uint meshIndex = gl_GlobalInvocationID.x;
+  if (meshIndex >= cullConstants.MeshCount) {
+    return;
+  }
+
+  uint instanceCount = meshCounters[meshIndex];
+  uint drawIndex     = meshIndex;
+  if ((cullConstants.Flags & CULL_COMPACT) != 0) {
+    if (instanceCount == 0) {
+      return;
+    }
+    drawIndex = atomicAdd(drawCount, 1);
+  }
+
+  GpuMesh mesh            = meshes[meshIndex];
+  drawCommands[drawIndex] = DrawIndexedIndirectCommand(
+      mesh.IndexCount, instanceCount, mesh.FirstIndex, mesh.VertexOffset, mesh.InstanceOffset
+  );
+}
\ No newline at end of file
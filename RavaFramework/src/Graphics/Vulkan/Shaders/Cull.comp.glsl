@@ -0,0 +1,86 @@
+#version 460
+#pragma shader_stage(compute)
+#extension GL_GOOGLE_include_directive : require
+
+#include "GpuScene.inc"
+#include "CullConstants.inc"
+
+layout(local_size_x = CULL_GROUP_SIZE) in;
+
+layout(std430, set = 0, binding = 0) readonly buffer Meshes {
+  GpuMesh meshes[];
+};
+layout(std430, set = 0, binding = 1) readonly buffer Instances {
+  GpuInstance instances[];
+};
+layout(std430, set = 0, binding = 2) writeonly buffer VisibleInstances {
+  uint visibleInstances[];
+};
+layout(std430, set = 0, binding = 3) buffer MeshCounters {
+  uint meshCounters[];
+};
+layout(std430, set = 0, binding = 6) buffer ClusterCounts {
+  uint clusterDrawCount;
+  uint clusterDrawCapacity;
+  uint clusterInstanceCount;
+};
+layout(std430, set = 0, binding = 7) writeonly buffer ClusterInstances {
+  uint clusterInstances[];
+};
+
+// The coarsest level whose error covers less than LodThreshold pixels at the point of the bounding
+// sphere closest to the camera, same as Rava::ComputeLodPixelScale and Rava::SelectLod
+uint SelectLod(uint meshIndex, vec3 center, float radius, float scale) {
+  uint lodCount = meshes[meshIndex].LodCount;
+  if (lodCount == 0 || cullConstants.LodThreshold <= 0.0) {
+    return meshIndex;
+  }
+
+  float distance   = max(length(center - cullConstants.LodCamera.xyz) - radius, MIN_LOD_DISTANCE);
+  float pixelScale = scale * cullConstants.LodCamera.w / distance;
+  for (uint level = lodCount; level > 0; --level) {
+    if (meshes[meshIndex + level].LodError * pixelScale < cullConstants.LodThreshold) {
+      return meshIndex + level;
+    }
+  }
+  return meshIndex;
+}
+
+// Bounding sphere against the frustum, survivors claim a slot in the range of their mesh or the
+// level of it that is drawn. Full meshes made of meshlets are handed to ClusterCull.comp instead.
+void main() {
+  uint instanceIndex = gl_GlobalInvocationID.x;
+  if (instanceIndex >= cullConstants.InstanceCount) {
+    return;
+  }
+
+  uint meshIndex = instances[instanceIndex].MeshIndex;
+  if (meshIndex == INVALID_MESH) {
+    return;
+  }
+
+  // The largest axis scale keeps the sphere conservative under non uniform scaling
+  mat4 transform = instances[instanceIndex].Transform;
+  mat3 axes      = mat3(transform);
+  vec3 scales    = vec3(length(axes[0]), length(axes[1]), length(axes[2]));
+  vec4 sphere    = meshes[meshIndex].BoundingSphere;
+  vec3 center    = (transform * vec4(sphere.xyz, 1.0)).xyz;
+  float scale    = max(scales.x, max(scales.y, scales.z));
+  float radius   = sphere.w * scale;
+
+  for (int i = 0; i < 6; ++i) {
+    vec4 plane = cullConstants.FrustumPlanes[i];
+    if (dot(plane.xyz, center) + plane.w < -radius) {
+      return;
+    }
+  }
+
+  meshIndex = SelectLod(meshIndex, center, radius, scale);
+  if ((cullConstants.Flags & CULL_CLUSTERS) != 0 && meshes[meshIndex].MeshletCount > 0) {
+    clusterInstances[atomicAdd(clusterInstanceCount, 1)] = instanceIndex;
+    return;
+  }
+
+  uint slot = atomicAdd(meshCounters[meshIndex], 1);
+  visibleInstances[meshes[meshIndex].InstanceOffset + slot] = instanceIndex;
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#version 460
+#pragma shader_stage(fragment)
+
+layout(location = 0) in vec4 inColor;
+layout(location = 1) in vec3 inNormal;
+
+layout(location = 0) out vec4 outColor;
+
+const vec3 LIGHT_DIRECTION = normalize(vec3(0.4, 1.0, 0.6));
+const float AMBIENT        = 0.2;
+
+void main() {
+  float diffuse = max(dot(normalize(inNormal), LIGHT_DIRECTION), 0.0);
+  outColor      = vec4(inColor.rgb * (AMBIENT + diffuse * (1.0 - AMBIENT)), inColor.a);
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#version 460
+#pragma shader_stage(vertex)
+#extension GL_GOOGLE_include_directive : require
+
+#include "GpuScene.inc"
+
+// VertexFormat::Packed: unorm16 positions inside the mesh bounds and octahedral snorm16 normals
+layout(constant_id = 0) const bool IS_PACKED = false;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inUV;
+
+layout(location = 0) out vec4 outColor;
+layout(location = 1) out vec3 outNormal;
+
+layout(std430, set = 0, binding = 0) readonly buffer Meshes {
+  GpuMesh meshes[];
+};
+layout(std430, set = 0, binding = 1) readonly buffer Instances {
+  GpuInstance instances[];
+};
+layout(std430, set = 0, binding = 2) readonly buffer VisibleInstances {
+  uint visibleInstances[];
+};
+
+layout(push_constant) uniform DrawConstants {
+  mat4 ViewProjection;
+  uint IsIndirect;  // gl_InstanceIndex points into the visible list instead of the instances
+}
+drawConstants;
+
+vec3 DecodeOctahedral(vec2 encoded) {
+  vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+  float fold  = max(-normal.z, 0.0);
+  normal.x += normal.x >= 0.0 ? -fold : fold;
+  normal.y += normal.y >= 0.0 ? -fold : fold;
+  return normalize(normal);
+}
+
+void main() {
+  uint instanceIndex = gl_InstanceIndex;
+  if (drawConstants.IsIndirect != 0) {
+    instanceIndex = visibleInstances[instanceIndex];
+  }
+
+  GpuInstance instance = instances[instanceIndex];
+  vec3 position        = inPosition;
+  vec3 normal          = inNormal;
+  if (IS_PACKED) {
+    GpuMesh mesh = meshes[instance.MeshIndex];
+    position     = mesh.PositionOffset.xyz + inPosition * mesh.PositionScale.xyz;
+    normal       = DecodeOctahedral(inNormal.xy);
+  }
+
+  gl_Position = drawConstants.ViewProjection * instance.Transform * vec4(position, 1.0);
+  outColor    = inColor * instance.Color;
+  outNormal   = mat3(instance.Transform) * normal;
+}
\ No newline at end of file
@@ -0,0 +1,596 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Vulkan/VKAllocator.h"
+
+#include "Graphics/Vulkan/VKValidation.h"
+
+namespace VK {
+//////////////////////////////////////////////////////////////////////////
+// TLSF sub-allocation inside a single VkDeviceMemory block
+//////////////////////////////////////////////////////////////////////////
+static constexpr u32 NIL_NODE          = ~0u;
+static constexpr u32 SL_INDEX_LOG2     = 5;
+static constexpr u32 SL_INDEX_COUNT    = 1u << SL_INDEX_LOG2;
+static constexpr u32 MIN_ALIGNMENT_LOG = 4;
+static constexpr u64 MIN_ALIGNMENT     = 1ull << MIN_ALIGNMENT_LOG;
+static constexpr u32 FL_INDEX_SHIFT    = SL_INDEX_LOG2 + MIN_ALIGNMENT_LOG;
+static constexpr u64 SMALL_BLOCK_SIZE  = 1ull << FL_INDEX_SHIFT;
+static constexpr u32 FL_INDEX_MAX      = 40;  // 1 TiB
+static constexpr u32 FL_INDEX_COUNT    = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+
+static inline u64 AlignUp(u64 value, u64 alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static inline u32 HighestBit(u64 value) {
+  return static_cast<u32>(std::bit_width(value) - 1);
+}
+
+struct MemoryBlock {
+  struct Node {
+    u64 Offset      = 0;
+    u64 Size        = 0;
+    u32 PrevPhysics = NIL_NODE;
+    u32 NextPhysics = NIL_NODE;
+    u32 PrevFree    = NIL_NODE;
+    u32 NextFree    = NIL_NODE;
+    bool IsFree     = false;
+  };
+
+  VkDeviceMemory Memory = VK_NULL_HANDLE;
+  VkDeviceSize Size     = 0;
+  VkDeviceSize Used     = 0;
+  u8* Mapped            = nullptr;
+  u32 AllocationCount   = 0;
+
+  std::vector<Node> Nodes;
+  std::vector<u32> UnusedNodes;
+  u32 FLBitmap = 0;
+  std::array<u32, FL_INDEX_COUNT> SLBitmap{};
+  std::array<std::array<u32, SL_INDEX_COUNT>, FL_INDEX_COUNT> FreeHeads;
+
+  MemoryBlock(VkDeviceMemory memory, VkDeviceSize size, void* mapped)
+      : Memory(memory), Size(size), Mapped(static_cast<u8*>(mapped)) {
+    for (auto& heads : FreeHeads) {
+      heads.fill(NIL_NODE);
+    }
+    u32 root           = NewNode();
+    Nodes[root].Offset = 0;
+    Nodes[root].Size   = size;
+    InsertFree(root);
+  }
+
+  inline bool IsEmpty() const { return AllocationCount == 0; }
+
+  static void MappingInsert(u64 size, u32& fl, u32& sl) {
+    if (size < SMALL_BLOCK_SIZE) {
+      fl = 0;
+      sl = static_cast<u32>(size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT));
+    } else {
+      u32 highest = HighestBit(size);
+      sl          = static_cast<u32>(size >> (highest - SL_INDEX_LOG2)) ^ SL_INDEX_COUNT;
+      fl          = highest - FL_INDEX_SHIFT + 1;
+    }
+  }
+
+  static void MappingSearch(u64 size, u32& fl, u32& sl) {
+    // Round up to the next list so any block found there is large enough
+    if (size >= SMALL_BLOCK_SIZE) {
+      size += (1ull << (HighestBit(size) - SL_INDEX_LOG2)) - 1;
+    }
+    MappingInsert(size, fl, sl);
+  }
+
+  u32 NewNode() {
+    if (!UnusedNodes.empty()) {
+      u32 index = UnusedNodes.back();
+      UnusedNodes.pop_back();
+      Nodes[index] = Node{};
+      return index;
+    }
+    Nodes.emplace_back();
+    return static_cast<u32>(Nodes.size() - 1);
+  }
+
+  void ReleaseNode(u32 index) { UnusedNodes.push_back(index); }
+
+  void InsertFree(u32 index) {
+    u32 fl, sl;
+    MappingInsert(Nodes[index].Size, fl, sl);
+
+    Node& node    = Nodes[index];
+    node.IsFree   = true;
+    node.PrevFree = NIL_NODE;
+    node.NextFree = FreeHeads[fl][sl];
+    if (node.NextFree != NIL_NODE) {
+      Nodes[node.NextFree].PrevFree = index;
+    }
+    FreeHeads[fl][sl] = index;
+    FLBitmap |= 1u << fl;
+    SLBitmap[fl] |= 1u << sl;
+  }
+
+  void RemoveFree(u32 index) {
+    u32 fl, sl;
+    MappingInsert(Nodes[index].Size, fl, sl);
+
+    Node& node = Nodes[index];
+    if (node.PrevFree != NIL_NODE) {
+      Nodes[node.PrevFree].NextFree = node.NextFree;
+    } else {
+      FreeHeads[fl][sl] = node.NextFree;
+      if (FreeHeads[fl][sl] == NIL_NODE) {
+        SLBitmap[fl] &= ~(1u << sl);
+        if (SLBitmap[fl] == 0) {
+          FLBitmap &= ~(1u << fl);
+        }
+      }
+    }
+    if (node.NextFree != NIL_NODE) {
+      Nodes[node.NextFree].PrevFree = node.PrevFree;
+    }
+    node.PrevFree = NIL_NODE;
+    node.NextFree = NIL_NODE;
+    node.IsFree   = false;
+  }
+
+  u32 FindFree(u64 size) const {
+    u32 fl, sl;
+    MappingSearch(size, fl, sl);
+    if (fl >= FL_INDEX_COUNT) {
+      return NIL_NODE;
+    }
+
+    u32 slMap = SLBitmap[fl] & (~0u << sl);
+    if (slMap == 0) {
+      u32 flMap = fl + 1 < 32 ? FLBitmap & (~0u << (fl + 1)) : 0;
+      if (flMap == 0) {
+        return NIL_NODE;
+      }
+      fl    = static_cast<u32>(std::countr_zero(flMap));
+      slMap = SLBitmap[fl];
+    }
+    sl = static_cast<u32>(std::countr_zero(slMap));
+    return FreeHeads[fl][sl];
+  }
+
+  // Splits the node so that it keeps exactly `size` bytes and returns the remainder as free
+  void SplitTail(u32 index, u64 size) {
+    if (Nodes[index].Size - size < MIN_ALIGNMENT) {
+      return;
+    }
+
+    u32 tail                = NewNode();
+    Node& node              = Nodes[index];
+    Nodes[tail].Offset      = node.Offset + size;
+    Nodes[tail].Size        = node.Size - size;
+    Nodes[tail].PrevPhysics = index;
+    Nodes[tail].NextPhysics = node.NextPhysics;
+    if (node.NextPhysics != NIL_NODE) {
+      Nodes[node.NextPhysics].PrevPhysics = tail;
+    }
+    node.NextPhysics = tail;
+    node.Size        = size;
+    InsertFree(tail);
+  }
+
+  bool Allocate(u64 size, u64 alignment, u32& nodeIndex, u64& offset) {
+    size      = AlignUp(size, MIN_ALIGNMENT);
+    alignment = std::max(alignment, MIN_ALIGNMENT);
+
+    // Every offset is a multiple of MIN_ALIGNMENT, so this is the worst case padding
+    u32 index = FindFree(size + alignment - MIN_ALIGNMENT);
+    if (index == NIL_NODE) {
+      return false;
+    }
+    RemoveFree(index);
+
+    u64 padding = AlignUp(Nodes[index].Offset, alignment) - Nodes[index].Offset;
+    if (padding > 0) {
+      // The previous physical node is always in use (free neighbours are merged), so the
+      // padding becomes a free node of its own
+      u32 head                = NewNode();
+      Node& node              = Nodes[index];
+      Nodes[head].Offset      = node.Offset;
+      Nodes[head].Size        = padding;
+      Nodes[head].PrevPhysics = node.PrevPhysics;
+      Nodes[head].NextPhysics = index;
+      if (node.PrevPhysics != NIL_NODE) {
+        Nodes[node.PrevPhysics].NextPhysics = head;
+      }
+      node.PrevPhysics = head;
+      node.Offset += padding;
+      node.Size -= padding;
+      InsertFree(head);
+    }
+
+    SplitTail(index, size);
+
+    nodeIndex = index;
+    offset    = Nodes[index].Offset;
+    Used += Nodes[index].Size;
+    AllocationCount++;
+    return true;
+  }
+
+  void Free(u32 index) {
+    Used -= Nodes[index].Size;
+    AllocationCount--;
+
+    u32 prev = Nodes[index].PrevPhysics;
+    if (prev != NIL_NODE && Nodes[prev].IsFree) {
+      RemoveFree(prev);
+      Nodes[prev].Size += Nodes[index].Size;
+      Nodes[prev].NextPhysics = Nodes[index].NextPhysics;
+      if (Nodes[index].NextPhysics != NIL_NODE) {
+        Nodes[Nodes[index].NextPhysics].PrevPhysics = prev;
+      }
+      ReleaseNode(index);
+      index = prev;
+    }
+
+    u32 next = Nodes[index].NextPhysics;
+    if (next != NIL_NODE && Nodes[next].IsFree) {
+      RemoveFree(next);
+      Nodes[index].Size += Nodes[next].Size;
+      Nodes[index].NextPhysics = Nodes[next].NextPhysics;
+      if (Nodes[next].NextPhysics != NIL_NODE) {
+        Nodes[Nodes[next].NextPhysics].PrevPhysics = index;
+      }
+      ReleaseNode(next);
+    }
+
+    InsertFree(index);
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Allocator
+//////////////////////////////////////////////////////////////////////////
+Allocator::Allocator(VkPhysicalDevice physicalDevice, VkDevice device) : _device(device) {
+  vkGetPhysicalDeviceMemoryProperties(physicalDevice, &_memoryProperties);
+
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+  _nonCoherentAtomSize = properties.limits.nonCoherentAtomSize;
+  _maxAllocationCount  = properties.limits.maxMemoryAllocationCount;
+
+  // Small heaps (e.g. the 256 MiB host visible device local heap) get proportionally smaller
+  // blocks so a single block never takes the whole heap
+  for (u32 i = 0; i < _memoryProperties.memoryHeapCount; ++i) {
+    VkDeviceSize heapSize = _memoryProperties.memoryHeaps[i].size;
+    _blockSizes[i]        = std::min(MAX_BLOCK_SIZE, AlignUp(heapSize / 8, MIN_ALIGNMENT));
+  }
+
+  _pools.resize(_memoryProperties.memoryTypeCount * 2);
+  for (u32 i = 0; i < _memoryProperties.memoryTypeCount; ++i) {
+    _pools[i * 2].MemoryTypeIndex     = i;
+    _pools[i * 2].IsOptimal           = false;
+    _pools[i * 2 + 1].MemoryTypeIndex = i;
+    _pools[i * 2 + 1].IsOptimal       = true;
+  }
+}
+
+Allocator::~Allocator() {
+  for (auto& pool : _pools) {
+    for (auto& block : pool.Blocks) {
+      if (block == nullptr) {
+        continue;
+      }
+      if (!block->IsEmpty()) {
+        std::print("[WARNING]: Allocator: {} allocations leaked\n", block->AllocationCount);
+      }
+      FreeDeviceMemory(block->Memory, block->Mapped != nullptr);
+    }
+    pool.Blocks.clear();
+  }
+}
+
+bool Allocator::AllocateImageMemory(
+    VkImage image, VkMemoryPropertyFlags properties, Allocation& allocation
+) {
+  VkMemoryDedicatedRequirements dedicatedRequirements{};
+  dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+  VkMemoryRequirements2 requirements{};
+  requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+  requirements.pNext = &dedicatedRequirements;
+
+  VkImageMemoryRequirementsInfo2 requirementsInfo{};
+  requirementsInfo.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+  requirementsInfo.image = image;
+  vkGetImageMemoryRequirements2(_device, &requirementsInfo, &requirements);
+
+  bool prefersDedicated = dedicatedRequirements.prefersDedicatedAllocation
+                       || dedicatedRequirements.requiresDedicatedAllocation;
+  if (!Allocate(
+          requirements.memoryRequirements, prefersDedicated, properties, true, image,
+          VK_NULL_HANDLE, allocation
+      )) {
+    return false;
+  }
+
+  VkResult result = vkBindImageMemory(_device, image, allocation.Memory, allocation.Offset);
+  return IsResultValid(result, "Failed to Bind Image Memory!\n");
+}
+
+bool Allocator::AllocateBufferMemory(
+    VkBuffer buffer, VkMemoryPropertyFlags properties, Allocation& allocation
+) {
+  VkMemoryDedicatedRequirements dedicatedRequirements{};
+  dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+  VkMemoryRequirements2 requirements{};
+  requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+  requirements.pNext = &dedicatedRequirements;
+
+  VkBufferMemoryRequirementsInfo2 requirementsInfo{};
+  requirementsInfo.sType  = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+  requirementsInfo.buffer = buffer;
+  vkGetBufferMemoryRequirements2(_device, &requirementsInfo, &requirements);
+
+  bool prefersDedicated = dedicatedRequirements.prefersDedicatedAllocation
+                       || dedicatedRequirements.requiresDedicatedAllocation;
+  if (!Allocate(
+          requirements.memoryRequirements, prefersDedicated, properties, false, VK_NULL_HANDLE,
+          buffer, allocation
+      )) {
+    return false;
+  }
+
+  VkResult result = vkBindBufferMemory(_device, buffer, allocation.Memory, allocation.Offset);
+  return IsResultValid(result, "Failed to Bind Buffer Memory!\n");
+}
+
+bool Allocator::AllocateMemory(
+    const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties,
+    Allocation& allocation
+) {
+  return Allocate(
+      requirements, false, properties, true, VK_NULL_HANDLE, VK_NULL_HANDLE, allocation
+  );
+}
+
+bool Allocator::Allocate(
+    const VkMemoryRequirements& requirements, bool prefersDedicated,
+    VkMemoryPropertyFlags properties, bool isOptimal, VkImage dedicatedImage,
+    VkBuffer dedicatedBuffer, Allocation& allocation
+) {
+  u32 memoryTypeIndex = FindMemoryTypeIndex(requirements.memoryTypeBits, properties);
+  if (memoryTypeIndex == ~0u) {
+    std::print("[ERROR]: Allocator: no memory type matches the requested properties\n");
+    return false;
+  }
+
+  std::lock_guard lock(_mutex);
+
+  u32 heapIndex          = _memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+  VkDeviceSize blockSize = _blockSizes[heapIndex];
+
+  // Large resources get their own VkDeviceMemory instead of fragmenting a block
+  if (prefersDedicated || requirements.size > blockSize / 2) {
+    return AllocateDedicated(
+        requirements, memoryTypeIndex, dedicatedImage, dedicatedBuffer, allocation
+    );
+  }
+
+  VkDeviceSize alignment          = requirements.alignment;
+  VkMemoryPropertyFlags typeFlags = _memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+  if ((typeFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+      && !(typeFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+    // Keep flush ranges of neighbouring allocations from overlapping
+    alignment = std::max(alignment, _nonCoherentAtomSize);
+  }
+
+  u32 poolIndex = memoryTypeIndex * 2 + (isOptimal ? 1 : 0);
+  Pool& pool    = _pools[poolIndex];
+
+  u32 nodeIndex  = NIL_NODE;
+  u64 offset     = 0;
+  u32 blockIndex = NIL_NODE;
+  for (u32 i = 0; i < pool.Blocks.size(); ++i) {
+    auto& block = pool.Blocks[i];
+    if (block && block->Allocate(requirements.size, alignment, nodeIndex, offset)) {
+      blockIndex = i;
+      break;
+    }
+  }
+
+  if (blockIndex == NIL_NODE) {
+    void* mapped          = nullptr;
+    VkDeviceMemory memory = AllocateDeviceMemory(blockSize, memoryTypeIndex, nullptr, &mapped);
+    if (memory == VK_NULL_HANDLE) {
+      // The heap may not fit another full block, fall back to an exact sized allocation
+      return AllocateDedicated(
+          requirements, memoryTypeIndex, dedicatedImage, dedicatedBuffer, allocation
+      );
+    }
+
+    auto block = std::make_unique<MemoryBlock>(memory, blockSize, mapped);
+    auto slot  = std::find(pool.Blocks.begin(), pool.Blocks.end(), nullptr);
+    if (slot == pool.Blocks.end()) {
+      pool.Blocks.push_back(std::move(block));
+      blockIndex = static_cast<u32>(pool.Blocks.size() - 1);
+    } else {
+      *slot      = std::move(block);
+      blockIndex = static_cast<u32>(slot - pool.Blocks.begin());
+    }
+
+    if (!pool.Blocks[blockIndex]->Allocate(requirements.size, alignment, nodeIndex, offset)) {
+      return false;
+    }
+  }
+
+  MemoryBlock& block         = *pool.Blocks[blockIndex];
+  allocation.Memory          = block.Memory;
+  allocation.Offset          = offset;
+  allocation.Size            = requirements.size;
+  allocation.Mapped          = block.Mapped ? block.Mapped + offset : nullptr;
+  allocation.MemoryTypeIndex = memoryTypeIndex;
+  allocation.PoolIndex       = poolIndex;
+  allocation.BlockIndex      = blockIndex;
+  allocation.NodeIndex       = nodeIndex;
+  return true;
+}
+
+bool Allocator::AllocateDedicated(
+    const VkMemoryRequirements& requirements, u32 memoryTypeIndex, VkImage image,
+    VkBuffer buffer, Allocation& allocation
+) {
+  VkMemoryDedicatedAllocateInfo dedicatedInfo{};
+  dedicatedInfo.sType  = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+  dedicatedInfo.image  = image;
+  dedicatedInfo.buffer = buffer;
+
+  // Memory of AllocateMemory is only sized exactly, it belongs to no single resource
+  bool isDedicated      = image != VK_NULL_HANDLE || buffer != VK_NULL_HANDLE;
+  void* mapped          = nullptr;
+  VkDeviceMemory memory = AllocateDeviceMemory(
+      requirements.size, memoryTypeIndex, isDedicated ? &dedicatedInfo : nullptr, &mapped
+  );
+  if (memory == VK_NULL_HANDLE) {
+    return false;
+  }
+
+  _dedicatedCount++;
+  _dedicatedBytes += requirements.size;
+
+  allocation.Memory          = memory;
+  allocation.Offset          = 0;
+  allocation.Size            = requirements.size;
+  allocation.Mapped          = mapped;
+  allocation.MemoryTypeIndex = memoryTypeIndex;
+  allocation.PoolIndex       = ~0u;
+  allocation.BlockIndex      = ~0u;
+  allocation.NodeIndex       = ~0u;
+  return true;
+}
+
+void Allocator::Free(Allocation& allocation) {
+  if (!allocation.IsValid()) {
+    return;
+  }
+
+  std::lock_guard lock(_mutex);
+
+  if (allocation.IsDedicated()) {
+    FreeDeviceMemory(allocation.Memory, allocation.Mapped != nullptr);
+    _dedicatedCount--;
+    _dedicatedBytes -= allocation.Size;
+    allocation = {};
+    return;
+  }
+
+  Pool& pool                 = _pools[allocation.PoolIndex];
+  Unique<MemoryBlock>& block = pool.Blocks[allocation.BlockIndex];
+  block->Free(allocation.NodeIndex);
+
+  // Keep one empty block per pool around so alternating create / destroy does not thrash
+  if (block->IsEmpty()) {
+    bool hasOtherEmpty = std::any_of(pool.Blocks.begin(), pool.Blocks.end(), [&](auto& other) {
+      return other && other.get() != block.get() && other->IsEmpty();
+    });
+    if (hasOtherEmpty) {
+      FreeDeviceMemory(block->Memory, block->Mapped != nullptr);
+      block.reset();
+    }
+  }
+
+  allocation = {};
+}
+
+VkResult Allocator::Flush(
+    const Allocation& allocation, VkDeviceSize offset, VkDeviceSize size
+) const {
+  VkMemoryPropertyFlags typeFlags
+      = _memoryProperties.memoryTypes[allocation.MemoryTypeIndex].propertyFlags;
+  if (typeFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) {
+    return VK_SUCCESS;
+  }
+
+  if (size == VK_WHOLE_SIZE) {
+    size = allocation.Size - offset;
+  }
+
+  VkDeviceSize begin = (allocation.Offset + offset) & ~(_nonCoherentAtomSize - 1);
+  VkDeviceSize end   = AlignUp(allocation.Offset + offset + size, _nonCoherentAtomSize);
+
+  VkMappedMemoryRange range{};
+  range.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+  range.memory = allocation.Memory;
+  range.offset = begin;
+  range.size   = end - begin;
+  return vkFlushMappedMemoryRanges(_device, 1, &range);
+}
+
+AllocatorStats Allocator::GetStats() const {
+  std::lock_guard lock(_mutex);
+
+  AllocatorStats stats;
+  stats.DeviceMemoryCount = _deviceMemoryCount;
+  stats.DedicatedCount    = _dedicatedCount;
+  stats.DedicatedBytes    = _dedicatedBytes;
+  stats.AllocationCount   = _dedicatedCount;
+  stats.UsedBytes         = _dedicatedBytes;
+  for (const auto& pool : _pools) {
+    for (const auto& block : pool.Blocks) {
+      if (block == nullptr) {
+        continue;
+      }
+      stats.BlockCount++;
+      stats.BlockBytes += block->Size;
+      stats.UsedBytes += block->Used;
+      stats.AllocationCount += block->AllocationCount;
+    }
+  }
+  return stats;
+}
+
+VkDeviceMemory Allocator::AllocateDeviceMemory(
+    VkDeviceSize size, u32 memoryTypeIndex, const void* next, void** mapped
+) {
+  if (_deviceMemoryCount >= _maxAllocationCount) {
+    std::print("[ERROR]: Allocator: maxMemoryAllocationCount ({}) reached\n", _maxAllocationCount);
+    return VK_NULL_HANDLE;
+  }
+
+  VkMemoryAllocateInfo allocInfo{};
+  allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  allocInfo.pNext           = next;
+  allocInfo.allocationSize  = size;
+  allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  if (vkAllocateMemory(_device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+    return VK_NULL_HANDLE;
+  }
+  _deviceMemoryCount++;
+
+  VkMemoryPropertyFlags typeFlags = _memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+  if (typeFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+    if (vkMapMemory(_device, memory, 0, VK_WHOLE_SIZE, 0, mapped) != VK_SUCCESS) {
+      *mapped = nullptr;
+    }
+  }
+
+  return memory;
+}
+
+void Allocator::FreeDeviceMemory(VkDeviceMemory memory, bool isMapped) {
+  if (isMapped) {
+    vkUnmapMemory(_device, memory);
+  }
+  vkFreeMemory(_device, memory, nullptr);
+  _deviceMemoryCount--;
+}
+
+u32 Allocator::FindMemoryTypeIndex(u32 allowedTypes, VkMemoryPropertyFlags properties) const {
+  for (u32 i = 0; i < _memoryProperties.memoryTypeCount; ++i) {
+    if ((allowedTypes & (1 << i))
+        && (_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+      return i;
+    }
+  }
+  return ~0u;
+}
+}  // namespace VK
\ No newline at end of file
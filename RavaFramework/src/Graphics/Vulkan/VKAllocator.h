@@ -0,0 +1,95 @@
+#pragma once
+
+namespace VK {
+struct MemoryBlock;
+
+struct Allocation {
+  VkDeviceMemory Memory = VK_NULL_HANDLE;
+  VkDeviceSize Offset   = 0;
+  VkDeviceSize Size     = 0;
+  void* Mapped          = nullptr;  // persistently mapped when the memory type is host visible
+  u32 MemoryTypeIndex   = 0;
+  u32 PoolIndex         = ~0u;  // ~0u for dedicated allocations
+  u32 BlockIndex        = ~0u;
+  u32 NodeIndex         = ~0u;
+
+  inline bool IsValid() const { return Memory != VK_NULL_HANDLE; }
+  inline bool IsDedicated() const { return PoolIndex == ~0u; }
+};
+
+struct AllocatorStats {
+  u32 DeviceMemoryCount       = 0;  // vkAllocateMemory calls currently alive
+  u32 BlockCount              = 0;
+  u32 DedicatedCount          = 0;
+  u32 AllocationCount         = 0;
+  VkDeviceSize BlockBytes     = 0;
+  VkDeviceSize DedicatedBytes = 0;
+  VkDeviceSize UsedBytes      = 0;
+};
+
+// Sub-allocates images and buffers out of large VkDeviceMemory blocks, one pool per memory type
+// and resource kind. Linear resources (buffers) and optimal images never share a block, so
+// bufferImageGranularity can not cause aliasing between them.
+class Allocator {
+public:
+  Allocator(VkPhysicalDevice physicalDevice, VkDevice device);
+  ~Allocator();
+
+  NO_COPY(Allocator)
+  NO_MOVE(Allocator)
+
+  bool AllocateImageMemory(VkImage image, VkMemoryPropertyFlags properties, Allocation& allocation);
+  bool AllocateBufferMemory(
+      VkBuffer buffer, VkMemoryPropertyFlags properties, Allocation& allocation
+  );
+  // Nothing bound, for several images placed at offsets of it (the aliased transient images of
+  // the RenderGraph). Never dedicated to one resource.
+  bool AllocateMemory(
+      const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties,
+      Allocation& allocation
+  );
+  void Free(Allocation& allocation);
+
+  VkResult Flush(const Allocation& allocation, VkDeviceSize offset, VkDeviceSize size) const;
+
+  AllocatorStats GetStats() const;
+
+private:
+  static constexpr VkDeviceSize MAX_BLOCK_SIZE = 256ull * 1024 * 1024;
+
+  struct Pool {
+    u32 MemoryTypeIndex = 0;
+    bool IsOptimal      = false;
+    std::vector<Unique<MemoryBlock>> Blocks;
+  };
+
+  VkDevice _device = VK_NULL_HANDLE;
+  VkPhysicalDeviceMemoryProperties _memoryProperties;
+  VkDeviceSize _nonCoherentAtomSize = 1;
+  u32 _maxAllocationCount           = 0;
+
+  // Indexed by memoryTypeIndex * 2 + (isOptimal ? 1 : 0)
+  std::vector<Pool> _pools;
+  VkDeviceSize _blockSizes[VK_MAX_MEMORY_HEAPS];
+  u32 _deviceMemoryCount       = 0;
+  u32 _dedicatedCount          = 0;
+  VkDeviceSize _dedicatedBytes = 0;
+  mutable std::mutex _mutex;
+
+private:
+  bool Allocate(
+      const VkMemoryRequirements& requirements, bool prefersDedicated,
+      VkMemoryPropertyFlags properties, bool isOptimal, VkImage dedicatedImage,
+      VkBuffer dedicatedBuffer, Allocation& allocation
+  );
+  bool AllocateDedicated(
+      const VkMemoryRequirements& requirements, u32 memoryTypeIndex, VkImage image,
+      VkBuffer buffer, Allocation& allocation
+  );
+  VkDeviceMemory AllocateDeviceMemory(
+      VkDeviceSize size, u32 memoryTypeIndex, const void* next, void** mapped
+  );
+  void FreeDeviceMemory(VkDeviceMemory memory, bool isMapped);
+  u32 FindMemoryTypeIndex(u32 allowedTypes, VkMemoryPropertyFlags properties) const;
+};
+}  // namespace VK
\ No newline at end of file
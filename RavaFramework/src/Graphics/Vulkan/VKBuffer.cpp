@@ -0,0 +1,62 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Vulkan/VKBuffer.h"
+
+#include "Graphics/Vulkan/VKContext.h"
+#include "Graphics/Vulkan/VKDeletionQueue.h"
+
+namespace VK {
+Buffer::Buffer(
+    Shared<Context> context, VkDeviceSize instanceSize, u32 instanceCount,
+    VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memoryPropertyFlags,
+    VkDeviceSize minOffsetAlignment
+)
+    : _context(context),
+      _instanceCount(instanceCount),
+      _instanceSize(instanceSize),
+      _usageFlags(usageFlags),
+      _memoryPropertyFlags(memoryPropertyFlags) {
+  _alignmentSize = GetAlignment(instanceSize, minOffsetAlignment);
+  _bufferSize    = _alignmentSize * instanceCount;
+  _context->CreateBuffer(_bufferSize, usageFlags, memoryPropertyFlags, _buffer, _allocation);
+}
+
+// Frames in flight may still read the buffer
+Buffer::~Buffer() {
+  _context->GetDeletionQueue().DestroyBuffer(_buffer, _allocation);
+}
+
+void Buffer::WriteToBuffer(const void* data, VkDeviceSize size, VkDeviceSize offset) {
+  assert(_allocation.Mapped && "Cannot copy to unmapped buffer");
+
+  if (size == VK_WHOLE_SIZE) {
+    memcpy(_allocation.Mapped, data, _bufferSize);
+  } else {
+    u8* memOffset = static_cast<u8*>(_allocation.Mapped) + offset;
+    memcpy(memOffset, data, size);
+  }
+}
+
+VkResult Buffer::Flush(VkDeviceSize size, VkDeviceSize offset) {
+  return _context->GetAllocator().Flush(_allocation, offset, size);
+}
+
+VkDescriptorBufferInfo Buffer::DescriptorInfo(VkDeviceSize size, VkDeviceSize offset) {
+  return VkDescriptorBufferInfo{_buffer, offset, size};
+}
+
+void Buffer::WriteToIndex(const void* data, u32 index) {
+  WriteToBuffer(data, _instanceSize, index * _alignmentSize);
+}
+
+VkResult Buffer::FlushIndex(u32 index) {
+  return Flush(_alignmentSize, index * _alignmentSize);
+}
+
+VkDeviceSize Buffer::GetAlignment(VkDeviceSize instanceSize, VkDeviceSize minOffsetAlignment) {
+  if (minOffsetAlignment > 0) {
+    return (instanceSize + minOffsetAlignment - 1) & ~(minOffsetAlignment - 1);
+  }
+  return instanceSize;
+}
+}  // namespace VK
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Graphics/Vulkan/VKAllocator.h"
+
+namespace VK {
+class Context;
+class Buffer {
+public:
+  Buffer(
+      Shared<Context> context, VkDeviceSize instanceSize, u32 instanceCount,
+      VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memoryPropertyFlags,
+      VkDeviceSize minOffsetAlignment = 1
+  );
+  ~Buffer();
+
+  NO_COPY(Buffer)
+
+  void WriteToBuffer(const void* data, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+  VkResult Flush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+  VkDescriptorBufferInfo DescriptorInfo(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+
+  void WriteToIndex(const void* data, u32 index);
+  VkResult FlushIndex(u32 index);
+
+  inline VkBuffer GetBuffer() const { return _buffer; }
+  inline void* GetMappedMemory() const { return _allocation.Mapped; }
+  inline const Allocation& GetAllocation() const { return _allocation; }
+  inline u32 GetInstanceCount() const { return _instanceCount; }
+  inline VkDeviceSize GetInstanceSize() const { return _instanceSize; }
+  inline VkDeviceSize GetAlignmentSize() const { return _alignmentSize; }
+  inline VkBufferUsageFlags GetUsageFlags() const { return _usageFlags; }
+  inline VkMemoryPropertyFlags GetMemoryPropertyFlags() const { return _memoryPropertyFlags; }
+  inline VkDeviceSize GetBufferSize() const { return _bufferSize; }
+
+private:
+  Shared<Context> _context;
+  VkBuffer _buffer = VK_NULL_HANDLE;
+  Allocation _allocation;
+
+  VkDeviceSize _bufferSize;
+  u32 _instanceCount;
+  VkDeviceSize _instanceSize;
+  VkDeviceSize _alignmentSize;
+  VkBufferUsageFlags _usageFlags;
+  VkMemoryPropertyFlags _memoryPropertyFlags;
+
+private:
+  static VkDeviceSize GetAlignment(VkDeviceSize instanceSize, VkDeviceSize minOffsetAlignment);
+};
+}  // namespace VK
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Vulkan/VKCommandRecorder.h"
+
+#include "Core/CpuProfiler.h"
+#include "Core/FrameAllocator.h"
+#include "Core/JobSystem.h"
+#include "Graphics/Vulkan/VKContext.h"
+#include "Graphics/Vulkan/VKValidation.h"
+
+namespace VK {
+CommandRecorder::CommandRecorder(Shared<Context> context, u32 frameCount, bool isParallel)
+    : _context(context), _isParallel(isParallel) {
+  if (!_isParallel) {
+    return;
+  }
+
+  _threadCount = Rava::JobSystem::Instance->GetThreadCount();
+  _pools.resize(frameCount * _threadCount);
+
+  VkCommandPoolCreateInfo poolInfo = {};
+  poolInfo.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.flags                   = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+  poolInfo.queueFamilyIndex        = _context->GetPhysicalQueueFamilies().GraphicsFamily;
+  for (ThreadPool& pool : _pools) {
+    VkResult result = vkCreateCommandPool(
+        _context->GetLogicalDevice(), &poolInfo, nullptr, &pool.Pool
+    );
+    IsResultValid(result, "Failed to Create Recording Command Pool!\n");
+  }
+}
+
+// Destroying a pool frees its buffers
+CommandRecorder::~CommandRecorder() {
+  for (ThreadPool& pool : _pools) {
+    vkDestroyCommandPool(_context->GetLogicalDevice(), pool.Pool, nullptr);
+  }
+}
+
+void CommandRecorder::BeginFrame(u32 frameIndex) {
+  RV_PROFILE_FUNCTION();
+  _frameIndex = frameIndex;
+  if (!_isParallel) {
+    return;
+  }
+
+  for (u32 i = 0; i < _threadCount; ++i) {
+    ThreadPool& pool = _pools[frameIndex * _threadCount + i];
+    if (pool.UsedCount > 0) {
+      vkResetCommandPool(_context->GetLogicalDevice(), pool.Pool, 0);
+      pool.UsedCount = 0;
+    }
+  }
+}
+
+void CommandRecorder::BeginRenderPass(
+    VkCommandBuffer primary, const VkRenderPassBeginInfo& beginInfo,
+    VkQueryPipelineStatisticFlags statistics, SetupFunction setup
+) {
+  _primary            = primary;
+  _setup              = std::move(setup);
+  _isDynamicRendering = false;
+  _secondaries.emplace(Rava::FrameAllocator::GetResource());
+
+  if (!_isParallel) {
+    vkCmdBeginRenderPass(_primary, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    _setup(_primary);
+    return;
+  }
+
+  _inheritance                      = {};
+  _inheritance.sType                = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  _inheritance.renderPass           = beginInfo.renderPass;
+  _inheritance.subpass              = 0;
+  _inheritance.framebuffer          = beginInfo.framebuffer;
+  _inheritance.occlusionQueryEnable = VK_FALSE;
+  _inheritance.pipelineStatistics   = statistics;
+  vkCmdBeginRenderPass(_primary, &beginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+}
+
+void CommandRecorder::BeginRendering(
+    VkCommandBuffer primary, const VkRenderingInfo& renderingInfo,
+    const VkCommandBufferInheritanceRenderingInfo& inheritance,
+    VkQueryPipelineStatisticFlags statistics, SetupFunction setup
+) {
+  _primary            = primary;
+  _setup              = std::move(setup);
+  _isDynamicRendering = true;
+  _secondaries.emplace(Rava::FrameAllocator::GetResource());
+
+  if (!_isParallel) {
+    vkCmdBeginRendering(_primary, &renderingInfo);
+    _setup(_primary);
+    return;
+  }
+
+  _renderingInheritance             = inheritance;
+  _inheritance                      = {};
+  _inheritance.sType                = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  _inheritance.pNext                = &_renderingInheritance;
+  _inheritance.occlusionQueryEnable = VK_FALSE;
+  _inheritance.pipelineStatistics   = statistics;
+
+  VkRenderingInfo secondaryInfo = renderingInfo;
+  secondaryInfo.flags |= VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+  vkCmdBeginRendering(_primary, &secondaryInfo);
+}
+
+void CommandRecorder::EndRenderPass() {
+  RV_PROFILE_FUNCTION();
+  if (_isParallel) {
+    EndOpenSecondary();
+    if (!_secondaries->empty()) {
+      vkCmdExecuteCommands(_primary, static_cast<u32>(_secondaries->size()), _secondaries->data());
+    }
+    _secondaryCount = static_cast<u32>(_secondaries->size());
+  }
+  _secondaries.reset();
+
+  if (_isDynamicRendering) {
+    vkCmdEndRendering(_primary);
+  } else {
+    vkCmdEndRenderPass(_primary);
+  }
+  _primary = VK_NULL_HANDLE;
+}
+
+void CommandRecorder::RecordParallel(u32 count, u32 batchSize, const RecordFunction& record) {
+  RV_PROFILE_FUNCTION();
+  if (count == 0) {
+    return;
+  }
+
+  if (!_isParallel) {
+    for (u32 begin = 0; begin < count; begin += batchSize) {
+      record(_primary, begin, std::min(begin + batchSize, count));
+    }
+    return;
+  }
+
+  // Every batch owns a position in the execution order up front
+  EndOpenSecondary();
+  u32 batchCount   = (count + batchSize - 1) / batchSize;
+  size_t firstSlot = _secondaries->size();
+  _secondaries->resize(firstSlot + batchCount);
+
+  Rava::JobSystem::Instance->ParallelFor(batchCount, 1, [&](u32 firstBatch, u32 endBatch) {
+    for (u32 batch = firstBatch; batch < endBatch; ++batch) {
+      VkCommandBuffer commandBuffer = BeginSecondary();
+      u32 begin                     = batch * batchSize;
+      record(commandBuffer, begin, std::min(begin + batchSize, count));
+      vkEndCommandBuffer(commandBuffer);
+      (*_secondaries)[firstSlot + batch] = commandBuffer;
+    }
+  });
+}
+
+VkCommandBuffer CommandRecorder::GetCommandBuffer() {
+  if (!_isParallel) {
+    return _primary;
+  }
+
+  if (_openSecondary == VK_NULL_HANDLE) {
+    _openSecondary = BeginSecondary();
+    _secondaries->push_back(_openSecondary);
+  }
+  return _openSecondary;
+}
+
+VkCommandBuffer CommandRecorder::BeginSecondary() {
+  ThreadPool& pool = _pools[_frameIndex * _threadCount + Rava::JobSystem::GetWorkerIndex()];
+  if (pool.UsedCount == pool.Buffers.size()) {
+    VkCommandBufferAllocateInfo allocateInfo{};
+    allocateInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocateInfo.level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    allocateInfo.commandPool        = pool.Pool;
+    allocateInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkResult result
+        = vkAllocateCommandBuffers(_context->GetLogicalDevice(), &allocateInfo, &commandBuffer);
+    IsResultValid(result, "Failed to Allocate Secondary Command Buffer!\n");
+    pool.Buffers.push_back(commandBuffer);
+  }
+
+  VkCommandBuffer commandBuffer = pool.Buffers[pool.UsedCount++];
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+                  | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+  beginInfo.pInheritanceInfo = &_inheritance;
+  vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+  _setup(commandBuffer);
+  return commandBuffer;
+}
+
+void CommandRecorder::EndOpenSecondary() {
+  if (_openSecondary != VK_NULL_HANDLE) {
+    vkEndCommandBuffer(_openSecondary);
+    _openSecondary = VK_NULL_HANDLE;
+  }
+}
+}  // namespace VK
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+namespace VK {
+class Context;
+
+// Records the swap chain render pass on every job thread. Each frame slot has a command pool per
+// job thread (the main thread and the workers), reset as a whole when the slot comes around again
+// instead of buffer by buffer. RecordParallel splits a range into batches the job system records
+// into secondary command buffers, and EndRenderPass executes them in the order they were requested
+// whatever thread recorded them, so the submitted commands do not depend on the scheduling.
+// Secondary command buffers inherit no state: each one starts with the setup function of
+// BeginRenderPass (viewport, scissor and the geometry pool), the record function has to bind the
+// pipeline it draws with itself like GpuScene::BindDrawState does. InstanceBatcher::Flush and
+// Model::DrawInstanced bind none, so their pipeline has to come from the setup function.
+// Without parallel recording the render pass is recorded inline into the primary command buffer
+// and the batches run one after the other on the main thread.
+class CommandRecorder {
+public:
+  using SetupFunction  = std::function<void(VkCommandBuffer commandBuffer)>;
+  using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, u32 begin, u32 end)>;
+
+public:
+  CommandRecorder(Shared<Context> context, u32 frameCount, bool isParallel);
+  ~CommandRecorder();
+
+  NO_COPY(CommandRecorder)
+  NO_MOVE(CommandRecorder)
+
+  // Main thread, once the frame that last used frameIndex finished
+  void BeginFrame(u32 frameIndex);
+
+  // Main thread. statistics are those of the pipeline statistics query active in primary.
+  void BeginRenderPass(
+      VkCommandBuffer primary, const VkRenderPassBeginInfo& beginInfo,
+      VkQueryPipelineStatisticFlags statistics, SetupFunction setup
+  );
+  // Dynamic rendering, the secondary command buffers inherit the attachment formats instead of a
+  // render pass. EndRenderPass ends either.
+  void BeginRendering(
+      VkCommandBuffer primary, const VkRenderingInfo& renderingInfo,
+      const VkCommandBufferInheritanceRenderingInfo& inheritance,
+      VkQueryPipelineStatisticFlags statistics, SetupFunction setup
+  );
+  void EndRenderPass();
+
+  // Main thread, inside the render pass. Records [0, count) in batches of batchSize, after
+  // everything recorded so far. record runs on any job thread, once per batch.
+  void RecordParallel(u32 count, u32 batchSize, const RecordFunction& record);
+  // Main thread, inside the render pass. Where the main thread records in order with the batches.
+  VkCommandBuffer GetCommandBuffer();
+
+  inline bool IsParallel() const { return _isParallel; }
+  // Executed by the latest render pass
+  inline u32 GetSecondaryCount() const { return _secondaryCount; }
+
+private:
+  // Buffers are allocated once and reused after every reset of the pool
+  struct ThreadPool {
+    VkCommandPool Pool = VK_NULL_HANDLE;
+    std::vector<VkCommandBuffer> Buffers;
+    u32 UsedCount = 0;
+  };
+
+  Shared<Context> _context;
+  bool _isParallel = false;
+  u32 _threadCount = 0;
+  u32 _frameIndex  = 0;
+  std::vector<ThreadPool> _pools;  // frame slot major, JobSystem::GetWorkerIndex minor
+
+  VkCommandBuffer _primary = VK_NULL_HANDLE;
+  bool _isDynamicRendering = false;  // of the open render pass
+  VkCommandBufferInheritanceInfo _inheritance{};
+  VkCommandBufferInheritanceRenderingInfo _renderingInheritance{};
+  SetupFunction _setup;
+  // In execution order, in the frame allocator from BeginRenderPass to EndRenderPass
+  std::optional<std::pmr::vector<VkCommandBuffer>> _secondaries;
+  VkCommandBuffer _openSecondary = VK_NULL_HANDLE;  // of GetCommandBuffer, still recording
+  u32 _secondaryCount            = 0;
+
+private:
+  // On the calling job thread, begun with the setup recorded
+  VkCommandBuffer BeginSecondary();
+  void EndOpenSecondary();
+};
+}  // namespace VK
\ No newline at end of file
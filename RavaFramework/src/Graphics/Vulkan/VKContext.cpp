@@ -4,6 +4,10 @@
 
 #include "Core/Config.h"
 #include "Core/Window.h"
+#include "Graphics/Vulkan/VKAllocator.h"
+#include "Graphics/Vulkan/VKDeletionQueue.h"
+#include "Graphics/Vulkan/VKStagingRing.h"
+#include "Graphics/Vulkan/VKTimeline.h"
 #include "Graphics/Vulkan/VKUtils.h"
 #include "Graphics/Vulkan/VKValidation.h"
 
@@ -16,7 +20,34 @@ Context::Context() {
   CreateSurface();
   PickPhysicalDevice();
   CreateLogicalDevice();
+  CreateAllocator();
+  CreatePipelineCache();
   CreateCommandPool();
+  CreateSyncObjects();
+}
+
+Context::~Context() {
+  // Nothing is in flight afterwards, so the deferred deletions can all go
+  if (_device != VK_NULL_HANDLE) {
+    vkDeviceWaitIdle(_device);
+  }
+  _stagingRing.reset();
+  _deletionQueue.reset();
+  _frameTimeline.reset();
+
+  vkDestroyCommandPool(_device, _commandPool, nullptr);
+  vkDestroyPipelineCache(_device, _pipelineCache, nullptr);
+  // Every image and buffer must be destroyed before the blocks backing them are freed
+  _allocator.reset();
+  vkDestroyDevice(_device, nullptr);
+
+  if (ENABLE_VALIDATION) {
+    DestroyDebugUtilsMessengerEXT(_instance, _debugMessenger, nullptr);
+  }
+  if (_surface != VK_NULL_HANDLE) {
+    vkDestroySurfaceKHR(_instance, _surface, nullptr);
+  }
+  vkDestroyInstance(_instance, nullptr);
 }
 
 void Context::CreateInstance() {
@@ -76,6 +107,10 @@ void Context::SetupDebugMessenger() {
 }
 
 void Context::CreateSurface() {
+  if (Config::IsHeadless) {
+    return;
+  }
+
   VkResult result = glfwCreateWindowSurface(
       _instance, Rava::Window::Instance->GetGLFWWindow(), nullptr, &_surface
   );
@@ -111,10 +146,13 @@ void Context::PickPhysicalDevice() {
 
 void Context::CreateLogicalDevice() {
   QueueFamilyIndices queueFamilyIndices = FindQueueFamilies(_physicalDevice);
+  _queueFamilyIndices                   = queueFamilyIndices;
 
   std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-  std::set<int> uniqueQueueFamilies
-      = {queueFamilyIndices.GraphicsFamily, queueFamilyIndices.PresentFamily};
+  std::set<int> uniqueQueueFamilies = {
+      queueFamilyIndices.GraphicsFamily, queueFamilyIndices.PresentFamily,
+      queueFamilyIndices.TransferFamily
+  };
 
   float queuePriority = 1.0f;
   for (u32 queueFamily : uniqueQueueFamilies) {
@@ -126,22 +164,182 @@ void Context::CreateLogicalDevice() {
     queueCreateInfos.push_back(queueCreateInfo);
   }
 
+  // The 1.3 features can only be queried from a 1.3 device
+  bool isVulkan13 = _physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_3;
+  VkPhysicalDeviceVulkan13Features supportedFeatures13{};
+  supportedFeatures13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+  VkPhysicalDeviceVulkan12Features supportedFeatures12{};
+  supportedFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+  supportedFeatures12.pNext = isVulkan13 ? &supportedFeatures13 : nullptr;
+  VkPhysicalDeviceFeatures2 supportedFeatures2{};
+  supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  supportedFeatures2.pNext = &supportedFeatures12;
+  vkGetPhysicalDeviceFeatures2(_physicalDevice, &supportedFeatures2);
+  const VkPhysicalDeviceFeatures& supportedFeatures = supportedFeatures2.features;
+
   VkPhysicalDeviceFeatures deviceFeatures = {};
   deviceFeatures.samplerAnisotropy        = VK_TRUE;
+  deviceFeatures.pipelineStatisticsQuery  = supportedFeatures.pipelineStatisticsQuery;  // profiler
+  // Command recorder, secondary command buffers executed inside a profiler statistics scope
+  deviceFeatures.inheritedQueries = supportedFeatures.inheritedQueries;
+  // GPU scene
+  deviceFeatures.multiDrawIndirect         = supportedFeatures.multiDrawIndirect;
+  deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+
+  VkPhysicalDeviceVulkan12Features deviceFeatures12{};
+  deviceFeatures12.sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+  deviceFeatures12.drawIndirectCount = supportedFeatures12.drawIndirectCount;
+  deviceFeatures12.timelineSemaphore = VK_TRUE;  // frame sync, checked by IsDeviceSuitable
+
+  // Render graph, without it render passes and framebuffers are created for the attachments
+  VkPhysicalDeviceVulkan13Features deviceFeatures13{};
+  deviceFeatures13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+  deviceFeatures13.dynamicRendering
+      = Config::IsDynamicRenderingEnabled ? supportedFeatures13.dynamicRendering : VK_FALSE;
+  deviceFeatures12.pNext = isVulkan13 ? &deviceFeatures13 : nullptr;
+
+  auto deviceExtensions = GetRequiredDeviceExtensions();
 
   VkDeviceCreateInfo createInfo      = {};
   createInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+  createInfo.pNext                   = &deviceFeatures12;
   createInfo.queueCreateInfoCount    = static_cast<u32>(queueCreateInfos.size());
   createInfo.pQueueCreateInfos       = queueCreateInfos.data();
   createInfo.pEnabledFeatures        = &deviceFeatures;
-  createInfo.enabledExtensionCount   = static_cast<u32>(DEVICE_EXTENSIONS.size());
-  createInfo.ppEnabledExtensionNames = DEVICE_EXTENSIONS.data();
+  createInfo.enabledExtensionCount   = static_cast<u32>(deviceExtensions.size());
+  createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+
+  VkResult result    = vkCreateDevice(_physicalDevice, &createInfo, nullptr, &_device);
+  _initialized       = IsResultValid(result, "Failed to Create Logical Device!\n");
+  _enabledFeatures   = deviceFeatures;
+  _enabledFeatures12 = deviceFeatures12;
+  _enabledFeatures13 = deviceFeatures13;
 
-  VkResult result = vkCreateDevice(_physicalDevice, &createInfo, nullptr, &_device);
-  _initialized    = IsResultValid(result, "Failed to Create Logical Device!\n");
+  _enabledFeatures12.pNext = nullptr;
 
   vkGetDeviceQueue(_device, queueFamilyIndices.GraphicsFamily, 0, &_graphicsQueue);
   vkGetDeviceQueue(_device, queueFamilyIndices.PresentFamily, 0, &_presentQueue);
+  vkGetDeviceQueue(_device, queueFamilyIndices.TransferFamily, 0, &_transferQueue);
+
+  if (queueFamilyIndices.HasDedicatedTransfer()) {
+    std::print("Dedicated transfer queue family: {}\n", queueFamilyIndices.TransferFamily);
+  }
+}
+
+void Context::CreateAllocator() {
+  _allocator = std::make_unique<Allocator>(_physicalDevice, _device);
+}
+
+void Context::CreatePipelineCache() {
+  std::vector<u8> cacheData;
+  if (!Config::PipelineCachePath.empty()) {
+    std::ifstream file(std::filesystem::path(Config::PipelineCachePath), std::ios::binary);
+    if (file) {
+      cacheData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+  }
+
+  // Drivers are supposed to reject foreign data themselves, but not all of them do
+  if (!cacheData.empty() && !IsPipelineCacheCompatible(cacheData)) {
+    std::print("Pipeline cache {} is stale, starting cold\n", Config::PipelineCachePath);
+    cacheData.clear();
+  }
+
+  VkPipelineCacheCreateInfo createInfo{};
+  createInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  createInfo.initialDataSize = cacheData.size();
+  createInfo.pInitialData    = cacheData.empty() ? nullptr : cacheData.data();
+
+  VkResult result = vkCreatePipelineCache(_device, &createInfo, nullptr, &_pipelineCache);
+  if (result != VK_SUCCESS && !cacheData.empty()) {
+    createInfo.initialDataSize = 0;
+    createInfo.pInitialData    = nullptr;
+    result = vkCreatePipelineCache(_device, &createInfo, nullptr, &_pipelineCache);
+  }
+  _initialized = IsResultValid(result, "Failed to Create Pipeline Cache!\n");
+
+  if (!cacheData.empty()) {
+    std::print("Pipeline cache loaded: {} bytes\n", cacheData.size());
+  }
+}
+
+void Context::SavePipelineCache() {
+  if (_pipelineCache == VK_NULL_HANDLE || Config::PipelineCachePath.empty()) {
+    return;
+  }
+
+  size_t dataSize = 0;
+  if (vkGetPipelineCacheData(_device, _pipelineCache, &dataSize, nullptr) != VK_SUCCESS
+      || dataSize == 0) {
+    return;
+  }
+
+  std::vector<u8> cacheData(dataSize);
+  if (vkGetPipelineCacheData(_device, _pipelineCache, &dataSize, cacheData.data())
+      != VK_SUCCESS) {
+    std::print("Failed to Get Pipeline Cache Data!\n");
+    return;
+  }
+
+  // Write next to the target first so a crash mid write never leaves a truncated cache behind
+  std::filesystem::path path(Config::PipelineCachePath);
+  std::filesystem::path tempPath = path;
+  tempPath += ".tmp";
+  {
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      std::print("Failed to Write Pipeline Cache {}\n", tempPath.string());
+      return;
+    }
+    file.write(reinterpret_cast<const char*>(cacheData.data()), dataSize);
+  }
+
+  std::error_code error;
+  std::filesystem::rename(tempPath, path, error);
+  if (error) {
+    std::print("Failed to Write Pipeline Cache {}: {}\n", path.string(), error.message());
+  }
+}
+
+VkShaderModule Context::LoadShaderModule(std::string_view fileName) const {
+  std::filesystem::path path = std::filesystem::path(Config::ShaderDirectory) / fileName;
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    std::print("Failed to Open Shader {}\n", path.string());
+    return VK_NULL_HANDLE;
+  }
+
+  // SPIR-V is a stream of 32 bit words
+  std::vector<u32> code(static_cast<size_t>(file.tellg()) / sizeof(u32));
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(code.data()), code.size() * sizeof(u32));
+
+  VkShaderModuleCreateInfo createInfo{};
+  createInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+  createInfo.codeSize = code.size() * sizeof(u32);
+  createInfo.pCode    = code.data();
+
+  VkShaderModule shaderModule = VK_NULL_HANDLE;
+  VkResult result             = vkCreateShaderModule(_device, &createInfo, nullptr, &shaderModule);
+  if (!IsResultValid(result, "Failed to Create Shader Module!\n")) {
+    return VK_NULL_HANDLE;
+  }
+  return shaderModule;
+}
+
+bool Context::IsPipelineCacheCompatible(const std::vector<u8>& cacheData) const {
+  VkPipelineCacheHeaderVersionOne header;
+  if (cacheData.size() < sizeof(header)) {
+    return false;
+  }
+  memcpy(&header, cacheData.data(), sizeof(header));
+
+  return header.headerSize >= sizeof(header)
+      && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+      && header.vendorID == _physicalDeviceProperties.vendorID
+      && header.deviceID == _physicalDeviceProperties.deviceID
+      && memcmp(header.pipelineCacheUUID, _physicalDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE)
+             == 0;
 }
 
 void Context::CreateCommandPool() {
@@ -157,6 +355,14 @@ void Context::CreateCommandPool() {
   _initialized    = IsResultValid(result, "Failed to Create Command Pool!\n");
 }
 
+void Context::CreateSyncObjects() {
+  if (_initialized) {
+    _frameTimeline = std::make_unique<Timeline>(_device);
+    _deletionQueue = std::make_unique<DeletionQueue>(*this);
+    _stagingRing   = std::make_unique<StagingRing>(*this, Config::StagingRingSize);
+  }
+}
+
 bool Context::IsValidationLayerSupport() {
   u32 layerCount;
   vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
@@ -179,29 +385,104 @@ bool Context::IsValidationLayerSupport() {
 
 void Context::CreateImageWithInfo(
     const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image,
-    VkDeviceMemory& imageMemory
+    Allocation& imageAllocation
 ) {
   if (vkCreateImage(_device, &imageInfo, nullptr, &image) != VK_SUCCESS) {
     throw std::runtime_error("failed to create image!");
   }
 
-  VkMemoryRequirements memRequirements;
-  vkGetImageMemoryRequirements(_device, image, &memRequirements);
+  if (!_allocator->AllocateImageMemory(image, properties, imageAllocation)) {
+    throw std::runtime_error("failed to allocate image memory!");
+  }
+}
 
-  VkMemoryAllocateInfo allocInfo{};
-  allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize  = memRequirements.size;
-  allocInfo.memoryTypeIndex = FindMemoryTypeIndex(memRequirements.memoryTypeBits, properties);
+void Context::CreateBuffer(
+    VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+    VkBuffer& buffer, Allocation& bufferAllocation, bool isTransferShared
+) {
+  VkBufferCreateInfo bufferInfo{};
+  bufferInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferInfo.size        = size;
+  bufferInfo.usage       = usage;
+  bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+  u32 queueFamilies[] = {
+      static_cast<u32>(_queueFamilyIndices.GraphicsFamily),
+      static_cast<u32>(_queueFamilyIndices.TransferFamily),
+  };
+  if (isTransferShared && _queueFamilyIndices.HasDedicatedTransfer()) {
+    bufferInfo.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+    bufferInfo.queueFamilyIndexCount = 2;
+    bufferInfo.pQueueFamilyIndices   = queueFamilies;
+  }
 
-  if (vkAllocateMemory(_device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-    throw std::runtime_error("failed to allocate image memory!");
+  if (vkCreateBuffer(_device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+    throw std::runtime_error("failed to create buffer!");
   }
 
-  if (vkBindImageMemory(_device, image, imageMemory, 0) != VK_SUCCESS) {
-    throw std::runtime_error("failed to bind image memory!");
+  if (!_allocator->AllocateBufferMemory(buffer, properties, bufferAllocation)) {
+    throw std::runtime_error("failed to allocate buffer memory!");
   }
 }
 
+void Context::DestroyImage(VkImage& image, Allocation& imageAllocation) {
+  vkDestroyImage(_device, image, nullptr);
+  _allocator->Free(imageAllocation);
+  image = VK_NULL_HANDLE;
+}
+
+void Context::DestroyBuffer(VkBuffer& buffer, Allocation& bufferAllocation) {
+  vkDestroyBuffer(_device, buffer, nullptr);
+  _allocator->Free(bufferAllocation);
+  buffer = VK_NULL_HANDLE;
+}
+
+VkCommandBuffer Context::BeginSingleTimeCommands() {
+  VkCommandBufferAllocateInfo allocInfo{};
+  allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandPool        = _commandPool;
+  allocInfo.commandBufferCount = 1;
+
+  VkCommandBuffer commandBuffer;
+  vkAllocateCommandBuffers(_device, &allocInfo, &commandBuffer);
+
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+  vkBeginCommandBuffer(commandBuffer, &beginInfo);
+  return commandBuffer;
+}
+
+void Context::EndSingleTimeCommands(VkCommandBuffer commandBuffer) {
+  vkEndCommandBuffer(commandBuffer);
+
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers    = &commandBuffer;
+
+  vkQueueSubmit(_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+  vkQueueWaitIdle(_graphicsQueue);
+
+  vkFreeCommandBuffers(_device, _commandPool, 1, &commandBuffer);
+}
+
+void Context::CopyBuffer(
+    VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize dstOffset
+) {
+  VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+
+  VkBufferCopy copyRegion{};
+  copyRegion.srcOffset = 0;
+  copyRegion.dstOffset = dstOffset;
+  copyRegion.size      = size;
+  vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+
+  EndSingleTimeCommands(commandBuffer);
+}
+
 u32 Context::FindMemoryTypeIndex(u32 allowedTypes, VkMemoryPropertyFlags properties) const {
   // Get properties of physical device memory
   VkPhysicalDeviceMemoryProperties memoryProperties;
@@ -233,6 +514,15 @@ VkFormat Context::FindSupportedFormat(
 }
 
 std::vector<const char*> Context::GetRequiredExtensions() {
+  if (Config::IsHeadless) {
+    // GLFW is never initialized in headless mode, and no surface extensions are needed
+    std::vector<const char*> extensions;
+    if (ENABLE_VALIDATION) {
+      extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+    }
+    return extensions;
+  }
+
   u32 glfwExtensionCount = 0;
   const char** glfwExtensions;
 
@@ -247,6 +537,13 @@ std::vector<const char*> Context::GetRequiredExtensions() {
   return extensions;
 }
 
+std::vector<const char*> Context::GetRequiredDeviceExtensions() {
+  if (Config::IsHeadless) {
+    return {};
+  }
+  return DEVICE_EXTENSIONS;
+}
+
 void Context::CheckRequiredInstanceExtensions() {
   u32 extensionCount = 0;
   vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
@@ -275,17 +572,29 @@ bool Context::IsDeviceSuitable(VkPhysicalDevice device) {
 
   bool extensionsSupported = IsDeviceExtensionSupport(device);
 
-  bool swapChainAdequate = false;
-  if (extensionsSupported) {
+  bool swapChainAdequate = Config::IsHeadless;
+  if (extensionsSupported && !Config::IsHeadless) {
     SwapchainDetails swapChainDetails = GetSwapchainDetails(device);
     swapChainAdequate = !swapChainDetails.Formats.empty() && !swapChainDetails.PresentModes.empty();
   }
 
-  VkPhysicalDeviceFeatures supportedFeatures;
-  vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
+  // The frame sync waits on timeline semaphores, the 1.2 features can only be queried from a 1.2
+  // device
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(device, &properties);
+  if (properties.apiVersion < VK_API_VERSION_1_2) {
+    return false;
+  }
+
+  VkPhysicalDeviceVulkan12Features supportedFeatures12{};
+  supportedFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+  VkPhysicalDeviceFeatures2 supportedFeatures2{};
+  supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  supportedFeatures2.pNext = &supportedFeatures12;
+  vkGetPhysicalDeviceFeatures2(device, &supportedFeatures2);
 
   return indices.IsValid() && extensionsSupported && swapChainAdequate
-      && supportedFeatures.samplerAnisotropy;
+      && supportedFeatures2.features.samplerAnisotropy && supportedFeatures12.timelineSemaphore;
 }
 
 bool Context::IsDeviceExtensionSupport(VkPhysicalDevice device) {
@@ -293,7 +602,7 @@ bool Context::IsDeviceExtensionSupport(VkPhysicalDevice device) {
   vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
 
   if (extensionCount == 0) {
-    return false;
+    return GetRequiredDeviceExtensions().empty();
   }
 
   std::vector<VkExtensionProperties> availableExtensions(extensionCount);
@@ -301,7 +610,8 @@ bool Context::IsDeviceExtensionSupport(VkPhysicalDevice device) {
       device, nullptr, &extensionCount, availableExtensions.data()
   );
 
-  std::set<std::string_view> requiredExtensions(DEVICE_EXTENSIONS.begin(), DEVICE_EXTENSIONS.end());
+  auto deviceExtensions = GetRequiredDeviceExtensions();
+  std::set<std::string_view> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
   for (const auto& extension : availableExtensions) {
     requiredExtensions.erase(extension.extensionName);
   }
@@ -318,28 +628,61 @@ QueueFamilyIndices Context::FindQueueFamilies(VkPhysicalDevice device) {
   std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
   vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
 
-  int i = 0;
-  for (const auto& queueFamily : queueFamilies) {
-    if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+  int transferOnlyFamily = -1;
+  int nonGraphicsFamily  = -1;
+
+  // Scan every family: the transfer family is usually listed after graphics and present
+  for (int i = 0; i < static_cast<int>(queueFamilies.size()); ++i) {
+    const auto& queueFamily = queueFamilies[i];
+    if (queueFamily.queueCount == 0) {
+      continue;
+    }
+
+    if (indices.GraphicsFamily < 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
       indices.GraphicsFamily = i;
     }
 
-    VkBool32 presentSupport = false;
-    vkGetPhysicalDeviceSurfaceSupportKHR(device, i, _surface, &presentSupport);
-    if (queueFamily.queueCount > 0 && presentSupport) {
-      indices.PresentFamily = i;
+    if (_surface != VK_NULL_HANDLE) {
+      VkBool32 presentSupport = false;
+      vkGetPhysicalDeviceSurfaceSupportKHR(device, i, _surface, &presentSupport);
+      if (presentSupport && (indices.PresentFamily < 0 || i == indices.GraphicsFamily)) {
+        indices.PresentFamily = i;
+      }
     }
 
-    if (indices.IsValid()) {
-      break;
+    bool isTransfer = queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT;
+    bool isGraphics = queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT;
+    bool isCompute  = queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT;
+    if (isTransfer && !isGraphics && !isCompute && transferOnlyFamily < 0) {
+      transferOnlyFamily = i;
+    } else if (isTransfer && !isGraphics && nonGraphicsFamily < 0) {
+      nonGraphicsFamily = i;
     }
+  }
 
-    i++;
+  if (_surface == VK_NULL_HANDLE) {
+    // Headless: nothing is presented, so the graphics queue stands in for the present queue
+    indices.PresentFamily = indices.GraphicsFamily;
   }
 
+  indices.TransferFamily = transferOnlyFamily >= 0 ? transferOnlyFamily
+                         : nonGraphicsFamily >= 0  ? nonGraphicsFamily
+                                                   : indices.GraphicsFamily;
+
   return indices;
 }
 
+const SwapchainDetails& Context::GetSwapchainDetails() {
+  if (_swapchainDetails.Formats.empty()) {
+    _swapchainDetails = GetSwapchainDetails(_physicalDevice);
+  } else {
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(
+        _physicalDevice, _surface, &_swapchainDetails.SurfaceCapabilities
+    );
+  }
+  return _swapchainDetails;
+}
+
 SwapchainDetails Context::GetSwapchainDetails(VkPhysicalDevice device) {
   SwapchainDetails swapChainDetails;
   vkGetPhysicalDeviceSurfaceCapabilitiesKHR(
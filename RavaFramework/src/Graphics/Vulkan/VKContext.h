@@ -4,6 +4,12 @@
 // #include "Graphics/Vulkan/VKUtils.h"
 
 namespace VK {
+class Allocator;
+class DeletionQueue;
+class StagingRing;
+class Timeline;
+struct Allocation;
+
 struct SwapchainDetails {
   VkSurfaceCapabilitiesKHR SurfaceCapabilities;
   std::vector<VkSurfaceFormatKHR> Formats;
@@ -13,15 +19,18 @@ struct SwapchainDetails {
 struct QueueFamilyIndices {
   int GraphicsFamily = -1;
   int PresentFamily  = -1;
+  // Transfer only family (DMA engine) when the device has one, the graphics family otherwise
+  int TransferFamily = -1;
   // bool GraphicsFamilyHasValue = false;
   // bool PresentFamilyHasValue  = false;
   bool IsValid() const { return GraphicsFamily >= 0 && PresentFamily >= 0; }
+  bool HasDedicatedTransfer() const { return TransferFamily != GraphicsFamily; }
 };
 
 class Context /*: public Rava::Context*/ {
 public:
   Context();
-  virtual ~Context() /* override*/ { std::print("~Context"); }
+  virtual ~Context() /* override*/;
 
   NO_COPY(Context)
   NO_MOVE(Context)
@@ -33,27 +42,62 @@ public:
 
   void CreateImageWithInfo(
       const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image,
-      VkDeviceMemory& imageMemory
+      Allocation& imageAllocation
+  );
+  // A transfer shared buffer is concurrent between the graphics and the dedicated transfer family,
+  // so ranges of it can be uploaded without an ownership transfer of the whole buffer
+  void CreateBuffer(
+      VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+      VkBuffer& buffer, Allocation& bufferAllocation, bool isTransferShared = false
+  );
+  void DestroyImage(VkImage& image, Allocation& imageAllocation);
+  void DestroyBuffer(VkBuffer& buffer, Allocation& bufferAllocation);
+
+  VkCommandBuffer BeginSingleTimeCommands();
+  void EndSingleTimeCommands(VkCommandBuffer commandBuffer);
+  void CopyBuffer(
+      VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize dstOffset = 0
   );
 
   u32 FindMemoryTypeIndex(u32 allowedTypes, VkMemoryPropertyFlags properties) const;
+  void SavePipelineCache();
+  // SPIR-V file relative to Config::ShaderDirectory, VK_NULL_HANDLE when it can not be read
+  VkShaderModule LoadShaderModule(std::string_view fileName) const;
+
   VkFormat FindSupportedFormat(
       const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features
   );
 
+  inline Allocator& GetAllocator() const { return *_allocator; }
+  inline StagingRing& GetStagingRing() const { return *_stagingRing; }
+  inline DeletionQueue& GetDeletionQueue() const { return *_deletionQueue; }
+  // Signaled with the frame number by every frame submission, see Swapchain
+  inline Timeline& GetFrameTimeline() const { return *_frameTimeline; }
   inline VkCommandPool GetCommandPool() const { return _commandPool; }
+  inline VkPipelineCache GetPipelineCache() const { return _pipelineCache; }
   inline VkSurfaceKHR GetSurface() const { return _surface; }
   inline VkPhysicalDevice GetPhysicalDevice() const { return _physicalDevice; }
   inline VkDevice GetLogicalDevice() const { return _device; }
   inline VkQueue GetGraphicsQueue() const { return _graphicsQueue; }
   inline VkQueue GetPresentQueue() const { return _presentQueue; }
+  inline VkQueue GetTransferQueue() const { return _transferQueue; }
+  inline const QueueFamilyIndices& GetQueueFamilyIndices() const { return _queueFamilyIndices; }
   inline QueueFamilyIndices GetPhysicalQueueFamilies() { return FindQueueFamilies(_physicalDevice); }
-  inline SwapchainDetails GetSwapchainDetails() { return GetSwapchainDetails(_physicalDevice); }
+  // Formats and present modes are queried once, the capabilities (current extent) on every call
+  const SwapchainDetails& GetSwapchainDetails();
   inline const VkPhysicalDeviceProperties& GetPhysicalDeviceProperties() const {
     return _physicalDeviceProperties;
   }
+  inline const VkPhysicalDeviceFeatures& GetEnabledFeatures() const { return _enabledFeatures; }
+  inline const VkPhysicalDeviceVulkan12Features& GetEnabledFeatures12() const {
+    return _enabledFeatures12;
+  }
+  inline const VkPhysicalDeviceVulkan13Features& GetEnabledFeatures13() const {
+    return _enabledFeatures13;
+  }
 
   inline bool IsInitialized() const { return _initialized; }
+  inline bool IsHeadless() const { return _surface == VK_NULL_HANDLE; }
 
 private:
   VkInstance _instance                     = VK_NULL_HANDLE;
@@ -62,10 +106,20 @@ private:
   VkDevice _device                         = VK_NULL_HANDLE;
   VkQueue _graphicsQueue                   = VK_NULL_HANDLE;
   VkQueue _presentQueue                    = VK_NULL_HANDLE;
+  VkQueue _transferQueue                   = VK_NULL_HANDLE;
   VkCommandPool _commandPool               = VK_NULL_HANDLE;
+  VkPipelineCache _pipelineCache           = VK_NULL_HANDLE;
   VkDebugUtilsMessengerEXT _debugMessenger = VK_NULL_HANDLE;
   VkPhysicalDeviceProperties _physicalDeviceProperties;
-  //QueueFamilyIndices _queueFamilyIndices;
+  VkPhysicalDeviceFeatures _enabledFeatures{};
+  VkPhysicalDeviceVulkan12Features _enabledFeatures12{};  // pNext points at nothing
+  VkPhysicalDeviceVulkan13Features _enabledFeatures13{};  // all false below Vulkan 1.3
+  Unique<Allocator> _allocator;
+  Unique<StagingRing> _stagingRing;
+  Unique<Timeline> _frameTimeline;
+  Unique<DeletionQueue> _deletionQueue;
+  QueueFamilyIndices _queueFamilyIndices;
+  SwapchainDetails _swapchainDetails;
 
 private:
   bool _initialized = false;
@@ -75,13 +129,18 @@ private:
   void CreateSurface();
   void PickPhysicalDevice();
   void CreateLogicalDevice();
+  void CreateAllocator();
+  void CreatePipelineCache();
   void CreateCommandPool();
+  void CreateSyncObjects();
 
   // Validation
   bool IsValidationLayerSupport();
+  bool IsPipelineCacheCompatible(const std::vector<u8>& cacheData) const;
 
   // Helpers
   std::vector<const char*> GetRequiredExtensions();
+  std::vector<const char*> GetRequiredDeviceExtensions();
   void CheckRequiredInstanceExtensions();
   bool IsDeviceSuitable(VkPhysicalDevice device);
   bool IsDeviceExtensionSupport(VkPhysicalDevice device);
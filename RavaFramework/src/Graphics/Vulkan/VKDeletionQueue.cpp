@@ -0,0 +1,138 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Vulkan/VKDeletionQueue.h"
+
+#include "Core/CpuProfiler.h"
+#include "Graphics/Vulkan/VKContext.h"
+#include "Graphics/Vulkan/VKTimeline.h"
+
+namespace VK {
+DeletionQueue::DeletionQueue(Context& context) : _context(context) {}
+
+DeletionQueue::~DeletionQueue() {
+  for (Entry& entry : _entries) {
+    Release(entry);
+  }
+}
+
+void DeletionQueue::DestroyBuffer(VkBuffer& buffer, Allocation& allocation) {
+  Push(ResourceType::Buffer, buffer, &allocation);
+}
+
+void DeletionQueue::DestroyImage(VkImage& image, Allocation& allocation) {
+  Push(ResourceType::Image, image, &allocation);
+}
+
+void DeletionQueue::DestroyImageView(VkImageView& imageView) {
+  Push(ResourceType::ImageView, imageView);
+}
+
+void DeletionQueue::DestroyFramebuffer(VkFramebuffer& framebuffer) {
+  Push(ResourceType::Framebuffer, framebuffer);
+}
+
+void DeletionQueue::DestroyRenderPass(VkRenderPass& renderPass) {
+  Push(ResourceType::RenderPass, renderPass);
+}
+
+void DeletionQueue::DestroyPipeline(VkPipeline& pipeline) {
+  Push(ResourceType::Pipeline, pipeline);
+}
+
+void DeletionQueue::DestroySemaphore(VkSemaphore& semaphore) {
+  Push(ResourceType::Semaphore, semaphore);
+}
+
+void DeletionQueue::DestroySwapchain(VkSwapchainKHR& swapchain) {
+  Push(ResourceType::Swapchain, swapchain);
+}
+
+void DeletionQueue::Free(Allocation& allocation) {
+  if (!allocation.IsValid()) {
+    return;
+  }
+
+  std::lock_guard lock(_mutex);
+  Entry& entry = _entries.emplace_back();
+  entry.Frame  = _context.GetFrameTimeline().GetSubmittedValue() + 1;
+  entry.Type   = ResourceType::Memory;
+  entry.Memory = allocation;
+  allocation   = {};
+}
+
+void DeletionQueue::Update() {
+  RV_PROFILE_FUNCTION();
+  std::lock_guard lock(_mutex);
+  if (_entries.empty()) {
+    return;
+  }
+
+  u64 completedFrame = _context.GetFrameTimeline().GetCompletedValue();
+  size_t count       = 0;
+  while (count < _entries.size() && _entries[count].Frame <= completedFrame) {
+    Release(_entries[count++]);
+  }
+  _entries.erase(_entries.begin(), _entries.begin() + count);
+}
+
+u32 DeletionQueue::GetPendingCount() {
+  std::lock_guard lock(_mutex);
+  return static_cast<u32>(_entries.size());
+}
+
+template <typename Handle>
+void DeletionQueue::Push(ResourceType type, Handle& handle, Allocation* allocation) {
+  if (handle == VK_NULL_HANDLE) {
+    return;
+  }
+
+  std::lock_guard lock(_mutex);
+  Entry& entry = _entries.emplace_back();
+  entry.Frame  = _context.GetFrameTimeline().GetSubmittedValue() + 1;
+  entry.Type   = type;
+  entry.Handle = std::bit_cast<u64>(handle);
+  if (allocation != nullptr) {
+    entry.Memory = *allocation;
+    *allocation  = {};
+  }
+  handle = VK_NULL_HANDLE;
+}
+
+void DeletionQueue::Release(Entry& entry) {
+  VkDevice device = _context.GetLogicalDevice();
+  switch (entry.Type) {
+    case ResourceType::Buffer:
+      vkDestroyBuffer(device, std::bit_cast<VkBuffer>(entry.Handle), nullptr);
+      break;
+    case ResourceType::Image:
+      vkDestroyImage(device, std::bit_cast<VkImage>(entry.Handle), nullptr);
+      break;
+    case ResourceType::ImageView:
+      vkDestroyImageView(device, std::bit_cast<VkImageView>(entry.Handle), nullptr);
+      break;
+    case ResourceType::Framebuffer:
+      vkDestroyFramebuffer(device, std::bit_cast<VkFramebuffer>(entry.Handle), nullptr);
+      break;
+    case ResourceType::RenderPass:
+      vkDestroyRenderPass(device, std::bit_cast<VkRenderPass>(entry.Handle), nullptr);
+      break;
+    case ResourceType::Pipeline:
+      vkDestroyPipeline(device, std::bit_cast<VkPipeline>(entry.Handle), nullptr);
+      break;
+    case ResourceType::Semaphore:
+      vkDestroySemaphore(device, std::bit_cast<VkSemaphore>(entry.Handle), nullptr);
+      break;
+    case ResourceType::Swapchain:
+      vkDestroySwapchainKHR(device, std::bit_cast<VkSwapchainKHR>(entry.Handle), nullptr);
+      break;
+    case ResourceType::Memory:
+      break;
+  }
+
+  // The memory goes back after the handle bound to it
+  if (entry.Memory.IsValid()) {
+    _context.GetAllocator().Free(entry.Memory);
+  }
+  ++_releasedCount;
+}
+}  // namespace VK
\ No newline at end of file
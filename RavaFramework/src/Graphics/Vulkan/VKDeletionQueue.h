@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Graphics/Vulkan/VKAllocator.h"
+
+namespace VK {
+class Context;
+
+// Destroys handles once the GPU has finished the frame that last used them, instead of waiting
+// for the device to go idle. Everything queued while a frame is recorded (or between two frames)
+// is tagged with the number of that frame and released by Update once the frame timeline of the
+// context has reached it. Handles passed in are reset to VK_NULL_HANDLE, like Context::Destroy*.
+// Thread safe.
+class DeletionQueue {
+public:
+  DeletionQueue(Context& context);
+  // Releases everything, the device has to be idle
+  ~DeletionQueue();
+
+  NO_COPY(DeletionQueue)
+  NO_MOVE(DeletionQueue)
+
+  void DestroyBuffer(VkBuffer& buffer, Allocation& allocation);
+  void DestroyImage(VkImage& image, Allocation& allocation);
+  void DestroyImageView(VkImageView& imageView);
+  void DestroyFramebuffer(VkFramebuffer& framebuffer);
+  void DestroyRenderPass(VkRenderPass& renderPass);
+  void DestroyPipeline(VkPipeline& pipeline);
+  void DestroySemaphore(VkSemaphore& semaphore);
+  void DestroySwapchain(VkSwapchainKHR& swapchain);
+  void Free(Allocation& allocation);
+
+  // Main thread, once per frame. Releases what every finished frame left behind.
+  void Update();
+
+  u32 GetPendingCount();
+  inline u64 GetReleasedCount() const { return _releasedCount; }
+
+private:
+  enum class ResourceType : u8 {
+    Buffer,
+    Image,
+    ImageView,
+    Framebuffer,
+    RenderPass,
+    Pipeline,
+    Semaphore,
+    Swapchain,
+    Memory,
+  };
+
+  struct Entry {
+    u64 Frame         = 0;
+    ResourceType Type = ResourceType::Memory;
+    u64 Handle        = 0;  // any non-dispatchable handle
+    Allocation Memory;
+  };
+
+  Context& _context;
+  std::mutex _mutex;
+  std::vector<Entry> _entries;  // in queueing order, so frames never decrease
+  u64 _releasedCount = 0;
+
+private:
+  template <typename Handle>
+  void Push(ResourceType type, Handle& handle, Allocation* allocation = nullptr);
+  void Release(Entry& entry);
+};
+}  // namespace VK
\ No newline at end of file
@@ -0,0 +1,613 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Vulkan/VKGeometryPool.h"
+
+#include "Core/CpuProfiler.h"
+#include "Core/FrameAllocator.h"
+#include "Graphics/Model.h"
+#include "Graphics/VertexPacking.h"
+#include "Graphics/Vulkan/VKBuffer.h"
+#include "Graphics/Vulkan/VKContext.h"
+#include "Graphics/Vulkan/VKModel.h"
+#include "Graphics/Vulkan/VKStagingRing.h"
+#include "Graphics/Vulkan/VKUploader.h"
+
+namespace VK {
+static constexpr VkDeviceSize INDEX_SIZE                 = sizeof(u32);
+static constexpr VkDeviceSize QUANTIZATION_SIZE          = sizeof(Rava::VertexQuantization);
+static constexpr VkDeviceSize MAX_DEFRAG_BYTES_PER_FRAME = 16ull * 1024 * 1024;
+static constexpr f32 DEFRAG_FRAGMENTATION                = 0.5f;
+
+static void RecordBarrier(
+    VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask,
+    VkPipelineStageFlags dstStageMask, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask
+) {
+  VkMemoryBarrier barrier{};
+  barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  barrier.srcAccessMask = srcAccessMask;
+  barrier.dstAccessMask = dstAccessMask;
+  vkCmdPipelineBarrier(
+      commandBuffer, srcStageMask, dstStageMask, 0, 1, &barrier, 0, nullptr, 0, nullptr
+  );
+}
+
+RangeAllocator::RangeAllocator(u32 capacity) : _capacity(capacity), _freeSize(capacity) {
+  if (capacity > 0) {
+    _freeRanges.push_back({0, capacity});
+  }
+}
+
+u32 RangeAllocator::Allocate(u32 size) {
+  if (size == 0) {
+    return 0;
+  }
+
+  auto it = std::find_if(_freeRanges.begin(), _freeRanges.end(), [size](const Range& range) {
+    return range.Size >= size;
+  });
+  if (it == _freeRanges.end()) {
+    return INVALID_OFFSET;
+  }
+
+  u32 offset = it->Offset;
+  it->Offset += size;
+  it->Size -= size;
+  if (it->Size == 0) {
+    _freeRanges.erase(it);
+  }
+  _freeSize -= size;
+  return offset;
+}
+
+void RangeAllocator::Free(u32 offset, u32 size) {
+  if (size == 0) {
+    return;
+  }
+
+  auto next = std::lower_bound(
+      _freeRanges.begin(), _freeRanges.end(), offset,
+      [](const Range& range, u32 value) { return range.Offset < value; }
+  );
+  assert((next == _freeRanges.end() || offset + size <= next->Offset) && "Range freed twice");
+
+  bool isMergedWithPrevious = false;
+  if (next != _freeRanges.begin()) {
+    auto previous = std::prev(next);
+    assert(previous->Offset + previous->Size <= offset && "Range freed twice");
+    if (previous->Offset + previous->Size == offset) {
+      previous->Size += size;
+      isMergedWithPrevious = true;
+      if (next != _freeRanges.end() && offset + size == next->Offset) {
+        previous->Size += next->Size;
+        _freeRanges.erase(next);
+      }
+    }
+  }
+
+  if (!isMergedWithPrevious) {
+    if (next != _freeRanges.end() && offset + size == next->Offset) {
+      next->Offset = offset;
+      next->Size += size;
+    } else {
+      _freeRanges.insert(next, {offset, size});
+    }
+  }
+  _freeSize += size;
+}
+
+void RangeAllocator::Rebuild(std::span<const Range> usedRanges) {
+  _freeRanges.clear();
+  _freeSize  = 0;
+  u32 cursor = 0;
+  for (const Range& used : usedRanges) {
+    assert(used.Offset >= cursor && "Used ranges have to be sorted and disjoint");
+    if (used.Offset > cursor) {
+      _freeRanges.push_back({cursor, used.Offset - cursor});
+      _freeSize += used.Offset - cursor;
+    }
+    cursor = used.Offset + used.Size;
+  }
+
+  if (cursor < _capacity) {
+    _freeRanges.push_back({cursor, _capacity - cursor});
+    _freeSize += _capacity - cursor;
+  }
+}
+
+u32 RangeAllocator::GetLargestFreeRange() const {
+  u32 largest = 0;
+  for (const Range& range : _freeRanges) {
+    largest = std::max(largest, range.Size);
+  }
+  return largest;
+}
+
+f32 RangeAllocator::GetFragmentation() const {
+  if (_freeSize == 0) {
+    return 0.0f;
+  }
+  return 1.0f - static_cast<f32>(GetLargestFreeRange()) / static_cast<f32>(_freeSize);
+}
+
+GeometryPool::GeometryPool(
+    Shared<Context> context, u32 frameCount, VertexFormat format, u32 vertexCapacity,
+    u32 indexCapacity
+)
+    : _context(context),
+      _format(format),
+      _vertexStride(Vertex::GetStride(format)),
+      _vertexRanges(vertexCapacity),
+      _indexRanges(indexCapacity),
+      _quantizationRanges(format == VertexFormat::Packed ? QUANTIZATION_CAPACITY : 0),
+      _retiredHandles(frameCount),
+      _retiredRanges(frameCount) {
+  constexpr VkBufferUsageFlags copy
+      = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+  _isTransferShared = _context->GetQueueFamilyIndices().HasDedicatedTransfer();
+
+  _context->CreateBuffer(
+      vertexCapacity * _vertexStride, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | copy,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _vertexBuffer, _vertexAllocation, true
+  );
+  _context->CreateBuffer(
+      indexCapacity * INDEX_SIZE, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | copy,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _indexBuffer, _indexAllocation, true
+  );
+  if (_format == VertexFormat::Packed) {
+    _context->CreateBuffer(
+        QUANTIZATION_CAPACITY * QUANTIZATION_SIZE,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _quantizationBuffer, _quantizationAllocation, true
+    );
+  }
+}
+
+GeometryPool::~GeometryPool() {
+  _defragBuffer.reset();
+  if (_quantizationBuffer != VK_NULL_HANDLE) {
+    _context->DestroyBuffer(_quantizationBuffer, _quantizationAllocation);
+  }
+  _context->DestroyBuffer(_indexBuffer, _indexAllocation);
+  _context->DestroyBuffer(_vertexBuffer, _vertexAllocation);
+}
+
+u32 GeometryPool::Allocate(u32 vertexCount, u32 indexCount, u32 meshCount, bool isResident) {
+  if (_format == VertexFormat::Float) {
+    meshCount = 0;
+  }
+
+  std::lock_guard lock(_mutex);
+  u32 firstVertex = _vertexRanges.Allocate(vertexCount);
+  if (firstVertex == RangeAllocator::INVALID_OFFSET) {
+    return INVALID_HANDLE;
+  }
+
+  u32 firstIndex = _indexRanges.Allocate(indexCount);
+  if (firstIndex == RangeAllocator::INVALID_OFFSET) {
+    _vertexRanges.Free(firstVertex, vertexCount);
+    return INVALID_HANDLE;
+  }
+
+  u32 firstMesh = _quantizationRanges.Allocate(meshCount);
+  if (firstMesh == RangeAllocator::INVALID_OFFSET) {
+    _indexRanges.Free(firstIndex, indexCount);
+    _vertexRanges.Free(firstVertex, vertexCount);
+    return INVALID_HANDLE;
+  }
+
+  u32 handle = 0;
+  if (!_freeHandles.empty()) {
+    handle = _freeHandles.back();
+    _freeHandles.pop_back();
+  } else {
+    handle = static_cast<u32>(_entries.size());
+    _entries.emplace_back();
+  }
+
+  Entry& entry     = _entries[handle];
+  entry.Range      = {firstVertex, vertexCount, firstIndex, indexCount, firstMesh, meshCount};
+  entry.IsLive     = true;
+  entry.IsResident = isResident;
+  _pinnedCount += isResident ? 0 : 1;
+  ++_liveCount;
+  return handle;
+}
+
+void GeometryPool::MarkResident(u32 handle) {
+  std::lock_guard lock(_mutex);
+  Entry& entry = _entries[handle];
+  if (entry.IsLive && !entry.IsResident) {
+    entry.IsResident = true;
+    --_pinnedCount;
+  }
+}
+
+void GeometryPool::Free(u32 handle) {
+  std::lock_guard lock(_mutex);
+  Entry& entry = _entries[handle];
+  assert(entry.IsLive && "Geometry freed twice");
+  if (!entry.IsResident) {
+    --_pinnedCount;
+  }
+  entry.IsLive = false;
+  --_liveCount;
+  _retiredHandles[_frameIndex].push_back(handle);
+}
+
+GeometryAllocation GeometryPool::Get(u32 handle) const {
+  std::shared_lock lock(_mutex);
+  return _entries[handle].Range;
+}
+
+void GeometryPool::Release(u32 handle) {
+  Entry& entry = _entries[handle];
+  _vertexRanges.Free(entry.Range.FirstVertex, entry.Range.VertexCount);
+  _indexRanges.Free(entry.Range.FirstIndex, entry.Range.IndexCount);
+  _quantizationRanges.Free(entry.Range.FirstMesh, entry.Range.MeshCount);
+  entry.Range = {};
+  _freeHandles.push_back(handle);
+}
+
+void GeometryPool::ReleaseRetired(u32 frameIndex) {
+  for (u32 handle : _retiredHandles[frameIndex]) {
+    Release(handle);
+  }
+  _retiredHandles[frameIndex].clear();
+
+  for (const RetiredRange& retired : _retiredRanges[frameIndex]) {
+    retired.Allocator->Free(retired.Range.Offset, retired.Range.Size);
+  }
+  _retiredRanges[frameIndex].clear();
+}
+
+void GeometryPool::Upload(
+    u32 handle, std::span<const Rava::Vertex> vertices, std::span<const u32> indices,
+    std::span<const Rava::Mesh> meshes
+) {
+  RV_PROFILE_FUNCTION();
+  StagingRing& stagingRing = _context->GetStagingRing();
+  ForEachUpload(
+      handle, vertices, indices, meshes,
+      [&](const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset,
+          VkAccessFlags dstAccessMask) {
+        stagingRing.UploadBuffer(
+            dstBuffer, dstOffset, data, size, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, dstAccessMask
+        );
+      }
+  );
+}
+
+void GeometryPool::PrepareUpload(
+    u32 handle, std::span<const Rava::Vertex> vertices, std::span<const u32> indices,
+    std::span<const Rava::Mesh> meshes, std::vector<BufferUpload>& uploads
+) {
+  ForEachUpload(
+      handle, vertices, indices, meshes,
+      [&](const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset,
+          VkAccessFlags dstAccessMask) {
+        if (size == 0) {
+          return;
+        }
+
+        auto stagingBuffer = std::make_unique<Buffer>(
+            _context, 1, static_cast<u32>(size), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+        stagingBuffer->WriteToBuffer(data);
+
+        BufferUpload& upload    = uploads.emplace_back();
+        upload.StagingBuffer    = std::move(stagingBuffer);
+        upload.DstBuffer        = dstBuffer;
+        upload.DstOffset        = dstOffset;
+        upload.Size             = size;
+        upload.DstStageMask     = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+        upload.DstAccessMask    = dstAccessMask;
+        upload.IsTransferShared = _isTransferShared;
+      }
+  );
+}
+
+void GeometryPool::ForEachUpload(
+    u32 handle, std::span<const Rava::Vertex> vertices, std::span<const u32> indices,
+    std::span<const Rava::Mesh> meshes, const UploadFunction& addUpload
+) {
+  GeometryAllocation range = Get(handle);
+  assert(vertices.size() == range.VertexCount && indices.size() == range.IndexCount);
+
+  addUpload(
+      indices.data(), indices.size_bytes(), _indexBuffer, range.FirstIndex * INDEX_SIZE,
+      VK_ACCESS_INDEX_READ_BIT
+  );
+
+  if (_format == VertexFormat::Float) {
+    addUpload(
+        vertices.data(), vertices.size_bytes(), _vertexBuffer, range.FirstVertex * _vertexStride,
+        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT
+    );
+    return;
+  }
+
+  Rava::Mesh wholeRange{0, range.VertexCount, 0, range.IndexCount};
+  if (meshes.empty()) {
+    meshes = {&wholeRange, 1};
+  }
+  assert(meshes.size() == range.MeshCount && "One quantization entry per mesh");
+
+  Rava::ScratchScope scratch;
+  auto packed        = scratch.AllocateArray<Rava::PackedVertex>(vertices.size());
+  auto quantizations = scratch.AllocateArray<Rava::VertexQuantization>(meshes.size());
+  for (size_t i = 0; i < meshes.size(); ++i) {
+    auto meshVertices = vertices.subspan(meshes[i].FirstVertex, meshes[i].VertexCount);
+    quantizations[i]  = Rava::ComputeVertexQuantization(meshVertices);
+    Rava::PackVertices(
+        meshVertices, quantizations[i], packed.subspan(meshes[i].FirstVertex, meshVertices.size())
+    );
+  }
+
+  addUpload(
+      packed.data(), packed.size_bytes(), _vertexBuffer, range.FirstVertex * _vertexStride,
+      VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT
+  );
+  addUpload(
+      quantizations.data(), quantizations.size_bytes(), _quantizationBuffer,
+      range.FirstMesh * QUANTIZATION_SIZE, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT
+  );
+}
+
+void GeometryPool::Update(VkCommandBuffer commandBuffer, u32 frameIndex) {
+  RV_PROFILE_FUNCTION();
+  bool isFragmented = false;
+  {
+    std::lock_guard lock(_mutex);
+    _frameIndex = frameIndex;
+    ReleaseRetired(frameIndex);
+
+    isFragmented = _vertexRanges.GetFragmentation() > DEFRAG_FRAGMENTATION
+                || _indexRanges.GetFragmentation() > DEFRAG_FRAGMENTATION;
+  }
+
+  if (isFragmented) {
+    Defragment(commandBuffer, MAX_DEFRAG_BYTES_PER_FRAME);
+  }
+}
+
+u32 GeometryPool::Defragment(VkCommandBuffer commandBuffer, VkDeviceSize maxBytes) {
+  RV_PROFILE_FUNCTION();
+  std::lock_guard lock(_mutex);
+  if (_pinnedCount > 0 || _liveCount == 0) {
+    return 0;
+  }
+
+  struct Move {
+    u32 Handle = 0;
+    u32 Offset = 0;  // destination, in elements
+  };
+
+  Rava::ScratchScope scratch;
+  std::pmr::vector<u32> handles(scratch.GetResource());
+  handles.reserve(_liveCount);
+  for (u32 i = 0; i < _entries.size(); ++i) {
+    if (_entries[i].IsLive) {
+      handles.push_back(i);
+    }
+  }
+
+  // Slides the live ranges down in offset order until the byte budget is spent (the first move
+  // always happens). The copies go into the defrag buffer first, packed in move order. Retired
+  // ranges stay where they are, frames in flight may still draw them and the uploads staged before
+  // this frame may not land in them.
+  VkDeviceSize movedBytes = 0;
+
+  auto planMoves = [&](u32 GeometryAllocation::*first, u32 GeometryAllocation::*count,
+                       VkDeviceSize elementSize, RangeAllocator& allocator,
+                       std::pmr::vector<VkBufferCopy>& copies, std::pmr::vector<Move>& moves) {
+    std::sort(handles.begin(), handles.end(), [&](u32 a, u32 b) {
+      return _entries[a].Range.*first < _entries[b].Range.*first;
+    });
+
+    std::pmr::vector<RangeAllocator::Range> retiredRanges(scratch.GetResource());
+    for (const std::vector<u32>& retiredHandles : _retiredHandles) {
+      for (u32 handle : retiredHandles) {
+        const GeometryAllocation& range = _entries[handle].Range;
+        if (range.*count > 0) {
+          retiredRanges.push_back({range.*first, range.*count});
+        }
+      }
+    }
+    for (const std::vector<RetiredRange>& frameRanges : _retiredRanges) {
+      for (const RetiredRange& retired : frameRanges) {
+        if (retired.Allocator == &allocator) {
+          retiredRanges.push_back(retired.Range);
+        }
+      }
+    }
+    std::sort(retiredRanges.begin(), retiredRanges.end(), [](const auto& a, const auto& b) {
+      return a.Offset < b.Offset;
+    });
+
+    std::pmr::vector<RangeAllocator::Range> usedRanges(scratch.GetResource());
+    std::pmr::vector<RangeAllocator::Range> sourceRanges(scratch.GetResource());
+    usedRanges.reserve(handles.size() + retiredRanges.size());
+    u32 cursor         = 0;
+    bool isStopped     = false;
+    size_t nextRetired = 0;
+    for (u32 handle : handles) {
+      const GeometryAllocation& range = _entries[handle].Range;
+      if (range.*count == 0) {
+        continue;
+      }
+
+      // Nothing below the cursor can move past a retired range
+      for (; nextRetired < retiredRanges.size()
+             && retiredRanges[nextRetired].Offset < range.*first;
+           ++nextRetired) {
+        const RangeAllocator::Range& retired = retiredRanges[nextRetired];
+        usedRanges.push_back(retired);
+        cursor = std::max(cursor, retired.Offset + retired.Size);
+      }
+
+      if (!isStopped && range.*first != cursor) {
+        VkDeviceSize size = range.*count * elementSize;
+        isStopped         = movedBytes > 0 && movedBytes + size > maxBytes;
+        if (!isStopped) {
+          copies.push_back({range.*first * elementSize, movedBytes, size});
+          moves.push_back({handle, cursor});
+          sourceRanges.push_back({range.*first, range.*count});
+          movedBytes += size;
+        }
+      }
+
+      if (isStopped) {
+        usedRanges.push_back({range.*first, range.*count});
+      } else {
+        usedRanges.push_back({cursor, range.*count});
+        cursor += range.*count;
+      }
+    }
+    usedRanges.insert(usedRanges.end(), retiredRanges.begin() + nextRetired, retiredRanges.end());
+
+    // The copies out of the sources run after the uploads staged this frame, so the parts no
+    // destination covers are retired until the frame finished instead of being free right away.
+    // Both the sources and the destinations are sorted by offset.
+    auto retire = [&](u32 begin, u32 end) {
+      if (begin < end) {
+        usedRanges.push_back({begin, end - begin});
+        _retiredRanges[_frameIndex].push_back({&allocator, {begin, end - begin}});
+      }
+    };
+    size_t firstMove = 0;
+    for (const RangeAllocator::Range& source : sourceRanges) {
+      u32 begin = source.Offset;
+      u32 end   = source.Offset + source.Size;
+      while (firstMove < moves.size()
+             && moves[firstMove].Offset + sourceRanges[firstMove].Size <= begin) {
+        ++firstMove;
+      }
+      for (size_t i = firstMove; i < moves.size() && moves[i].Offset < end; ++i) {
+        retire(begin, std::min(moves[i].Offset, end));
+        begin = std::max(begin, moves[i].Offset + sourceRanges[i].Size);
+      }
+      retire(begin, end);
+    }
+
+    std::sort(usedRanges.begin(), usedRanges.end(), [](const auto& a, const auto& b) {
+      return a.Offset < b.Offset;
+    });
+    allocator.Rebuild(usedRanges);
+  };
+
+  std::pmr::vector<VkBufferCopy> vertexCopies(scratch.GetResource());
+  std::pmr::vector<VkBufferCopy> indexCopies(scratch.GetResource());
+  std::pmr::vector<Move> vertexMoves(scratch.GetResource());
+  std::pmr::vector<Move> indexMoves(scratch.GetResource());
+  planMoves(
+      &GeometryAllocation::FirstVertex, &GeometryAllocation::VertexCount, _vertexStride,
+      _vertexRanges, vertexCopies, vertexMoves
+  );
+  planMoves(
+      &GeometryAllocation::FirstIndex, &GeometryAllocation::IndexCount, INDEX_SIZE, _indexRanges,
+      indexCopies, indexMoves
+  );
+
+  if (movedBytes == 0) {
+    return 0;
+  }
+
+  VkBuffer defragBuffer = GetDefragBuffer(movedBytes).GetBuffer();
+
+  auto copyRanges = [&](VkBuffer srcBuffer, VkBuffer dstBuffer,
+                        const std::pmr::vector<VkBufferCopy>& copies) {
+    if (!copies.empty()) {
+      vkCmdCopyBuffer(
+          commandBuffer, srcBuffer, dstBuffer, static_cast<u32>(copies.size()), copies.data()
+      );
+    }
+  };
+
+  // Earlier draws, uploads and defragment copies of the pool
+  RecordBarrier(
+      commandBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+      VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT
+  );
+  copyRanges(_vertexBuffer, defragBuffer, vertexCopies);
+  copyRanges(_indexBuffer, defragBuffer, indexCopies);
+
+  RecordBarrier(
+      commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT
+  );
+
+  // Back into the pool at the new offsets
+  for (size_t i = 0; i < vertexCopies.size(); ++i) {
+    vertexCopies[i].srcOffset = vertexCopies[i].dstOffset;
+    vertexCopies[i].dstOffset = vertexMoves[i].Offset * _vertexStride;
+    _entries[vertexMoves[i].Handle].Range.FirstVertex = vertexMoves[i].Offset;
+  }
+  for (size_t i = 0; i < indexCopies.size(); ++i) {
+    indexCopies[i].srcOffset = indexCopies[i].dstOffset;
+    indexCopies[i].dstOffset = indexMoves[i].Offset * INDEX_SIZE;
+    _entries[indexMoves[i].Handle].Range.FirstIndex = indexMoves[i].Offset;
+  }
+  copyRanges(defragBuffer, _vertexBuffer, vertexCopies);
+  copyRanges(defragBuffer, _indexBuffer, indexCopies);
+
+  RecordBarrier(
+      commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+      VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT
+  );
+
+  ++_generation;
+  _defragmentedBytes += movedBytes;
+  return static_cast<u32>(vertexMoves.size() + indexMoves.size());
+}
+
+Buffer& GeometryPool::GetDefragBuffer(VkDeviceSize size) {
+  if (_defragBuffer && _defragBuffer->GetBufferSize() >= size) {
+    return *_defragBuffer;
+  }
+
+  VkDeviceSize capacity = std::bit_ceil(size);
+  _defragBuffer         = std::make_unique<Buffer>(
+      _context, 1, static_cast<u32>(capacity),
+      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+  );
+  return *_defragBuffer;
+}
+
+void GeometryPool::Bind(VkCommandBuffer commandBuffer) const {
+  VkBuffer buffers[]     = {_vertexBuffer};
+  VkDeviceSize offsets[] = {0};
+  vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+  vkCmdBindIndexBuffer(commandBuffer, _indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+}
+
+void GeometryPool::BindQuantization(
+    VkCommandBuffer commandBuffer, const GeometryAllocation& geometry, u32 meshIndex
+) const {
+  if (_format == VertexFormat::Float) {
+    return;
+  }
+
+  assert(meshIndex < geometry.MeshCount);
+  VkDeviceSize offset = (geometry.FirstMesh + meshIndex) * QUANTIZATION_SIZE;
+  vkCmdBindVertexBuffers(
+      commandBuffer, Vertex::QUANTIZATION_BINDING, 1, &_quantizationBuffer, &offset
+  );
+}
+
+GeometryPoolStats GeometryPool::GetStats() const {
+  std::lock_guard lock(_mutex);
+  GeometryPoolStats stats;
+  stats.AllocationCount      = _liveCount;
+  stats.UsedVertices         = _vertexRanges.GetCapacity() - _vertexRanges.GetFreeSize();
+  stats.UsedIndices          = _indexRanges.GetCapacity() - _indexRanges.GetFreeSize();
+  stats.VertexFreeRangeCount = _vertexRanges.GetFreeRangeCount();
+  stats.IndexFreeRangeCount  = _indexRanges.GetFreeRangeCount();
+  stats.VertexFragmentation  = _vertexRanges.GetFragmentation();
+  stats.IndexFragmentation   = _indexRanges.GetFragmentation();
+  stats.DefragmentedBytes    = _defragmentedBytes;
+  return stats;
+}
+}  // namespace VK
\ No newline at end of file
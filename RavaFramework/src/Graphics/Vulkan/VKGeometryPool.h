@@ -0,0 +1,195 @@
+#pragma once
+
+#include "Graphics/Vulkan/VKAllocator.h"
+
+namespace Rava {
+struct Mesh;
+struct Vertex;
+}
+
+namespace VK {
+class Buffer;
+class Context;
+struct BufferUpload;
+
+// First fit over a free list sorted by offset, freed ranges merge with their neighbours. Offsets
+// and sizes are in elements, not bytes.
+class RangeAllocator {
+public:
+  static constexpr u32 INVALID_OFFSET = ~0u;
+
+  struct Range {
+    u32 Offset = 0;
+    u32 Size   = 0;
+  };
+
+public:
+  RangeAllocator(u32 capacity);
+
+  u32 Allocate(u32 size);
+  void Free(u32 offset, u32 size);
+  // Replaces the free list with the gaps between the used ranges, which have to be sorted
+  void Rebuild(std::span<const Range> usedRanges);
+
+  inline u32 GetCapacity() const { return _capacity; }
+  inline u32 GetFreeSize() const { return _freeSize; }
+  inline u32 GetFreeRangeCount() const { return static_cast<u32>(_freeRanges.size()); }
+  u32 GetLargestFreeRange() const;
+  // 0 when the free space is one range, approaching 1 the more it is scattered
+  f32 GetFragmentation() const;
+
+private:
+  std::vector<Range> _freeRanges;
+  u32 _capacity = 0;
+  u32 _freeSize = 0;
+};
+
+// Element ranges of one mesh group inside the shared buffers. They move when the pool is
+// defragmented, so read them through GeometryPool::Get while recording instead of caching them.
+// The mesh range points into the quantization table and is empty for VertexFormat::Float.
+struct GeometryAllocation {
+  u32 FirstVertex = 0;
+  u32 VertexCount = 0;
+  u32 FirstIndex  = 0;
+  u32 IndexCount  = 0;
+  u32 FirstMesh   = 0;
+  u32 MeshCount   = 0;
+};
+
+struct GeometryPoolStats {
+  u32 AllocationCount      = 0;
+  u32 UsedVertices         = 0;
+  u32 UsedIndices          = 0;
+  u32 VertexFreeRangeCount = 0;
+  u32 IndexFreeRangeCount  = 0;
+  f32 VertexFragmentation  = 0.0f;
+  f32 IndexFragmentation   = 0.0f;
+  u64 DefragmentedBytes    = 0;  // moved by GPU copies since the pool was created
+};
+
+// One device local vertex buffer and one index buffer shared by every model, so a frame binds its
+// geometry once and draws can be batched into indirect draws. Allocations come from a free list per
+// buffer. Freed ranges are reused once the frames in flight are done with them, and Update moves
+// live ranges towards the start of the buffers by GPU copies when the free space fragments. The
+// ranges they moved out of are reused once the frame that copied them finished.
+// Handles stay valid across defragmentation, only the ranges behind them change.
+// With VertexFormat::Packed the uploads are packed on the way into the staging buffers and every
+// mesh gets a Rava::VertexQuantization in a third buffer, which never moves.
+class GeometryPool {
+public:
+  static constexpr u32 INVALID_HANDLE        = ~0u;
+  static constexpr u32 QUANTIZATION_CAPACITY = 64 * 1024;  // meshes
+
+public:
+  GeometryPool(
+      Shared<Context> context, u32 frameCount, VertexFormat format, u32 vertexCapacity,
+      u32 indexCapacity
+  );
+  ~GeometryPool();
+
+  NO_COPY(GeometryPool)
+  NO_MOVE(GeometryPool)
+
+  // Thread safe. An allocation that is not resident yet (its upload is still in flight on the
+  // transfer queue) is pinned: defragmentation waits until MarkResident. meshCount is the number of
+  // quantization entries, ignored for VertexFormat::Float.
+  u32 Allocate(u32 vertexCount, u32 indexCount, u32 meshCount, bool isResident = true);
+  void MarkResident(u32 handle);
+  // The range is reused after the frames in flight have finished
+  void Free(u32 handle);
+  GeometryAllocation Get(u32 handle) const;
+
+  // Staged in the StagingRing of the context, the copies run before the next frame. Main thread.
+  // Each mesh is quantized over its own vertices, so meshes must not share vertices. No meshes
+  // quantize all vertices as one.
+  void Upload(
+      u32 handle, std::span<const Rava::Vertex> vertices, std::span<const u32> indices,
+      std::span<const Rava::Mesh> meshes
+  );
+  // Fills staging buffers only, for the Uploader. Thread safe.
+  void PrepareUpload(
+      u32 handle, std::span<const Rava::Vertex> vertices, std::span<const u32> indices,
+      std::span<const Rava::Mesh> meshes, std::vector<BufferUpload>& uploads
+  );
+
+  // Main thread, outside of a render pass, once the frame that last used frameIndex finished.
+  // Releases the ranges retired by that frame and defragments a bounded amount when the free space
+  // is scattered.
+  void Update(VkCommandBuffer commandBuffer, u32 frameIndex);
+  // Moves up to maxBytes of live geometry towards the start of the buffers, returns the number of
+  // moved ranges. Does nothing while an upload is in flight.
+  u32 Defragment(VkCommandBuffer commandBuffer, VkDeviceSize maxBytes);
+
+  // Vertex binding 0 and the uint32 index buffer
+  void Bind(VkCommandBuffer commandBuffer) const;
+  // The quantization of one mesh at Vertex::QUANTIZATION_BINDING, nothing for VertexFormat::Float
+  void BindQuantization(
+      VkCommandBuffer commandBuffer, const GeometryAllocation& geometry, u32 meshIndex
+  ) const;
+
+  inline VertexFormat GetVertexFormat() const { return _format; }
+  inline VkDeviceSize GetVertexStride() const { return _vertexStride; }
+  inline VkBuffer GetVertexBuffer() const { return _vertexBuffer; }
+  inline VkBuffer GetIndexBuffer() const { return _indexBuffer; }
+  // Increments whenever ranges moved, for users that mirror them (GpuScene)
+  inline u32 GetGeneration() const { return _generation; }
+  GeometryPoolStats GetStats() const;
+
+private:
+  using UploadFunction = std::function<void(
+      const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset,
+      VkAccessFlags dstAccessMask
+  )>;
+
+  struct Entry {
+    GeometryAllocation Range;
+    bool IsLive     = false;
+    bool IsResident = false;
+  };
+
+  struct RetiredRange {
+    RangeAllocator* Allocator = nullptr;
+    RangeAllocator::Range Range;
+  };
+
+  Shared<Context> _context;
+  VertexFormat _format         = VertexFormat::Float;
+  VkDeviceSize _vertexStride   = 0;
+  VkBuffer _vertexBuffer       = VK_NULL_HANDLE;
+  VkBuffer _indexBuffer        = VK_NULL_HANDLE;
+  VkBuffer _quantizationBuffer = VK_NULL_HANDLE;  // Packed only
+  Allocation _vertexAllocation;
+  Allocation _indexAllocation;
+  Allocation _quantizationAllocation;
+  bool _isTransferShared = false;
+
+  mutable std::shared_mutex _mutex;  // shared by Get, the draws of every recording thread
+  RangeAllocator _vertexRanges;
+  RangeAllocator _indexRanges;
+  RangeAllocator _quantizationRanges;
+  std::vector<Entry> _entries;
+  std::vector<u32> _freeHandles;
+  std::vector<std::vector<u32>> _retiredHandles;          // per frame in flight
+  std::vector<std::vector<RetiredRange>> _retiredRanges;  // per frame, vacated by Defragment
+  u32 _frameIndex        = 0;
+  u32 _pinnedCount       = 0;
+  u32 _liveCount         = 0;
+  u32 _generation        = 0;
+  u64 _defragmentedBytes = 0;
+
+  // Temporary copy of the moved ranges, the source and destination of one vkCmdCopyBuffer may not
+  // overlap. Replaced buffers go through the deletion queue, earlier frames may still copy through
+  // them.
+  Unique<Buffer> _defragBuffer;
+
+private:
+  // Packs the vertices when needed and hands every destination range to addUpload
+  void ForEachUpload(
+      u32 handle, std::span<const Rava::Vertex> vertices, std::span<const u32> indices,
+      std::span<const Rava::Mesh> meshes, const UploadFunction& addUpload
+  );
+  void Release(u32 handle);
+  void ReleaseRetired(u32 frameIndex);
+  Buffer& GetDefragBuffer(VkDeviceSize size);
+};
+}  // namespace VK
\ No newline at end of file
@@ -0,0 +1,372 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Vulkan/VKGpuProfiler.h"
+
+#include "Core/Config.h"
+#include "Core/CpuProfiler.h"
+#include "Core/FrameAllocator.h"
+#include "Graphics/Vulkan/VKContext.h"
+#include "Graphics/Vulkan/VKValidation.h"
+
+namespace VK {
+// Same order as Rava::GPU_PIPELINE_STATISTIC_NAMES, results come back in bit order
+static constexpr VkQueryPipelineStatisticFlags PIPELINE_STATISTICS
+    = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT
+    | VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT
+    | VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT
+    | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT
+    | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT
+    | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT
+    | VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+// Query 0 and 1 bracket the whole frame, scopes use the rest in pairs
+static constexpr u32 TIMESTAMP_QUERY_COUNT = 2 + GpuProfiler::MAX_SCOPES * 2;
+
+GpuProfiler::GpuProfiler(Shared<Context> context, u32 frameCount)
+    : _context(context), _frames(frameCount) {
+  const VkPhysicalDeviceLimits& limits = _context->GetPhysicalDeviceProperties().limits;
+  _timestampPeriod                     = limits.timestampPeriod;
+
+  u32 queueFamilyCount = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(
+      _context->GetPhysicalDevice(), &queueFamilyCount, nullptr
+  );
+  std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+  vkGetPhysicalDeviceQueueFamilyProperties(
+      _context->GetPhysicalDevice(), &queueFamilyCount, queueFamilies.data()
+  );
+
+  u32 graphicsFamily = static_cast<u32>(_context->GetQueueFamilyIndices().GraphicsFamily);
+  u32 validBits      = queueFamilies[graphicsFamily].timestampValidBits;
+  _isSupported       = validBits > 0 && limits.timestampPeriod > 0.0f;
+  _timestampMask     = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+  if (!_isSupported) {
+    std::print("GpuProfiler: timestamps are not supported on the graphics queue\n");
+    return;
+  }
+
+  _isStatisticsEnabled = Config::IsGpuPipelineStatisticsEnabled
+                      && _context->GetEnabledFeatures().pipelineStatisticsQuery;
+  _statisticsCount     = static_cast<u32>(std::popcount(PIPELINE_STATISTICS));
+  if (Config::IsGpuPipelineStatisticsEnabled && !_isStatisticsEnabled) {
+    std::print("GpuProfiler: pipeline statistics queries are not supported\n");
+  }
+
+  CreateQueryPools();
+
+  if (!Config::GpuProfileDumpPath.empty()) {
+    std::filesystem::path dumpPath(Config::GpuProfileDumpPath);
+    _isJsonDump = dumpPath.extension() == ".json";
+    _dumpFile.open(dumpPath, std::ios::trunc);
+    if (!_dumpFile) {
+      std::print("GpuProfiler: failed to open {}\n", Config::GpuProfileDumpPath);
+    } else if (_isJsonDump) {
+      _dumpFile << "[\n";
+    } else {
+      _dumpFile << "frame,scope,depth,begin_ms,duration_ms";
+      for (std::string_view name : Rava::GPU_PIPELINE_STATISTIC_NAMES) {
+        _dumpFile << ',' << name;
+      }
+      _dumpFile << '\n';
+    }
+  }
+}
+
+GpuProfiler::~GpuProfiler() {
+  // The owner idles the device first, so every pending frame can be resolved
+  for (auto& frame : _frames) {
+    if (frame.IsPending) {
+      Resolve(frame, true);
+    }
+  }
+
+  if (_dumpFile.is_open() && _isJsonDump) {
+    _dumpFile << "\n]\n";
+  }
+
+  VkDevice device = _context->GetLogicalDevice();
+  for (auto& frame : _frames) {
+    vkDestroyQueryPool(device, frame.TimestampPool, nullptr);
+    vkDestroyQueryPool(device, frame.StatisticsPool, nullptr);
+  }
+}
+
+void GpuProfiler::CreateQueryPools() {
+  VkDevice device = _context->GetLogicalDevice();
+
+  for (auto& frame : _frames) {
+    frame.Scopes.resize(MAX_SCOPES);
+
+    VkQueryPoolCreateInfo createInfo{};
+    createInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    createInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+    createInfo.queryCount = TIMESTAMP_QUERY_COUNT;
+
+    VkResult result = vkCreateQueryPool(device, &createInfo, nullptr, &frame.TimestampPool);
+    _isSupported    = IsResultValid(result, "Failed to Create Timestamp Query Pool!\n");
+
+    if (_isStatisticsEnabled) {
+      createInfo.queryType          = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+      createInfo.queryCount         = MAX_SCOPES;
+      createInfo.pipelineStatistics = PIPELINE_STATISTICS;
+
+      result = vkCreateQueryPool(device, &createInfo, nullptr, &frame.StatisticsPool);
+      _isStatisticsEnabled
+          = IsResultValid(result, "Failed to Create Pipeline Statistics Query Pool!\n");
+    }
+  }
+}
+
+void GpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, u32 frameIndex) {
+  if (!_isSupported) {
+    return;
+  }
+
+  ResolvePending(frameIndex);
+
+  FrameQueries& frame   = _frames[frameIndex];
+  frame.ScopeCount      = 0;
+  frame.TimestampCount  = 2;
+  frame.StatisticsCount = 0;
+  frame.FrameNumber     = _frameNumber++;
+  frame.IsPending       = true;
+  _currentFrame         = &frame;
+  _openScopes.emplace(Rava::FrameAllocator::GetResource());
+  _openStatisticsScope = -1;
+
+  vkCmdResetQueryPool(commandBuffer, frame.TimestampPool, 0, TIMESTAMP_QUERY_COUNT);
+  if (_isStatisticsEnabled) {
+    vkCmdResetQueryPool(commandBuffer, frame.StatisticsPool, 0, MAX_SCOPES);
+  }
+
+  vkCmdWriteTimestamp(
+      commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.TimestampPool, 0
+  );
+}
+
+void GpuProfiler::EndFrame(VkCommandBuffer commandBuffer) {
+  if (_currentFrame == nullptr) {
+    return;
+  }
+
+  // Close whatever the caller left open so the queries stay balanced
+  while (!_openScopes->empty()) {
+    EndScope(commandBuffer);
+  }
+  _openScopes.reset();
+
+  vkCmdWriteTimestamp(
+      commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _currentFrame->TimestampPool, 1
+  );
+  _currentFrame = nullptr;
+}
+
+void GpuProfiler::BeginScope(VkCommandBuffer commandBuffer, std::string_view name) {
+  if (_currentFrame == nullptr) {
+    return;
+  }
+
+  FrameQueries& frame = *_currentFrame;
+  if (frame.ScopeCount >= MAX_SCOPES) {
+    // Out of queries, keep the stack balanced with a scope that records nothing
+    _openScopes->push_back(~0u);
+    return;
+  }
+
+  // Scopes are reused frame after frame, assigning the name keeps its capacity
+  u32 scopeIndex        = frame.ScopeCount++;
+  Scope& scope          = frame.Scopes[scopeIndex];
+  scope.Depth           = static_cast<u32>(_openScopes->size());
+  scope.BeginQuery      = frame.TimestampCount++;
+  scope.EndQuery        = frame.TimestampCount++;
+  scope.StatisticsQuery = -1;
+  scope.Name.assign(name);
+
+  vkCmdWriteTimestamp(
+      commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.TimestampPool, scope.BeginQuery
+  );
+
+  if (_isStatisticsEnabled && _openStatisticsScope < 0) {
+    scope.StatisticsQuery = static_cast<i32>(frame.StatisticsCount++);
+    _openStatisticsScope  = static_cast<i32>(scopeIndex);
+    vkCmdBeginQuery(commandBuffer, frame.StatisticsPool, scope.StatisticsQuery, 0);
+  }
+
+  _openScopes->push_back(scopeIndex);
+}
+
+void GpuProfiler::EndScope(VkCommandBuffer commandBuffer) {
+  if (_currentFrame == nullptr || _openScopes->empty()) {
+    return;
+  }
+
+  u32 scopeIndex = _openScopes->back();
+  _openScopes->pop_back();
+  if (scopeIndex == ~0u) {
+    return;
+  }
+
+  FrameQueries& frame = *_currentFrame;
+  const Scope& scope  = frame.Scopes[scopeIndex];
+
+  if (_openStatisticsScope == static_cast<i32>(scopeIndex)) {
+    vkCmdEndQuery(commandBuffer, frame.StatisticsPool, scope.StatisticsQuery);
+    _openStatisticsScope = -1;
+  }
+
+  vkCmdWriteTimestamp(
+      commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.TimestampPool, scope.EndQuery
+  );
+}
+
+VkQueryPipelineStatisticFlags GpuProfiler::GetActiveStatistics() const {
+  return _openStatisticsScope >= 0 ? PIPELINE_STATISTICS : 0;
+}
+
+bool GpuProfiler::GetLatestFrame(Rava::GpuFrameTimings& timings) const {
+  if (!_hasLatestFrame) {
+    return false;
+  }
+  timings = _latestFrame;
+  return true;
+}
+
+void GpuProfiler::ResolvePending(u32 reusedIndex) {
+  FrameQueries& reused = _frames[reusedIndex];
+  while (true) {
+    FrameQueries* oldest = nullptr;
+    for (auto& frame : _frames) {
+      if (frame.IsPending && (oldest == nullptr || frame.FrameNumber < oldest->FrameNumber)) {
+        oldest = &frame;
+      }
+    }
+    if (oldest == nullptr || !Resolve(*oldest, oldest == &reused)) {
+      break;
+    }
+  }
+
+  // Slots follow the frame numbers, so it is the oldest anyway unless the sequence restarted
+  if (reused.IsPending) {
+    Resolve(reused, true);
+  }
+}
+
+bool GpuProfiler::Resolve(FrameQueries& frame, bool isWaiting) {
+  RV_PROFILE_FUNCTION();
+  VkDevice device          = _context->GetLogicalDevice();
+  VkQueryResultFlags flags = VK_QUERY_RESULT_64_BIT | (isWaiting ? VK_QUERY_RESULT_WAIT_BIT : 0);
+
+  Rava::ScratchScope scratch;
+  std::span<u64> timestamps = scratch.AllocateArray<u64>(frame.TimestampCount);
+  VkResult result           = vkGetQueryPoolResults(
+      device, frame.TimestampPool, 0, frame.TimestampCount, timestamps.size_bytes(),
+      timestamps.data(), sizeof(u64), flags
+  );
+  if (result == VK_NOT_READY) {
+    return false;
+  }
+
+  frame.IsPending = false;
+  if (result != VK_SUCCESS) {
+    return true;
+  }
+
+  std::span<u64> statistics = scratch.AllocateArray<u64>(frame.StatisticsCount * _statisticsCount);
+  if (frame.StatisticsCount > 0) {
+    result = vkGetQueryPoolResults(
+        device, frame.StatisticsPool, 0, frame.StatisticsCount, statistics.size_bytes(),
+        statistics.data(), _statisticsCount * sizeof(u64), flags
+    );
+    if (result != VK_SUCCESS) {
+      statistics = {};
+    }
+  }
+
+  auto toMs = [&](u64 begin, u64 end) {
+    return static_cast<f64>((end - begin) & _timestampMask) * _timestampPeriod * 1e-6;
+  };
+
+  u64 frameBegin           = timestamps[0];
+  _latestFrame.FrameNumber = frame.FrameNumber;
+  _latestFrame.FrameMs     = toMs(frameBegin, timestamps[1]);
+  _latestFrame.Scopes.resize(frame.ScopeCount);
+
+  for (u32 i = 0; i < frame.ScopeCount; ++i) {
+    const Scope& scope           = frame.Scopes[i];
+    u64 scopeBegin               = timestamps[scope.BeginQuery];
+    Rava::GpuScopeTiming& timing = _latestFrame.Scopes[i];
+    timing.Name                  = scope.Name;
+    timing.Depth                 = scope.Depth;
+    timing.BeginMs               = toMs(frameBegin, scopeBegin);
+    timing.DurationMs            = toMs(scopeBegin, timestamps[scope.EndQuery]);
+    timing.PipelineStatistics.clear();
+
+    if (scope.StatisticsQuery >= 0 && !statistics.empty()) {
+      auto first = statistics.begin() + scope.StatisticsQuery * _statisticsCount;
+      timing.PipelineStatistics.assign(first, first + _statisticsCount);
+    }
+  }
+
+  _hasLatestFrame = true;
+  Dump(_latestFrame);
+  return true;
+}
+
+void GpuProfiler::Dump(const Rava::GpuFrameTimings& timings) {
+  if (!_dumpFile.is_open()) {
+    return;
+  }
+
+  // Formats straight into the stream, no temporary strings per frame
+  std::ostreambuf_iterator<char> out(_dumpFile);
+
+  if (!_isJsonDump) {
+    std::format_to(out, "{},Frame,0,0,{:.6f}", timings.FrameNumber, timings.FrameMs);
+    std::fill_n(out, _statisticsCount, ',');
+    _dumpFile << '\n';
+
+    for (const auto& scope : timings.Scopes) {
+      std::format_to(
+          out, "{},{},{},{:.6f},{:.6f}", timings.FrameNumber, scope.Name, scope.Depth + 1,
+          scope.BeginMs, scope.DurationMs
+      );
+      for (u32 i = 0; i < _statisticsCount; ++i) {
+        _dumpFile << ',';
+        if (i < scope.PipelineStatistics.size()) {
+          _dumpFile << scope.PipelineStatistics[i];
+        }
+      }
+      _dumpFile << '\n';
+    }
+    return;
+  }
+
+  _dumpFile << (_isFirstDump ? "  " : ",\n  ");
+  _isFirstDump = false;
+
+  std::format_to(
+      out, "{{\"frame\": {}, \"frame_ms\": {:.6f}, \"scopes\": [", timings.FrameNumber,
+      timings.FrameMs
+  );
+  for (size_t i = 0; i < timings.Scopes.size(); ++i) {
+    const auto& scope = timings.Scopes[i];
+    std::format_to(
+        out, "{}{{\"name\": \"{}\", \"depth\": {}, \"begin_ms\": {:.6f}, \"duration_ms\": {:.6f}",
+        i == 0 ? "" : ", ", scope.Name, scope.Depth, scope.BeginMs, scope.DurationMs
+    );
+    if (!scope.PipelineStatistics.empty()) {
+      _dumpFile << ", \"statistics\": {";
+      for (size_t j = 0; j < scope.PipelineStatistics.size(); ++j) {
+        std::format_to(
+            out, "{}\"{}\": {}", j == 0 ? "" : ", ", Rava::GPU_PIPELINE_STATISTIC_NAMES[j],
+            scope.PipelineStatistics[j]
+        );
+      }
+      _dumpFile << '}';
+    }
+    _dumpFile << '}';
+  }
+  _dumpFile << "]}";
+}
+}  // namespace VK
\ No newline at end of file
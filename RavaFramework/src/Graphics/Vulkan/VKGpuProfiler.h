@@ -0,0 +1,89 @@
+#pragma once
+
+namespace VK {
+class Context;
+
+// Named, nested GPU scopes measured with timestamp queries, plus pipeline statistics for scopes
+// that are not nested in another statistics scope (Vulkan allows one active query per type).
+// Every frame in flight owns its query pools. Results are read without waiting at the start of the
+// following frames, a frame whose queries are not available yet stays pending. It is only waited
+// for when its slot comes around again, after that frame finished, so reading them never stalls.
+class GpuProfiler {
+public:
+  static constexpr u32 MAX_SCOPES = 256;
+
+public:
+  GpuProfiler(Shared<Context> context, u32 frameCount);
+  ~GpuProfiler();
+
+  NO_COPY(GpuProfiler)
+  NO_MOVE(GpuProfiler)
+
+  // Outside of a render pass, once the frame that last used frameIndex finished
+  void BeginFrame(VkCommandBuffer commandBuffer, u32 frameIndex);
+  void EndFrame(VkCommandBuffer commandBuffer);
+
+  void BeginScope(VkCommandBuffer commandBuffer, std::string_view name);
+  void EndScope(VkCommandBuffer commandBuffer);
+
+  bool GetLatestFrame(Rava::GpuFrameTimings& timings) const;
+  // Of the pipeline statistics query open in the primary command buffer, 0 without one. Secondary
+  // command buffers executed meanwhile have to inherit them.
+  VkQueryPipelineStatisticFlags GetActiveStatistics() const;
+  // Without copying the scopes, for the frame pacer
+  inline bool HasLatestFrame() const { return _hasLatestFrame; }
+  inline u64 GetLatestFrameNumber() const { return _latestFrame.FrameNumber; }
+  inline f64 GetLatestFrameMs() const { return _latestFrame.FrameMs; }
+
+  inline bool IsSupported() const { return _isSupported; }
+
+private:
+  struct Scope {
+    std::string Name;
+    u32 Depth           = 0;
+    u32 BeginQuery      = 0;
+    u32 EndQuery        = 0;
+    i32 StatisticsQuery = -1;
+  };
+
+  struct FrameQueries {
+    VkQueryPool TimestampPool  = VK_NULL_HANDLE;
+    VkQueryPool StatisticsPool = VK_NULL_HANDLE;
+    std::vector<Scope> Scopes;  // MAX_SCOPES, reused every frame
+    u32 ScopeCount      = 0;
+    u32 TimestampCount  = 0;
+    u32 StatisticsCount = 0;
+    u64 FrameNumber     = 0;
+    bool IsPending      = false;
+  };
+
+  Shared<Context> _context;
+  std::vector<FrameQueries> _frames;
+  FrameQueries* _currentFrame = nullptr;
+  std::optional<std::pmr::vector<u32>> _openScopes;  // in the frame allocator while recording
+  i32 _openStatisticsScope = -1;
+  u64 _frameNumber         = 0;
+
+  bool _isSupported         = false;
+  bool _isStatisticsEnabled = false;
+  u32 _statisticsCount      = 0;
+  f64 _timestampPeriod      = 1.0;
+  u64 _timestampMask        = ~0ull;
+
+  Rava::GpuFrameTimings _latestFrame;
+  bool _hasLatestFrame = false;
+
+  std::ofstream _dumpFile;
+  bool _isJsonDump  = false;
+  bool _isFirstDump = true;
+
+private:
+  void CreateQueryPools();
+  // Oldest first, so the latest frame only moves forward. The frame in reusedIndex is waited for,
+  // its queries are reset next.
+  void ResolvePending(u32 reusedIndex);
+  // False while the results are not available, the frame stays pending
+  bool Resolve(FrameQueries& frame, bool isWaiting);
+  void Dump(const Rava::GpuFrameTimings& timings);
+};
+}  // namespace VK
\ No newline at end of file
@@ -0,0 +1,906 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Vulkan/VKGpuScene.h"
+
+#include "Core/Config.h"
+#include "Core/CpuProfiler.h"
+#include "Core/FrameAllocator.h"
+#include "Graphics/Vulkan/VKBuffer.h"
+#include "Graphics/Vulkan/VKCommandRecorder.h"
+#include "Graphics/Vulkan/VKContext.h"
+#include "Graphics/Vulkan/VKDeletionQueue.h"
+#include "Graphics/Vulkan/VKGeometryPool.h"
+#include "Graphics/Vulkan/VKModel.h"
+#include "Graphics/Vulkan/VKSwapchain.h"
+#include "Graphics/Vulkan/VKValidation.h"
+
+namespace VK {
+static constexpr u32 CULL_GROUP_SIZE           = 64;  // Shaders/GpuScene.inc
+static constexpr u32 CULL_COMPACT              = 1;
+static constexpr u32 CULL_CLUSTERS             = 2;
+static constexpr u32 MAX_CLUSTER_GROUPS        = 1024;  // ClusterCull.comp strides over the rest
+static constexpr u32 BINDING_COUNT             = 10;
+static constexpr VkDeviceSize MIN_STAGING_SIZE = 64 * 1024;
+static constexpr u32 CPU_DRAW_BATCH_SIZE       = 4096;  // instances per secondary command buffer
+
+static_assert(sizeof(GpuMesh) == 80, "GpuMesh has to match the std430 layout");
+static_assert(sizeof(GpuMeshlet) == 48, "GpuMeshlet has to match the std430 layout");
+static_assert(sizeof(GpuInstance) == 96, "GpuInstance has to match the std430 layout");
+
+struct CullConstants {
+  Vec4 FrustumPlanes[6];
+  u32 InstanceCount;
+  u32 MeshCount;
+  u32 Flags;  // CULL_COMPACT | CULL_CLUSTERS
+  f32 LodThreshold;
+  Vec4 LodCamera;  // position and Rava::LodCamera::ProjectionScale
+};
+
+// Reset by every Cull, DrawCount is read by the cluster draw as its count
+struct ClusterCounts {
+  u32 DrawCount;
+  u32 DrawCapacity;
+  u32 InstanceCount;
+  u32 Padding;
+};
+
+struct DrawConstants {
+  Mat4 ViewProjection;
+  u32 IsIndirect;
+};
+
+static u32 GetGroupCount(u32 threadCount) {
+  return (threadCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE;
+}
+
+// Gribb/Hartmann on the rows of the matrix, for a [0, 1] depth range. The planes point inwards.
+static std::array<Vec4, 6> ExtractFrustumPlanes(const Mat4& viewProjection) {
+  Mat4 rows = glm::transpose(viewProjection);
+
+  std::array<Vec4, 6> planes = {
+      rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1],
+      rows[3] - rows[1], rows[2],           rows[3] - rows[2],
+  };
+  for (Vec4& plane : planes) {
+    plane /= glm::length(Vec3(plane));
+  }
+  return planes;
+}
+
+// Same selection as Shaders/Cull.comp.glsl, returns the mesh of the level to draw
+static u32 SelectLodMesh(
+    std::span<const GpuMesh> meshes, u32 meshIndex, const GpuInstance& instance,
+    const Rava::LodCamera& camera, f32 threshold
+) {
+  const GpuMesh& mesh = meshes[meshIndex];
+  if (mesh.LodCount == 0 || threshold <= 0.0f) {
+    return meshIndex;
+  }
+
+  f32 pixelScale = Rava::ComputeLodPixelScale(camera, instance.Transform, mesh.BoundingSphere);
+  for (u32 level = mesh.LodCount; level > 0; --level) {
+    if (meshes[meshIndex + level].LodError * pixelScale < threshold) {
+      return meshIndex + level;
+    }
+  }
+  return meshIndex;
+}
+
+// Same test as Shaders/Cull.comp.glsl
+static bool IsInstanceVisible(
+    const std::array<Vec4, 6>& planes, const GpuInstance& instance, const GpuMesh& mesh
+) {
+  Mat3 axes   = Mat3(instance.Transform);
+  Vec3 scales = {glm::length(axes[0]), glm::length(axes[1]), glm::length(axes[2])};
+  Vec3 center = Vec3(instance.Transform * Vec4(Vec3(mesh.BoundingSphere), 1.0f));
+  f32 radius  = mesh.BoundingSphere.w * std::max({scales.x, scales.y, scales.z});
+
+  for (const Vec4& plane : planes) {
+    if (glm::dot(Vec3(plane), center) + plane.w < -radius) {
+      return false;
+    }
+  }
+  return true;
+}
+
+GpuScene::GpuScene(
+    Shared<Context> context, Shared<GeometryPool> geometryPool, const PipelineTarget& target,
+    u32 frameCount, const GpuSceneLimits& limits
+)
+    : _context(context),
+      _geometryPool(geometryPool),
+      _limits(limits),
+      _stagingBuffers(frameCount),
+      _geometryGeneration(geometryPool->GetGeneration()) {
+  const VkPhysicalDeviceFeatures& features = _context->GetEnabledFeatures();
+  if (!features.drawIndirectFirstInstance) {
+    std::print("GpuScene: drawIndirectFirstInstance is not supported\n");
+    return;
+  }
+
+  // Compacted draws are only readable with a GPU side count
+  _isDrawIndirectCountSupported
+      = features.multiDrawIndirect && _context->GetEnabledFeatures12().drawIndirectCount;
+
+  CreateBuffers();
+  CreateDescriptors();
+  _isValid = CreateComputePipelines() && CreateGraphicsPipeline(target);
+  SetViewProjection(_viewProjection);
+}
+
+GpuScene::~GpuScene() {
+  for (size_t i = 0; i < _meshes.size(); i += _meshes[i].LodCount + 1) {
+    _geometryPool->Free(_meshGeometry[i]);
+  }
+
+  VkDevice device = _context->GetLogicalDevice();
+  vkDestroyPipeline(device, _graphicsPipeline, nullptr);
+  vkDestroyPipeline(device, _compactPipeline, nullptr);
+  vkDestroyPipeline(device, _clusterPipeline, nullptr);
+  vkDestroyPipeline(device, _cullPipeline, nullptr);
+  vkDestroyPipelineLayout(device, _graphicsPipelineLayout, nullptr);
+  vkDestroyPipelineLayout(device, _computePipelineLayout, nullptr);
+  vkDestroyDescriptorPool(device, _descriptorPool, nullptr);
+  vkDestroyDescriptorSetLayout(device, _descriptorSetLayout, nullptr);
+}
+
+void GpuScene::CreateBuffers() {
+  auto createBuffer = [this](VkDeviceSize size, u32 count, VkBufferUsageFlags usage) {
+    return std::make_unique<Buffer>(
+        _context, size, count, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    );
+  };
+
+  constexpr VkBufferUsageFlags storage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+  constexpr VkBufferUsageFlags command = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+  constexpr VkBufferUsageFlags dst     = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+  constexpr VkDeviceSize drawSize      = sizeof(VkDrawIndexedIndirectCommand);
+
+  // Every level of a mesh reserves room for all instances of the mesh
+  u32 visibleCapacity = _limits.MaxInstances * (Rava::Mesh::MAX_LODS + 1);
+
+  _meshBuffer            = createBuffer(sizeof(GpuMesh), _limits.MaxMeshes, storage | dst);
+  _instanceBuffer        = createBuffer(sizeof(GpuInstance), _limits.MaxInstances, storage | dst);
+  _visibleInstanceBuffer = createBuffer(sizeof(u32), visibleCapacity, storage);
+  _meshCounterBuffer     = createBuffer(sizeof(u32), _limits.MaxMeshes, storage | dst);
+  _drawCommandBuffer     = createBuffer(drawSize, _limits.MaxMeshes, storage | command);
+  _drawCountBuffer       = createBuffer(sizeof(u32), 1, storage | command | dst);
+
+  _meshletBuffer         = createBuffer(sizeof(GpuMeshlet), _limits.MaxMeshlets, storage | dst);
+  _clusterCountBuffer    = createBuffer(sizeof(ClusterCounts), 1, storage | command | dst);
+  _clusterInstanceBuffer = createBuffer(sizeof(u32), _limits.MaxInstances, storage);
+  _clusterDrawBuffer     = createBuffer(drawSize, _limits.MaxClusterDraws, storage | command);
+}
+
+void GpuScene::CreateDescriptors() {
+  VkDevice device = _context->GetLogicalDevice();
+
+  // Binding order of Shaders/*.glsl, the vertex shader reads the instances and the visible list
+  constexpr VkShaderStageFlags compute = VK_SHADER_STAGE_COMPUTE_BIT;
+  constexpr VkShaderStageFlags shared  = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+  std::array<VkShaderStageFlags, BINDING_COUNT> stages = {
+      shared, shared, shared, compute, compute, compute, compute, compute, compute, compute
+  };
+  std::array<Buffer*, BINDING_COUNT> buffers = {
+      _meshBuffer.get(),         _instanceBuffer.get(),        _visibleInstanceBuffer.get(),
+      _meshCounterBuffer.get(),  _drawCommandBuffer.get(),     _drawCountBuffer.get(),
+      _clusterCountBuffer.get(), _clusterInstanceBuffer.get(), _meshletBuffer.get(),
+      _clusterDrawBuffer.get(),
+  };
+
+  std::array<VkDescriptorSetLayoutBinding, BINDING_COUNT> bindings{};
+  for (u32 i = 0; i < BINDING_COUNT; ++i) {
+    bindings[i].binding         = i;
+    bindings[i].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[i].descriptorCount = 1;
+    bindings[i].stageFlags      = stages[i];
+  }
+
+  VkDescriptorSetLayoutCreateInfo layoutInfo{};
+  layoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  layoutInfo.bindingCount = BINDING_COUNT;
+  layoutInfo.pBindings    = bindings.data();
+
+  VkResult result
+      = vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &_descriptorSetLayout);
+  IsResultValid(result, "Failed to Create GpuScene Descriptor Set Layout!\n");
+
+  VkDescriptorPoolSize poolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, BINDING_COUNT};
+
+  VkDescriptorPoolCreateInfo poolInfo{};
+  poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  poolInfo.maxSets       = 1;
+  poolInfo.poolSizeCount = 1;
+  poolInfo.pPoolSizes    = &poolSize;
+
+  result = vkCreateDescriptorPool(device, &poolInfo, nullptr, &_descriptorPool);
+  IsResultValid(result, "Failed to Create GpuScene Descriptor Pool!\n");
+
+  VkDescriptorSetAllocateInfo allocateInfo{};
+  allocateInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  allocateInfo.descriptorPool     = _descriptorPool;
+  allocateInfo.descriptorSetCount = 1;
+  allocateInfo.pSetLayouts        = &_descriptorSetLayout;
+
+  result = vkAllocateDescriptorSets(device, &allocateInfo, &_descriptorSet);
+  IsResultValid(result, "Failed to Allocate GpuScene Descriptor Set!\n");
+
+  std::array<VkDescriptorBufferInfo, BINDING_COUNT> bufferInfos;
+  std::array<VkWriteDescriptorSet, BINDING_COUNT> writes{};
+  for (u32 i = 0; i < BINDING_COUNT; ++i) {
+    bufferInfos[i]            = buffers[i]->DescriptorInfo();
+    writes[i].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[i].dstSet          = _descriptorSet;
+    writes[i].dstBinding      = i;
+    writes[i].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[i].descriptorCount = 1;
+    writes[i].pBufferInfo     = &bufferInfos[i];
+  }
+  vkUpdateDescriptorSets(device, BINDING_COUNT, writes.data(), 0, nullptr);
+}
+
+bool GpuScene::CreateComputePipelines() {
+  VkDevice device = _context->GetLogicalDevice();
+
+  VkPushConstantRange pushConstantRange{VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullConstants)};
+
+  VkPipelineLayoutCreateInfo layoutInfo{};
+  layoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  layoutInfo.setLayoutCount         = 1;
+  layoutInfo.pSetLayouts            = &_descriptorSetLayout;
+  layoutInfo.pushConstantRangeCount = 1;
+  layoutInfo.pPushConstantRanges    = &pushConstantRange;
+
+  VkResult result = vkCreatePipelineLayout(device, &layoutInfo, nullptr, &_computePipelineLayout);
+  if (!IsResultValid(result, "Failed to Create GpuScene Compute Pipeline Layout!\n")) {
+    return false;
+  }
+
+  auto createPipeline = [this, device](std::string_view fileName, VkPipeline& pipeline) {
+    VkShaderModule shaderModule = _context->LoadShaderModule(fileName);
+    if (shaderModule == VK_NULL_HANDLE) {
+      return false;
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType        = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName  = "main";
+    pipelineInfo.layout       = _computePipelineLayout;
+
+    VkResult result = vkCreateComputePipelines(
+        device, _context->GetPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline
+    );
+    vkDestroyShaderModule(device, shaderModule, nullptr);
+    return IsResultValid(result, "Failed to Create GpuScene Compute Pipeline!\n");
+  };
+
+  return createPipeline("Cull.comp.spv", _cullPipeline)
+      && createPipeline("Compact.comp.spv", _compactPipeline)
+      && createPipeline("ClusterCull.comp.spv", _clusterPipeline);
+}
+
+bool GpuScene::CreateGraphicsPipeline(const PipelineTarget& target) {
+  VkDevice device = _context->GetLogicalDevice();
+
+  if (_graphicsPipelineLayout == VK_NULL_HANDLE) {
+    VkPushConstantRange pushConstantRange{VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawConstants)};
+
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount         = 1;
+    layoutInfo.pSetLayouts            = &_descriptorSetLayout;
+    layoutInfo.pushConstantRangeCount = 1;
+    layoutInfo.pPushConstantRanges    = &pushConstantRange;
+
+    VkResult result
+        = vkCreatePipelineLayout(device, &layoutInfo, nullptr, &_graphicsPipelineLayout);
+    if (!IsResultValid(result, "Failed to Create GpuScene Graphics Pipeline Layout!\n")) {
+      return false;
+    }
+  }
+
+  VkShaderModule vertexModule   = _context->LoadShaderModule("Mesh.vert.spv");
+  VkShaderModule fragmentModule = _context->LoadShaderModule("Mesh.frag.spv");
+  if (vertexModule == VK_NULL_HANDLE || fragmentModule == VK_NULL_HANDLE) {
+    vkDestroyShaderModule(device, vertexModule, nullptr);
+    vkDestroyShaderModule(device, fragmentModule, nullptr);
+    return false;
+  }
+
+  // IS_PACKED in Mesh.vert
+  VertexFormat format = _geometryPool->GetVertexFormat();
+  VkBool32 isPacked   = format == VertexFormat::Packed;
+  VkSpecializationMapEntry specializationEntry{0, 0, sizeof(VkBool32)};
+  VkSpecializationInfo specializationInfo{1, &specializationEntry, sizeof(VkBool32), &isPacked};
+
+  std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages{};
+  shaderStages[0].sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  shaderStages[0].stage               = VK_SHADER_STAGE_VERTEX_BIT;
+  shaderStages[0].module              = vertexModule;
+  shaderStages[0].pName               = "main";
+  shaderStages[0].pSpecializationInfo = &specializationInfo;
+  shaderStages[1].sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  shaderStages[1].stage               = VK_SHADER_STAGE_FRAGMENT_BIT;
+  shaderStages[1].module              = fragmentModule;
+  shaderStages[1].pName               = "main";
+
+  // The quantization comes from the mesh table instead of the per draw binding
+  auto bindingDescriptions   = Vertex::GetBindingDescriptions(format);
+  auto attributeDescriptions = Vertex::GetAttributeDescriptions(format);
+  std::erase_if(bindingDescriptions, [](const auto& binding) {
+    return binding.binding == Vertex::QUANTIZATION_BINDING;
+  });
+  std::erase_if(attributeDescriptions, [](const auto& attribute) {
+    return attribute.binding == Vertex::QUANTIZATION_BINDING;
+  });
+
+  VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+  vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+  vertexInputInfo.vertexBindingDescriptionCount   = static_cast<u32>(bindingDescriptions.size());
+  vertexInputInfo.pVertexBindingDescriptions      = bindingDescriptions.data();
+  vertexInputInfo.vertexAttributeDescriptionCount = static_cast<u32>(attributeDescriptions.size());
+  vertexInputInfo.pVertexAttributeDescriptions    = attributeDescriptions.data();
+
+  VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo{};
+  inputAssemblyInfo.sType    = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+  inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+  // Viewport and scissor are set by the swap chain render pass
+  VkPipelineViewportStateCreateInfo viewportInfo{};
+  viewportInfo.sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+  viewportInfo.viewportCount = 1;
+  viewportInfo.scissorCount  = 1;
+
+  // Imported models do not agree on a winding order
+  VkPipelineRasterizationStateCreateInfo rasterizationInfo{};
+  rasterizationInfo.sType       = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+  rasterizationInfo.polygonMode = VK_POLYGON_MODE_FILL;
+  rasterizationInfo.cullMode    = VK_CULL_MODE_NONE;
+  rasterizationInfo.frontFace   = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+  rasterizationInfo.lineWidth   = 1.0f;
+
+  VkPipelineMultisampleStateCreateInfo multisampleInfo{};
+  multisampleInfo.sType                = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+  multisampleInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+  VkPipelineDepthStencilStateCreateInfo depthStencilInfo{};
+  depthStencilInfo.sType            = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+  depthStencilInfo.depthTestEnable  = VK_TRUE;
+  depthStencilInfo.depthWriteEnable = VK_TRUE;
+  depthStencilInfo.depthCompareOp   = VK_COMPARE_OP_LESS;
+
+  VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+  colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT
+                                      | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+  VkPipelineColorBlendStateCreateInfo colorBlendInfo{};
+  colorBlendInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+  colorBlendInfo.attachmentCount = 1;
+  colorBlendInfo.pAttachments    = &colorBlendAttachment;
+
+  std::array<VkDynamicState, 2> dynamicStates = {
+      VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR
+  };
+  VkPipelineDynamicStateCreateInfo dynamicStateInfo{};
+  dynamicStateInfo.sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+  dynamicStateInfo.dynamicStateCount = static_cast<u32>(dynamicStates.size());
+  dynamicStateInfo.pDynamicStates    = dynamicStates.data();
+
+  // Dynamic rendering names the formats instead of a render pass to be compatible with
+  VkPipelineRenderingCreateInfo renderingInfo{};
+  renderingInfo.sType                   = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+  renderingInfo.colorAttachmentCount    = 1;
+  renderingInfo.pColorAttachmentFormats = &target.ColorFormat;
+  renderingInfo.depthAttachmentFormat   = target.DepthFormat;
+
+  VkGraphicsPipelineCreateInfo pipelineInfo{};
+  pipelineInfo.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+  pipelineInfo.stageCount          = static_cast<u32>(shaderStages.size());
+  pipelineInfo.pStages             = shaderStages.data();
+  pipelineInfo.pVertexInputState   = &vertexInputInfo;
+  pipelineInfo.pInputAssemblyState = &inputAssemblyInfo;
+  pipelineInfo.pViewportState      = &viewportInfo;
+  pipelineInfo.pRasterizationState = &rasterizationInfo;
+  pipelineInfo.pMultisampleState   = &multisampleInfo;
+  pipelineInfo.pDepthStencilState  = &depthStencilInfo;
+  pipelineInfo.pColorBlendState    = &colorBlendInfo;
+  pipelineInfo.pDynamicState       = &dynamicStateInfo;
+  pipelineInfo.layout              = _graphicsPipelineLayout;
+  pipelineInfo.renderPass          = target.RenderPass;
+  pipelineInfo.subpass             = 0;
+  if (target.RenderPass == VK_NULL_HANDLE) {
+    pipelineInfo.pNext = &renderingInfo;
+  }
+
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  VkResult result     = vkCreateGraphicsPipelines(
+      device, _context->GetPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline
+  );
+  vkDestroyShaderModule(device, vertexModule, nullptr);
+  vkDestroyShaderModule(device, fragmentModule, nullptr);
+  if (!IsResultValid(result, "Failed to Create GpuScene Graphics Pipeline!\n")) {
+    return false;
+  }
+
+  // Frames in flight may still draw with the old one
+  _context->GetDeletionQueue().DestroyPipeline(_graphicsPipeline);
+  _graphicsPipeline = pipeline;
+  return true;
+}
+
+void GpuScene::SetPipelineTarget(const PipelineTarget& target) {
+  if (_isValid) {
+    _isValid = CreateGraphicsPipeline(target);
+  }
+}
+
+std::vector<u32> GpuScene::AddModel(const Rava::ModelData& data) {
+  std::vector<u32> meshes;
+  meshes.reserve(data.Meshes.size());
+  std::vector<u32> indices;
+  std::vector<Rava::MeshLod> lods;
+  std::vector<Rava::Meshlet> meshlets;
+  for (const Rava::Mesh& mesh : data.Meshes) {
+    // The levels of a model sit behind all full meshes, AddMesh wants them behind their own
+    auto meshIndices = data.Indices.subspan(mesh.FirstIndex, mesh.IndexCount);
+    indices.assign(meshIndices.begin(), meshIndices.end());
+    lods.clear();
+    for (Rava::MeshLod lod : data.Lods.subspan(mesh.FirstLod, mesh.LodCount)) {
+      auto lodIndices = data.Indices.subspan(lod.FirstIndex, lod.IndexCount);
+      lod.FirstIndex  = static_cast<u32>(indices.size());
+      indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+      lods.push_back(lod);
+    }
+    meshlets.clear();
+    for (Rava::Meshlet meshlet : data.Meshlets.subspan(mesh.FirstMeshlet, mesh.MeshletCount)) {
+      meshlet.FirstIndex -= mesh.FirstIndex;
+      meshlets.push_back(meshlet);
+    }
+
+    auto vertices = data.Vertices.subspan(mesh.FirstVertex, mesh.VertexCount);
+    meshes.push_back(AddMesh(vertices, indices, lods, meshlets));
+  }
+  return meshes;
+}
+
+u32 GpuScene::AddMesh(
+    std::span<const Rava::Vertex> vertices, std::span<const u32> indices,
+    std::span<const Rava::MeshLod> lods, std::span<const Rava::Meshlet> meshlets
+) {
+  RV_PROFILE_FUNCTION();
+  if (!_isValid || vertices.empty() || indices.empty()) {
+    return INVALID_HANDLE;
+  }
+
+  lods = lods.first(std::min<size_t>(lods.size(), Rava::Mesh::MAX_LODS));
+  if (_meshes.size() + lods.size() + 1 > _limits.MaxMeshes) {
+    std::print("GpuScene: the mesh table is full\n");
+    return INVALID_HANDLE;
+  }
+  if (_meshlets.size() + meshlets.size() > _limits.MaxMeshlets) {
+    std::print("GpuScene: the meshlet table is full, the mesh is drawn without cluster culling\n");
+    meshlets = {};
+  }
+
+  u32 vertexCount = static_cast<u32>(vertices.size());
+  u32 indexCount  = static_cast<u32>(indices.size());
+  u32 geometry    = _geometryPool->Allocate(vertexCount, indexCount, 1);
+  if (geometry == GeometryPool::INVALID_HANDLE) {
+    std::print("GpuScene: the geometry pool is full\n");
+    return INVALID_HANDLE;
+  }
+  _geometryPool->Upload(geometry, vertices, indices, {});
+
+  // The shader dequantizes from the mesh table, the pool computes the same quantization
+  GeometryAllocation range = _geometryPool->Get(geometry);
+  GpuMesh mesh;
+  mesh.FirstIndex     = range.FirstIndex;
+  mesh.IndexCount     = lods.empty() ? indexCount : lods.front().FirstIndex;
+  mesh.VertexOffset   = static_cast<i32>(range.FirstVertex);
+  mesh.BoundingSphere = Rava::ComputeBoundingSphere(vertices);
+  mesh.LodCount       = static_cast<u32>(lods.size());
+  mesh.FirstMeshlet   = static_cast<u32>(_meshlets.size());
+  mesh.MeshletCount   = static_cast<u32>(meshlets.size());
+  if (_geometryPool->GetVertexFormat() == VertexFormat::Packed) {
+    mesh.Quantization = Rava::ComputeVertexQuantization(vertices);
+  }
+
+  u32 handle = static_cast<u32>(_meshes.size());
+  _meshes.push_back(mesh);
+  for (const Rava::MeshLod& lod : lods) {
+    GpuMesh& level     = _meshes.emplace_back(mesh);
+    level.FirstIndex   = range.FirstIndex + lod.FirstIndex;
+    level.IndexCount   = lod.IndexCount;
+    level.LodCount     = 0;
+    level.LodError     = lod.Error;
+    level.FirstMeshlet = 0;
+    level.MeshletCount = 0;
+  }
+  for (const Rava::Meshlet& meshlet : meshlets) {
+    GpuMeshlet& gpuMeshlet    = _meshlets.emplace_back();
+    gpuMeshlet.FirstIndex     = meshlet.FirstIndex;
+    gpuMeshlet.IndexCount     = meshlet.IndexCount;
+    gpuMeshlet.BoundingSphere = meshlet.BoundingSphere;
+    gpuMeshlet.Cone           = meshlet.Cone;
+  }
+  _meshGeometry.resize(_meshes.size(), geometry);
+  _meshInstanceCounts.resize(_meshes.size(), 0);
+  _isMeshTableDirty = true;
+  return handle;
+}
+
+u32 GpuScene::AddInstance(u32 mesh, const Rava::InstanceData& data) {
+  assert(mesh < _meshes.size() && "Invalid GpuScene mesh handle");
+
+  u32 instance = INVALID_HANDLE;
+  if (!_freeInstances.empty()) {
+    instance = _freeInstances.back();
+    _freeInstances.pop_back();
+  } else if (_instances.size() < _limits.MaxInstances) {
+    instance = static_cast<u32>(_instances.size());
+    _instances.emplace_back();
+    _isInstanceDirty.push_back(false);
+  } else {
+    return INVALID_HANDLE;
+  }
+
+  GpuInstance& gpuInstance = _instances[instance];
+  gpuInstance.Transform    = data.Transform;
+  gpuInstance.Color        = data.Color;
+  gpuInstance.ID           = data.ID;
+  gpuInstance.MeshIndex    = mesh;
+
+  ++_meshInstanceCounts[mesh];
+  ++_liveInstanceCount;
+  _isMeshTableDirty = true;
+  MarkInstanceDirty(instance);
+  return instance;
+}
+
+void GpuScene::UpdateInstance(u32 instance, const Rava::InstanceData& data) {
+  assert(
+      instance < _instances.size() && _instances[instance].MeshIndex != GpuInstance::INVALID_MESH
+      && "Invalid GpuScene instance handle"
+  );
+
+  GpuInstance& gpuInstance = _instances[instance];
+  gpuInstance.Transform    = data.Transform;
+  gpuInstance.Color        = data.Color;
+  gpuInstance.ID           = data.ID;
+  MarkInstanceDirty(instance);
+}
+
+void GpuScene::RemoveInstance(u32 instance) {
+  assert(
+      instance < _instances.size() && _instances[instance].MeshIndex != GpuInstance::INVALID_MESH
+      && "Invalid GpuScene instance handle"
+  );
+
+  GpuInstance& gpuInstance = _instances[instance];
+  --_meshInstanceCounts[gpuInstance.MeshIndex];
+  gpuInstance.MeshIndex = GpuInstance::INVALID_MESH;
+
+  --_liveInstanceCount;
+  _freeInstances.push_back(instance);
+  _isMeshTableDirty = true;
+  MarkInstanceDirty(instance);
+}
+
+void GpuScene::SetViewProjection(const Mat4& viewProjection) {
+  _viewProjection = viewProjection;
+  _frustumPlanes  = ExtractFrustumPlanes(viewProjection);
+}
+
+void GpuScene::UpdateMeshGeometry() {
+  u32 generation = _geometryPool->GetGeneration();
+  if (generation == _geometryGeneration) {
+    return;
+  }
+
+  // The levels move with their full mesh, which starts at the allocation
+  for (size_t i = 0; i < _meshes.size(); i += _meshes[i].LodCount + 1) {
+    GeometryAllocation range = _geometryPool->Get(_meshGeometry[i]);
+    u32 indexShift           = range.FirstIndex - _meshes[i].FirstIndex;  // wraps when moving down
+    for (size_t level = i; level <= i + _meshes[i].LodCount; ++level) {
+      _meshes[level].FirstIndex += indexShift;
+      _meshes[level].VertexOffset = static_cast<i32>(range.FirstVertex);
+    }
+  }
+  _geometryGeneration = generation;
+  _isMeshTableDirty   = true;
+}
+
+void GpuScene::MarkInstanceDirty(u32 instance) {
+  if (!_isInstanceDirty[instance]) {
+    _isInstanceDirty[instance] = true;
+    _dirtyInstances.push_back(instance);
+  }
+}
+
+void GpuScene::Cull(VkCommandBuffer commandBuffer, u32 frameIndex) {
+  RV_PROFILE_FUNCTION();
+  if (!_isValid) {
+    return;
+  }
+
+  // The buffers are shared by all frames in flight, the previous frame has to be done reading
+  // them before they are written again
+  VkMemoryBarrier barrier{};
+  barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  barrier.srcAccessMask = 0;
+  barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  vkCmdPipelineBarrier(
+      commandBuffer,
+      VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT
+          | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr
+  );
+
+  UpdateMeshGeometry();
+  UploadChanges(commandBuffer, frameIndex);
+
+  bool isGpuCulled  = _cullMode == CullMode::Gpu && !_meshes.empty();
+  bool isClustering = isGpuCulled && IsClusterCullingActive() && _clusterInstanceCount > 0;
+  if (isGpuCulled) {
+    u32 meshCount = GetMeshCount();
+    vkCmdFillBuffer(
+        commandBuffer, _meshCounterBuffer->GetBuffer(), 0, meshCount * sizeof(u32), 0
+    );
+    vkCmdFillBuffer(commandBuffer, _drawCountBuffer->GetBuffer(), 0, sizeof(u32), 0);
+  }
+  if (isClustering) {
+    ClusterCounts counts{0, _limits.MaxClusterDraws, 0, 0};
+    vkCmdUpdateBuffer(
+        commandBuffer, _clusterCountBuffer->GetBuffer(), 0, sizeof(counts), &counts
+    );
+  }
+
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  vkCmdPipelineBarrier(
+      commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 1, &barrier,
+      0, nullptr, 0, nullptr
+  );
+
+  if (!isGpuCulled) {
+    return;
+  }
+
+  CullConstants constants{};
+  std::copy(_frustumPlanes.begin(), _frustumPlanes.end(), constants.FrustumPlanes);
+  constants.InstanceCount = static_cast<u32>(_instances.size());
+  constants.MeshCount     = GetMeshCount();
+  constants.Flags         = (_isDrawIndirectCountSupported ? CULL_COMPACT : 0)
+                          | (isClustering ? CULL_CLUSTERS : 0);
+  constants.LodThreshold  = _lodCamera.ProjectionScale > 0.0f ? Config::LodErrorThreshold : 0.0f;
+  constants.LodCamera     = Vec4(_lodCamera.Position, _lodCamera.ProjectionScale);
+
+  vkCmdBindDescriptorSets(
+      commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _computePipelineLayout, 0, 1,
+      &_descriptorSet, 0, nullptr
+  );
+  vkCmdPushConstants(
+      commandBuffer, _computePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants),
+      &constants
+  );
+
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _cullPipeline);
+  vkCmdDispatch(commandBuffer, GetGroupCount(constants.InstanceCount), 1, 1);
+
+  barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+  vkCmdPipelineBarrier(
+      commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+      1, &barrier, 0, nullptr, 0, nullptr
+  );
+
+  // Both only read what the cull pass wrote, so they need no barrier between them
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _compactPipeline);
+  vkCmdDispatch(commandBuffer, GetGroupCount(constants.MeshCount), 1, 1);
+  if (isClustering) {
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _clusterPipeline);
+    vkCmdDispatch(commandBuffer, std::min(_clusterInstanceCount, MAX_CLUSTER_GROUPS), 1, 1);
+  }
+
+  barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+  vkCmdPipelineBarrier(
+      commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0, 1, &barrier, 0,
+      nullptr, 0, nullptr
+  );
+}
+
+void GpuScene::UploadChanges(VkCommandBuffer commandBuffer, u32 frameIndex) {
+  u32 newMeshletCount = static_cast<u32>(_meshlets.size()) - _uploadedMeshletCount;
+  if (!_isMeshTableDirty && _dirtyInstances.empty() && newMeshletCount == 0) {
+    return;
+  }
+
+  // Every mesh owns a range of the visible list as large as its instance count, its levels as
+  // large as that of their full mesh
+  if (_isMeshTableDirty) {
+    u32 instanceOffset = 0;
+    for (size_t i = 0; i < _meshes.size(); i += _meshes[i].LodCount + 1) {
+      for (size_t level = i; level <= i + _meshes[i].LodCount; ++level) {
+        _meshes[level].InstanceOffset = instanceOffset;
+        instanceOffset += _meshInstanceCounts[i];
+      }
+    }
+
+    _clusterInstanceCount = 0;
+    for (size_t i = 0; i < _meshes.size(); i += _meshes[i].LodCount + 1) {
+      _clusterInstanceCount += _meshes[i].MeshletCount > 0 ? _meshInstanceCounts[i] : 0;
+    }
+  }
+
+  VkDeviceSize meshBytes     = _isMeshTableDirty ? _meshes.size() * sizeof(GpuMesh) : 0;
+  VkDeviceSize meshletBytes  = newMeshletCount * sizeof(GpuMeshlet);
+  VkDeviceSize instanceBytes = _dirtyInstances.size() * sizeof(GpuInstance);
+
+  Buffer& stagingBuffer = GetStagingBuffer(frameIndex, meshBytes + meshletBytes + instanceBytes);
+  auto* mapped          = static_cast<u8*>(stagingBuffer.GetMappedMemory());
+
+  if (meshBytes > 0) {
+    memcpy(mapped, _meshes.data(), meshBytes);
+    VkBufferCopy meshCopy{0, 0, meshBytes};
+    vkCmdCopyBuffer(
+        commandBuffer, stagingBuffer.GetBuffer(), _meshBuffer->GetBuffer(), 1, &meshCopy
+    );
+    _isMeshTableDirty = false;
+  }
+
+  if (meshletBytes > 0) {
+    memcpy(mapped + meshBytes, _meshlets.data() + _uploadedMeshletCount, meshletBytes);
+    VkBufferCopy meshletCopy{meshBytes, _uploadedMeshletCount * sizeof(GpuMeshlet), meshletBytes};
+    vkCmdCopyBuffer(
+        commandBuffer, stagingBuffer.GetBuffer(), _meshletBuffer->GetBuffer(), 1, &meshletCopy
+    );
+    _uploadedMeshletCount = static_cast<u32>(_meshlets.size());
+  }
+
+  // Sorted, so neighbouring slots share one copy region
+  std::sort(_dirtyInstances.begin(), _dirtyInstances.end());
+
+  Rava::ScratchScope scratch;
+  std::pmr::vector<VkBufferCopy> instanceCopies(scratch.GetResource());
+  VkDeviceSize srcOffset = meshBytes + meshletBytes;
+  for (u32 instance : _dirtyInstances) {
+    memcpy(mapped + srcOffset, &_instances[instance], sizeof(GpuInstance));
+    _isInstanceDirty[instance] = false;
+
+    VkDeviceSize dstOffset = instance * sizeof(GpuInstance);
+    if (!instanceCopies.empty()
+        && instanceCopies.back().dstOffset + instanceCopies.back().size == dstOffset) {
+      instanceCopies.back().size += sizeof(GpuInstance);
+    } else {
+      instanceCopies.push_back({srcOffset, dstOffset, sizeof(GpuInstance)});
+    }
+    srcOffset += sizeof(GpuInstance);
+  }
+  _dirtyInstances.clear();
+
+  if (!instanceCopies.empty()) {
+    vkCmdCopyBuffer(
+        commandBuffer, stagingBuffer.GetBuffer(), _instanceBuffer->GetBuffer(),
+        static_cast<u32>(instanceCopies.size()), instanceCopies.data()
+    );
+  }
+}
+
+Buffer& GpuScene::GetStagingBuffer(u32 frameIndex, VkDeviceSize size) {
+  Unique<Buffer>& buffer = _stagingBuffers[frameIndex];
+  if (buffer && buffer->GetBufferSize() >= size) {
+    return *buffer;
+  }
+
+  // Only the upload copies of the frames in this slot read it and Cull runs after the slot wait.
+  // Powers of two so a scene that keeps adding instances does not grow it every frame
+  VkDeviceSize capacity = std::max(std::bit_ceil(size), MIN_STAGING_SIZE);
+  buffer                = std::make_unique<Buffer>(
+      _context, 1, static_cast<u32>(capacity), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+  );
+  return *buffer;
+}
+
+void GpuScene::Draw(CommandRecorder& recorder) {
+  RV_PROFILE_FUNCTION();
+  _drawCallCount = 0;
+  if (!_isValid || _meshes.empty()) {
+    return;
+  }
+
+  // One draw per visible instance, the slots are split between the job threads
+  if (_cullMode == CullMode::Cpu) {
+    std::atomic<u32> drawCallCount{0};
+    recorder.RecordParallel(
+        static_cast<u32>(_instances.size()), CPU_DRAW_BATCH_SIZE,
+        [&](VkCommandBuffer commandBuffer, u32 begin, u32 end) {
+          BindDrawState(commandBuffer);
+          drawCallCount.fetch_add(
+              DrawCpuCulled(commandBuffer, begin, end), std::memory_order_relaxed
+          );
+        }
+    );
+    _drawCallCount = drawCallCount.load(std::memory_order_relaxed);
+    return;
+  }
+
+  VkCommandBuffer commandBuffer = recorder.GetCommandBuffer();
+  BindDrawState(commandBuffer);
+
+  constexpr u32 stride = sizeof(VkDrawIndexedIndirectCommand);
+  VkBuffer drawBuffer  = _drawCommandBuffer->GetBuffer();
+  u32 meshCount        = GetMeshCount();
+  if (_isDrawIndirectCountSupported) {
+    vkCmdDrawIndexedIndirectCount(
+        commandBuffer, drawBuffer, 0, _drawCountBuffer->GetBuffer(), 0, meshCount, stride
+    );
+    _drawCallCount = 1;
+  } else if (_context->GetEnabledFeatures().multiDrawIndirect) {
+    vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer, 0, meshCount, stride);
+    _drawCallCount = 1;
+  } else {
+    for (u32 i = 0; i < meshCount; ++i) {
+      vkCmdDrawIndexedIndirect(commandBuffer, drawBuffer, i * stride, 1, stride);
+    }
+    _drawCallCount = meshCount;
+  }
+
+  // The cluster draws carry the instance slot as their first instance
+  if (IsClusterCullingActive() && _clusterInstanceCount > 0) {
+    u32 isIndirect = 0;
+    vkCmdPushConstants(
+        commandBuffer, _graphicsPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+        offsetof(DrawConstants, IsIndirect), sizeof(u32), &isIndirect
+    );
+    vkCmdDrawIndexedIndirectCount(
+        commandBuffer, _clusterDrawBuffer->GetBuffer(), 0, _clusterCountBuffer->GetBuffer(),
+        offsetof(ClusterCounts, DrawCount), _limits.MaxClusterDraws, stride
+    );
+    ++_drawCallCount;
+  }
+}
+
+void GpuScene::BindDrawState(VkCommandBuffer commandBuffer) const {
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _graphicsPipeline);
+  vkCmdBindDescriptorSets(
+      commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _graphicsPipelineLayout, 0, 1,
+      &_descriptorSet, 0, nullptr
+  );
+
+  DrawConstants constants{};
+  constants.ViewProjection = _viewProjection;
+  constants.IsIndirect     = _cullMode == CullMode::Gpu;
+  vkCmdPushConstants(
+      commandBuffer, _graphicsPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants),
+      &constants
+  );
+}
+
+u32 GpuScene::DrawCpuCulled(VkCommandBuffer commandBuffer, u32 begin, u32 end) const {
+  f32 threshold     = _lodCamera.ProjectionScale > 0.0f ? Config::LodErrorThreshold : 0.0f;
+  u32 drawCallCount = 0;
+  for (u32 i = begin; i < end; ++i) {
+    const GpuInstance& instance = _instances[i];
+    if (instance.MeshIndex == GpuInstance::INVALID_MESH) {
+      continue;
+    }
+
+    u32 meshIndex
+        = SelectLodMesh(_meshes, instance.MeshIndex, instance, _lodCamera, threshold);
+    const GpuMesh& mesh = _meshes[meshIndex];
+    if (IsInstanceVisible(_frustumPlanes, instance, mesh)) {
+      vkCmdDrawIndexed(commandBuffer, mesh.IndexCount, 1, mesh.FirstIndex, mesh.VertexOffset, i);
+      ++drawCallCount;
+    }
+  }
+  return drawCallCount;
+}
+}  // namespace VK
\ No newline at end of file
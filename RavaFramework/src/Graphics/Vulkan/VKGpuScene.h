@@ -0,0 +1,195 @@
+#pragma once
+
+#include "Graphics/Model.h"
+#include "Graphics/VertexPacking.h"
+
+namespace VK {
+class Buffer;
+class CommandRecorder;
+class Context;
+class GeometryPool;
+struct PipelineTarget;
+
+// Mirrors of the std430 structs in Shaders/GpuScene.inc
+struct GpuMesh {
+  u32 FirstIndex     = 0;
+  u32 IndexCount     = 0;
+  i32 VertexOffset   = 0;
+  u32 InstanceOffset = 0;     // first slot of the mesh in the visible instance list
+  Vec4 BoundingSphere{0.0f};  // mesh space center and radius
+  // Dequantizes the positions in the vertex shader with VertexFormat::Packed
+  Rava::VertexQuantization Quantization;
+  // A full mesh is followed by LodCount meshes with its simplified levels, LodError is the error of
+  // such a level in mesh space units
+  u32 LodCount = 0;
+  f32 LodError = 0.0f;
+  // Meshlets of a full mesh in the meshlet table, levels have none and are always drawn whole
+  u32 FirstMeshlet = 0;
+  u32 MeshletCount = 0;
+};
+
+struct GpuMeshlet {
+  u32 FirstIndex = 0;  // relative to the FirstIndex of its mesh, which moves with defragmentation
+  u32 IndexCount = 0;
+  u32 Padding[2]{};
+  Vec4 BoundingSphere{0.0f};
+  Vec4 Cone{0.0f, 0.0f, 0.0f, 1.0f};  // see Rava::Meshlet
+};
+
+struct GpuInstance {
+  static constexpr u32 INVALID_MESH = ~0u;  // removed instance, skipped by the culling
+
+  Mat4 Transform{1.0f};
+  Vec4 Color{1.0f};
+  u32 MeshIndex = INVALID_MESH;
+  u32 ID        = 0;
+  u32 Padding[2]{};
+};
+
+struct GpuSceneLimits {
+  u32 MaxMeshes       = 4096;
+  u32 MaxInstances    = 1u << 20;
+  u32 MaxMeshlets     = 1u << 16;  // about the meshlets of a full default geometry pool
+  u32 MaxClusterDraws = 1u << 18;  // visible meshlets per frame, the rest is dropped
+};
+
+enum class CullMode {
+  Gpu,  // compute culling writes the draws, the CPU records a constant number of commands
+  Cpu,  // frustum test on the host and one draw per visible instance, for comparison
+};
+
+// GPU driven renderer for persistent instances. The geometry of every mesh lives in the renderer's
+// GeometryPool, instances stay on the GPU and only changed ones are uploaded. Each
+// frame a compute pass frustum culls all instances and compacts the survivors per mesh, a second
+// one writes the VkDrawIndexedIndirectCommands and their count, so drawing the whole scene is a
+// single vkCmdDrawIndexedIndirectCount. Without drawIndirectCount every mesh keeps its command
+// slot (empty ones have an instance count of 0) and vkCmdDrawIndexedIndirect draws all of them.
+// Meshes with LODs draw each visible instance with the coarsest level whose projected error stays
+// below Config::LodErrorThreshold, every level is a mesh of its own in the tables.
+// Full meshes with meshlets take the cluster culling path instead: a third compute pass tests the
+// meshlets of their visible instances against the frustum and their normal cones and writes one
+// indirect draw per surviving meshlet. It only needs compute and drawIndirectCount, no mesh
+// shaders, and without drawIndirectCount those meshes are drawn whole.
+class GpuScene {
+public:
+  static constexpr u32 INVALID_HANDLE = ~0u;
+
+public:
+  GpuScene(
+      Shared<Context> context, Shared<GeometryPool> geometryPool, const PipelineTarget& target,
+      u32 frameCount, const GpuSceneLimits& limits = {}
+  );
+  ~GpuScene();
+
+  NO_COPY(GpuScene)
+  NO_MOVE(GpuScene)
+
+  // False when the device lacks the required features or the shaders failed to load
+  inline bool IsValid() const { return _isValid; }
+
+  // Uploads into the geometry pool through the staging ring, main thread. AddModel returns one mesh
+  // handle per Rava::Mesh, AddMesh INVALID_HANDLE once the pool or the mesh table is full. The lods
+  // and meshlets point into indices, the full mesh are the indices before the first level.
+  std::vector<u32> AddModel(const Rava::ModelData& data);
+  u32 AddMesh(
+      std::span<const Rava::Vertex> vertices, std::span<const u32> indices,
+      std::span<const Rava::MeshLod> lods = {}, std::span<const Rava::Meshlet> meshlets = {}
+  );
+
+  // Instances persist across frames, changes reach the GPU with the next Cull
+  u32 AddInstance(u32 mesh, const Rava::InstanceData& instance);
+  void UpdateInstance(u32 instance, const Rava::InstanceData& data);
+  void RemoveInstance(u32 instance);
+
+  void SetViewProjection(const Mat4& viewProjection);
+  inline void SetLodCamera(const Rava::LodCamera& camera) { _lodCamera = camera; }
+  inline void SetCullMode(CullMode mode) { _cullMode = mode; }
+  inline CullMode GetCullMode() const { return _cullMode; }
+  inline void SetClusterCulling(bool isEnabled) { _isClusterCullingEnabled = isEnabled; }
+  // Only with CullMode::Gpu and drawIndirectCount, meshes with meshlets are drawn whole otherwise
+  inline bool IsClusterCullingActive() const {
+    return _isClusterCullingEnabled && _isDrawIndirectCountSupported && _cullMode == CullMode::Gpu;
+  }
+
+  // Outside of a render pass, once the frame that last used frameIndex finished
+  void Cull(VkCommandBuffer commandBuffer, u32 frameIndex);
+  // Inside the swap chain render pass, after Cull. CullMode::Cpu records its draws in parallel.
+  void Draw(CommandRecorder& recorder);
+  // The graphics pipeline has to match the swap chain formats
+  void SetPipelineTarget(const PipelineTarget& target);
+
+  inline u32 GetMeshCount() const { return static_cast<u32>(_meshes.size()); }
+  inline u32 GetInstanceCount() const { return _liveInstanceCount; }
+  // Draw calls recorded by the CPU in the latest Draw
+  inline u32 GetDrawCallCount() const { return _drawCallCount; }
+  inline bool IsDrawIndirectCountSupported() const { return _isDrawIndirectCountSupported; }
+
+private:
+  Shared<Context> _context;
+  Shared<GeometryPool> _geometryPool;
+  GpuSceneLimits _limits;
+  bool _isValid                      = false;
+  bool _isDrawIndirectCountSupported = false;
+  bool _isClusterCullingEnabled      = true;
+  CullMode _cullMode                 = CullMode::Gpu;
+
+  Unique<Buffer> _meshBuffer;
+  Unique<Buffer> _instanceBuffer;
+  Unique<Buffer> _visibleInstanceBuffer;
+  Unique<Buffer> _meshCounterBuffer;
+  Unique<Buffer> _drawCommandBuffer;
+  Unique<Buffer> _drawCountBuffer;
+  Unique<Buffer> _meshletBuffer;
+  Unique<Buffer> _clusterCountBuffer;  // draw count first, so it is the count of the cluster draws
+  Unique<Buffer> _clusterInstanceBuffer;
+  Unique<Buffer> _clusterDrawBuffer;
+  std::vector<Unique<Buffer>> _stagingBuffers;  // per frame in flight
+
+  std::vector<GpuMesh> _meshes;
+  std::vector<u32> _meshGeometry;  // GeometryPool handles, shared by a mesh and its levels
+  std::vector<u32> _meshInstanceCounts;
+  u32 _geometryGeneration = 0;
+  bool _isMeshTableDirty  = false;
+
+  std::vector<GpuMeshlet> _meshlets;
+  u32 _uploadedMeshletCount = 0;  // the table only grows, new meshlets are appended
+  u32 _clusterInstanceCount = 0;  // instances of meshes with meshlets, bounds the cluster pass
+
+  std::vector<GpuInstance> _instances;
+  std::vector<u32> _freeInstances;
+  std::vector<u32> _dirtyInstances;
+  std::vector<bool> _isInstanceDirty;
+  u32 _liveInstanceCount = 0;
+
+  Mat4 _viewProjection{1.0f};
+  std::array<Vec4, 6> _frustumPlanes{};
+  Rava::LodCamera _lodCamera;
+  u32 _drawCallCount = 0;
+
+  VkDescriptorSetLayout _descriptorSetLayout = VK_NULL_HANDLE;
+  VkDescriptorPool _descriptorPool           = VK_NULL_HANDLE;
+  VkDescriptorSet _descriptorSet             = VK_NULL_HANDLE;
+  VkPipelineLayout _computePipelineLayout    = VK_NULL_HANDLE;
+  VkPipelineLayout _graphicsPipelineLayout   = VK_NULL_HANDLE;
+  VkPipeline _cullPipeline                   = VK_NULL_HANDLE;
+  VkPipeline _compactPipeline                = VK_NULL_HANDLE;
+  VkPipeline _clusterPipeline                = VK_NULL_HANDLE;
+  VkPipeline _graphicsPipeline               = VK_NULL_HANDLE;
+
+private:
+  void CreateBuffers();
+  void CreateDescriptors();
+  bool CreateComputePipelines();
+  bool CreateGraphicsPipeline(const PipelineTarget& target);
+
+  void MarkInstanceDirty(u32 instance);
+  // Follows the geometry pool after it defragmented
+  void UpdateMeshGeometry();
+  void UploadChanges(VkCommandBuffer commandBuffer, u32 frameIndex);
+  Buffer& GetStagingBuffer(u32 frameIndex, VkDeviceSize size);
+  // Pipeline, descriptor set and constants, every secondary command buffer needs its own
+  void BindDrawState(VkCommandBuffer commandBuffer) const;
+  // Instances [begin, end), returns the number of draw calls. Thread safe.
+  u32 DrawCpuCulled(VkCommandBuffer commandBuffer, u32 begin, u32 end) const;
+};
+}  // namespace VK
\ No newline at end of file
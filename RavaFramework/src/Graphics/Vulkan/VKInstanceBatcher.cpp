@@ -0,0 +1,163 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Vulkan/VKInstanceBatcher.h"
+
+#include "Core/CpuProfiler.h"
+#include "Core/FrameAllocator.h"
+#include "Graphics/Vulkan/VKBuffer.h"
+#include "Graphics/Vulkan/VKCommandRecorder.h"
+#include "Graphics/Vulkan/VKContext.h"
+#include "Graphics/Vulkan/VKModel.h"
+
+namespace VK {
+static constexpr u32 MIN_INSTANCE_CAPACITY = 1024;
+static constexpr u32 DRAW_BATCH_SIZE       = 512;  // batches per secondary command buffer
+
+std::vector<VkVertexInputBindingDescription> Instance::GetBindingDescriptions() {
+  std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+  bindingDescriptions[0].binding   = BINDING;
+  bindingDescriptions[0].stride    = sizeof(Rava::InstanceData);
+  bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+  return bindingDescriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> Instance::GetAttributeDescriptions() {
+  constexpr u32 transform = offsetof(Rava::InstanceData, Transform);
+  constexpr u32 color     = offsetof(Rava::InstanceData, Color);
+  constexpr u32 id        = offsetof(Rava::InstanceData, ID);
+  constexpr u32 column    = sizeof(Vec4);
+  constexpr u32 location  = FIRST_LOCATION;
+
+  // The transform takes one location per column
+  std::vector<VkVertexInputAttributeDescription> attributeDescriptions{
+      {location + 0, BINDING, VK_FORMAT_R32G32B32A32_SFLOAT, transform             },
+      {location + 1, BINDING, VK_FORMAT_R32G32B32A32_SFLOAT, transform + column    },
+      {location + 2, BINDING, VK_FORMAT_R32G32B32A32_SFLOAT, transform + column * 2},
+      {location + 3, BINDING, VK_FORMAT_R32G32B32A32_SFLOAT, transform + column * 3},
+      {location + 4, BINDING, VK_FORMAT_R32G32B32A32_SFLOAT, color                 },
+      {location + 5, BINDING, VK_FORMAT_R32_UINT,            id                    },
+  };
+  return attributeDescriptions;
+}
+
+InstanceBatcher::InstanceBatcher(Shared<Context> context, u32 frameCount)
+    : _context(context), _instanceBuffers(frameCount) {}
+
+InstanceBatcher::~InstanceBatcher() {}
+
+void InstanceBatcher::Submit(
+    const Model* model, u32 meshIndex, u32 lod, std::span<const Rava::InstanceData> instances
+) {
+  if (instances.empty()) {
+    return;
+  }
+
+  FrameLists& frame        = GetFrameLists();
+  Submission& submission   = frame.Submissions.emplace_back();
+  submission.BatchModel    = model;
+  submission.MeshIndex     = meshIndex;
+  submission.Lod           = lod;
+  submission.FirstInstance = static_cast<u32>(frame.Instances.size());
+  submission.InstanceCount = static_cast<u32>(instances.size());
+  frame.Instances.insert(frame.Instances.end(), instances.begin(), instances.end());
+}
+
+void InstanceBatcher::Flush(CommandRecorder& recorder, u32 frameIndex) {
+  RV_PROFILE_FUNCTION();
+  _drawCallCount = 0;
+  _instanceCount = 0;
+
+  if (!_frame || _frame->Submissions.empty()) {
+    _frame.reset();
+    return;
+  }
+
+  std::pmr::vector<Submission>& submissions = _frame->Submissions;
+  std::pmr::vector<Batch>& batches          = _frame->Batches;
+  _instanceCount                            = static_cast<u32>(_frame->Instances.size());
+  _submissionCount                          = static_cast<u32>(submissions.size());
+
+  // Groups equal model/mesh/LOD triples, FirstInstance keeps the submission order within a group
+  std::sort(submissions.begin(), submissions.end(), [](const auto& a, const auto& b) {
+    return std::tie(a.BatchModel, a.MeshIndex, a.Lod, a.FirstInstance)
+         < std::tie(b.BatchModel, b.MeshIndex, b.Lod, b.FirstInstance);
+  });
+
+  Buffer& instanceBuffer = GetInstanceBuffer(frameIndex, _instanceCount);
+  auto* mapped           = static_cast<Rava::InstanceData*>(instanceBuffer.GetMappedMemory());
+
+  auto isSameBatch = [](const Submission& a, const Submission& b) {
+    return a.BatchModel == b.BatchModel && a.MeshIndex == b.MeshIndex && a.Lod == b.Lod;
+  };
+
+  // Host coherent memory, visible to the GPU once the frame is submitted
+  batches.reserve(_batchCount);
+  u32 written = 0;
+  size_t i    = 0;
+  while (i < submissions.size()) {
+    Batch& batch        = batches.emplace_back();
+    batch.First         = &submissions[i];
+    batch.FirstInstance = written;
+
+    for (; i < submissions.size() && isSameBatch(submissions[i], *batch.First); ++i) {
+      const Submission& submission = submissions[i];
+      memcpy(
+          mapped + written, _frame->Instances.data() + submission.FirstInstance,
+          submission.InstanceCount * sizeof(Rava::InstanceData)
+      );
+      written += submission.InstanceCount;
+    }
+    batch.InstanceCount = written - batch.FirstInstance;
+  }
+  _batchCount = static_cast<u32>(batches.size());
+
+  // Models only read their ranges from the geometry pool while drawing
+  std::atomic<u32> drawCallCount{0};
+  VkBuffer instanceVkBuffer = instanceBuffer.GetBuffer();
+  recorder.RecordParallel(
+      static_cast<u32>(batches.size()), DRAW_BATCH_SIZE,
+      [&](VkCommandBuffer commandBuffer, u32 begin, u32 end) {
+        VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(commandBuffer, Instance::BINDING, 1, &instanceVkBuffer, &offset);
+
+        u32 count = 0;
+        for (u32 index = begin; index < end; ++index) {
+          const Batch& batch = batches[index];
+          count += batch.First->BatchModel->DrawInstanced(
+              commandBuffer, batch.FirstInstance, batch.InstanceCount, batch.First->MeshIndex,
+              batch.First->Lod
+          );
+        }
+        drawCallCount.fetch_add(count, std::memory_order_relaxed);
+      }
+  );
+  _drawCallCount = drawCallCount.load(std::memory_order_relaxed);
+
+  // The memory goes back when the frame allocator resets the slot
+  _frame.reset();
+}
+
+InstanceBatcher::FrameLists& InstanceBatcher::GetFrameLists() {
+  if (!_frame) {
+    _frame.emplace(Rava::FrameAllocator::GetResource());
+    _frame->Instances.reserve(_instanceCount);
+    _frame->Submissions.reserve(_submissionCount);
+  }
+  return *_frame;
+}
+
+Buffer& InstanceBatcher::GetInstanceBuffer(u32 frameIndex, u32 instanceCount) {
+  Unique<Buffer>& buffer = _instanceBuffers[frameIndex];
+  if (buffer && buffer->GetInstanceCount() >= instanceCount) {
+    return *buffer;
+  }
+
+  // The previous frame using this slot has finished, so the old buffer can go right away
+  u32 capacity = std::max(std::bit_ceil(instanceCount), MIN_INSTANCE_CAPACITY);
+  buffer       = std::make_unique<Buffer>(
+      _context, sizeof(Rava::InstanceData), capacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+  );
+  return *buffer;
+}
+}  // namespace VK
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Graphics/Model.h"
+
+namespace VK {
+class Buffer;
+class CommandRecorder;
+class Context;
+class Model;
+
+struct Instance : public Rava::InstanceData {
+  static constexpr u32 BINDING        = 1;
+  static constexpr u32 FIRST_LOCATION = 4;  // after the Vertex attributes
+
+  static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions();
+  static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions();
+};
+
+// Collects the instances submitted during a frame and draws every model/mesh/LOD once with the
+// combined instance count. Each frame in flight owns a host visible instance buffer, it grows when
+// a frame submits more instances than it holds. The submissions of a frame live in the frame
+// allocator and are sorted instead of hashed, so a steady stream of frames does not touch the heap.
+// The batches are recorded in parallel.
+class InstanceBatcher {
+public:
+  InstanceBatcher(Shared<Context> context, u32 frameCount);
+  ~InstanceBatcher();
+
+  NO_COPY(InstanceBatcher)
+  NO_MOVE(InstanceBatcher)
+
+  // lod 0 is the full mesh, see Model::DrawInstanced
+  void Submit(
+      const Model* model, u32 meshIndex, u32 lod, std::span<const Rava::InstanceData> instances
+  );
+  // Once per frame inside the render pass, after the frame that last used frameIndex finished
+  void Flush(CommandRecorder& recorder, u32 frameIndex);
+
+  // Of the latest flush
+  inline u32 GetDrawCallCount() const { return _drawCallCount; }
+  inline u32 GetInstanceCount() const { return _instanceCount; }
+
+private:
+  struct Submission {
+    const Model* BatchModel = nullptr;
+    u32 MeshIndex           = 0;
+    u32 Lod                 = 0;
+    u32 FirstInstance       = 0;  // into FrameLists::Instances
+    u32 InstanceCount       = 0;
+  };
+
+  // Equal submissions merged, instances are in the instance buffer of the frame
+  struct Batch {
+    const Submission* First = nullptr;
+    u32 FirstInstance       = 0;
+    u32 InstanceCount       = 0;
+  };
+
+  // Bound to the frame slot current at the first submission, dropped by Flush. Reserved with the
+  // sizes of the previous frame so the lists do not regrow inside the arena.
+  struct FrameLists {
+    explicit FrameLists(std::pmr::memory_resource* resource)
+        : Instances(resource), Submissions(resource), Batches(resource) {}
+
+    std::pmr::vector<Rava::InstanceData> Instances;
+    std::pmr::vector<Submission> Submissions;
+    std::pmr::vector<Batch> Batches;
+  };
+
+  Shared<Context> _context;
+  std::vector<Unique<Buffer>> _instanceBuffers;
+  std::optional<FrameLists> _frame;
+  u32 _drawCallCount   = 0;
+  u32 _instanceCount   = 0;
+  u32 _submissionCount = 0;  // of the latest flush
+  u32 _batchCount      = 0;
+
+private:
+  FrameLists& GetFrameLists();
+  Buffer& GetInstanceBuffer(u32 frameIndex, u32 instanceCount);
+};
+}  // namespace VK
\ No newline at end of file
@@ -1,4 +1,233 @@
 #include "RavaFramework.h"
 
 #include "Graphics/Vulkan/VKModel.h"
-#include "Graphics/ModelLoader/ufbxLoader.h"
\ No newline at end of file
+
+#include "Core/Config.h"
+#include "Core/FrameAllocator.h"
+#include "Graphics/VertexPacking.h"
+#include "Graphics/Vulkan/VKContext.h"
+#include "Graphics/Vulkan/VKGeometryPool.h"
+#include "Graphics/Vulkan/VKInstanceBatcher.h"
+#include "Graphics/Vulkan/VKRenderer.h"
+#include "Graphics/Vulkan/VKUploader.h"
+
+namespace VK {
+// Non indexed models are drawn in one go, so all their vertices share one quantization
+static std::span<const Rava::Mesh> GetQuantizedMeshes(const Rava::ModelData& data) {
+  return data.Indices.empty() ? std::span<const Rava::Mesh>{} : data.Meshes;
+}
+
+u32 Vertex::GetStride(VertexFormat format) {
+  return format == VertexFormat::Packed ? sizeof(Rava::PackedVertex) : sizeof(Rava::Vertex);
+}
+
+std::vector<VkVertexInputBindingDescription> Vertex::GetBindingDescriptions() {
+  return GetBindingDescriptions(Config::SelectedVertexFormat);
+}
+
+std::vector<VkVertexInputAttributeDescription> Vertex::GetAttributeDescriptions() {
+  return GetAttributeDescriptions(Config::SelectedVertexFormat);
+}
+
+std::vector<VkVertexInputBindingDescription> Vertex::GetBindingDescriptions(VertexFormat format) {
+  std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+  bindingDescriptions[0].binding   = 0;
+  bindingDescriptions[0].stride    = GetStride(format);
+  bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+  if (format == VertexFormat::Packed) {
+    bindingDescriptions.push_back({QUANTIZATION_BINDING, 0, VK_VERTEX_INPUT_RATE_INSTANCE});
+  }
+  return bindingDescriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> Vertex::GetAttributeDescriptions(
+    VertexFormat format
+) {
+  if (format == VertexFormat::Float) {
+    return {
+        {0, 0, VK_FORMAT_R32G32B32_SFLOAT,    offsetof(Rava::Vertex, Position)},
+        {1, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(Rava::Vertex, Color)   },
+        {2, 0, VK_FORMAT_R32G32B32_SFLOAT,    offsetof(Rava::Vertex, Normal)  },
+        {3, 0, VK_FORMAT_R32G32_SFLOAT,       offsetof(Rava::Vertex, UV)      },
+    };
+  }
+
+  constexpr u32 position = offsetof(Rava::PackedVertex, Position);
+  constexpr u32 color    = offsetof(Rava::PackedVertex, Color);
+  constexpr u32 normal   = offsetof(Rava::PackedVertex, Normal);
+  constexpr u32 uv       = offsetof(Rava::PackedVertex, UV);
+  constexpr u32 offset   = offsetof(Rava::VertexQuantization, Offset);
+  constexpr u32 scale    = offsetof(Rava::VertexQuantization, Scale);
+  constexpr u32 location = QUANTIZATION_FIRST_LOCATION;
+  constexpr u32 binding  = QUANTIZATION_BINDING;
+  return {
+      {0,            0,       VK_FORMAT_R16G16B16A16_UNORM,  position},
+      {1,            0,       VK_FORMAT_R8G8B8A8_UNORM,      color   },
+      {2,            0,       VK_FORMAT_R16G16_SNORM,        normal  },
+      {3,            0,       VK_FORMAT_R16G16_SFLOAT,       uv      },
+      {location + 0, binding, VK_FORMAT_R32G32B32A32_SFLOAT, offset  },
+      {location + 1, binding, VK_FORMAT_R32G32B32A32_SFLOAT, scale   },
+  };
+}
+
+Model::Model(
+    Shared<Context> context, Shared<GeometryPool> geometryPool, const Rava::ModelData& data
+)
+    : _context(context), _geometryPool(geometryPool) {
+  if (AllocateGeometry(data, true)) {
+    _geometryPool->Upload(_geometry, data.Vertices, data.Indices, GetQuantizedMeshes(data));
+  }
+}
+
+Model::Model(
+    Shared<Context> context, Shared<GeometryPool> geometryPool, const Rava::ModelData& data,
+    std::vector<BufferUpload>& uploads
+)
+    : _context(context), _geometryPool(geometryPool) {
+  if (AllocateGeometry(data, false)) {
+    _geometryPool->PrepareUpload(
+        _geometry, data.Vertices, data.Indices, GetQuantizedMeshes(data), uploads
+    );
+  }
+}
+
+Model::~Model() {
+  if (IsValid()) {
+    _geometryPool->Free(_geometry);
+  }
+}
+
+bool Model::AllocateGeometry(const Rava::ModelData& data, bool isResident) {
+  _meshes.assign(data.Meshes.begin(), data.Meshes.end());
+  _lods.assign(data.Lods.begin(), data.Lods.end());
+  _meshBounds.clear();
+  if (!_lods.empty()) {
+    for (const Rava::Mesh& mesh : _meshes) {
+      auto vertices = data.Vertices.subspan(mesh.FirstVertex, mesh.VertexCount);
+      _meshBounds.push_back(Rava::ComputeBoundingSphere(vertices));
+    }
+  }
+  _vertexCount = static_cast<u32>(data.Vertices.size());
+  _indexCount  = static_cast<u32>(data.Indices.size());
+  assert(_vertexCount >= 3 && "Vertex count must be at least 3");
+
+  u32 meshCount = std::max(static_cast<u32>(GetQuantizedMeshes(data).size()), 1u);
+  _geometry     = _geometryPool->Allocate(_vertexCount, _indexCount, meshCount, isResident);
+  if (!IsValid()) {
+    std::print("Geometry pool is full, can not create a Model with {} vertices\n", _vertexCount);
+    return false;
+  }
+  return true;
+}
+
+void Model::Draw() {
+  auto* renderer                = static_cast<Renderer*>(Rava::Renderer::Instance.get());
+  VkCommandBuffer commandBuffer = renderer->GetCurrentCommandBuffer();
+  GeometryAllocation geometry   = _geometryPool->Get(_geometry);
+
+  if (_indexCount == 0) {
+    _geometryPool->BindQuantization(commandBuffer, geometry, 0);
+    vkCmdDraw(commandBuffer, _vertexCount, 1, geometry.FirstVertex, 0);
+    return;
+  }
+
+  for (u32 i = 0; i < _meshes.size(); ++i) {
+    const Rava::Mesh& mesh = _meshes[i];
+    _geometryPool->BindQuantization(commandBuffer, geometry, i);
+    vkCmdDrawIndexed(
+        commandBuffer, mesh.IndexCount, 1, geometry.FirstIndex + mesh.FirstIndex,
+        static_cast<i32>(geometry.FirstVertex + mesh.FirstVertex), 0
+    );
+  }
+}
+
+void Model::Submit(std::span<const Rava::InstanceData> instances, u32 meshIndex) {
+  assert(meshIndex == ALL_MESHES || meshIndex < _meshes.size());
+  auto* renderer           = static_cast<Renderer*>(Rava::Renderer::Instance.get());
+  InstanceBatcher& batcher = renderer->GetInstanceBatcher();
+  if (_lods.empty() || Config::LodErrorThreshold <= 0.0f) {
+    batcher.Submit(this, meshIndex, 0, instances);
+    return;
+  }
+
+  // Every mesh picks its own level per instance, so ALL_MESHES is split into single meshes
+  Rava::ScratchScope scratch;
+  auto sorted            = scratch.AllocateArray<Rava::InstanceData>(instances.size());
+  Rava::LodCamera camera = renderer->GetLodCamera();
+
+  u32 first = meshIndex == ALL_MESHES ? 0 : meshIndex;
+  u32 end   = meshIndex == ALL_MESHES ? static_cast<u32>(_meshes.size()) : meshIndex + 1;
+  for (u32 i = first; i < end; ++i) {
+    SubmitLods(batcher, camera, i, instances, sorted);
+  }
+}
+
+void Model::SubmitLods(
+    InstanceBatcher& batcher, const Rava::LodCamera& camera, u32 meshIndex,
+    std::span<const Rava::InstanceData> instances, std::span<Rava::InstanceData> sorted
+) {
+  const Rava::Mesh& mesh = _meshes[meshIndex];
+  if (mesh.LodCount == 0 || camera.ProjectionScale <= 0.0f) {
+    batcher.Submit(this, meshIndex, 0, instances);
+    return;
+  }
+
+  std::span<const Rava::MeshLod> lods{_lods.data() + mesh.FirstLod, mesh.LodCount};
+  const Vec4& sphere = _meshBounds[meshIndex];
+
+  Rava::ScratchScope scratch;
+  std::span<u8> levels = scratch.AllocateArray<u8>(instances.size());
+  std::array<u32, Rava::Mesh::MAX_LODS + 2> offsets{};
+  for (size_t i = 0; i < instances.size(); ++i) {
+    f32 pixelScale = Rava::ComputeLodPixelScale(camera, instances[i].Transform, sphere);
+    levels[i]      = static_cast<u8>(Rava::SelectLod(lods, pixelScale, Config::LodErrorThreshold));
+    ++offsets[levels[i] + 1];
+  }
+
+  // Counting sort by level, the instances keep their submission order within a level
+  for (u32 level = 0; level <= mesh.LodCount; ++level) {
+    offsets[level + 1] += offsets[level];
+  }
+  std::array<u32, Rava::Mesh::MAX_LODS + 2> fill = offsets;
+  for (size_t i = 0; i < instances.size(); ++i) {
+    sorted[fill[levels[i]]++] = instances[i];
+  }
+  for (u32 level = 0; level <= mesh.LodCount; ++level) {
+    u32 count = offsets[level + 1] - offsets[level];
+    batcher.Submit(this, meshIndex, level, sorted.subspan(offsets[level], count));
+  }
+}
+
+u32 Model::DrawInstanced(
+    VkCommandBuffer commandBuffer, u32 firstInstance, u32 instanceCount, u32 meshIndex, u32 lod
+) const {
+  GeometryAllocation geometry = _geometryPool->Get(_geometry);
+  if (_indexCount == 0) {
+    _geometryPool->BindQuantization(commandBuffer, geometry, 0);
+    vkCmdDraw(commandBuffer, _vertexCount, instanceCount, geometry.FirstVertex, firstInstance);
+    return 1;
+  }
+
+  u32 first = meshIndex == ALL_MESHES ? 0 : meshIndex;
+  u32 end   = meshIndex == ALL_MESHES ? static_cast<u32>(_meshes.size()) : meshIndex + 1;
+  assert((lod == 0 || meshIndex != ALL_MESHES) && "A LOD needs a single mesh");
+  for (u32 i = first; i < end; ++i) {
+    const Rava::Mesh& mesh = _meshes[i];
+    u32 firstIndex         = mesh.FirstIndex;
+    u32 indexCount         = mesh.IndexCount;
+    if (lod > 0) {
+      assert(lod <= mesh.LodCount);
+      const Rava::MeshLod& meshLod = _lods[mesh.FirstLod + lod - 1];
+      firstIndex                   = meshLod.FirstIndex;
+      indexCount                   = meshLod.IndexCount;
+    }
+
+    _geometryPool->BindQuantization(commandBuffer, geometry, i);
+    vkCmdDrawIndexed(
+        commandBuffer, indexCount, instanceCount, geometry.FirstIndex + firstIndex,
+        static_cast<i32>(geometry.FirstVertex + mesh.FirstVertex), firstInstance
+    );
+  }
+  return end - first;
+}
+}  // namespace VK
\ No newline at end of file
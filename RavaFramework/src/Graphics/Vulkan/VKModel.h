@@ -1,48 +1,81 @@
 #pragma once
 
 #include "Graphics/Model.h"
+#include "Graphics/Vulkan/VKGeometryPool.h"
 
 namespace VK {
-class ufbxLoader;
-struct Mesh;
-class Buffer;
+class Context;
+class InstanceBatcher;
+struct BufferUpload;
+
+// Vertex input of the geometry pool's format. VertexFormat::Packed feeds the attributes as
+// normalized integers and half floats and adds the mesh's Rava::VertexQuantization at
+// QUANTIZATION_BINDING with a stride of 0, the shader computes
+//   position = offset + inPosition * scale, normal = octahedral decode of inNormal.xy
 struct Vertex : public Rava::Vertex {
+  static constexpr u32 QUANTIZATION_BINDING        = 2;
+  static constexpr u32 QUANTIZATION_FIRST_LOCATION = 10;  // after the Instance attributes
+
+  static u32 GetStride(VertexFormat format);
+  // For Config::SelectedVertexFormat
   static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions();
   static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions();
+  static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions(VertexFormat format);
+  static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions(
+      VertexFormat format
+  );
 };
 
+// The vertices and indices live in one range of the renderer's GeometryPool, the meshes index into
+// it. Draws expect the pool bound, which the swap chain render pass does once per frame.
 class Model : public Rava::Model {
 public:
-  Model(const ufbxLoader& loader);
+  Model(Shared<Context> context, Shared<GeometryPool> geometryPool, const Rava::ModelData& data);
+  // Fills staging buffers only, the caller records the copies into the pool and marks the geometry
+  // resident once they completed
+  Model(
+      Shared<Context> context, Shared<GeometryPool> geometryPool, const Rava::ModelData& data,
+      std::vector<BufferUpload>& uploads
+  );
   ~Model();
 
   NO_COPY(Model)
 
-  void Draw() override;
+  // False when the geometry pool had no room left
+  inline bool IsValid() const { return _geometry != GeometryPool::INVALID_HANDLE; }
 
-  const std::vector<Vertex> GetVertices() { return _vertices; }
-  const std::vector<u32> GetIndices() { return _indices; }
-
-private:
-  std::vector<Mesh> _meshes{};
-  std::vector<Vertex> _vertices;
-  std::vector<u32> _indices;
+  void Draw() override;
+  using Rava::Model::Submit;
+  void Submit(std::span<const Rava::InstanceData> instances, u32 meshIndex) override;
 
-  Unique<Buffer> _vertexBuffer;
-  u32 _vertexCount;
+  // Expects the instance buffer at Instance::BINDING, returns the number of draw calls. lod 0 draws
+  // the full mesh, level n the n-th simplified version of meshIndex, ALL_MESHES only draws level 0.
+  u32 DrawInstanced(
+      VkCommandBuffer commandBuffer, u32 firstInstance, u32 instanceCount, u32 meshIndex,
+      u32 lod = 0
+  ) const;
 
-  bool _hasIndexBuffer = false;
-  Unique<Buffer> _indexBuffer;
-  u32 _indexCount;
+  inline const std::vector<Rava::Mesh>& GetMeshes() const { return _meshes; }
+  // GeometryPool handle
+  inline u32 GetGeometry() const { return _geometry; }
 
 private:
-  void CopyMeshes(const std::vector<Mesh>& meshes);
+  Shared<Context> _context;
+  Shared<GeometryPool> _geometryPool;
+  std::vector<Rava::Mesh> _meshes{};
+  std::vector<Rava::MeshLod> _lods{};
+  std::vector<Vec4> _meshBounds{};  // per mesh, for the LOD selection
 
-  void CreateVertexBuffers(const std::vector<Vertex>& vertices);
-  void CreateIndexBuffers(const std::vector<u32>& indices);
+  u32 _geometry    = GeometryPool::INVALID_HANDLE;
+  u32 _vertexCount = 0;
+  u32 _indexCount  = 0;
 
-  void BindDescriptors(
-      /*const FrameInfo& frameInfo,*/ const VkPipelineLayout& pipelineLayout, Mesh& mesh
+private:
+  bool AllocateGeometry(const Rava::ModelData& data, bool isResident);
+  // Splits the instances of one mesh by their LOD level
+  void SubmitLods(
+      InstanceBatcher& batcher, const Rava::LodCamera& camera, u32 meshIndex,
+      std::span<const Rava::InstanceData> instances, std::span<Rava::InstanceData> sorted
   );
 };
 }  // namespace VK
\ No newline at end of file
@@ -0,0 +1,1030 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Vulkan/VKRenderGraph.h"
+
+#include "Core/CpuProfiler.h"
+#include "Graphics/Vulkan/VKContext.h"
+#include "Graphics/Vulkan/VKDeletionQueue.h"
+#include "Graphics/Vulkan/VKValidation.h"
+
+namespace VK {
+// One per swap chain image and a few more for passes that come and go
+static constexpr u32 MAX_COMPILED_GRAPHS = 8;
+
+struct UsageInfo {
+  VkPipelineStageFlags Stages = 0;
+  VkAccessFlags Access        = 0;
+  VkImageLayout Layout        = VK_IMAGE_LAYOUT_UNDEFINED;
+};
+
+static UsageInfo GetUsageInfo(ResourceUsage usage, PassType type) {
+  VkPipelineStageFlags shaderStages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+  if (type == PassType::Graphics) {
+    shaderStages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+  }
+  constexpr VkPipelineStageFlags depthStages
+      = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+
+  switch (usage) {
+    case ResourceUsage::ColorAttachment:
+      return {
+          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+          VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+      };
+    case ResourceUsage::DepthAttachment:
+      return {
+          depthStages,
+          VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT
+              | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+          VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+      };
+    case ResourceUsage::DepthReadOnly:
+      return {
+          depthStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+          VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+      };
+    case ResourceUsage::Sampled:
+      return {shaderStages, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    case ResourceUsage::StorageRead:
+      return {shaderStages, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL};
+    case ResourceUsage::StorageWrite:
+      return {
+          shaderStages, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+          VK_IMAGE_LAYOUT_GENERAL
+      };
+    case ResourceUsage::IndirectRead:
+      return {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT};
+    case ResourceUsage::VertexRead:
+      return {
+          VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+          VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT
+      };
+    case ResourceUsage::TransferSrc:
+      return {
+          VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+      };
+    case ResourceUsage::TransferDst:
+      return {
+          VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+      };
+    case ResourceUsage::Present:
+      // The present waits on a semaphore, the barrier only has to order the transition
+      return {VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR};
+  }
+  return {};
+}
+
+static bool IsWriteUsage(ResourceUsage usage) {
+  return usage == ResourceUsage::ColorAttachment || usage == ResourceUsage::DepthAttachment
+      || usage == ResourceUsage::StorageWrite || usage == ResourceUsage::TransferDst;
+}
+
+static VkImageUsageFlags GetImageUsage(ResourceUsage usage) {
+  switch (usage) {
+    case ResourceUsage::ColorAttachment:
+      return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    case ResourceUsage::DepthAttachment:
+    case ResourceUsage::DepthReadOnly:
+      return VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    case ResourceUsage::Sampled:
+      return VK_IMAGE_USAGE_SAMPLED_BIT;
+    case ResourceUsage::StorageRead:
+    case ResourceUsage::StorageWrite:
+      return VK_IMAGE_USAGE_STORAGE_BIT;
+    case ResourceUsage::TransferSrc:
+      return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    case ResourceUsage::TransferDst:
+      return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    default:
+      return 0;
+  }
+}
+
+static VkImageAspectFlags GetAspect(VkFormat format) {
+  switch (format) {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+      return VK_IMAGE_ASPECT_DEPTH_BIT;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+      return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    case VK_FORMAT_S8_UINT:
+      return VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+      return VK_IMAGE_ASPECT_COLOR_BIT;
+  }
+}
+
+static inline VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+static inline bool IsOverlapping(u32 firstA, u32 lastA, u32 firstB, u32 lastB) {
+  return firstA <= lastB && firstB <= lastA;
+}
+
+RenderGraph::RenderGraph(Shared<Context> context)
+    : _context(context), _isDynamicRendering(context->GetEnabledFeatures13().dynamicRendering) {}
+
+// The device is idle, nothing has to wait for the deletion queue
+RenderGraph::~RenderGraph() {
+  VkDevice device = _context->GetLogicalDevice();
+  for (auto& [key, framebuffer] : _framebuffers) {
+    vkDestroyFramebuffer(device, framebuffer, nullptr);
+  }
+  for (auto& [key, renderPass] : _renderPasses) {
+    vkDestroyRenderPass(device, renderPass, nullptr);
+  }
+  for (Transient& transient : _transients) {
+    vkDestroyImageView(device, transient.View, nullptr);
+    vkDestroyImage(device, transient.Image, nullptr);
+  }
+  for (MemoryBucket& bucket : _buckets) {
+    _context->GetAllocator().Free(bucket.Memory);
+  }
+}
+
+void RenderGraph::Reset() {
+  _resourceCount = 0;
+  _passCount     = 0;
+  _compiledGraph = INVALID_HANDLE;
+  _nextPass      = 0;
+}
+
+u32 RenderGraph::CreateImage(std::string_view name, VkFormat format, VkExtent2D extent) {
+  Resource& image = DeclareResource(name);
+  image.Format    = format;
+  image.Extent    = extent;
+  image.Aspect    = GetAspect(format);
+  return _resourceCount - 1;
+}
+
+u32 RenderGraph::ImportImage(
+    std::string_view name, VkImage image, VkImageView view, VkFormat format, VkExtent2D extent,
+    VkPipelineStageFlags readyStages, ResourceUsage finalUsage
+) {
+  Resource& resource     = DeclareResource(name);
+  resource.IsImported    = true;
+  resource.Format        = format;
+  resource.Extent        = extent;
+  resource.Aspect        = GetAspect(format);
+  resource.Image         = image;
+  resource.View          = view;
+  resource.ReadyStages   = readyStages;
+  resource.FinalUsage    = finalUsage;
+  resource.HasFinalUsage = true;
+  return _resourceCount - 1;
+}
+
+u32 RenderGraph::ImportBuffer(std::string_view name, VkBuffer buffer, VkDeviceSize size) {
+  Resource& resource  = DeclareResource(name);
+  resource.IsImage    = false;
+  resource.IsImported = true;
+  resource.Buffer     = buffer;
+  resource.Size       = size;
+  return _resourceCount - 1;
+}
+
+// The slot of the previous frame keeps the capacity of its access and attachment lists
+u32 RenderGraph::AddPass(std::string_view name, PassType type, ExecuteFunction execute) {
+  if (_passCount == _passes.size()) {
+    _passes.emplace_back();
+  }
+  Pass& pass         = _passes[_passCount];
+  pass.Name          = name;
+  pass.Type          = type;
+  pass.Execute       = std::move(execute);
+  pass.HasDepth      = false;
+  pass.HasSideEffect = false;
+  pass.IsCulled      = false;
+  pass.Accesses.clear();
+  pass.Attachments.clear();
+  return _passCount++;
+}
+
+void RenderGraph::Read(u32 pass, u32 resource, ResourceUsage usage) {
+  assert(!IsWriteUsage(usage));
+  _passes[pass].Accesses.push_back({resource, usage, true, false});
+  _resources[resource].ImageUsage |= GetImageUsage(usage);
+}
+
+void RenderGraph::Write(u32 pass, u32 resource, ResourceUsage usage) {
+  assert(IsWriteUsage(usage));
+  _passes[pass].Accesses.push_back({resource, usage, false, true});
+  _resources[resource].ImageUsage |= GetImageUsage(usage);
+}
+
+void RenderGraph::SetColorAttachment(
+    u32 pass, u32 image, VkAttachmentLoadOp loadOp, VkClearColorValue clearValue
+) {
+  Pass& colorPass = _passes[pass];
+  Attachment attachment;
+  attachment.Image            = image;
+  attachment.LoadOp           = loadOp;
+  attachment.ClearValue.color = clearValue;
+  attachment.Usage            = ResourceUsage::ColorAttachment;
+  colorPass.Attachments.insert(
+      colorPass.Attachments.end() - (colorPass.HasDepth ? 1 : 0), attachment
+  );
+
+  bool isRead = loadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+  colorPass.Accesses.push_back({image, ResourceUsage::ColorAttachment, isRead, true});
+  _resources[image].ImageUsage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+}
+
+void RenderGraph::SetDepthAttachment(
+    u32 pass, u32 image, VkAttachmentLoadOp loadOp, f32 clearDepth, bool isReadOnly
+) {
+  Pass& depthPass                    = _passes[pass];
+  Attachment& attachment             = depthPass.Attachments.emplace_back();
+  attachment.Image                   = image;
+  attachment.LoadOp                  = isReadOnly ? VK_ATTACHMENT_LOAD_OP_LOAD : loadOp;
+  attachment.ClearValue.depthStencil = {clearDepth, 0};
+  attachment.Usage   = isReadOnly ? ResourceUsage::DepthReadOnly : ResourceUsage::DepthAttachment;
+  depthPass.HasDepth = true;
+
+  bool isRead = attachment.LoadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+  depthPass.Accesses.push_back({image, attachment.Usage, isRead, !isReadOnly});
+  _resources[image].ImageUsage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+}
+
+void RenderGraph::SetSideEffect(u32 pass) {
+  _passes[pass].HasSideEffect = true;
+}
+
+void RenderGraph::Compile() {
+  RV_PROFILE_FUNCTION();
+  // Only shrinks when fewer were declared than in the previous frame
+  _resources.resize(_resourceCount);
+  _passes.resize(_passCount);
+  BuildSignature();
+  for (u32 i = 0; i < _compiledGraphs.size(); ++i) {
+    if (_compiledGraphs[i].Signature == _signature) {
+      UseCompiledGraph(i);
+      return;
+    }
+  }
+
+  _stats           = {};
+  _stats.PassCount = static_cast<u32>(_passes.size());
+
+  Cull();
+  ComputeLifetimes();
+  CreateTransients();
+
+  if (_compiledGraphs.size() == MAX_COMPILED_GRAPHS) {
+    _compiledGraphs.erase(_compiledGraphs.begin());
+  }
+  CompiledGraph& compiled = _compiledGraphs.emplace_back();
+  _compiledGraph          = static_cast<u32>(_compiledGraphs.size() - 1);
+  compiled.Signature      = _signature;
+  compiled.Passes.resize(_passes.size());
+  for (u32 i = 0; i < _passes.size(); ++i) {
+    compiled.Passes[i].IsCulled = _passes[i].IsCulled;
+  }
+  for (const Resource& resource : _resources) {
+    compiled.Transients.push_back(resource.Transient);
+  }
+
+  BuildBarriers();
+
+  for (u32 i = 0; i < _passes.size(); ++i) {
+    const Pass& pass = _passes[i];
+    if (pass.IsCulled || pass.Type != PassType::Graphics || pass.Attachments.empty()) {
+      continue;
+    }
+
+    VkExtent2D extent = _resources[pass.Attachments[0].Image].Extent;
+    if (_isDynamicRendering) {
+      BuildRenderingInfo(i, extent);
+      continue;
+    }
+
+    CompiledPass& compiledPass = compiled.Passes[i];
+    for (const Attachment& attachment : pass.Attachments) {
+      compiledPass.ClearValues.push_back(attachment.ClearValue);
+    }
+
+    VkRenderPassBeginInfo& beginInfo = compiledPass.BeginInfo;
+    VkRenderPass renderPass          = GetRenderPass(i);
+    beginInfo.sType                  = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    beginInfo.renderPass             = renderPass;
+    beginInfo.framebuffer            = GetFramebuffer(i, renderPass, extent);
+    beginInfo.renderArea.offset      = {0, 0};
+    beginInfo.renderArea.extent      = extent;
+    beginInfo.clearValueCount        = static_cast<u32>(compiledPass.ClearValues.size());
+    beginInfo.pClearValues           = compiledPass.ClearValues.data();
+  }
+
+  _stats.RenderPassCount  = static_cast<u32>(_renderPasses.size());
+  _stats.FramebufferCount = static_cast<u32>(_framebuffers.size());
+  compiled.Stats          = _stats;
+}
+
+RenderGraph::Resource& RenderGraph::DeclareResource(std::string_view name) {
+  if (_resourceCount == _resources.size()) {
+    _resources.emplace_back();
+  }
+  Resource& resource = _resources[_resourceCount++];
+  resource           = {};
+  resource.Name      = name;
+  return resource;
+}
+
+void RenderGraph::BuildSignature() {
+  auto add = [this](u64 value) { _signature.push_back(value); };
+
+  _signature.clear();
+  add(_resources.size());
+  for (const Resource& resource : _resources) {
+    add(resource.IsImage);
+    add(resource.IsImported);
+    add(static_cast<u64>(resource.Format));
+    add(resource.Extent.width);
+    add(resource.Extent.height);
+    add(resource.ImageUsage);
+    add(std::bit_cast<u64>(resource.Image));
+    add(std::bit_cast<u64>(resource.View));
+    add(std::bit_cast<u64>(resource.Buffer));
+    add(resource.Size);
+    add(resource.ReadyStages);
+    add(static_cast<u64>(resource.FinalUsage));
+    add(resource.HasFinalUsage);
+  }
+
+  add(_passes.size());
+  for (const Pass& pass : _passes) {
+    add(static_cast<u64>(pass.Type));
+    add(pass.HasDepth);
+    add(pass.HasSideEffect);
+    add(pass.Accesses.size());
+    for (const Access& access : pass.Accesses) {
+      add(access.Resource);
+      add(static_cast<u64>(access.Usage));
+      add(access.IsRead);
+      add(access.IsWrite);
+    }
+    add(pass.Attachments.size());
+    for (const Attachment& attachment : pass.Attachments) {
+      u64 clearValue[2] = {};
+      static_assert(sizeof(clearValue) == sizeof(VkClearValue));
+      memcpy(clearValue, &attachment.ClearValue, sizeof(clearValue));
+      add(attachment.Image);
+      add(static_cast<u64>(attachment.LoadOp));
+      add(clearValue[0]);
+      add(clearValue[1]);
+      add(static_cast<u64>(attachment.Usage));
+    }
+  }
+}
+
+// Only the views of the transient images are read from the resources after compiling
+void RenderGraph::UseCompiledGraph(u32 compiledGraph) {
+  _compiledGraph                = compiledGraph;
+  const CompiledGraph& compiled = GetCompiledGraph();
+  for (u32 i = 0; i < _resources.size(); ++i) {
+    u32 transient = compiled.Transients[i];
+    if (transient != INVALID_HANDLE) {
+      _resources[i].Image = _transients[transient].Image;
+      _resources[i].View  = _transients[transient].View;
+    }
+  }
+  _stats                  = compiled.Stats;
+  _stats.RenderPassCount  = static_cast<u32>(_renderPasses.size());
+  _stats.FramebufferCount = static_cast<u32>(_framebuffers.size());
+}
+
+// Backwards from the outputs: a pass is kept when a kept pass after it or an output reads what it
+// writes. An attachment that is cleared (or not loaded) hides every earlier write to its image.
+void RenderGraph::Cull() {
+  std::vector<bool> isNeeded(_resources.size());
+  for (u32 i = 0; i < _resources.size(); ++i) {
+    isNeeded[i] = _resources[i].IsImported;
+  }
+
+  for (u32 i = static_cast<u32>(_passes.size()); i-- > 0;) {
+    Pass& pass  = _passes[i];
+    bool isKept = pass.HasSideEffect;
+    for (const Access& access : pass.Accesses) {
+      isKept |= access.IsWrite && isNeeded[access.Resource];
+    }
+
+    pass.IsCulled = !isKept;
+    if (!isKept) {
+      ++_stats.CulledPassCount;
+      continue;
+    }
+
+    for (const Access& access : pass.Accesses) {
+      bool isAttachment = access.Usage == ResourceUsage::ColorAttachment
+                       || access.Usage == ResourceUsage::DepthAttachment;
+      if (isAttachment && access.IsWrite && !access.IsRead) {
+        isNeeded[access.Resource] = false;
+      }
+    }
+    for (const Access& access : pass.Accesses) {
+      if (access.IsRead) {
+        isNeeded[access.Resource] = true;
+      }
+    }
+  }
+}
+
+void RenderGraph::ComputeLifetimes() {
+  for (u32 i = 0; i < _passes.size(); ++i) {
+    if (_passes[i].IsCulled) {
+      continue;
+    }
+
+    for (const Access& access : _passes[i].Accesses) {
+      Resource& resource = _resources[access.Resource];
+      if (resource.FirstPass == INVALID_HANDLE) {
+        resource.FirstPass = i;
+      }
+      resource.LastPass = i;
+      if (access.IsRead) {
+        resource.LastReadPass = i;
+      }
+    }
+  }
+}
+
+void RenderGraph::CreateTransients() {
+  std::vector<Transient> transients;
+  for (Resource& resource : _resources) {
+    if (!resource.IsImage || resource.IsImported || resource.FirstPass == INVALID_HANDLE) {
+      continue;
+    }
+
+    resource.Transient   = static_cast<u32>(transients.size());
+    Transient& transient = transients.emplace_back();
+    transient.Aspect     = resource.Aspect;
+    transient.FirstPass  = resource.FirstPass;
+    transient.LastPass   = resource.LastPass;
+
+    VkImageCreateInfo& imageInfo = transient.CreateInfo;
+    imageInfo.sType              = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType          = VK_IMAGE_TYPE_2D;
+    imageInfo.extent             = {resource.Extent.width, resource.Extent.height, 1};
+    imageInfo.mipLevels          = 1;
+    imageInfo.arrayLayers        = 1;
+    imageInfo.format             = resource.Format;
+    imageInfo.tiling             = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout      = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage              = resource.ImageUsage;
+    imageInfo.samples            = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.sharingMode        = VK_SHARING_MODE_EXCLUSIVE;
+  }
+
+  auto isSame = [](const Transient& a, const Transient& b) {
+    return a.CreateInfo.format == b.CreateInfo.format
+        && a.CreateInfo.extent.width == b.CreateInfo.extent.width
+        && a.CreateInfo.extent.height == b.CreateInfo.extent.height
+        && a.CreateInfo.usage == b.CreateInfo.usage && a.FirstPass == b.FirstPass
+        && a.LastPass == b.LastPass;
+  };
+
+  if (!std::ranges::equal(transients, _transients, isSame)) {
+    ReleaseTransients();
+    _transients = std::move(transients);
+
+    VkDevice device = _context->GetLogicalDevice();
+    for (Transient& transient : _transients) {
+      VkResult result = vkCreateImage(device, &transient.CreateInfo, nullptr, &transient.Image);
+      IsResultValid(result, "Failed to Create Transient Image!\n");
+      vkGetImageMemoryRequirements(device, transient.Image, &transient.Requirements);
+    }
+
+    PlaceTransients();
+
+    for (MemoryBucket& bucket : _buckets) {
+      VkMemoryRequirements requirements{};
+      requirements.size           = bucket.Size;
+      requirements.alignment      = bucket.Alignment;
+      requirements.memoryTypeBits = bucket.MemoryTypeBits;
+      if (!_context->GetAllocator().AllocateMemory(
+              requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, bucket.Memory
+          )) {
+        throw std::runtime_error("failed to allocate transient image memory!");
+      }
+    }
+
+    for (Transient& transient : _transients) {
+      const Allocation& memory = _buckets[transient.Bucket].Memory;
+      VkResult result          = vkBindImageMemory(
+          device, transient.Image, memory.Memory, memory.Offset + transient.Offset
+      );
+      IsResultValid(result, "Failed to Bind Transient Image Memory!\n");
+
+      // Depth stencil images are only viewed as depth, for sampling and attachments alike
+      VkImageAspectFlags viewAspect = transient.Aspect;
+      if (viewAspect & VK_IMAGE_ASPECT_DEPTH_BIT) {
+        viewAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+      }
+
+      VkImageViewCreateInfo viewInfo{};
+      viewInfo.sType                       = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+      viewInfo.image                       = transient.Image;
+      viewInfo.viewType                    = VK_IMAGE_VIEW_TYPE_2D;
+      viewInfo.format                      = transient.CreateInfo.format;
+      viewInfo.subresourceRange.aspectMask = viewAspect;
+      viewInfo.subresourceRange.levelCount = 1;
+      viewInfo.subresourceRange.layerCount = 1;
+      result = vkCreateImageView(device, &viewInfo, nullptr, &transient.View);
+      IsResultValid(result, "Failed to Create Transient Image View!\n");
+    }
+  }
+
+  for (Resource& resource : _resources) {
+    if (resource.Transient != INVALID_HANDLE) {
+      resource.Image = _transients[resource.Transient].Image;
+      resource.View  = _transients[resource.Transient].View;
+    }
+  }
+
+  _stats.TransientCount    = static_cast<u32>(_transients.size());
+  _stats.MemoryBucketCount = static_cast<u32>(_buckets.size());
+  for (const Transient& transient : _transients) {
+    _stats.TransientBytes += transient.Requirements.size;
+  }
+  for (const MemoryBucket& bucket : _buckets) {
+    _stats.AllocatedBytes += bucket.Size;
+  }
+}
+
+// Largest first, each image goes to the lowest offset of the first bucket where it overlaps no
+// image whose lifetime overlaps its own. The first image of a bucket sets its size.
+void RenderGraph::PlaceTransients() {
+  std::vector<u32> order(_transients.size());
+  for (u32 i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::ranges::stable_sort(order, [this](u32 a, u32 b) {
+    return _transients[a].Requirements.size > _transients[b].Requirements.size;
+  });
+
+  std::vector<u32> placed;
+  std::vector<VkDeviceSize> offsets;
+  for (u32 index : order) {
+    Transient& transient                     = _transients[index];
+    const VkMemoryRequirements& requirements = transient.Requirements;
+
+    bool isPlaced = false;
+    for (u32 bucketIndex = 0; _isAliasingEnabled && bucketIndex < _buckets.size(); ++bucketIndex) {
+      MemoryBucket& bucket = _buckets[bucketIndex];
+      if ((bucket.MemoryTypeBits & requirements.memoryTypeBits) == 0) {
+        continue;
+      }
+
+      // Candidates are the start of the bucket and the ends of the images alive at the same time
+      offsets.assign(1, 0);
+      for (u32 other : placed) {
+        const Transient& otherTransient = _transients[other];
+        if (otherTransient.Bucket == bucketIndex
+            && IsOverlapping(
+                transient.FirstPass, transient.LastPass, otherTransient.FirstPass,
+                otherTransient.LastPass
+            )) {
+          offsets.push_back(AlignUp(
+              otherTransient.Offset + otherTransient.Requirements.size, requirements.alignment
+          ));
+        }
+      }
+      std::ranges::sort(offsets);
+
+      for (VkDeviceSize offset : offsets) {
+        if (offset + requirements.size > bucket.Size) {
+          break;
+        }
+
+        bool isFree = std::ranges::none_of(placed, [&](u32 other) {
+          const Transient& otherTransient = _transients[other];
+          return otherTransient.Bucket == bucketIndex
+              && IsOverlapping(
+                     transient.FirstPass, transient.LastPass, otherTransient.FirstPass,
+                     otherTransient.LastPass
+              )
+              && offset < otherTransient.Offset + otherTransient.Requirements.size
+              && otherTransient.Offset < offset + requirements.size;
+        });
+        if (isFree) {
+          transient.Bucket = bucketIndex;
+          transient.Offset = offset;
+          isPlaced         = true;
+          break;
+        }
+      }
+
+      if (isPlaced) {
+        bucket.Alignment       = std::max(bucket.Alignment, requirements.alignment);
+        bucket.MemoryTypeBits &= requirements.memoryTypeBits;
+        break;
+      }
+    }
+
+    if (!isPlaced) {
+      MemoryBucket& bucket  = _buckets.emplace_back();
+      bucket.Size           = requirements.size;
+      bucket.Alignment      = requirements.alignment;
+      bucket.MemoryTypeBits = requirements.memoryTypeBits;
+      transient.Bucket      = static_cast<u32>(_buckets.size() - 1);
+      transient.Offset      = 0;
+    }
+    placed.push_back(index);
+  }
+}
+
+// Frames in flight may still use them
+void RenderGraph::ReleaseTransients() {
+  DeletionQueue& deletionQueue = _context->GetDeletionQueue();
+  for (Transient& transient : _transients) {
+    Allocation boundMemory;  // freed with the bucket
+    deletionQueue.DestroyImageView(transient.View);
+    deletionQueue.DestroyImage(transient.Image, boundMemory);
+  }
+  for (MemoryBucket& bucket : _buckets) {
+    deletionQueue.Free(bucket.Memory);
+  }
+  _transients.clear();
+  _buckets.clear();
+  ReleaseFramebuffers();
+}
+
+void RenderGraph::BuildBarriers() {
+  // The first use of a transient image waits for every use of its memory, by the images it aliases
+  // and by the frames before, which ran the same passes on the same queue. Their writes have to be
+  // made available too, or they could land after the writes of the first use.
+  for (MemoryBucket& bucket : _buckets) {
+    bucket.Stages      = 0;
+    bucket.WriteAccess = 0;
+  }
+  for (const Pass& pass : _passes) {
+    for (const Access& access : pass.Accesses) {
+      u32 transient = _resources[access.Resource].Transient;
+      if (!pass.IsCulled && transient != INVALID_HANDLE) {
+        UsageInfo info       = GetUsageInfo(access.Usage, pass.Type);
+        MemoryBucket& bucket = _buckets[_transients[transient].Bucket];
+        bucket.Stages       |= info.Stages;
+        bucket.WriteAccess  |= access.IsWrite ? info.Access : 0;
+      }
+    }
+  }
+
+  std::vector<ResourceState> states(_resources.size());
+  for (u32 i = 0; i < _resources.size(); ++i) {
+    const Resource& resource = _resources[i];
+    if (resource.Transient != INVALID_HANDLE) {
+      const MemoryBucket& bucket = _buckets[_transients[resource.Transient].Bucket];
+      states[i].WriteStages      = bucket.Stages;
+      states[i].WriteAccess      = bucket.WriteAccess;
+    } else if (resource.IsImage) {
+      states[i].WriteStages = resource.ReadyStages;
+    }
+  }
+
+  CompiledGraph& compiled = GetCompiledGraph();
+  for (u32 i = 0; i < _passes.size(); ++i) {
+    const Pass& pass = _passes[i];
+    if (pass.IsCulled) {
+      continue;
+    }
+
+    BarrierBatch& barriers      = compiled.Passes[i].Barriers;
+    barriers.FirstImageBarrier  = static_cast<u32>(compiled.ImageBarriers.size());
+    barriers.FirstBufferBarrier = static_cast<u32>(compiled.BufferBarriers.size());
+    for (const Access& access : pass.Accesses) {
+      AddAccessBarrier(barriers, access.Resource, access.Usage, pass.Type, access.IsWrite, states);
+    }
+  }
+
+  BarrierBatch& finalBarriers      = compiled.FinalBarriers;
+  finalBarriers.FirstImageBarrier  = static_cast<u32>(compiled.ImageBarriers.size());
+  finalBarriers.FirstBufferBarrier = static_cast<u32>(compiled.BufferBarriers.size());
+  for (u32 i = 0; i < _resources.size(); ++i) {
+    if (_resources[i].HasFinalUsage) {
+      AddAccessBarrier(
+          finalBarriers, i, _resources[i].FinalUsage, PassType::Graphics, false, states
+      );
+    }
+  }
+
+  _stats.ImageBarrierCount  = static_cast<u32>(compiled.ImageBarriers.size());
+  _stats.BufferBarrierCount = static_cast<u32>(compiled.BufferBarriers.size());
+}
+
+// A write or a layout transition waits for the last write and every read since, a read waits for
+// the last write unless an earlier barrier already made it visible to the same stages and accesses
+void RenderGraph::AddAccessBarrier(
+    BarrierBatch& batch, u32 resource, ResourceUsage usage, PassType type, bool isWrite,
+    std::vector<ResourceState>& states
+) {
+  const Resource& target  = _resources[resource];
+  UsageInfo info          = GetUsageInfo(usage, type);
+  ResourceState& state    = states[resource];
+  VkImageLayout oldLayout = state.Layout;
+  bool isTransition       = target.IsImage && state.Layout != info.Layout;
+
+  VkPipelineStageFlags srcStages = 0;
+  VkAccessFlags srcAccess        = 0;
+  if (isWrite || isTransition) {
+    srcStages           = state.WriteStages | state.ReadStages;
+    srcAccess           = state.WriteAccess;
+    state.Layout        = info.Layout;
+    state.WriteStages   = info.Stages;
+    state.WriteAccess   = isWrite ? info.Access : 0;
+    state.ReadStages    = 0;
+    state.VisibleStages = isWrite ? 0 : info.Stages;
+    state.VisibleAccess = isWrite ? 0 : info.Access;
+  } else {
+    bool isVisible = (info.Stages & ~state.VisibleStages) == 0
+                  && (info.Access & ~state.VisibleAccess) == 0;
+    state.ReadStages |= info.Stages;
+    if (state.WriteStages == 0 || isVisible) {
+      return;
+    }
+    srcStages = state.WriteStages;
+    srcAccess = state.WriteAccess;
+    state.VisibleStages |= info.Stages;
+    state.VisibleAccess |= info.Access;
+  }
+
+  if (srcStages == 0 && !isTransition) {
+    return;
+  }
+
+  CompiledGraph& compiled = GetCompiledGraph();
+  if (target.IsImage) {
+    VkImageMemoryBarrier& barrier       = compiled.ImageBarriers.emplace_back();
+    barrier                             = {};
+    barrier.sType                       = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask               = srcAccess;
+    barrier.dstAccessMask               = info.Access;
+    barrier.oldLayout                   = oldLayout;
+    barrier.newLayout                   = info.Layout;
+    barrier.srcQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image                       = target.Image;
+    barrier.subresourceRange.aspectMask = target.Aspect;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    ++batch.ImageBarrierCount;
+  } else {
+    VkBufferMemoryBarrier& barrier = compiled.BufferBarriers.emplace_back();
+    barrier                        = {};
+    barrier.sType                  = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask          = srcAccess;
+    barrier.dstAccessMask          = info.Access;
+    barrier.srcQueueFamilyIndex    = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex    = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer                 = target.Buffer;
+    barrier.size                   = target.Size;
+    ++batch.BufferBarrierCount;
+  }
+  batch.SrcStages |= srcStages;
+  batch.DstStages |= info.Stages;
+}
+
+VkAttachmentStoreOp RenderGraph::GetStoreOp(u32 pass, const Attachment& attachment) const {
+  const Resource& image = _resources[attachment.Image];
+  bool isStored
+      = image.IsImported || (image.LastReadPass != INVALID_HANDLE && image.LastReadPass > pass);
+  return isStored ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+}
+
+// Attachments stay in the layouts the barriers put them in, so the render pass needs no
+// dependencies of its own
+VkRenderPass RenderGraph::GetRenderPass(u32 pass) {
+  const Pass& renderPass = _passes[pass];
+  std::vector<u64> key;
+  std::vector<VkAttachmentDescription> descriptions;
+  for (const Attachment& attachment : renderPass.Attachments) {
+    VkAttachmentDescription& description = descriptions.emplace_back();
+    description                          = {};
+    description.format                   = _resources[attachment.Image].Format;
+    description.samples                  = VK_SAMPLE_COUNT_1_BIT;
+    description.loadOp                   = attachment.LoadOp;
+    description.storeOp                  = GetStoreOp(pass, attachment);
+    description.stencilLoadOp            = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    description.stencilStoreOp           = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    description.initialLayout = GetUsageInfo(attachment.Usage, PassType::Graphics).Layout;
+    description.finalLayout   = description.initialLayout;
+
+    key.push_back(description.format);
+    key.push_back(description.loadOp);
+    key.push_back(description.storeOp);
+    key.push_back(description.initialLayout);
+  }
+
+  auto cached = _renderPasses.find(key);
+  if (cached != _renderPasses.end()) {
+    return cached->second;
+  }
+
+  std::vector<VkAttachmentReference> colorReferences;
+  VkAttachmentReference depthReference{};
+  for (u32 i = 0; i < descriptions.size(); ++i) {
+    VkAttachmentReference reference{i, descriptions[i].initialLayout};
+    if (renderPass.HasDepth && i + 1 == descriptions.size()) {
+      depthReference = reference;
+    } else {
+      colorReferences.push_back(reference);
+    }
+  }
+
+  VkSubpassDescription subpass{};
+  subpass.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
+  subpass.colorAttachmentCount    = static_cast<u32>(colorReferences.size());
+  subpass.pColorAttachments       = colorReferences.data();
+  subpass.pDepthStencilAttachment = renderPass.HasDepth ? &depthReference : nullptr;
+
+  VkRenderPassCreateInfo renderPassInfo{};
+  renderPassInfo.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+  renderPassInfo.attachmentCount = static_cast<u32>(descriptions.size());
+  renderPassInfo.pAttachments    = descriptions.data();
+  renderPassInfo.subpassCount    = 1;
+  renderPassInfo.pSubpasses      = &subpass;
+
+  VkRenderPass handle = VK_NULL_HANDLE;
+  VkResult result
+      = vkCreateRenderPass(_context->GetLogicalDevice(), &renderPassInfo, nullptr, &handle);
+  IsResultValid(result, "Failed to Create Render Graph Render Pass!\n");
+  _renderPasses.emplace(std::move(key), handle);
+  return handle;
+}
+
+VkFramebuffer RenderGraph::GetFramebuffer(u32 pass, VkRenderPass renderPass, VkExtent2D extent) {
+  std::vector<VkImageView> views;
+  std::vector<u64> key{std::bit_cast<u64>(renderPass), extent.width, extent.height};
+  for (const Attachment& attachment : _passes[pass].Attachments) {
+    views.push_back(_resources[attachment.Image].View);
+    key.push_back(std::bit_cast<u64>(views.back()));
+  }
+
+  auto cached = _framebuffers.find(key);
+  if (cached != _framebuffers.end()) {
+    return cached->second;
+  }
+
+  VkFramebufferCreateInfo framebufferInfo{};
+  framebufferInfo.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+  framebufferInfo.renderPass      = renderPass;
+  framebufferInfo.attachmentCount = static_cast<u32>(views.size());
+  framebufferInfo.pAttachments    = views.data();
+  framebufferInfo.width           = extent.width;
+  framebufferInfo.height          = extent.height;
+  framebufferInfo.layers          = 1;
+
+  VkFramebuffer framebuffer = VK_NULL_HANDLE;
+  VkResult result
+      = vkCreateFramebuffer(_context->GetLogicalDevice(), &framebufferInfo, nullptr, &framebuffer);
+  IsResultValid(result, "Failed to Create Render Graph Framebuffer!\n");
+  _framebuffers.emplace(std::move(key), framebuffer);
+  return framebuffer;
+}
+
+// Same layouts, load and store operations as the render pass would have. Nothing is created, so
+// a resize only changes the views and the extent.
+void RenderGraph::BuildRenderingInfo(u32 pass, VkExtent2D extent) {
+  const Pass& renderPass     = _passes[pass];
+  CompiledPass& compiledPass = GetCompiledGraph().Passes[pass];
+  for (const Attachment& attachment : renderPass.Attachments) {
+    VkRenderingAttachmentInfo& info = compiledPass.AttachmentInfos.emplace_back();
+    info                            = {};
+    info.sType                      = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    info.imageView                  = _resources[attachment.Image].View;
+    info.imageLayout                = GetUsageInfo(attachment.Usage, PassType::Graphics).Layout;
+    info.loadOp                     = attachment.LoadOp;
+    info.storeOp                    = GetStoreOp(pass, attachment);
+    info.clearValue                 = attachment.ClearValue;
+    if (attachment.Usage == ResourceUsage::ColorAttachment) {
+      compiledPass.ColorFormats.push_back(_resources[attachment.Image].Format);
+    }
+  }
+
+  u32 colorCount                   = static_cast<u32>(compiledPass.ColorFormats.size());
+  VkRenderingAttachmentInfo* depth = nullptr;
+  VkFormat depthFormat             = VK_FORMAT_UNDEFINED;
+  if (renderPass.HasDepth) {
+    depth       = &compiledPass.AttachmentInfos.back();
+    depthFormat = _resources[renderPass.Attachments.back().Image].Format;
+  }
+
+  VkRenderingInfo& renderingInfo     = compiledPass.RenderingInfo;
+  renderingInfo.sType                = VK_STRUCTURE_TYPE_RENDERING_INFO;
+  renderingInfo.renderArea.offset    = {0, 0};
+  renderingInfo.renderArea.extent    = extent;
+  renderingInfo.layerCount           = 1;
+  renderingInfo.colorAttachmentCount = colorCount;
+  renderingInfo.pColorAttachments    = compiledPass.AttachmentInfos.data();
+  renderingInfo.pDepthAttachment     = depth;
+
+  VkCommandBufferInheritanceRenderingInfo& inheritance = compiledPass.Inheritance;
+
+  inheritance.sType                   = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+  inheritance.colorAttachmentCount    = colorCount;
+  inheritance.pColorAttachmentFormats = compiledPass.ColorFormats.data();
+  inheritance.depthAttachmentFormat   = depthFormat;
+  inheritance.rasterizationSamples    = VK_SAMPLE_COUNT_1_BIT;
+}
+
+void RenderGraph::ExecuteUntil(VkCommandBuffer commandBuffer, u32 pass) {
+  RV_PROFILE_FUNCTION();
+  assert(_compiledGraph != INVALID_HANDLE);
+  for (; _nextPass < pass; ++_nextPass) {
+    RecordPass(commandBuffer, _nextPass);
+  }
+  const CompiledPass& compiledPass = GetCompiledGraph().Passes[pass];
+  if (!compiledPass.IsCulled) {
+    RecordBarriers(commandBuffer, compiledPass.Barriers);
+  }
+  _nextPass = pass + 1;
+}
+
+void RenderGraph::Execute(VkCommandBuffer commandBuffer) {
+  RV_PROFILE_FUNCTION();
+  assert(_compiledGraph != INVALID_HANDLE);
+  for (; _nextPass < _passes.size(); ++_nextPass) {
+    RecordPass(commandBuffer, _nextPass);
+  }
+  RecordBarriers(commandBuffer, GetCompiledGraph().FinalBarriers);
+}
+
+const VkRenderPassBeginInfo& RenderGraph::GetRenderPassBeginInfo(u32 pass) const {
+  return GetCompiledGraph().Passes[pass].BeginInfo;
+}
+
+const VkRenderingInfo& RenderGraph::GetRenderingInfo(u32 pass) const {
+  return GetCompiledGraph().Passes[pass].RenderingInfo;
+}
+
+const VkCommandBufferInheritanceRenderingInfo& RenderGraph::GetRenderingInheritance(
+    u32 pass
+) const {
+  return GetCompiledGraph().Passes[pass].Inheritance;
+}
+
+void RenderGraph::SetAliasingEnabled(bool isEnabled) {
+  if (_isAliasingEnabled != isEnabled) {
+    _isAliasingEnabled = isEnabled;
+    ReleaseTransients();
+  }
+}
+
+void RenderGraph::ReleaseFramebuffers() {
+  for (auto& [key, framebuffer] : _framebuffers) {
+    _context->GetDeletionQueue().DestroyFramebuffer(framebuffer);
+  }
+  _framebuffers.clear();
+  // They begin the released framebuffers and wait for the released transient images
+  _compiledGraphs.clear();
+  _compiledGraph = INVALID_HANDLE;
+}
+
+void RenderGraph::RecordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch) {
+  if (batch.ImageBarrierCount == 0 && batch.BufferBarrierCount == 0) {
+    return;
+  }
+
+  VkPipelineStageFlags srcStages = batch.SrcStages;
+  if (srcStages == 0) {
+    srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+  }
+  const CompiledGraph& compiled = GetCompiledGraph();
+  vkCmdPipelineBarrier(
+      commandBuffer, srcStages, batch.DstStages, 0, 0, nullptr, batch.BufferBarrierCount,
+      compiled.BufferBarriers.data() + batch.FirstBufferBarrier, batch.ImageBarrierCount,
+      compiled.ImageBarriers.data() + batch.FirstImageBarrier
+  );
+  ++_stats.BarrierBatchCount;
+}
+
+void RenderGraph::RecordPass(VkCommandBuffer commandBuffer, u32 pass) {
+  const Pass& graphPass            = _passes[pass];
+  const CompiledPass& compiledPass = GetCompiledGraph().Passes[pass];
+  if (compiledPass.IsCulled) {
+    return;
+  }
+
+  RecordBarriers(commandBuffer, compiledPass.Barriers);
+  if (!graphPass.Execute) {
+    return;
+  }
+
+  if (compiledPass.RenderingInfo.sType == VK_STRUCTURE_TYPE_RENDERING_INFO) {
+    vkCmdBeginRendering(commandBuffer, &compiledPass.RenderingInfo);
+    graphPass.Execute(commandBuffer);
+    vkCmdEndRendering(commandBuffer);
+  } else if (compiledPass.BeginInfo.renderPass != VK_NULL_HANDLE) {
+    vkCmdBeginRenderPass(commandBuffer, &compiledPass.BeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    graphPass.Execute(commandBuffer);
+    vkCmdEndRenderPass(commandBuffer);
+  } else {
+    graphPass.Execute(commandBuffer);
+  }
+}
+}  // namespace VK
\ No newline at end of file
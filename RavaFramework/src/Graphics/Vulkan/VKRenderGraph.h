@@ -0,0 +1,283 @@
+#pragma once
+
+#include "Graphics/Vulkan/VKAllocator.h"
+
+namespace VK {
+class Context;
+
+enum class PassType : u8 {
+  Graphics,
+  Compute,
+  Transfer,
+};
+
+// How a pass uses a resource. Each usage maps to the stages, accesses and image layout the barriers
+// are built from, shader usages take their stages from the type of the pass.
+enum class ResourceUsage : u8 {
+  ColorAttachment,
+  DepthAttachment,
+  DepthReadOnly,  // depth tested, not written
+  Sampled,
+  StorageRead,
+  StorageWrite,
+  IndirectRead,
+  VertexRead,  // vertex or index buffer
+  TransferSrc,
+  TransferDst,
+  Present,
+};
+
+struct RenderGraphStats {
+  u32 PassCount          = 0;
+  u32 CulledPassCount    = 0;
+  u32 BarrierBatchCount  = 0;  // vkCmdPipelineBarrier calls
+  u32 ImageBarrierCount  = 0;
+  u32 BufferBarrierCount = 0;
+  u32 TransientCount     = 0;  // images created for the kept passes
+  u32 MemoryBucketCount  = 0;  // allocations the transient images are placed in
+  u64 TransientBytes     = 0;  // the images would take without aliasing
+  u64 AllocatedBytes     = 0;
+  u32 RenderPassCount    = 0;  // cached, none with dynamic rendering
+  u32 FramebufferCount   = 0;
+};
+
+// Passes declared in execution order with what they read and write. Compile drops the passes none
+// of the outputs depend on, derives the barriers and layout transitions between the rest from the
+// declared usages (reads of the same data share one barrier, read after read needs none) and places
+// transient images whose lifetimes do not overlap at the same memory.
+// Imported resources are the outputs: the swap chain image, buffers of other subsystems. Transient
+// images only live inside the frame, their contents are undefined at their first use.
+// The graph is declared again every frame into the slots of the previous one, so the declarations
+// allocate only when they grow. Names are kept by reference and have to be literals. Transient
+// images, render passes and framebuffers are created once and reused while the declarations stay
+// the same. So is the compiled graph: Compile
+// only compares the declarations against the last few it compiled, one per swap chain image.
+// With dynamic rendering (Vulkan 1.3) graphics passes begin their attachments directly and no
+// render passes or framebuffers exist.
+// Main thread.
+class RenderGraph {
+public:
+  static constexpr u32 INVALID_HANDLE = ~0u;
+
+  using ExecuteFunction = std::function<void(VkCommandBuffer commandBuffer)>;
+
+public:
+  RenderGraph(Shared<Context> context);
+  ~RenderGraph();
+
+  NO_COPY(RenderGraph)
+  NO_MOVE(RenderGraph)
+
+  // Drops the declarations of the previous frame, keeps their slots and what was created for them
+  void Reset();
+
+  u32 CreateImage(std::string_view name, VkFormat format, VkExtent2D extent);
+  // Contents are not kept, the first barrier waits for readyStages (the wait stage of the acquire
+  // semaphore for a swap chain image). The graph leaves the image in the layout of finalUsage.
+  u32 ImportImage(
+      std::string_view name, VkImage image, VkImageView view, VkFormat format, VkExtent2D extent,
+      VkPipelineStageFlags readyStages, ResourceUsage finalUsage
+  );
+  // Writes before the graph are synchronized by whoever made them
+  u32 ImportBuffer(std::string_view name, VkBuffer buffer, VkDeviceSize size = VK_WHOLE_SIZE);
+
+  // A graphics pass gets its attachments begun around execute. Without an execute function the
+  // pass is recorded by the caller between ExecuteUntil and Execute.
+  u32 AddPass(std::string_view name, PassType type, ExecuteFunction execute = nullptr);
+  void Read(u32 pass, u32 resource, ResourceUsage usage);
+  void Write(u32 pass, u32 resource, ResourceUsage usage);
+  // Attachments in declaration order, VK_ATTACHMENT_LOAD_OP_LOAD reads the image as well
+  void SetColorAttachment(
+      u32 pass, u32 image, VkAttachmentLoadOp loadOp, VkClearColorValue clearValue = {}
+  );
+  void SetDepthAttachment(
+      u32 pass, u32 image, VkAttachmentLoadOp loadOp, f32 clearDepth = 1.0f,
+      bool isReadOnly = false
+  );
+  // Never culled, for passes whose results leave the graph another way (readbacks)
+  void SetSideEffect(u32 pass);
+
+  void Compile();
+  // Records the kept passes up to pass and the barriers of pass, which the caller records itself.
+  // A graphics pass is begun with GetRenderPassBeginInfo, or GetRenderingInfo with dynamic
+  // rendering.
+  void ExecuteUntil(VkCommandBuffer commandBuffer, u32 pass);
+  // Records the remaining passes and the transitions into the final usages of imported images
+  void Execute(VkCommandBuffer commandBuffer);
+  const VkRenderPassBeginInfo& GetRenderPassBeginInfo(u32 pass) const;
+  const VkRenderingInfo& GetRenderingInfo(u32 pass) const;
+  // The attachment formats secondary command buffers recorded inside the pass inherit
+  const VkCommandBufferInheritanceRenderingInfo& GetRenderingInheritance(u32 pass) const;
+
+  // Every image placed at its own memory, for comparisons
+  void SetAliasingEnabled(bool isEnabled);
+  // The views of imported images changed (swap chain recreation)
+  void ReleaseFramebuffers();
+
+  inline bool IsDynamicRendering() const { return _isDynamicRendering; }
+  inline bool IsCulled(u32 pass) const { return GetCompiledGraph().Passes[pass].IsCulled; }
+  inline VkImageView GetImageView(u32 image) const { return _resources[image].View; }
+  inline VkImage GetImage(u32 image) const { return _resources[image].Image; }
+  inline const RenderGraphStats& GetStats() const { return _stats; }
+
+private:
+  struct Resource {
+    std::string_view Name;
+    bool IsImage    = true;
+    bool IsImported = false;
+
+    VkFormat Format                  = VK_FORMAT_UNDEFINED;
+    VkExtent2D Extent                = {};
+    VkImageUsageFlags ImageUsage     = 0;  // of every declared usage, for the transient images
+    VkImageAspectFlags Aspect        = 0;
+    VkImage Image                    = VK_NULL_HANDLE;
+    VkImageView View                 = VK_NULL_HANDLE;
+    VkBuffer Buffer                  = VK_NULL_HANDLE;
+    VkDeviceSize Size                = 0;
+    VkPipelineStageFlags ReadyStages = 0;
+    ResourceUsage FinalUsage         = ResourceUsage::Present;
+    bool HasFinalUsage               = false;
+
+    u32 FirstPass    = INVALID_HANDLE;  // of the kept passes
+    u32 LastPass     = INVALID_HANDLE;
+    u32 LastReadPass = INVALID_HANDLE;
+    u32 Transient    = INVALID_HANDLE;  // into _transients
+  };
+
+  struct Access {
+    u32 Resource        = INVALID_HANDLE;
+    ResourceUsage Usage = ResourceUsage::Sampled;
+    bool IsRead         = false;
+    bool IsWrite        = false;
+  };
+
+  struct Attachment {
+    u32 Image                 = INVALID_HANDLE;
+    VkAttachmentLoadOp LoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    VkClearValue ClearValue   = {};
+    ResourceUsage Usage       = ResourceUsage::ColorAttachment;
+  };
+
+  // Barriers recorded in front of a pass, ranges of the barriers of its CompiledGraph
+  struct BarrierBatch {
+    VkPipelineStageFlags SrcStages = 0;
+    VkPipelineStageFlags DstStages = 0;
+    u32 FirstImageBarrier          = 0;
+    u32 ImageBarrierCount          = 0;
+    u32 FirstBufferBarrier         = 0;
+    u32 BufferBarrierCount         = 0;
+  };
+
+  struct Pass {
+    std::string_view Name;
+    PassType Type = PassType::Graphics;
+    ExecuteFunction Execute;
+    std::vector<Access> Accesses;
+    std::vector<Attachment> Attachments;  // colors, then the depth attachment
+    bool HasDepth      = false;
+    bool HasSideEffect = false;
+    bool IsCulled      = false;  // while compiling
+  };
+
+  struct CompiledPass {
+    bool IsCulled = false;
+    BarrierBatch Barriers;
+    VkRenderPassBeginInfo BeginInfo{};
+    std::vector<VkClearValue> ClearValues;
+    // Dynamic rendering, in the order of Attachments
+    VkRenderingInfo RenderingInfo{};
+    std::vector<VkRenderingAttachmentInfo> AttachmentInfos;
+    VkCommandBufferInheritanceRenderingInfo Inheritance{};
+    std::vector<VkFormat> ColorFormats;
+  };
+
+  // Everything Compile derives from one set of declarations. It refers to the transient images,
+  // render passes and framebuffers, so it goes when they are released.
+  struct CompiledGraph {
+    std::vector<u64> Signature;  // of the declarations, see BuildSignature
+    std::vector<CompiledPass> Passes;
+    std::vector<u32> Transients;  // per resource, into _transients
+    std::vector<VkImageMemoryBarrier> ImageBarriers;
+    std::vector<VkBufferMemoryBarrier> BufferBarriers;
+    BarrierBatch FinalBarriers;
+    RenderGraphStats Stats;  // without the recorded barrier batches
+  };
+
+  // What the barrier in front of the next access has to wait for
+  struct ResourceState {
+    VkImageLayout Layout               = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkPipelineStageFlags WriteStages   = 0;  // of the last write or layout transition
+    VkAccessFlags WriteAccess          = 0;
+    VkPipelineStageFlags ReadStages    = 0;  // since then
+    VkPipelineStageFlags VisibleStages = 0;  // the last write was made visible to
+    VkAccessFlags VisibleAccess        = 0;
+  };
+
+  // A transient image and where it lives. The images placed in one bucket alias each other.
+  struct Transient {
+    VkImageCreateInfo CreateInfo{};
+    VkImageAspectFlags Aspect = 0;
+    u32 FirstPass             = 0;
+    u32 LastPass              = 0;
+    VkMemoryRequirements Requirements{};
+    u32 Bucket          = 0;
+    VkDeviceSize Offset = 0;  // in the bucket
+    VkImage Image       = VK_NULL_HANDLE;
+    VkImageView View    = VK_NULL_HANDLE;
+  };
+
+  struct MemoryBucket {
+    VkDeviceSize Size           = 0;
+    VkDeviceSize Alignment      = 1;
+    u32 MemoryTypeBits          = ~0u;
+    VkPipelineStageFlags Stages = 0;  // of every use of the images in it
+    VkAccessFlags WriteAccess   = 0;  // of every write to the images in it
+    Allocation Memory;
+  };
+
+  Shared<Context> _context;
+  bool _isDynamicRendering = false;
+  bool _isAliasingEnabled  = true;
+  u32 _compiledGraph       = INVALID_HANDLE;  // into _compiledGraphs, of this frame
+  u32 _nextPass            = 0;               // of ExecuteUntil and Execute
+  u32 _resourceCount       = 0;               // declared since Reset, Compile drops the rest
+  u32 _passCount           = 0;
+
+  std::vector<Resource> _resources;
+  std::vector<Pass> _passes;
+  std::vector<u64> _signature;
+  RenderGraphStats _stats;
+
+  // Kept while the transient images are declared the same way, compared by CreateTransients
+  std::vector<Transient> _transients;
+  std::vector<MemoryBucket> _buckets;
+  std::map<std::vector<u64>, VkRenderPass> _renderPasses;
+  std::map<std::vector<u64>, VkFramebuffer> _framebuffers;
+  std::vector<CompiledGraph> _compiledGraphs;  // oldest first
+
+private:
+  Resource& DeclareResource(std::string_view name);
+  // Everything Compile reads from the declarations, the imported handles included
+  void BuildSignature();
+  void UseCompiledGraph(u32 compiledGraph);
+  inline CompiledGraph& GetCompiledGraph() { return _compiledGraphs[_compiledGraph]; }
+  inline const CompiledGraph& GetCompiledGraph() const { return _compiledGraphs[_compiledGraph]; }
+  void Cull();
+  void ComputeLifetimes();
+  void CreateTransients();
+  void PlaceTransients();
+  void ReleaseTransients();
+  void BuildBarriers();
+  void AddAccessBarrier(
+      BarrierBatch& batch, u32 resource, ResourceUsage usage, PassType type, bool isWrite,
+      std::vector<ResourceState>& states
+  );
+  // Only what a later pass or an output reads is stored
+  VkAttachmentStoreOp GetStoreOp(u32 pass, const Attachment& attachment) const;
+  VkRenderPass GetRenderPass(u32 pass);
+  VkFramebuffer GetFramebuffer(u32 pass, VkRenderPass renderPass, VkExtent2D extent);
+  void BuildRenderingInfo(u32 pass, VkExtent2D extent);
+  void RecordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch);
+  void RecordPass(VkCommandBuffer commandBuffer, u32 pass);
+};
+}  // namespace VK
\ No newline at end of file
@@ -1,54 +1,109 @@
 #include "RavaFramework.h"
 
 #include "Core/Config.h"
+#include "Core/CpuProfiler.h"
+#include "Core/FrameAllocator.h"
+#include "Core/FramePacer.h"
+#include "Core/JobSystem.h"
 #include "Graphics/Vulkan/VKValidation.h"
 
 #include "Core/Window.h"
 #include "Graphics/Context.h"
+#include "Graphics/Vulkan/VKCommandRecorder.h"
 #include "Graphics/Vulkan/VKContext.h"
+#include "Graphics/Vulkan/VKDeletionQueue.h"
+#include "Graphics/Vulkan/VKGeometryPool.h"
+#include "Graphics/Vulkan/VKGpuProfiler.h"
+#include "Graphics/Vulkan/VKGpuScene.h"
+#include "Graphics/Vulkan/VKInstanceBatcher.h"
+#include "Graphics/Vulkan/VKRenderGraph.h"
 #include "Graphics/Vulkan/VKRenderer.h"
+#include "Graphics/Vulkan/VKStagingRing.h"
 #include "Graphics/Vulkan/VKSwapchain.h"
+#include "Graphics/Vulkan/VKUploader.h"
 #include "Graphics/Vulkan/VKUtils.h"
 
 namespace VK {
 // Unique<Context> Renderer::VKContext = nullptr;
 
 Renderer::Renderer() {
+  Rava::FrameAllocator::Create(MAX_FRAMES_SYNC);
+
   if (_context == nullptr) {
     _context = std::make_shared<Context>();
   }
-  _initialized = _context->IsInitialized();
+  _initialized     = _context->IsInitialized();
+  _geometryPool    = std::make_shared<GeometryPool>(
+      _context, MAX_FRAMES_SYNC, Config::SelectedVertexFormat, Config::GeometryPoolVertexCount,
+      Config::GeometryPoolIndexCount
+  );
+  _uploader        = std::make_unique<Uploader>(_context, _geometryPool);
+  _instanceBatcher = std::make_unique<InstanceBatcher>(_context, MAX_FRAMES_SYNC);
+  _renderGraph     = std::make_unique<RenderGraph>(_context);
   RecreateSwapChain();
   // RecreateRenderpass();
   CreateCommandBuffers();
+
+  if (Config::IsGpuProfilerEnabled) {
+    _gpuProfiler = std::make_unique<GpuProfiler>(_context, MAX_FRAMES_SYNC);
+  }
+
+  // The render pass is recorded inline when the profiler's statistics query can not be inherited
+  bool isParallel = Config::IsParallelRecordingEnabled
+                 && Rava::JobSystem::Instance->GetThreadCount() > 1
+                 && (!Config::IsGpuPipelineStatisticsEnabled
+                     || _context->GetEnabledFeatures().inheritedQueries);
+  _commandRecorder = std::make_unique<CommandRecorder>(_context, MAX_FRAMES_SYNC, isParallel);
+
+  if (Config::IsGpuSceneEnabled) {
+    _gpuScene = std::make_unique<GpuScene>(
+        _context, _geometryPool, _swapchain->GetPipelineTarget(), MAX_FRAMES_SYNC
+    );
+    if (!_gpuScene->IsValid()) {
+      std::print("GpuScene is not available, GPU driven rendering is disabled\n");
+      _gpuScene.reset();
+    }
+  }
 }
 
 Renderer::~Renderer() {
+  _commandRecorder.reset();
+  _renderGraph.reset();
+  _gpuScene.reset();
+  _gpuProfiler.reset();
+  _instanceBatcher.reset();
+  _uploader.reset();
+  _geometryPool.reset();
   _swapchain.reset();
   std::print("~Renderer");
   FreeCommandBuffers();
   // _context = nullptr;
   _context.reset();
+  Rava::FrameAllocator::Instance.reset();
 }
 
 void Renderer::RecreateSwapChain() {
+  RV_PROFILE_FUNCTION();
   std::print("WindowWidth: {}", Config::WindowWidth);
   VkExtent2D extent = {Config::WindowWidth, Config::WindowHeight};
-  while (extent.width == 0 || extent.height == 0) {
+  while (!Config::IsHeadless && (extent.width == 0 || extent.height == 0)) {
     extent = {Config::WindowWidth, Config::WindowHeight};
     glfwWaitEvents();
   }
 
-  vkDeviceWaitIdle(_context->GetLogicalDevice());
-
+  // No device wait, the old swapchain goes through the deletion queue
   if (_swapchain == nullptr) {
     _swapchain = std::make_unique<Swapchain>(_context);
   } else {
     // std::print("recreating swapchain at frame {0}", _frameCounter);
     Shared<Swapchain> oldSwapChain = std::move(_swapchain);
     _swapchain                     = std::make_unique<Swapchain>(_context, oldSwapChain);
+    _renderGraph->ReleaseFramebuffers();
     if (!oldSwapChain->CompareSwapFormats(*_swapchain.get())) {
       std::print("swap chain image or depth format has changed");
+      if (_gpuScene) {
+        _gpuScene->SetPipelineTarget(_swapchain->GetPipelineTarget());
+      }
     }
   }
 }
@@ -77,9 +132,16 @@ void Renderer::FreeCommandBuffers() {
 }
 
 void Renderer::BeginFrame() {
+  RV_PROFILE_FUNCTION();
   // assert(!m_frameInProgress,  "Can't Call BeginFrame while already in progress!");
 
+  // The present mode follows the latency mode, the frame count is read by every acquire
+  if (!_swapchain->IsHeadless() && _swapchain->GetLatencyMode() != Config::SelectedLatencyMode) {
+    RecreateSwapChain();
+  }
+
   auto result = _swapchain->AcquireNextImage(&_currentImageIndex);
+  Rava::FramePacer::Instance->MarkAcquired();
   if (result == VK_ERROR_OUT_OF_DATE_KHR) {
     RecreateSwapChain();
     // return nullptr;
@@ -92,6 +154,10 @@ void Renderer::BeginFrame() {
   //_frameInProgress = true;
   //_frameCounter++;
 
+  // The frame slot was waited on above, everything older is done as well
+  _context->GetDeletionQueue().Update();
+  Rava::FrameAllocator::Instance->BeginFrame(_swapchain->GetCurrentFrameIndex());
+
   _currentCommandBuffer = GetCurrentCommandBuffer();
   VkCommandBufferBeginInfo beginInfo{};
   beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -99,6 +165,27 @@ void Renderer::BeginFrame() {
   result = vkBeginCommandBuffer(_currentCommandBuffer, &beginInfo);
   IsResultValid(result, "Failed to Begin Recording Command Buffer!");
 
+  _commandRecorder->BeginFrame(_swapchain->GetCurrentFrameIndex());
+  _uploader->Update(_currentCommandBuffer);
+  _geometryPool->Update(_currentCommandBuffer, _swapchain->GetCurrentFrameIndex());
+
+  if (_gpuProfiler) {
+    _gpuProfiler->BeginFrame(_currentCommandBuffer, _swapchain->GetCurrentFrameIndex());
+    if (_gpuProfiler->HasLatestFrame()) {
+      Rava::FramePacer::Instance->RecordGpuFrame(
+          _gpuProfiler->GetLatestFrameNumber(), _gpuProfiler->GetLatestFrameMs()
+      );
+    }
+  }
+
+  // Compute work has to stay outside of the render pass
+  if (_gpuScene) {
+    _gpuScene->SetLodCamera(GetLodCamera());
+    BeginGpuScope("GpuSceneCull");
+    _gpuScene->Cull(_currentCommandBuffer, _swapchain->GetCurrentFrameIndex());
+    EndGpuScope();
+  }
+
   //_currentCommandBuffer = commandBuffer;
   //// return commandBuffer;
   // if (_currentCommandBuffer) {
@@ -111,14 +198,26 @@ void Renderer::BeginFrame() {
 }
 
 void Renderer::EndFrame() {
+  RV_PROFILE_FUNCTION();
   //_currentCommandBuffer = GetCurrentCommandBuffer();
+  if (_swapchain->IsHeadless()) {
+    _swapchain->RecordReadback(_currentCommandBuffer, _currentImageIndex);
+  }
+
+  if (_gpuProfiler) {
+    _gpuProfiler->EndFrame(_currentCommandBuffer);
+  }
+
   if (vkEndCommandBuffer(_currentCommandBuffer) != VK_SUCCESS) {
     throw std::runtime_error("failed to record command buffer!");
   }
 
+  // Uploads staged since the last frame go first, on the same queue
+  _context->GetStagingRing().Submit();
   auto result = _swapchain->SubmitCommandBuffers(&_currentCommandBuffer, &_currentImageIndex);
+  Rava::FramePacer::Instance->MarkPresented();
   if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR
-      || Rava::Window::Instance->IsResized()) {
+      || (Rava::Window::Instance && Rava::Window::Instance->IsResized())) {
     Rava::Window::Instance->ResetResizedFlag();
     RecreateSwapChain();
   } else if (result != VK_SUCCESS) {
@@ -130,29 +229,91 @@ void Renderer::EndFrame() {
 }
 
 void Renderer::BeginSwapChainRenderPass() {
+  RV_PROFILE_FUNCTION();
   // assert(isFrameStarted && "Can't call beginSwapChainRenderPass if frame is not in progress");
   // assert(
   //     commandBuffer == getCurrentCommandBuffer()
   //     && "Can't begin render pass on command buffer from a different frame"
   //);
 
-  VkRenderPassBeginInfo renderPassInfo{};
-  renderPassInfo.sType       = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-  renderPassInfo.renderPass  = _swapchain->GetRenderPass();
-  renderPassInfo.framebuffer = _swapchain->GetFrameBuffer(_currentImageIndex);
+  // The graph is declared again every frame around the swap chain render pass, the acquire
+  // semaphore is waited on at the color attachment output stage
+  RenderGraph& graph       = *_renderGraph;
+  VkExtent2D extent        = _swapchain->GetSwapChainExtent();
+  ResourceUsage finalUsage = _swapchain->IsHeadless() ? ResourceUsage::TransferSrc
+                                                      : ResourceUsage::Present;
+  graph.Reset();
+
+  SwapChainTargets targets;
+  targets.Color = graph.ImportImage(
+      "SwapChain", _swapchain->GetImage(_currentImageIndex),
+      _swapchain->GetImageView(_currentImageIndex), _swapchain->GetSwapChainImageFormat(), extent,
+      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, finalUsage
+  );
+  targets.Depth = graph.CreateImage("Depth", _swapchain->GetSwapChainDepthFormat(), extent);
 
-  renderPassInfo.renderArea.offset = {0, 0};
-  renderPassInfo.renderArea.extent = _swapchain->GetSwapChainExtent();
+  for (const GraphSetup& graphSetup : _graphSetups) {
+    if (!graphSetup.IsAfterSwapChainPass) {
+      graphSetup.Setup(graph, targets);
+    }
+  }
 
-  std::array<VkClearValue, 2> clearValues{};
-  clearValues[0].color
+  VkClearColorValue clearColor
       = {Config::ClearColor.r, Config::ClearColor.g, Config::ClearColor.b, Config::ClearColor.a};
-  clearValues[1].depthStencil    = {1.0f, 0};
-  renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-  renderPassInfo.pClearValues    = clearValues.data();
+  _swapChainPass = graph.AddPass("SwapChainRenderPass", PassType::Graphics);
+  graph.SetColorAttachment(_swapChainPass, targets.Color, VK_ATTACHMENT_LOAD_OP_CLEAR, clearColor);
+  graph.SetDepthAttachment(_swapChainPass, targets.Depth, VK_ATTACHMENT_LOAD_OP_CLEAR);
+
+  for (const GraphSetup& graphSetup : _graphSetups) {
+    if (graphSetup.IsAfterSwapChainPass) {
+      graphSetup.Setup(graph, targets);
+    }
+  }
 
-  vkCmdBeginRenderPass(_currentCommandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+  graph.Compile();
+  graph.ExecuteUntil(_currentCommandBuffer, _swapChainPass);
+
+  // The statistics query of the scope is open in the primary command buffer now
+  BeginGpuScope("SwapChainRenderPass");
+  VkQueryPipelineStatisticFlags statistics
+      = _gpuProfiler ? _gpuProfiler->GetActiveStatistics() : 0;
+  auto setup = [this](VkCommandBuffer commandBuffer) { SetRenderPassState(commandBuffer); };
+  if (graph.IsDynamicRendering()) {
+    _commandRecorder->BeginRendering(
+        _currentCommandBuffer, graph.GetRenderingInfo(_swapChainPass),
+        graph.GetRenderingInheritance(_swapChainPass), statistics, setup
+    );
+  } else {
+    _commandRecorder->BeginRenderPass(
+        _currentCommandBuffer, graph.GetRenderPassBeginInfo(_swapChainPass), statistics, setup
+    );
+  }
+  _isInRenderPass = true;
+}
 
+void Renderer::EndSwapChainRenderPass() {
+  // assert(isFrameStarted && "Can't call endSwapChainRenderPass if frame is not in progress");
+  // assert(
+  //     commandBuffer == getCurrentCommandBuffer()
+  //     && "Can't end render pass on command buffer from a different frame"
+  //);
+  if (_gpuScene) {
+    _gpuScene->Draw(*_commandRecorder);
+  }
+  _instanceBatcher->Flush(*_commandRecorder, _swapchain->GetCurrentFrameIndex());
+  _isInRenderPass = false;
+  _commandRecorder->EndRenderPass();
+  EndGpuScope();
+
+  // The passes after it and the transition of the swap chain image for the present or the readback
+  _renderGraph->Execute(_currentCommandBuffer);
+}
+
+void Renderer::AddGraphSetup(GraphSetupFunction setup, bool isAfterSwapChainPass) {
+  _graphSetups.push_back({std::move(setup), isAfterSwapChainPass});
+}
+
+void Renderer::SetRenderPassState(VkCommandBuffer commandBuffer) const {
   VkViewport viewport{};
   viewport.x        = 0.0f;
   viewport.y        = 0.0f;
@@ -164,24 +325,64 @@ void Renderer::BeginSwapChainRenderPass() {
       {0, 0},
       _swapchain->GetSwapChainExtent()
   };
-  vkCmdSetViewport(_currentCommandBuffer, 0, 1, &viewport);
-  vkCmdSetScissor(_currentCommandBuffer, 0, 1, &scissor);
-}
+  vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+  vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-void Renderer::EndSwapChainRenderPass() {
-  // assert(isFrameStarted && "Can't call endSwapChainRenderPass if frame is not in progress");
-  // assert(
-  //     commandBuffer == getCurrentCommandBuffer()
-  //     && "Can't end render pass on command buffer from a different frame"
-  //);
-  vkCmdEndRenderPass(_currentCommandBuffer);
+  // The only geometry binding of the frame, every model draws out of the pool
+  _geometryPool->Bind(commandBuffer);
 }
 
 void Renderer::WaitDeviceIdle() {
   vkDeviceWaitIdle(_context->GetLogicalDevice());
 }
 
+void Renderer::WaitForFrameSlot() {
+  _swapchain->WaitForFrameSlot();
+}
+
+void Renderer::SavePipelineCache() {
+  _context->SavePipelineCache();
+}
+
+bool Renderer::GetFramePixels(std::vector<u8>& pixels) const {
+  return _swapchain->GetFramePixels(pixels);
+}
+
+void Renderer::BeginGpuScope(std::string_view name) {
+  if (_gpuProfiler) {
+    _gpuProfiler->BeginScope(GetCurrentCommandBuffer(), name);
+  }
+}
+
+void Renderer::EndGpuScope() {
+  if (_gpuProfiler) {
+    _gpuProfiler->EndScope(GetCurrentCommandBuffer());
+  }
+}
+
+bool Renderer::GetGpuFrameTimings(Rava::GpuFrameTimings& timings) const {
+  return _gpuProfiler && _gpuProfiler->GetLatestFrame(timings);
+}
+
+void Renderer::SetLodCamera(const Vec3& position, f32 verticalFov) {
+  _lodPosition = position;
+  _lodFov      = verticalFov;
+}
+
+Rava::LodCamera Renderer::GetLodCamera() const {
+  Rava::LodCamera camera;
+  camera.Position = _lodPosition;
+  if (_lodFov > 0.0f) {
+    f32 height             = static_cast<f32>(_swapchain->GetSwapChainExtent().height);
+    camera.ProjectionScale = height / (2.0f * std::tan(_lodFov * 0.5f));
+  }
+  return camera;
+}
+
 VkCommandBuffer Renderer::GetCurrentCommandBuffer() const {
+  if (_isInRenderPass) {
+    return _commandRecorder->GetCommandBuffer();
+  }
   return _commandBuffers[_swapchain->GetCurrentFrameIndex()];
 }
 }  // namespace VK
\ No newline at end of file
@@ -1,11 +1,30 @@
 #pragma once
 
+#include "Graphics/Model.h"
 #include "Graphics/Renderer.h"
 
 namespace VK {
+class CommandRecorder;
 class Context;
+class GeometryPool;
+class GpuProfiler;
+class GpuScene;
+class InstanceBatcher;
+class RenderGraph;
 class Swapchain;
+class Uploader;
+
+// Images of the swap chain render pass in the render graph of the current frame
+struct SwapChainTargets {
+  u32 Color = ~0u;
+  u32 Depth = ~0u;
+};
+
 class Renderer : public Rava::Renderer {
+public:
+  using GraphSetupFunction
+      = std::function<void(RenderGraph& graph, const SwapChainTargets& targets)>;
+
 public:
   // static Unique<DescriptorPool> GlobalDescriptorPool;
   //static Unique<Context> VKContext;
@@ -22,15 +41,57 @@ public:
   virtual void EndSwapChainRenderPass() override;
 
   virtual void WaitDeviceIdle() override;
+  virtual void WaitForFrameSlot() override;
+  virtual void SavePipelineCache() override;
+
+  virtual bool GetFramePixels(std::vector<u8>& pixels) const override;
+
+  virtual void BeginGpuScope(std::string_view name) override;
+  virtual void EndGpuScope() override;
+  virtual bool GetGpuFrameTimings(Rava::GpuFrameTimings& timings) const override;
+
+  virtual void SetLodCamera(const Vec3& position, f32 verticalFov) override;
+  // Scaled to the current swap chain height, ProjectionScale is 0 until SetLodCamera
+  Rava::LodCamera GetLodCamera() const;
 
   const Shared<Context> GetContext() const { return _context; }
+  const Shared<GeometryPool>& GetGeometryPool() const { return _geometryPool; }
+  Uploader& GetUploader() const { return *_uploader; }
+  InstanceBatcher& GetInstanceBatcher() const { return *_instanceBatcher; }
+  // nullptr unless Config::IsGpuSceneEnabled and the device supports it
+  GpuScene* GetGpuScene() const { return _gpuScene.get(); }
+  CommandRecorder& GetCommandRecorder() const { return *_commandRecorder; }
+  RenderGraph& GetRenderGraph() const { return *_renderGraph; }
+  // Declares passes every frame, in front of the swap chain render pass or after it. Passes none of
+  // the outputs depend on are culled.
+  void AddGraphSetup(GraphSetupFunction setup, bool isAfterSwapChainPass = false);
+  // Inside the swap chain render pass a secondary command buffer when recording in parallel. GPU
+  // scopes opened inside the render pass have to be closed inside it.
   VkCommandBuffer GetCurrentCommandBuffer() const;
 
 private:
   Shared<Context> _context;
   Unique<Swapchain> _swapchain;
+  Shared<GeometryPool> _geometryPool;
+  Unique<Uploader> _uploader;
+  Unique<GpuProfiler> _gpuProfiler;
+  Unique<InstanceBatcher> _instanceBatcher;
+  Unique<GpuScene> _gpuScene;
+  Unique<CommandRecorder> _commandRecorder;
+  Unique<RenderGraph> _renderGraph;
   std::vector<VkCommandBuffer> _commandBuffers;
-  VkCommandBuffer _currentCommandBuffer = VK_NULL_HANDLE;
+  VkCommandBuffer _currentCommandBuffer = VK_NULL_HANDLE;  // primary
+  bool _isInRenderPass                  = false;
+
+  struct GraphSetup {
+    GraphSetupFunction Setup;
+    bool IsAfterSwapChainPass = false;
+  };
+  std::vector<GraphSetup> _graphSetups;
+  u32 _swapChainPass = 0;  // in the render graph
+
+  Vec3 _lodPosition{0.0f};
+  f32 _lodFov = 0.0f;
 
   u32 _currentImageIndex;
   u32 _currentFrameIndex;
@@ -41,6 +102,8 @@ private:
   //void RecreateRenderpass();
   void CreateCommandBuffers();
   void FreeCommandBuffers();
+  // Viewport, scissor and the geometry pool, for the primary and every secondary command buffer
+  void SetRenderPassState(VkCommandBuffer commandBuffer) const;
   //void Recreate();
 };
 }  // namespace VK
\ No newline at end of file
@@ -0,0 +1,296 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Vulkan/VKStagingRing.h"
+
+#include "Graphics/Vulkan/VKContext.h"
+#include "Graphics/Vulkan/VKValidation.h"
+
+namespace VK {
+static constexpr VkMemoryPropertyFlags STAGING_MEMORY
+    = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static VkImageMemoryBarrier CreateLayoutBarrier(
+    VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask,
+    VkAccessFlags dstAccessMask
+) {
+  VkImageMemoryBarrier barrier{};
+  barrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.srcAccessMask       = srcAccessMask;
+  barrier.dstAccessMask       = dstAccessMask;
+  barrier.oldLayout           = oldLayout;
+  barrier.newLayout           = newLayout;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image               = image;
+  barrier.subresourceRange    = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+  return barrier;
+}
+
+StagingRing::StagingRing(Context& context, VkDeviceSize size)
+    : _context(context),
+      _size(AlignUp(size, UPLOAD_ALIGNMENT)),
+      _timeline(context.GetLogicalDevice()) {
+  VkDevice device = _context.GetLogicalDevice();
+  _context.CreateBuffer(_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, STAGING_MEMORY, _buffer, _memory);
+  _mapped = static_cast<u8*>(_memory.Mapped);
+
+  // A pool of its own, the submissions are recorded while the context pool may be in use
+  VkCommandPoolCreateInfo poolInfo{};
+  poolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  poolInfo.queueFamilyIndex = static_cast<u32>(_context.GetQueueFamilyIndices().GraphicsFamily);
+  VkResult result           = vkCreateCommandPool(device, &poolInfo, nullptr, &_commandPool);
+  IsResultValid(result, "Failed to Create Staging Command Pool!\n");
+
+  std::array<VkCommandBuffer, MAX_SUBMISSIONS> commandBuffers{};
+  VkCommandBufferAllocateInfo allocInfo{};
+  allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.commandPool        = _commandPool;
+  allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandBufferCount = MAX_SUBMISSIONS;
+  result = vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data());
+  IsResultValid(result, "Failed to Allocate Staging Command Buffers!\n");
+
+  for (u32 i = 0; i < MAX_SUBMISSIONS; ++i) {
+    _submissions[i].CommandBuffer = commandBuffers[i];
+  }
+}
+
+StagingRing::~StagingRing() {
+  Wait(_timeline.GetSubmittedValue());
+  // Uploads that were never submitted
+  for (DedicatedBuffer& dedicated : _dedicatedBuffers) {
+    _context.DestroyBuffer(dedicated.Buffer, dedicated.Memory);
+  }
+
+  vkDestroyCommandPool(_context.GetLogicalDevice(), _commandPool, nullptr);
+  _context.DestroyBuffer(_buffer, _memory);
+}
+
+void StagingRing::UploadBuffer(
+    VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size,
+    VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask
+) {
+  if (size == 0) {
+    return;
+  }
+
+  StagingSpan staging = Allocate(size);
+  memcpy(staging.Mapped, data, size);
+
+  BufferCopy& copy  = _bufferCopies.emplace_back();
+  copy.DstBuffer    = dstBuffer;
+  copy.SrcBuffer    = staging.Buffer;
+  copy.Region       = {staging.Offset, dstOffset, size};
+  _dstStageMask    |= dstStageMask;
+  _dstAccessMask   |= dstAccessMask;
+}
+
+void StagingRing::UploadImage(
+    VkImage image, VkExtent3D extent, const void* data, VkDeviceSize size,
+    VkImageLayout finalLayout, VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask
+) {
+  StagingSpan staging = Allocate(size);
+  memcpy(staging.Mapped, data, size);
+
+  ImageCopy& copy               = _imageCopies.emplace_back();
+  copy.Image                    = image;
+  copy.SrcBuffer                = staging.Buffer;
+  copy.Region.bufferOffset      = staging.Offset;
+  copy.Region.imageSubresource  = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+  copy.Region.imageExtent       = extent;
+  copy.FinalLayout              = finalLayout;
+  _dstStageMask                |= dstStageMask;
+  _dstAccessMask               |= dstAccessMask;
+}
+
+u64 StagingRing::Submit() {
+  Reclaim();
+  if (_bufferCopies.empty() && _imageCopies.empty()) {
+    return _timeline.GetSubmittedValue();
+  }
+
+  // The slot is still owned by the submission MAX_SUBMISSIONS before this one
+  u64 value              = _timeline.GetSubmittedValue() + 1;
+  Submission& submission = GetSubmission(value);
+  if (value > MAX_SUBMISSIONS && _completedValue < value - MAX_SUBMISSIONS) {
+    Stall(value - MAX_SUBMISSIONS);
+  }
+  Record(submission);
+
+  VkTimelineSemaphoreSubmitInfo timelineInfo{};
+  timelineInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+  timelineInfo.signalSemaphoreValueCount = 1;
+  timelineInfo.pSignalSemaphoreValues    = &value;
+
+  VkSemaphore semaphore = _timeline.GetSemaphore();
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.pNext                = &timelineInfo;
+  submitInfo.commandBufferCount   = 1;
+  submitInfo.pCommandBuffers      = &submission.CommandBuffer;
+  submitInfo.signalSemaphoreCount = 1;
+  submitInfo.pSignalSemaphores    = &semaphore;
+  VkResult result = vkQueueSubmit(_context.GetGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+  IsResultValid(result, "Failed to Submit Staging Uploads!\n");
+
+  submission.RingEnd          = _head;
+  submission.DedicatedBuffers = std::move(_dedicatedBuffers);
+  _timeline.Next();
+  ++_stats.SubmitCount;
+
+  _bufferCopies.clear();
+  _imageCopies.clear();
+  _dedicatedBuffers.clear();
+  _dstStageMask  = 0;
+  _dstAccessMask = 0;
+  return value;
+}
+
+void StagingRing::Wait(u64 value) {
+  _timeline.Wait(std::min(value, _timeline.GetSubmittedValue()));
+  Reclaim();
+}
+
+u64 StagingRing::GetCompletedValue() {
+  Reclaim();
+  return _completedValue;
+}
+
+StagingRing::StagingSpan StagingRing::Allocate(VkDeviceSize size) {
+  ++_stats.UploadCount;
+  _stats.UploadedBytes += size;
+
+  if (size > _size / 4) {
+    DedicatedBuffer& dedicated = _dedicatedBuffers.emplace_back();
+    _context.CreateBuffer(
+        size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, STAGING_MEMORY, dedicated.Buffer, dedicated.Memory
+    );
+    ++_stats.DedicatedCount;
+    return {dedicated.Buffer, 0, static_cast<u8*>(dedicated.Memory.Mapped)};
+  }
+
+  // An upload never wraps around, the space left at the end of the ring is skipped instead
+  VkDeviceSize alignedSize = AlignUp(size, UPLOAD_ALIGNMENT);
+  auto findStart           = [&]() {
+    VkDeviceSize offset = _head % _size;
+    return offset + alignedSize > _size ? _head + (_size - offset) : _head;
+  };
+
+  u64 start = findStart();
+  if (start + alignedSize - _tail > _size) {
+    Reclaim();
+  }
+  if (start + alignedSize - _tail > _size) {
+    // The queued copies hold the space up to the head, it only comes back once they were submitted
+    Submit();
+  }
+  while (start + alignedSize - _tail > _size) {
+    assert(_completedValue < _timeline.GetSubmittedValue() && "An empty ring fits every upload");
+    Stall(_completedValue + 1);
+  }
+
+  VkDeviceSize offset  = start % _size;
+  _stats.Wasted       += start - _head;
+  _head                = start + alignedSize;
+  return {_buffer, offset, _mapped + offset};
+}
+
+void StagingRing::Stall(u64 value) {
+  auto start = std::chrono::steady_clock::now();
+  Wait(value);
+  f64 stallMs = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start)
+                    .count();
+
+  ++_stats.StallCount;
+  _stats.StallMs    += stallMs;
+  _stats.MaxStallMs  = std::max(_stats.MaxStallMs, stallMs);
+}
+
+void StagingRing::Record(Submission& submission) {
+  VkCommandBuffer commandBuffer = submission.CommandBuffer;
+  vkResetCommandBuffer(commandBuffer, 0);
+
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+  Rava::ScratchScope scratch;
+  std::pmr::vector<VkImageMemoryBarrier> imageBarriers(scratch.GetResource());
+  if (!_imageCopies.empty()) {
+    for (const ImageCopy& copy : _imageCopies) {
+      imageBarriers.push_back(CreateLayoutBarrier(
+          copy.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0,
+          VK_ACCESS_TRANSFER_WRITE_BIT
+      ));
+    }
+    vkCmdPipelineBarrier(
+        commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
+        nullptr, 0, nullptr, static_cast<u32>(imageBarriers.size()), imageBarriers.data()
+    );
+  }
+
+  // One vkCmdCopyBuffer per source and destination pair, in upload order within each
+  std::stable_sort(
+      _bufferCopies.begin(), _bufferCopies.end(), [](const BufferCopy& a, const BufferCopy& b) {
+        return std::tie(a.DstBuffer, a.SrcBuffer) < std::tie(b.DstBuffer, b.SrcBuffer);
+      }
+  );
+  std::pmr::vector<VkBufferCopy> regions(scratch.GetResource());
+  for (size_t i = 0; i < _bufferCopies.size();) {
+    const BufferCopy& first = _bufferCopies[i];
+    regions.clear();
+    for (; i < _bufferCopies.size() && _bufferCopies[i].DstBuffer == first.DstBuffer
+           && _bufferCopies[i].SrcBuffer == first.SrcBuffer;
+         ++i) {
+      regions.push_back(_bufferCopies[i].Region);
+    }
+    vkCmdCopyBuffer(
+        commandBuffer, first.SrcBuffer, first.DstBuffer, static_cast<u32>(regions.size()),
+        regions.data()
+    );
+  }
+
+  for (const ImageCopy& copy : _imageCopies) {
+    vkCmdCopyBufferToImage(
+        commandBuffer, copy.SrcBuffer, copy.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
+        &copy.Region
+    );
+  }
+
+  // Every copy is made visible to the first use of every destination at once
+  imageBarriers.clear();
+  for (const ImageCopy& copy : _imageCopies) {
+    imageBarriers.push_back(CreateLayoutBarrier(
+        copy.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, copy.FinalLayout,
+        VK_ACCESS_TRANSFER_WRITE_BIT, _dstAccessMask
+    ));
+  }
+  VkMemoryBarrier memoryBarrier{};
+  memoryBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  memoryBarrier.dstAccessMask = _dstAccessMask;
+  vkCmdPipelineBarrier(
+      commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, _dstStageMask, 0, 1, &memoryBarrier, 0,
+      nullptr, static_cast<u32>(imageBarriers.size()), imageBarriers.data()
+  );
+  vkEndCommandBuffer(commandBuffer);
+}
+
+void StagingRing::Reclaim() {
+  u64 completedValue = _timeline.GetCompletedValue();
+  for (; _completedValue < completedValue; ++_completedValue) {
+    Submission& submission = GetSubmission(_completedValue + 1);
+    for (DedicatedBuffer& dedicated : submission.DedicatedBuffers) {
+      _context.DestroyBuffer(dedicated.Buffer, dedicated.Memory);
+    }
+    submission.DedicatedBuffers.clear();
+    _tail = submission.RingEnd;
+  }
+}
+}  // namespace VK
\ No newline at end of file
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "Graphics/Vulkan/VKAllocator.h"
+#include "Graphics/Vulkan/VKTimeline.h"
+
+namespace VK {
+class Context;
+
+struct StagingStats {
+  u64 UploadedBytes   = 0;
+  u32 UploadCount     = 0;
+  u32 SubmitCount     = 0;
+  u32 DedicatedCount  = 0;  // uploads too large for the ring, staged in a buffer of their own
+  u32 StallCount      = 0;  // waits for the GPU to hand back ring space or a submission slot
+  f64 StallMs         = 0.0;
+  f64 MaxStallMs      = 0.0;
+  VkDeviceSize Wasted = 0;  // skipped at the end of the ring when an upload did not fit in front
+};
+
+// Persistently mapped ring of host visible memory uploads are staged in, owned by the Context.
+// An upload copies the data in right away and queues the transfer, Submit records every queued
+// transfer into a single command buffer on the graphics queue (Renderer::EndFrame calls it before
+// submitting the frame, so the frame sees the data). Submissions signal their number on a timeline
+// semaphore, the ring space of one is reused once the timeline has passed it. Uploads larger
+// than a quarter of the ring get a temporary buffer that is destroyed the same way. Only when the
+// ring or the submission slots run out does an upload wait for the GPU, counted as stall time.
+// Main thread only, the submissions share the graphics queue with the frames.
+class StagingRing {
+public:
+  static constexpr u32 MAX_SUBMISSIONS           = 8;
+  static constexpr VkDeviceSize UPLOAD_ALIGNMENT = 16;  // also a multiple of every texel size
+
+public:
+  StagingRing(Context& context, VkDeviceSize size);
+  ~StagingRing();
+
+  NO_COPY(StagingRing)
+  NO_MOVE(StagingRing)
+
+  // The destination is written by the next Submit, dstStageMask and dstAccessMask are its first
+  // use by later commands on the graphics queue
+  void UploadBuffer(
+      VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size,
+      VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask
+  );
+  // First mip level and layer of a color image, tightly packed. The image goes from undefined to
+  // finalLayout, its previous contents are discarded.
+  void UploadImage(
+      VkImage image, VkExtent3D extent, const void* data, VkDeviceSize size,
+      VkImageLayout finalLayout, VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask
+  );
+
+  // Returns the number of the submission, or that of the latest one when nothing was queued
+  u64 Submit();
+  // Blocks until the submission numbered value has finished on the GPU
+  void Wait(u64 value);
+  u64 GetCompletedValue();
+
+  inline VkDeviceSize GetSize() const { return _size; }
+  inline const StagingStats& GetStats() const { return _stats; }
+  inline void ResetStats() { _stats = {}; }
+
+private:
+  struct BufferCopy {
+    VkBuffer DstBuffer = VK_NULL_HANDLE;
+    VkBuffer SrcBuffer = VK_NULL_HANDLE;
+    VkBufferCopy Region{};
+  };
+
+  struct ImageCopy {
+    VkImage Image      = VK_NULL_HANDLE;
+    VkBuffer SrcBuffer = VK_NULL_HANDLE;
+    VkBufferImageCopy Region{};
+    VkImageLayout FinalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  };
+
+  struct DedicatedBuffer {
+    VkBuffer Buffer = VK_NULL_HANDLE;
+    Allocation Memory;
+  };
+
+  struct StagingSpan {
+    VkBuffer Buffer     = VK_NULL_HANDLE;
+    VkDeviceSize Offset = 0;
+    u8* Mapped          = nullptr;
+  };
+
+  struct Submission {
+    VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+    u64 RingEnd                   = 0;  // ring position up to which the submission owns the space
+    std::vector<DedicatedBuffer> DedicatedBuffers;
+  };
+
+  Context& _context;
+  VkDeviceSize _size = 0;
+  VkBuffer _buffer   = VK_NULL_HANDLE;
+  Allocation _memory;
+  u8* _mapped                = nullptr;
+  VkCommandPool _commandPool = VK_NULL_HANDLE;
+
+  // Ring positions only grow, the offset in the buffer is the position modulo the size
+  u64 _head = 0;
+  u64 _tail = 0;
+
+  std::array<Submission, MAX_SUBMISSIONS> _submissions;
+  Timeline _timeline;
+  u64 _completedValue = 0;  // every submission up to it was reclaimed
+
+  std::vector<BufferCopy> _bufferCopies;
+  std::vector<ImageCopy> _imageCopies;
+  std::vector<DedicatedBuffer> _dedicatedBuffers;
+  VkPipelineStageFlags _dstStageMask = 0;
+  VkAccessFlags _dstAccessMask       = 0;
+
+  StagingStats _stats;
+
+private:
+  // Ring space or a dedicated buffer for size bytes
+  StagingSpan Allocate(VkDeviceSize size);
+  // Waits like Wait and counts it as a stall
+  void Stall(u64 value);
+  void Record(Submission& submission);
+  // Hands back the space and dedicated buffers of every finished submission
+  void Reclaim();
+  Submission& GetSubmission(u64 value) { return _submissions[value % MAX_SUBMISSIONS]; }
+};
+}  // namespace VK
\ No newline at end of file
@@ -3,7 +3,10 @@
 #include "Graphics/Vulkan/VKSwapchain.h"
 
 #include "Core/Config.h"
+#include "Core/CpuProfiler.h"
 #include "Graphics/Vulkan/VKContext.h"
+#include "Graphics/Vulkan/VKDeletionQueue.h"
+#include "Graphics/Vulkan/VKTimeline.h"
 #include "Graphics/Vulkan/VKUtils.h"
 #include "Graphics/Vulkan/VkRenderer.h"
 
@@ -12,59 +15,74 @@ Swapchain::Swapchain(Shared<Context> context) : Swapchain(context, nullptr) {}
 
 Swapchain::Swapchain(Shared<Context> context, Shared<Swapchain> oldSwapchain)
     : _context(context), _oldSwapchain(oldSwapchain) {
+  _isHeadless  = _context->IsHeadless();
+  _latencyMode = Config::SelectedLatencyMode;
+  // Slots follow the frame numbers, so a recreated swapchain goes on where the old one stopped
+  _currentFrameIndex = (_context->GetFrameTimeline().GetSubmittedValue() + 1) % MAX_FRAMES_SYNC;
   Init();
   _oldSwapchain = nullptr;
 }
 
+// Frames in flight may still use everything, it is released once they finished, so recreating the
+// swapchain does not have to wait for the device. The presentation engine is assumed to be done
+// with the render finished semaphores once a later frame finished on the same queue.
 Swapchain::~Swapchain() {
   std::print("~Swapchain");
-  auto device = _context->GetLogicalDevice();
-  for (size_t i = 0; i < _swapchainImages.size(); ++i) {
-    vkDestroySemaphore(device, _renderFinishedSemaphores[i], nullptr);
+  DeletionQueue& deletionQueue = _context->GetDeletionQueue();
+  for (auto& semaphore : _renderFinishedSemaphores) {
+    deletionQueue.DestroySemaphore(semaphore);
   }
-  for (int i = 0; i < MAX_FRAMES_SYNC; ++i) {
-    vkDestroySemaphore(device, _imageAvailableSemaphores[i], nullptr);
-    vkDestroyFence(device, _inFlightFences[i], nullptr);
+  for (auto& semaphore : _imageAvailableSemaphores) {
+    deletionQueue.DestroySemaphore(semaphore);
   }
 
-  for (auto framebuffer : _swapchainFramebuffers) {
-    vkDestroyFramebuffer(device, framebuffer, nullptr);
+  for (size_t i = 0; i < _readbackBuffers.size(); ++i) {
+    deletionQueue.DestroyBuffer(_readbackBuffers[i], _readbackAllocations[i]);
   }
 
-  vkDestroyRenderPass(device, _renderPass, nullptr);
+  deletionQueue.DestroyRenderPass(_renderPass);
 
-  for (size_t i = 0; i < _depthImages.size(); ++i) {
-    vkDestroyImageView(device, _depthImageViews[i], nullptr);
-    vkDestroyImage(device, _depthImages[i], nullptr);
-    vkFreeMemory(device, _depthImageMemorys[i], nullptr);
+  for (auto& imageView : _swapchainImageViews) {
+    deletionQueue.DestroyImageView(imageView);
   }
+  _swapchainImageViews.clear();
 
-  for (auto imageView : _swapchainImageViews) {
-    vkDestroyImageView(device, imageView, nullptr);
+  if (_isHeadless) {
+    for (size_t i = 0; i < _swapchainImages.size(); ++i) {
+      deletionQueue.DestroyImage(_swapchainImages[i], _offscreenImageAllocations[i]);
+    }
+    return;
   }
-  _swapchainImageViews.clear();
 
-  vkDestroySwapchainKHR(device, _swapchain, nullptr);
-  _swapchain = VK_NULL_HANDLE;
+  deletionQueue.DestroySwapchain(_swapchain);
 }
 
 void Swapchain::Init() {
-  CreateSwapchain();
+  if (_isHeadless) {
+    CreateOffscreenImages();
+  } else {
+    CreateSwapchain();
+  }
   CreateImageViews();
-  CreateRenderPass();
-  CreateDepthResources();
-  CreateFramebuffers();
+  if (!_context->GetEnabledFeatures13().dynamicRendering) {
+    CreateRenderPass();
+  }
   CreateSyncObjects();
+  CreateReadbackBuffers();
 }
 
 void Swapchain::CreateSwapchain() {
-  SwapchainDetails swapchainDetail = _context->GetSwapchainDetails();
+  const SwapchainDetails& swapchainDetail = _context->GetSwapchainDetails();
 
   VkSurfaceFormatKHR surfaceFormat = ChooseSurfaceFormat(swapchainDetail.Formats);
   VkPresentModeKHR presentMode     = ChoosePresentMode(swapchainDetail.PresentModes);
   VkExtent2D extent                = ChooseSwapExtent(swapchainDetail.SurfaceCapabilities);
 
+  // One more image keeps the deeper queue of the throughput mode from blocking on the acquire
   u32 imageCount = swapchainDetail.SurfaceCapabilities.minImageCount + 1;
+  if (_latencyMode == LatencyMode::Throughput) {
+    ++imageCount;
+  }
   if (swapchainDetail.SurfaceCapabilities.maxImageCount > 0
       && imageCount > swapchainDetail.SurfaceCapabilities.maxImageCount) {
     imageCount = swapchainDetail.SurfaceCapabilities.maxImageCount;
@@ -84,8 +102,8 @@ void Swapchain::CreateSwapchain() {
   createInfo.presentMode              = presentMode;
   createInfo.clipped                  = VK_TRUE;
 
-  QueueFamilyIndices indices = _context->GetPhysicalQueueFamilies();
-  u32 queueFamilyIndices[]   = {indices.GraphicsFamily, indices.PresentFamily};
+  const QueueFamilyIndices& indices = _context->GetQueueFamilyIndices();
+  u32 queueFamilyIndices[]          = {indices.GraphicsFamily, indices.PresentFamily};
 
   if (indices.GraphicsFamily != indices.PresentFamily) {
     createInfo.imageSharingMode      = VK_SHARING_MODE_CONCURRENT;
@@ -117,6 +135,38 @@ void Swapchain::CreateSwapchain() {
   _swapchainDepthFormat = FindDepthFormat();
 }
 
+void Swapchain::CreateOffscreenImages() {
+  _swapchainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+  _swapchainExtent      = {Config::WindowWidth, Config::WindowHeight};
+  _swapchainDepthFormat = FindDepthFormat();
+
+  // One target per frame in flight, the image index always follows the frame index
+  _swapchainImages.resize(MAX_FRAMES_SYNC);
+  _offscreenImageAllocations.resize(MAX_FRAMES_SYNC);
+  for (size_t i = 0; i < _swapchainImages.size(); ++i) {
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+    imageInfo.extent.width  = _swapchainExtent.width;
+    imageInfo.extent.height = _swapchainExtent.height;
+    imageInfo.extent.depth  = 1;
+    imageInfo.mipLevels     = 1;
+    imageInfo.arrayLayers   = 1;
+    imageInfo.format        = _swapchainImageFormat;
+    imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage         = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.flags         = 0;
+
+    _context->CreateImageWithInfo(
+        imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _swapchainImages[i],
+        _offscreenImageAllocations[i]
+    );
+  }
+}
+
 void Swapchain::CreateImageViews() {
   _swapchainImageViews.resize(_swapchainImages.size());
   for (size_t i = 0; i < _swapchainImages.size(); i++) {
@@ -140,6 +190,9 @@ void Swapchain::CreateImageViews() {
   }
 }
 
+// Pipelines are created against it. Frames begin the compatible render pass of the RenderGraph
+// (same formats, one subpass), whose barriers replace the subpass dependencies. Not needed with
+// dynamic rendering, where pipelines only name the formats.
 void Swapchain::CreateRenderPass() {
   VkAttachmentDescription colorAttachment  = {};
   colorAttachment.format                   = _swapchainImageFormat;
@@ -149,7 +202,8 @@ void Swapchain::CreateRenderPass() {
   colorAttachment.stencilLoadOp            = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
   colorAttachment.stencilStoreOp           = VK_ATTACHMENT_STORE_OP_DONT_CARE;
   colorAttachment.initialLayout            = VK_IMAGE_LAYOUT_UNDEFINED;
-  colorAttachment.finalLayout              = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+  colorAttachment.finalLayout              = _isHeadless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                                                         : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
   VkAttachmentReference colorAttachmentRef = {};
   colorAttachmentRef.attachment            = 0;
   colorAttachmentRef.layout                = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
@@ -173,17 +227,6 @@ void Swapchain::CreateRenderPass() {
   subpass.pColorAttachments       = &colorAttachmentRef;
   subpass.pDepthStencilAttachment = &depthAttachmentRef;
 
-  VkSubpassDependency dependency = {};
-  dependency.srcSubpass          = VK_SUBPASS_EXTERNAL;
-  dependency.srcAccessMask       = 0;
-  dependency.srcStageMask
-      = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-  dependency.dstSubpass = 0;
-  dependency.dstAccessMask
-      = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-  dependency.dstStageMask
-      = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-
   std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
   VkRenderPassCreateInfo renderPassInfo              = {};
   renderPassInfo.sType                               = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -191,8 +234,6 @@ void Swapchain::CreateRenderPass() {
   renderPassInfo.pAttachments                        = attachments.data();
   renderPassInfo.subpassCount                        = 1;
   renderPassInfo.pSubpasses                          = &subpass;
-  renderPassInfo.dependencyCount                     = 1;
-  renderPassInfo.pDependencies                       = &dependency;
 
   if (vkCreateRenderPass(
           _context->GetLogicalDevice(), &renderPassInfo, nullptr, &_renderPass
@@ -202,103 +243,25 @@ void Swapchain::CreateRenderPass() {
   }
 }
 
-void Swapchain::CreateDepthResources() {
-  VkExtent2D swapChainExtent = GetSwapChainExtent();
-
-  _depthImages.resize(ImageCount());
-  _depthImageMemorys.resize(ImageCount());
-  _depthImageViews.resize(ImageCount());
-  for (size_t i = 0; i < _depthImages.size(); i++) {
-    VkImageCreateInfo imageInfo{};
-    imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-    imageInfo.imageType     = VK_IMAGE_TYPE_2D;
-    imageInfo.extent.width  = swapChainExtent.width;
-    imageInfo.extent.height = swapChainExtent.height;
-    imageInfo.extent.depth  = 1;
-    imageInfo.mipLevels     = 1;
-    imageInfo.arrayLayers   = 1;
-    imageInfo.format        = _swapchainDepthFormat;
-    imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
-    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    imageInfo.usage         = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-    imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
-    imageInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
-    imageInfo.flags         = 0;
-
-    _context->CreateImageWithInfo(
-        imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _depthImages[i], _depthImageMemorys[i]
-    );
-
-    VkImageViewCreateInfo viewInfo{};
-    viewInfo.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-    viewInfo.image                           = _depthImages[i];
-    viewInfo.viewType                        = VK_IMAGE_VIEW_TYPE_2D;
-    viewInfo.format                          = _swapchainDepthFormat;
-    viewInfo.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_DEPTH_BIT;
-    viewInfo.subresourceRange.baseMipLevel   = 0;
-    viewInfo.subresourceRange.levelCount     = 1;
-    viewInfo.subresourceRange.baseArrayLayer = 0;
-    viewInfo.subresourceRange.layerCount     = 1;
-
-    if (vkCreateImageView(
-            _context->GetLogicalDevice(), &viewInfo, nullptr, &_depthImageViews[i]
-        )
-        != VK_SUCCESS) {
-      throw std::runtime_error("failed to create texture image view!");
-    }
-  }
-}
-
-void Swapchain::CreateFramebuffers() {
-  _swapchainFramebuffers.resize(ImageCount());
-  for (size_t i = 0; i < ImageCount(); i++) {
-    std::array<VkImageView, 2> attachments = {_swapchainImageViews[i], _depthImageViews[i]};
-
-    VkExtent2D swapChainExtent              = GetSwapChainExtent();
-    VkFramebufferCreateInfo framebufferInfo = {};
-    framebufferInfo.sType                   = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-    framebufferInfo.renderPass              = _renderPass;
-    framebufferInfo.attachmentCount         = static_cast<u32>(attachments.size());
-    framebufferInfo.pAttachments            = attachments.data();
-    framebufferInfo.width                   = swapChainExtent.width;
-    framebufferInfo.height                  = swapChainExtent.height;
-    framebufferInfo.layers                  = 1;
-
-    if (vkCreateFramebuffer(
-            _context->GetLogicalDevice(), &framebufferInfo, nullptr,
-            &_swapchainFramebuffers[i]
-        )
-        != VK_SUCCESS) {
-      throw std::runtime_error("failed to create framebuffer!");
-    }
-  }
-}
-
 void Swapchain::CreateSyncObjects() {
-  _imageAvailableSemaphores.resize(MAX_FRAMES_SYNC);
-  _renderFinishedSemaphores.resize(ImageCount());
-  _inFlightFences.resize(MAX_FRAMES_SYNC);
+  // Nothing is acquired or presented in headless mode, only the frame timeline is needed
+  _imageAvailableSemaphores.resize(_isHeadless ? 0 : MAX_FRAMES_SYNC);
+  _renderFinishedSemaphores.resize(_isHeadless ? 0 : ImageCount());
 
   VkSemaphoreCreateInfo semaphoreInfo = {};
   semaphoreInfo.sType                 = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-  VkFenceCreateInfo fenceInfo = {};
-  fenceInfo.sType             = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-  fenceInfo.flags             = VK_FENCE_CREATE_SIGNALED_BIT;
-
-  for (size_t i = 0; i < MAX_FRAMES_SYNC; ++i) {
+  for (size_t i = 0; i < _imageAvailableSemaphores.size(); ++i) {
     if (vkCreateSemaphore(
             _context->GetLogicalDevice(), &semaphoreInfo, nullptr,
             &_imageAvailableSemaphores[i]
-        ) != VK_SUCCESS
-        || vkCreateFence(
-               _context->GetLogicalDevice(), &fenceInfo, nullptr, &_inFlightFences[i]
-           ) != VK_SUCCESS) {
+        )
+        != VK_SUCCESS) {
       throw std::runtime_error("failed to create synchronization objects for a frame!");
     }
   }
 
-  for (size_t i = 0; i < ImageCount(); ++i) {
+  for (size_t i = 0; i < _renderFinishedSemaphores.size(); ++i) {
     if (vkCreateSemaphore(
             _context->GetLogicalDevice(), &semaphoreInfo, nullptr,
             &_renderFinishedSemaphores[i]
@@ -309,12 +272,109 @@ void Swapchain::CreateSyncObjects() {
   }
 }
 
-VkResult Swapchain::AcquireNextImage(u32* imageIndex) {
-  vkWaitForFences(
-      _context->GetLogicalDevice(), 1, &_inFlightFences[_currentFrameIndex], VK_TRUE,
-      std::numeric_limits<uint64_t>::max()
+void Swapchain::CreateReadbackBuffers() {
+  if (!_isHeadless || !Config::IsFrameReadbackEnabled) {
+    return;
+  }
+
+  VkDeviceSize size
+      = static_cast<VkDeviceSize>(_swapchainExtent.width) * _swapchainExtent.height * 4;
+
+  _readbackBuffers.resize(MAX_FRAMES_SYNC);
+  _readbackAllocations.resize(MAX_FRAMES_SYNC);
+  _readbackPending.assign(MAX_FRAMES_SYNC, false);
+  for (size_t i = 0; i < MAX_FRAMES_SYNC; ++i) {
+    // Host visible allocations stay persistently mapped by the allocator
+    _context->CreateBuffer(
+        size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        _readbackBuffers[i], _readbackAllocations[i]
+    );
+  }
+}
+
+void Swapchain::RecordReadback(VkCommandBuffer commandBuffer, u32 imageIndex) {
+  if (_readbackBuffers.empty()) {
+    return;
+  }
+
+  VkBufferImageCopy region{};
+  region.bufferOffset                    = 0;
+  region.bufferRowLength                 = 0;
+  region.bufferImageHeight               = 0;
+  region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.mipLevel       = 0;
+  region.imageSubresource.baseArrayLayer = 0;
+  region.imageSubresource.layerCount     = 1;
+  region.imageOffset                     = {0, 0, 0};
+  region.imageExtent                     = {_swapchainExtent.width, _swapchainExtent.height, 1};
+
+  // The RenderGraph leaves the image in TRANSFER_SRC_OPTIMAL when headless
+  vkCmdCopyImageToBuffer(
+      commandBuffer, _swapchainImages[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+      _readbackBuffers[_currentFrameIndex], 1, &region
+  );
+
+  VkBufferMemoryBarrier barrier{};
+  barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask       = VK_ACCESS_HOST_READ_BIT;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.buffer              = _readbackBuffers[_currentFrameIndex];
+  barrier.offset              = 0;
+  barrier.size                = VK_WHOLE_SIZE;
+  vkCmdPipelineBarrier(
+      commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1,
+      &barrier, 0, nullptr
   );
 
+  _readbackPending[_currentFrameIndex] = true;
+}
+
+void Swapchain::CollectReadback(u32 frameIndex) {
+  if (_readbackPending.empty() || !_readbackPending[frameIndex]) {
+    return;
+  }
+
+  // Only called once the frame that last used this slot has finished
+  size_t size = static_cast<size_t>(_swapchainExtent.width) * _swapchainExtent.height * 4;
+  _framePixels.resize(size);
+  memcpy(_framePixels.data(), _readbackAllocations[frameIndex].Mapped, size);
+  _readbackPending[frameIndex] = false;
+  _hasFramePixels              = true;
+}
+
+bool Swapchain::GetFramePixels(std::vector<u8>& pixels) const {
+  if (!_hasFramePixels) {
+    return false;
+  }
+  pixels = _framePixels;
+  return true;
+}
+
+void Swapchain::WaitForFrameSlot() {
+  RV_PROFILE_FUNCTION();
+  // Frames advance together with the slots, the frame MAX_FRAMES_SYNC back used this slot and is
+  // never later than the frame FramesInFlight back
+  Timeline& frameTimeline = _context->GetFrameTimeline();
+  u64 frame               = frameTimeline.GetSubmittedValue() + 1;
+  u64 framesInFlight      = std::clamp<u64>(Config::FramesInFlight, 1, MAX_FRAMES_SYNC);
+  if (frame > framesInFlight) {
+    frameTimeline.Wait(frame - framesInFlight);
+  }
+}
+
+VkResult Swapchain::AcquireNextImage(u32* imageIndex) {
+  RV_PROFILE_FUNCTION();
+  WaitForFrameSlot();
+
+  if (_isHeadless) {
+    CollectReadback(_currentFrameIndex);
+    *imageIndex = _currentFrameIndex;
+    return VK_SUCCESS;
+  }
+
   VkResult result = vkAcquireNextImageKHR(
       _context->GetLogicalDevice(), _swapchain, std::numeric_limits<uint64_t>::max(),
       _imageAvailableSemaphores[_currentFrameIndex], VK_NULL_HANDLE, imageIndex
@@ -324,30 +384,46 @@ VkResult Swapchain::AcquireNextImage(u32* imageIndex) {
 }
 
 VkResult Swapchain::SubmitCommandBuffers(const VkCommandBuffer* buffers, u32* imageIndex) {
-  VkSubmitInfo submitInfo = {};
-  submitInfo.sType        = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-
-  VkSemaphore waitSemaphores[]      = {_imageAvailableSemaphores[_currentFrameIndex]};
+  RV_PROFILE_FUNCTION();
+  // The frame signals its number on the timeline, and the binary render finished semaphore (value
+  // ignored) unless headless, where only the timeline is signaled
+  Timeline& frameTimeline           = _context->GetFrameTimeline();
+  u64 signalValues[]                = {0, frameTimeline.GetSubmittedValue() + 1};
+  VkSemaphore signalSemaphores[]    = {VK_NULL_HANDLE, frameTimeline.GetSemaphore()};
+  VkSemaphore waitSemaphores[]      = {VK_NULL_HANDLE};
   VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-  submitInfo.waitSemaphoreCount     = 1;
-  submitInfo.pWaitSemaphores        = waitSemaphores;
-  submitInfo.pWaitDstStageMask      = waitStages;
-
-  submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers    = buffers;
-
-  VkSemaphore signalSemaphores[]  = {_renderFinishedSemaphores[*imageIndex]};
-  submitInfo.signalSemaphoreCount = 1;
-  submitInfo.pSignalSemaphores    = signalSemaphores;
+  u32 signalOffset                  = _isHeadless ? 1 : 0;
+
+  VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+  timelineInfo.sType                         = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+  timelineInfo.signalSemaphoreValueCount     = 2 - signalOffset;
+  timelineInfo.pSignalSemaphoreValues        = signalValues + signalOffset;
+
+  VkSubmitInfo submitInfo         = {};
+  submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.pNext                = &timelineInfo;
+  submitInfo.commandBufferCount   = 1;
+  submitInfo.pCommandBuffers      = buffers;
+  submitInfo.signalSemaphoreCount = 2 - signalOffset;
+  submitInfo.pSignalSemaphores    = signalSemaphores + signalOffset;
+
+  if (!_isHeadless) {
+    waitSemaphores[0]             = _imageAvailableSemaphores[_currentFrameIndex];
+    signalSemaphores[0]           = _renderFinishedSemaphores[*imageIndex];
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores    = waitSemaphores;
+    submitInfo.pWaitDstStageMask  = waitStages;
+  }
 
-  vkResetFences(_context->GetLogicalDevice(), 1, &_inFlightFences[_currentFrameIndex]);
-  if (vkQueueSubmit(
-          _context->GetGraphicsQueue(), 1, &submitInfo,
-          _inFlightFences[_currentFrameIndex]
-      )
-      != VK_SUCCESS) {
+  if (vkQueueSubmit(_context->GetGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
     throw std::runtime_error("failed to submit draw command buffer!");
   }
+  frameTimeline.Next();
+
+  if (_isHeadless) {
+    _currentFrameIndex = (_currentFrameIndex + 1) % MAX_FRAMES_SYNC;
+    return VK_SUCCESS;
+  }
 
   VkPresentInfoKHR presentInfo = {};
   presentInfo.sType            = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -361,7 +437,11 @@ VkResult Swapchain::SubmitCommandBuffers(const VkCommandBuffer* buffers, u32* im
 
   presentInfo.pImageIndices = imageIndex;
 
-  auto result = vkQueuePresentKHR(_context->GetPresentQueue(), &presentInfo);
+  VkResult result;
+  {
+    RV_PROFILE_SCOPE("QueuePresent");
+    result = vkQueuePresentKHR(_context->GetPresentQueue(), &presentInfo);
+  }
 
   _currentFrameIndex = (_currentFrameIndex + 1) % MAX_FRAMES_SYNC;
 
@@ -391,19 +471,20 @@ VkSurfaceFormatKHR Swapchain::ChooseSurfaceFormat(
 VkPresentModeKHR Swapchain::ChoosePresentMode(
     const std::vector<VkPresentModeKHR>& availablePresentModes
 ) {
-  for (const auto& availablePresentMode : availablePresentModes) {
-    if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-      std::cout << "Present mode: Mailbox" << std::endl;
-      return availablePresentMode;
-    }
+  auto isAvailable = [&](VkPresentModeKHR presentMode) {
+    return std::ranges::find(availablePresentModes, presentMode) != availablePresentModes.end();
+  };
+
+  // FIFO is always there, and the only one of the vsync mode
+  if (_latencyMode == LatencyMode::Throughput && isAvailable(VK_PRESENT_MODE_IMMEDIATE_KHR)) {
+    std::cout << "Present mode: Immediate" << std::endl;
+    return VK_PRESENT_MODE_IMMEDIATE_KHR;
   }
 
-  // for (const auto &availablePresentMode : availablePresentModes) {
-  //   if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-  //     std::cout << "Present mode: Immediate" << std::endl;
-  //     return availablePresentMode;
-  //   }
-  // }
+  if (_latencyMode != LatencyMode::VSync && isAvailable(VK_PRESENT_MODE_MAILBOX_KHR)) {
+    std::cout << "Present mode: Mailbox" << std::endl;
+    return VK_PRESENT_MODE_MAILBOX_KHR;
+  }
 
   std::cout << "Present mode: V-Sync" << std::endl;
   return VK_PRESENT_MODE_FIFO_KHR;
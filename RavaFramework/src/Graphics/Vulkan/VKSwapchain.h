@@ -1,7 +1,19 @@
 #pragma once
 
+#include "Graphics/Vulkan/VKAllocator.h"
+
 namespace VK {
 class Context;
+
+// What a graphics pipeline drawing into the swap chain render pass is created for. With dynamic
+// rendering there is no render pass, only the formats, so the pipelines outlive every swap chain
+// with the same formats.
+struct PipelineTarget {
+  VkRenderPass RenderPass = VK_NULL_HANDLE;
+  VkFormat ColorFormat    = VK_FORMAT_UNDEFINED;
+  VkFormat DepthFormat    = VK_FORMAT_UNDEFINED;
+};
+
 class Swapchain {
 public:
   Swapchain(Shared<Context> context);
@@ -10,18 +22,30 @@ public:
 
   NO_COPY(Swapchain)
 
+  // Waits for the frame Config::FramesInFlight back, when it has not been waited on already
+  void WaitForFrameSlot();
   VkResult AcquireNextImage(uint32_t* imageIndex);
   VkResult SubmitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex);
+  void RecordReadback(VkCommandBuffer commandBuffer, u32 imageIndex);
+  bool GetFramePixels(std::vector<u8>& pixels) const;
 
-  inline VkFramebuffer GetFrameBuffer(int index) { return _swapchainFramebuffers[index]; }
+  // Pipelines are created against it, frames are rendered by the RenderGraph into a compatible one.
+  // VK_NULL_HANDLE with dynamic rendering.
   inline VkRenderPass GetRenderPass() const { return _renderPass; }
+  inline PipelineTarget GetPipelineTarget() const {
+    return {_renderPass, _swapchainImageFormat, _swapchainDepthFormat};
+  }
+  inline VkImage GetImage(int index) { return _swapchainImages[index]; }
   inline VkImageView GetImageView(int index) { return _swapchainImageViews[index]; }
   inline size_t ImageCount() { return _swapchainImages.size(); }
   inline VkFormat GetSwapChainImageFormat() const { return _swapchainImageFormat; }
+  inline VkFormat GetSwapChainDepthFormat() const { return _swapchainDepthFormat; }
   inline VkExtent2D GetSwapChainExtent() const { return _swapchainExtent; }
   inline u32 Width() const { return _swapchainExtent.width; }
   inline u32 Height() const { return _swapchainExtent.height; }
   inline u32 GetCurrentFrameIndex() const { return _currentFrameIndex; }
+  // The mode the present mode was chosen for
+  inline LatencyMode GetLatencyMode() const { return _latencyMode; }
 
   inline float ExtentAspectRatio() const {
     return static_cast<float>(_swapchainExtent.width) / static_cast<float>(_swapchainExtent.height);
@@ -33,38 +57,45 @@ public:
         && swapChain._swapchainImageFormat == _swapchainImageFormat;
   }
   bool IsInitialized() const { return _initialized; }
+  bool IsHeadless() const { return _isHeadless; }
 
 private:
-  bool _initialized = false;
+  bool _initialized        = false;
+  bool _isHeadless         = false;
+  LatencyMode _latencyMode = LatencyMode::Balanced;
   Shared<Context> _context;
   VkSwapchainKHR _swapchain;
   Shared<Swapchain> _oldSwapchain;
   VkExtent2D _swapchainExtent;
 
-  std::vector<VkFramebuffer> _swapchainFramebuffers;
   VkFormat _swapchainImageFormat;
   std::vector<VkImage> _swapchainImages;
   std::vector<VkImageView> _swapchainImageViews;
 
-  VkRenderPass _renderPass;
+  // Headless: offscreen color targets stand in for the swapchain images
+  std::vector<Allocation> _offscreenImageAllocations;
+  std::vector<VkBuffer> _readbackBuffers;
+  std::vector<Allocation> _readbackAllocations;
+  std::vector<bool> _readbackPending;
+  std::vector<u8> _framePixels;
+  bool _hasFramePixels = false;
 
-  std::vector<VkDeviceMemory> _depthImageMemorys;
-  VkFormat _swapchainDepthFormat;
-  std::vector<VkImage> _depthImages;
-  std::vector<VkImageView> _depthImageViews;
+  VkRenderPass _renderPass = VK_NULL_HANDLE;
+  VkFormat _swapchainDepthFormat;  // of the depth image the RenderGraph creates
 
+  // Frames in flight are bounded by the frame timeline of the context, not by fences
   std::vector<VkSemaphore> _imageAvailableSemaphores;
   std::vector<VkSemaphore> _renderFinishedSemaphores;
-  std::vector<VkFence> _inFlightFences;
   u32 _currentFrameIndex = 0;
 
 private:
   void Init();
   void CreateSwapchain();
+  void CreateOffscreenImages();
+  void CreateReadbackBuffers();
+  void CollectReadback(u32 frameIndex);
   void CreateImageViews();
   void CreateRenderPass();
-  void CreateDepthResources();
-  void CreateFramebuffers();
   void CreateSyncObjects();
 
   // Helper functions
@@ -72,4 +103,4 @@ private:
   VkPresentModeKHR ChoosePresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
   VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
 };
-}  // namespace VK
+}  // namespace VK
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Vulkan/VKTimeline.h"
+
+#include "Graphics/Vulkan/VKValidation.h"
+
+namespace VK {
+Timeline::Timeline(VkDevice device) : _device(device) {
+  VkSemaphoreTypeCreateInfo typeInfo{};
+  typeInfo.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+  typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+  typeInfo.initialValue  = 0;
+
+  VkSemaphoreCreateInfo createInfo{};
+  createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+  createInfo.pNext = &typeInfo;
+
+  VkResult result = vkCreateSemaphore(_device, &createInfo, nullptr, &_semaphore);
+  IsResultValid(result, "Failed to Create Timeline Semaphore!\n");
+}
+
+Timeline::~Timeline() {
+  vkDestroySemaphore(_device, _semaphore, nullptr);
+}
+
+u64 Timeline::GetCompletedValue() {
+  u64 value = 0;
+  vkGetSemaphoreCounterValue(_device, _semaphore, &value);
+  UpdateCompletedValue(value);
+  return value;
+}
+
+bool Timeline::IsComplete(u64 value) {
+  if (value <= _completedValue.load(std::memory_order_acquire)) {
+    return true;
+  }
+  return value <= GetCompletedValue();
+}
+
+bool Timeline::Wait(u64 value, u64 timeout) {
+  if (IsComplete(value)) {
+    return true;
+  }
+
+  VkSemaphoreWaitInfo waitInfo{};
+  waitInfo.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+  waitInfo.semaphoreCount = 1;
+  waitInfo.pSemaphores    = &_semaphore;
+  waitInfo.pValues        = &value;
+  if (vkWaitSemaphores(_device, &waitInfo, timeout) != VK_SUCCESS) {
+    return false;
+  }
+
+  UpdateCompletedValue(value);
+  return true;
+}
+
+void Timeline::UpdateCompletedValue(u64 value) {
+  u64 cached = _completedValue.load(std::memory_order_relaxed);
+  while (cached < value
+         && !_completedValue.compare_exchange_weak(cached, value, std::memory_order_release)) {
+  }
+}
+}  // namespace VK
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+namespace VK {
+// A timeline semaphore (core in Vulkan 1.2) and the CPU side counter of the values submitted to
+// signal it. Values only grow, so "has value N finished" replaces a fence per submission that has
+// to be reset and waited on individually, and any number of subsystems can wait on or poll the same
+// value. Submissions reserve their value with Next, on the thread that submits them.
+class Timeline {
+public:
+  Timeline(VkDevice device);
+  ~Timeline();
+
+  NO_COPY(Timeline)
+  NO_MOVE(Timeline)
+
+  // Reserves the value the next submission signals
+  inline u64 Next() { return _submittedValue.fetch_add(1, std::memory_order_acq_rel) + 1; }
+  // Thread safe. Highest value a submission was made for, the GPU may not have reached it yet.
+  inline u64 GetSubmittedValue() const { return _submittedValue.load(std::memory_order_acquire); }
+
+  // Thread safe. IsComplete polls the semaphore only when the last value seen is behind.
+  u64 GetCompletedValue();
+  bool IsComplete(u64 value);
+  // Thread safe. Returns false when the timeout (nanoseconds) ran out first.
+  bool Wait(u64 value, u64 timeout = std::numeric_limits<u64>::max());
+
+  inline VkSemaphore GetSemaphore() const { return _semaphore; }
+
+private:
+  VkDevice _device       = VK_NULL_HANDLE;
+  VkSemaphore _semaphore = VK_NULL_HANDLE;
+  std::atomic<u64> _submittedValue{0};
+  std::atomic<u64> _completedValue{0};
+
+private:
+  void UpdateCompletedValue(u64 value);
+};
+}  // namespace VK
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "RavaFramework.h"
+
+#include "Graphics/Vulkan/VKUploader.h"
+
+#include "Core/CpuProfiler.h"
+#include "Core/FrameAllocator.h"
+#include "Graphics/Model.h"
+#include "Graphics/Vulkan/VKBuffer.h"
+#include "Graphics/Vulkan/VKContext.h"
+#include "Graphics/Vulkan/VKGeometryPool.h"
+#include "Graphics/Vulkan/VKModel.h"
+#include "Graphics/Vulkan/VKValidation.h"
+
+namespace VK {
+Uploader::Uploader(Shared<Context> context, Shared<GeometryPool> geometryPool)
+    : _context(context), _geometryPool(geometryPool) {
+  const QueueFamilyIndices& queueFamilyIndices = _context->GetQueueFamilyIndices();
+  _transferFamily      = static_cast<u32>(queueFamilyIndices.TransferFamily);
+  _graphicsFamily      = static_cast<u32>(queueFamilyIndices.GraphicsFamily);
+  _isDedicatedTransfer = queueFamilyIndices.HasDedicatedTransfer();
+
+  CreateCommandPool();
+}
+
+Uploader::~Uploader() {
+  VkDevice device = _context->GetLogicalDevice();
+  for (auto& batch : _submittedBatches) {
+    vkWaitForFences(device, 1, &batch.Fence, VK_TRUE, UINT64_MAX);
+    Release(batch);
+  }
+  _submittedBatches.clear();
+  _preparedBatches.clear();
+
+  vkDestroyCommandPool(device, _commandPool, nullptr);
+}
+
+void Uploader::CreateCommandPool() {
+  VkCommandPoolCreateInfo poolInfo{};
+  poolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+  poolInfo.queueFamilyIndex = _transferFamily;
+
+  VkResult result
+      = vkCreateCommandPool(_context->GetLogicalDevice(), &poolInfo, nullptr, &_commandPool);
+  IsResultValid(result, "Failed to Create Transfer Command Pool!\n");
+}
+
+void Uploader::UploadModel(Shared<Rava::AsyncModel> asyncModel, const Rava::ModelData& data) {
+  RV_PROFILE_FUNCTION();
+  Batch batch;
+  auto model = std::make_unique<Model>(_context, _geometryPool, data, batch.Uploads);
+  if (!model->IsValid()) {
+    asyncModel->SetFailed();
+    return;
+  }
+
+  batch.AsyncModel   = std::move(asyncModel);
+  batch.PendingModel = std::move(model);
+
+  std::lock_guard lock(_mutex);
+  _preparedBatches.push_back(std::move(batch));
+}
+
+void Uploader::Update(VkCommandBuffer commandBuffer) {
+  RV_PROFILE_FUNCTION();
+  VkDevice device = _context->GetLogicalDevice();
+
+  // Hand out what the transfer queue finished since the last frame. The fence was observed on the
+  // host before this frame is submitted, so the acquire is ordered after the release.
+  std::erase_if(_submittedBatches, [&](Batch& batch) {
+    if (vkGetFenceStatus(device, batch.Fence) != VK_SUCCESS) {
+      return false;
+    }
+
+    RecordAcquire(batch, commandBuffer);
+    _geometryPool->MarkResident(static_cast<const Model&>(*batch.PendingModel).GetGeometry());
+    batch.AsyncModel->SetReady(std::move(batch.PendingModel));
+    Release(batch);
+    return true;
+  });
+
+  std::vector<Batch> preparedBatches;
+  {
+    std::lock_guard lock(_mutex);
+    preparedBatches.swap(_preparedBatches);
+  }
+
+  for (auto& batch : preparedBatches) {
+    Submit(batch);
+    _submittedBatches.push_back(std::move(batch));
+  }
+}
+
+void Uploader::Submit(Batch& batch) {
+  VkDevice device = _context->GetLogicalDevice();
+
+  VkCommandBufferAllocateInfo allocInfo{};
+  allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandPool        = _commandPool;
+  allocInfo.commandBufferCount = 1;
+  vkAllocateCommandBuffers(device, &allocInfo, &batch.CommandBuffer);
+
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(batch.CommandBuffer, &beginInfo);
+
+  // Main thread during the frame, the frame allocator takes the list back with the slot
+  std::pmr::vector<VkBufferMemoryBarrier> releaseBarriers(Rava::FrameAllocator::GetResource());
+  releaseBarriers.reserve(batch.Uploads.size());
+  for (const auto& upload : batch.Uploads) {
+    VkBufferCopy copyRegion{};
+    copyRegion.dstOffset = upload.DstOffset;
+    copyRegion.size      = upload.Size;
+    vkCmdCopyBuffer(
+        batch.CommandBuffer, upload.StagingBuffer->GetBuffer(), upload.DstBuffer, 1, &copyRegion
+    );
+
+    if (upload.IsTransferShared) {
+      continue;
+    }
+
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask       = 0;
+    barrier.srcQueueFamilyIndex = _transferFamily;
+    barrier.dstQueueFamilyIndex = _graphicsFamily;
+    barrier.buffer              = upload.DstBuffer;
+    barrier.offset              = upload.DstOffset;
+    barrier.size                = upload.Size;
+    releaseBarriers.push_back(barrier);
+  }
+
+  // Release half of the ownership transfer, the acquire half is recorded by Update
+  if (_isDedicatedTransfer && !releaseBarriers.empty()) {
+    vkCmdPipelineBarrier(
+        batch.CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0, 0, nullptr, static_cast<u32>(releaseBarriers.size()), releaseBarriers.data(), 0, nullptr
+    );
+  }
+
+  vkEndCommandBuffer(batch.CommandBuffer);
+
+  VkFenceCreateInfo fenceInfo{};
+  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  vkCreateFence(device, &fenceInfo, nullptr, &batch.Fence);
+
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers    = &batch.CommandBuffer;
+
+  VkResult result = vkQueueSubmit(_context->GetTransferQueue(), 1, &submitInfo, batch.Fence);
+  IsResultValid(result, "Failed to Submit Upload Command Buffer!\n");
+}
+
+void Uploader::RecordAcquire(const Batch& batch, VkCommandBuffer commandBuffer) const {
+  std::pmr::vector<VkBufferMemoryBarrier> acquireBarriers(Rava::FrameAllocator::GetResource());
+  acquireBarriers.reserve(batch.Uploads.size());
+  VkPipelineStageFlags dstStageMask = 0;
+
+  for (const auto& upload : batch.Uploads) {
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType         = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.dstAccessMask = upload.DstAccessMask;
+    barrier.buffer        = upload.DstBuffer;
+    barrier.offset        = upload.DstOffset;
+    barrier.size          = upload.Size;
+
+    if (_isDedicatedTransfer && upload.IsTransferShared) {
+      // Concurrent sharing, the fence signal made the writes available, this makes them visible
+      barrier.srcAccessMask       = 0;
+      barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    } else if (_isDedicatedTransfer) {
+      // Acquire half: the release already made the writes available
+      barrier.srcAccessMask       = 0;
+      barrier.srcQueueFamilyIndex = _transferFamily;
+      barrier.dstQueueFamilyIndex = _graphicsFamily;
+    } else {
+      barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+      barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    }
+
+    acquireBarriers.push_back(barrier);
+    dstStageMask |= upload.DstStageMask;
+  }
+
+  if (acquireBarriers.empty()) {
+    return;
+  }
+
+  VkPipelineStageFlags srcStageMask
+      = _isDedicatedTransfer ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_TRANSFER_BIT;
+  vkCmdPipelineBarrier(
+      commandBuffer, srcStageMask, dstStageMask, 0, 0, nullptr,
+      static_cast<u32>(acquireBarriers.size()), acquireBarriers.data(), 0, nullptr
+  );
+}
+
+void Uploader::Release(Batch& batch) {
+  VkDevice device = _context->GetLogicalDevice();
+  vkDestroyFence(device, batch.Fence, nullptr);
+  vkFreeCommandBuffers(device, _commandPool, 1, &batch.CommandBuffer);
+  batch.Fence         = VK_NULL_HANDLE;
+  batch.CommandBuffer = VK_NULL_HANDLE;
+  batch.Uploads.clear();
+}
+}  // namespace VK
\ No newline at end of file
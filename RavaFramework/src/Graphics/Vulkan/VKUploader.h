@@ -0,0 +1,74 @@
+#pragma once
+
+namespace Rava {
+class AsyncModel;
+class Model;
+struct ModelData;
+}  // namespace Rava
+
+namespace VK {
+class Buffer;
+class Context;
+
+class GeometryPool;
+
+// Copy from a filled staging buffer into a range of a device local buffer, plus the first use of
+// the destination on the graphics queue. Transfer shared destinations (concurrent sharing) need no
+// queue family ownership transfer.
+struct BufferUpload {
+  Unique<Buffer> StagingBuffer;
+  VkBuffer DstBuffer                = VK_NULL_HANDLE;
+  VkDeviceSize DstOffset            = 0;
+  VkDeviceSize Size                 = 0;
+  VkPipelineStageFlags DstStageMask = 0;
+  VkAccessFlags DstAccessMask       = 0;
+  bool IsTransferShared             = false;
+};
+
+// Streams models to the GPU without stalling the frame. Worker threads allocate the geometry and
+// fill the staging memory, the main thread submits the copies on the transfer queue once per frame
+// and, when they completed, acquires the ranges on the graphics queue before the model is handed
+// out.
+class Uploader {
+public:
+  Uploader(Shared<Context> context, Shared<GeometryPool> geometryPool);
+  ~Uploader();
+
+  NO_COPY(Uploader)
+  NO_MOVE(Uploader)
+
+  // Thread safe
+  void UploadModel(Shared<Rava::AsyncModel> asyncModel, const Rava::ModelData& data);
+
+  // Main thread, commandBuffer is the graphics command buffer of the frame being recorded and
+  // must not be inside a render pass
+  void Update(VkCommandBuffer commandBuffer);
+
+private:
+  struct Batch {
+    Shared<Rava::AsyncModel> AsyncModel;
+    Unique<Rava::Model> PendingModel;
+    std::vector<BufferUpload> Uploads;
+    VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+    VkFence Fence                 = VK_NULL_HANDLE;
+  };
+
+  Shared<Context> _context;
+  Shared<GeometryPool> _geometryPool;
+  VkCommandPool _commandPool = VK_NULL_HANDLE;
+  u32 _transferFamily        = 0;
+  u32 _graphicsFamily        = 0;
+  bool _isDedicatedTransfer  = false;
+
+  std::mutex _mutex;
+  std::vector<Batch> _preparedBatches;  // filled by workers, guarded by _mutex
+  std::vector<Batch> _submittedBatches;
+
+private:
+  void CreateCommandPool();
+
+  void Submit(Batch& batch);
+  void RecordAcquire(const Batch& batch, VkCommandBuffer commandBuffer) const;
+  void Release(Batch& batch);
+};
+}  // namespace VK
\ No newline at end of file
@@ -1,7 +1,10 @@
 #pragma once
 // #include "RavaFramework.h"
 
-static constexpr int MAX_FRAMES_SYNC = 2;
+// Slots of the per frame resources. Frame N uses slot N % MAX_FRAMES_SYNC whatever the number of
+// frames in flight, which only sets how far back AcquireNextImage waits (Config::FramesInFlight),
+// so it can change between two frames without reallocating anything.
+static constexpr int MAX_FRAMES_SYNC = Rava::MAX_FRAMES_IN_FLIGHT;
 
 const std::vector<const char*> DEVICE_EXTENSIONS = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
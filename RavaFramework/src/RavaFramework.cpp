@@ -1,10 +1,14 @@
 #include "RavaFramework.h"
 
 #include "Core/Config.h"
+#include "Core/CpuProfiler.h"
+#include "Core/FramePacer.h"
 #include "Core/Input.h"
+#include "Core/JobSystem.h"
 #include "Core/Window.h"
 
 #include "Graphics/Context.h"
+#include "Graphics/Model.h"
 #include "Graphics/Renderer.h"
 
 namespace Config {
@@ -15,6 +19,31 @@ extern std::string_view WindowTitle = "RavaFramework";
 extern bool IsFullscreen            = false;
 extern bool IsResizeable            = true;
 extern Color ClearColor             = {0.3f, 0.3f, 0.3f, 1.0f};
+extern bool IsHeadless              = false;
+extern bool IsFrameReadbackEnabled  = false;
+extern std::string_view PipelineCachePath  = "PipelineCache.bin";
+extern std::string_view MeshCacheDirectory = "Cache/Meshes";
+extern bool IsMeshOptimizationEnabled      = true;
+extern u32 WorkerThreadCount               = 0;
+extern bool IsGpuProfilerEnabled           = false;
+extern bool IsGpuPipelineStatisticsEnabled = false;
+extern std::string_view GpuProfileDumpPath = "";
+extern bool IsCpuProfilerEnabled           = false;
+extern std::string_view CpuTracePath       = "";
+extern std::string_view ShaderDirectory    = "Assets/Shaders";
+extern bool IsGpuSceneEnabled              = false;
+extern u32 GeometryPoolVertexCount         = 2u << 20;
+extern u32 GeometryPoolIndexCount          = 8u << 20;
+extern VertexFormat SelectedVertexFormat   = VertexFormat::Float;
+extern u32 LodLevelCount                   = 4;
+extern f32 LodErrorThreshold               = 1.0f;
+extern bool IsMeshletGenerationEnabled     = true;
+extern u32 StagingRingSize                 = 32u << 20;
+extern u32 FramesInFlight                  = 2;
+extern LatencyMode SelectedLatencyMode     = LatencyMode::Balanced;
+extern f32 TargetFrameRate                 = 0.0f;
+extern bool IsParallelRecordingEnabled     = true;
+extern bool IsDynamicRenderingEnabled      = true;
 }  // namespace Config
 
 namespace Rava {
@@ -27,13 +56,33 @@ bool InitFramework(u32 width, u32 height, std::string_view title) {
   Config::WindowHeight = height;
   Config::WindowTitle  = title;
 
-  return Window::Create() && Renderer::Create();
+  // Before the job system, so the workers register their names
+  CpuProfiler::Create();
+  if (Config::IsCpuProfilerEnabled) {
+    CpuProfiler::Instance->Start();
+  }
+
+  FramePacer::Create();
+  if (!JobSystem::Create(Config::WorkerThreadCount)) {
+    return false;
+  }
+
+  // Headless mode renders into offscreen images, so no window (and no GLFW) is needed
+  return (Config::IsHeadless || Window::Create()) && Renderer::Create();
 }
 
 void ShutdownFramework() {
+  Model::WaitAsyncLoads();
   if (Renderer::Instance) {
     Renderer::Instance->WaitDeviceIdle();
+    Renderer::Instance->SavePipelineCache();
   }
+  JobSystem::Instance.reset();
+  if (CpuProfiler::Instance && !Config::CpuTracePath.empty()) {
+    CpuProfiler::Instance->SaveTrace(Config::CpuTracePath);
+  }
+  CpuProfiler::Instance.reset();
+  FramePacer::Instance.reset();
   std::print("Shutdown");
 }
 
@@ -57,11 +106,192 @@ void SetRendererAPI(RendererAPI api) {
   Config::SelectedAPI = api;
 }
 
+void SetHeadless(bool isHeadless) {
+  Config::IsHeadless = isHeadless;
+}
+
+void SetFrameReadback(bool isEnabled) {
+  Config::IsFrameReadbackEnabled = isEnabled;
+}
+
+void SetPipelineCachePath(std::string_view path) {
+  Config::PipelineCachePath = path;
+}
+
+void SetMeshCacheDirectory(std::string_view directory) {
+  Config::MeshCacheDirectory = directory;
+}
+
+void SetMeshOptimization(bool isEnabled) {
+  Config::IsMeshOptimizationEnabled = isEnabled;
+}
+
+void SetWorkerThreadCount(u32 count) {
+  Config::WorkerThreadCount = count;
+}
+
+void SetGpuProfiler(bool isEnabled) {
+  Config::IsGpuProfilerEnabled = isEnabled;
+}
+
+void SetGpuPipelineStatistics(bool isEnabled) {
+  Config::IsGpuPipelineStatisticsEnabled = isEnabled;
+}
+
+void SetGpuProfileDumpPath(std::string_view path) {
+  Config::GpuProfileDumpPath = path;
+}
+
+void SetCpuProfiler(bool isEnabled) {
+  Config::IsCpuProfilerEnabled = isEnabled;
+  if (!CpuProfiler::Instance) {
+    return;
+  }
+
+  if (isEnabled) {
+    CpuProfiler::Instance->Start();
+  } else {
+    CpuProfiler::Instance->Stop();
+  }
+}
+
+void SetCpuTracePath(std::string_view path) {
+  Config::CpuTracePath = path;
+}
+
+void SetShaderDirectory(std::string_view directory) {
+  Config::ShaderDirectory = directory;
+}
+
+void SetGpuScene(bool isEnabled) {
+  Config::IsGpuSceneEnabled = isEnabled;
+}
+
+void SetGeometryPoolSize(u32 vertexCount, u32 indexCount) {
+  Config::GeometryPoolVertexCount = vertexCount;
+  Config::GeometryPoolIndexCount  = indexCount;
+}
+
+void SetVertexFormat(VertexFormat format) {
+  Config::SelectedVertexFormat = format;
+}
+
+void SetLodGeneration(u32 levelCount) {
+  Config::LodLevelCount = std::min(levelCount, Mesh::MAX_LODS);
+}
+
+void SetLodThreshold(f32 pixels) {
+  Config::LodErrorThreshold = pixels;
+}
+
+void SetMeshletGeneration(bool isEnabled) {
+  Config::IsMeshletGenerationEnabled = isEnabled;
+}
+
+void SetStagingRingSize(u32 size) {
+  Config::StagingRingSize = size;
+}
+
+void SetFramesInFlight(u32 count) {
+  Config::FramesInFlight = std::clamp(count, 1u, MAX_FRAMES_IN_FLIGHT);
+}
+
+void SetLatencyMode(LatencyMode mode) {
+  Config::SelectedLatencyMode = mode;
+  switch (mode) {
+    case LatencyMode::Balanced:
+    case LatencyMode::VSync:
+      Config::FramesInFlight = 2;
+      break;
+    case LatencyMode::Throughput:
+      Config::FramesInFlight = 3;
+      break;
+    case LatencyMode::LowLatency:
+      Config::FramesInFlight = 1;
+      break;
+  }
+}
+
+void SetTargetFrameRate(f32 framesPerSecond) {
+  Config::TargetFrameRate = std::max(framesPerSecond, 0.0f);
+}
+
+void SetParallelRecording(bool isEnabled) {
+  Config::IsParallelRecordingEnabled = isEnabled;
+}
+
+void SetDynamicRendering(bool isEnabled) {
+  Config::IsDynamicRenderingEnabled = isEnabled;
+}
+
+void SetLodCamera(const Vec3& position, f32 verticalFov) {
+  if (Renderer::Instance) {
+    Renderer::Instance->SetLodCamera(position, verticalFov);
+  }
+}
+
+bool SaveCpuTrace(std::string_view path) {
+  return CpuProfiler::Instance && CpuProfiler::Instance->SaveTrace(path);
+}
+
+void BeginGpuScope(std::string_view name) {
+  if (Renderer::Instance) {
+    Renderer::Instance->BeginGpuScope(name);
+  }
+}
+
+void EndGpuScope() {
+  if (Renderer::Instance) {
+    Renderer::Instance->EndGpuScope();
+  }
+}
+
+bool GetGpuFrameTimings(GpuFrameTimings& timings) {
+  if (!Renderer::Instance) {
+    return false;
+  }
+  return Renderer::Instance->GetGpuFrameTimings(timings);
+}
+
+bool GetFramePacingStats(FramePacingStats& stats) {
+  if (!FramePacer::Instance) {
+    return false;
+  }
+  stats = FramePacer::Instance->GetStats();
+  return true;
+}
+
+void ResetFramePacingStats() {
+  if (FramePacer::Instance) {
+    FramePacer::Instance->ResetStats();
+  }
+}
+
+bool GetFramePixels(std::vector<u8>& pixels) {
+  if (!Renderer::Instance) {
+    return false;
+  }
+  return Renderer::Instance->GetFramePixels(pixels);
+}
+
 bool ProcessMessage() {
+  RV_PROFILE_SCOPE("ProcessMessage");
+  JobSystem::Instance->ProcessMainThreadJobs();
+
+  if (Config::IsHeadless) {
+    return true;
+  }
+
+  // Blocking here instead of in BeginFrame polls the input after the GPU caught up, so the frame
+  // starts from the newest input
+  if (Config::SelectedLatencyMode == LatencyMode::LowLatency && Renderer::Instance) {
+    Renderer::Instance->WaitForFrameSlot();
+  }
   return Window::Instance->ProcessMessage();
 }
 
 void BeginFrame() {
+  FramePacer::Instance->BeginFrame();
   Renderer::Instance->BeginFrame();
   Renderer::Instance->BeginSwapChainRenderPass();
 }
@@ -69,18 +299,30 @@ void BeginFrame() {
 void EndFrame() {
   Renderer::Instance->EndSwapChainRenderPass();
   Renderer::Instance->EndFrame();
+  FramePacer::Instance->EndFrame();
 }
 }  // namespace Rava
 
 namespace Input {
+static GLFWwindow* GetGLFWWindow() {
+  // There is no window to poll in headless mode
+  return Rava::Window::Instance ? Rava::Window::Instance->GetGLFWWindow() : nullptr;
+}
+
 bool IsKeyPressed(KeyCode key) {
-  auto* window = Rava::Window::Instance->GetGLFWWindow();
-  auto state   = glfwGetKey(window, static_cast<int>(key));
+  auto* window = GetGLFWWindow();
+  if (window == nullptr) {
+    return false;
+  }
+  auto state = glfwGetKey(window, static_cast<int>(key));
   return state == GLFW_PRESS;
 }
 
 bool IsKeyDown(KeyCode key) {
-  auto* window = Rava::Window::Instance->GetGLFWWindow();
+  auto* window = GetGLFWWindow();
+  if (window == nullptr) {
+    return false;
+  }
   auto keyCode = static_cast<int>(key);
   auto state   = glfwGetKey(window, keyCode);
 
@@ -97,9 +339,12 @@ bool IsKeyDown(KeyCode key) {
 }
 
 bool IsKeyRepeat(KeyCode key, u32 frameCount) {
-  auto* window = Rava::Window::Instance->GetGLFWWindow();
-  auto keyInt  = static_cast<int>(key);
-  auto state   = glfwGetKey(window, keyInt);
+  auto* window = GetGLFWWindow();
+  if (window == nullptr) {
+    return false;
+  }
+  auto keyInt = static_cast<int>(key);
+  auto state  = glfwGetKey(window, keyInt);
 
   if (state == GLFW_PRESS) {
     KeyHoldFrames[keyInt]++;
@@ -114,19 +359,28 @@ bool IsKeyRepeat(KeyCode key, u32 frameCount) {
 }
 
 bool IsKeyReleased(KeyCode key) {
-  auto* window = Rava::Window::Instance->GetGLFWWindow();
-  auto state   = glfwGetKey(window, static_cast<int>(key));
+  auto* window = GetGLFWWindow();
+  if (window == nullptr) {
+    return false;
+  }
+  auto state = glfwGetKey(window, static_cast<int>(key));
   return state == GLFW_RELEASE;
 }
 
 bool IsMousePressed(Mouse button) {
-  auto* window = Rava::Window::Instance->GetGLFWWindow();
-  auto state   = glfwGetMouseButton(window, static_cast<int>(button));
+  auto* window = GetGLFWWindow();
+  if (window == nullptr) {
+    return false;
+  }
+  auto state = glfwGetMouseButton(window, static_cast<int>(button));
   return state == GLFW_PRESS;
 }
 
 bool IsMouseDown(Mouse button) {
-  auto* window     = Rava::Window::Instance->GetGLFWWindow();
+  auto* window = GetGLFWWindow();
+  if (window == nullptr) {
+    return false;
+  }
   auto mouseButton = static_cast<int>(button);
   auto state       = glfwGetMouseButton(window, mouseButton);
 
@@ -143,7 +397,10 @@ bool IsMouseDown(Mouse button) {
 }
 
 bool IsMouseRepeat(Mouse button, u32 frameCount) {
-  auto* window     = Rava::Window::Instance->GetGLFWWindow();
+  auto* window = GetGLFWWindow();
+  if (window == nullptr) {
+    return false;
+  }
   auto mouseButton = static_cast<int>(button);
   auto state       = glfwGetMouseButton(window, mouseButton);
 
@@ -160,13 +417,19 @@ bool IsMouseRepeat(Mouse button, u32 frameCount) {
 }
 
 bool IsMouseReleased(Mouse button) {
-  auto* window = Rava::Window::Instance->GetGLFWWindow();
-  auto state   = glfwGetMouseButton(window, static_cast<int>(button));
+  auto* window = GetGLFWWindow();
+  if (window == nullptr) {
+    return false;
+  }
+  auto state = glfwGetMouseButton(window, static_cast<int>(button));
   return state == GLFW_RELEASE;
 }
 
 Vec2 GetMousePosition() {
-  auto* window = Rava::Window::Instance->GetGLFWWindow();
+  auto* window = GetGLFWWindow();
+  if (window == nullptr) {
+    return {0.0f, 0.0f};
+  }
   double xpos, ypos;
   glfwGetCursorPos(window, &xpos, &ypos);
 
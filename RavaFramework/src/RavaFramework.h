@@ -13,15 +13,26 @@
 #include <shobjidl.h>
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <chrono>
 #include <filesystem>
+#include <format>
+#include <fstream>
 #include <functional>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 #include <print>
 #include <set>
+#include <shared_mutex>
+#include <span>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -45,6 +56,7 @@ using namespace std::chrono_literals;
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #ifndef GLM_ENABLE_EXPERIMENTAL
 #define GLM_ENABLE_EXPERIMENTAL
@@ -103,13 +115,123 @@ enum class RendererAPI {
   OpenGL,
 };
 
+// Layout of the vertices in GPU memory, chosen before InitFramework
+enum class VertexFormat {
+  Float,   // Rava::Vertex, 48 bytes
+  Packed,  // Rava::PackedVertex, 20 bytes, dequantized per mesh
+};
+
+// Trade between frame rate and the delay from input to the screen, can be changed at any time
+enum class LatencyMode {
+  Balanced,    // mailbox when available, 2 frames in flight
+  Throughput,  // immediate present (tears), 3 frames in flight and one more swapchain image
+  LowLatency,  // mailbox when available, 1 frame in flight, input sampled once the GPU caught up
+  VSync,       // FIFO, 2 frames in flight
+};
+
 namespace Rava {
+// Upper bound of SetFramesInFlight, the per frame resources are allocated for this many frames
+inline constexpr u32 MAX_FRAMES_IN_FLIGHT = 4;
+
+// Same order as GpuScopeTiming::PipelineStatistics and the columns of the profile dump
+inline constexpr std::array<std::string_view, 7> GPU_PIPELINE_STATISTIC_NAMES = {
+    "ia_vertices",         "ia_primitives",  "vs_invocations", "clipping_invocations",
+    "clipping_primitives", "fs_invocations", "cs_invocations"
+};
+
+struct GpuScopeTiming {
+  std::string Name;
+  u32 Depth      = 0;
+  f64 BeginMs    = 0.0;  // relative to the start of the frame
+  f64 DurationMs = 0.0;
+  // Empty when pipeline statistics are disabled or the scope is nested in a scope collecting them
+  std::vector<u64> PipelineStatistics;
+};
+
+struct GpuFrameTimings {
+  u64 FrameNumber = 0;
+  f64 FrameMs     = 0.0;
+  std::vector<GpuScopeTiming> Scopes;
+};
+
+// Distribution of one frame timing in milliseconds, over the latest FramePacer::HISTORY_SIZE frames
+struct FrameTimeStats {
+  f64 AverageMs   = 0.0;
+  f64 P50Ms       = 0.0;
+  f64 P95Ms       = 0.0;
+  f64 P99Ms       = 0.0;
+  f64 MaxMs       = 0.0;
+  u32 SampleCount = 0;
+};
+
+struct FramePacingStats {
+  f64 TargetMs = 0.0;       // 0 while the frame rate is not limited
+  FrameTimeStats Interval;  // BeginFrame to the next BeginFrame, what reaches the screen
+  FrameTimeStats Jitter;    // distance of the interval from the target, or from its median
+  FrameTimeStats Cpu;       // BeginFrame to the end of EndFrame, without the pacing wait
+  FrameTimeStats Gpu;       // frame of the GPU profiler, empty while it is disabled
+  FrameTimeStats Present;   // image acquired to present queued (submitted when headless)
+  f64 SleepMs     = 0.0;    // per frame, spent in the pacing wait
+  f64 SpinMs      = 0.0;
+  u64 FrameCount  = 0;
+  u64 MissedCount = 0;      // frames that started after they were due
+};
+
 // Initialization / Shutdown
 extern void SetClearColor(f32 r, f32 g, f32 b, f32 a);
 extern void SetClearColor(Color color);
 extern void SetFullscreen(bool isFullscreen);
 extern void SetResizeable(bool isResizable);
 extern void SetRendererAPI(RendererAPI api);
+// Headless mode renders offscreen without a window, optionally reading frames back to the host
+extern void SetHeadless(bool isHeadless);
+extern void SetFrameReadback(bool isEnabled);
+// An empty path disables the corresponding on-disk cache
+extern void SetPipelineCachePath(std::string_view path);
+extern void SetMeshCacheDirectory(std::string_view directory);
+// Import time triangle and vertex reordering for the post transform cache, overdraw and fetch
+extern void SetMeshOptimization(bool isEnabled);
+// 0 spawns one job worker per hardware thread besides the main thread
+extern void SetWorkerThreadCount(u32 count);
+// GPU profiling with timestamp queries. A dump path ending in .json writes a JSON array of frames,
+// anything else CSV, an empty path disables the dump.
+extern void SetGpuProfiler(bool isEnabled);
+extern void SetGpuPipelineStatistics(bool isEnabled);
+extern void SetGpuProfileDumpPath(std::string_view path);
+// CPU profiling of the framework scopes (RV_PROFILE_SCOPE, compiled out in release builds).
+// Can be toggled at any time, the trace path is written as a Chrome trace on shutdown.
+extern void SetCpuProfiler(bool isEnabled);
+extern void SetCpuTracePath(std::string_view path);
+// Compiled SPIR-V (CompileShaders.bat), relative to the working directory
+extern void SetShaderDirectory(std::string_view directory);
+// Persistent instances culled by a compute shader and drawn with indirect draws, see VK::GpuScene
+extern void SetGpuScene(bool isEnabled);
+// Capacity of the shared vertex and index buffer all models are sub-allocated from, in elements
+extern void SetGeometryPoolSize(u32 vertexCount, u32 indexCount);
+// Packed vertices need a shader that dequantizes them, see VK::Vertex
+extern void SetVertexFormat(VertexFormat format);
+// Simplified levels generated per mesh at import (at most Mesh::MAX_LODS), 0 disables them
+extern void SetLodGeneration(u32 levelCount);
+// The coarsest level whose error stays below this many pixels on screen is drawn, 0 always draws
+// the full meshes. Can be changed at any time.
+extern void SetLodThreshold(f32 pixels);
+// Import time split of the full meshes into meshlets for the cluster culling of the GPU scene
+extern void SetMeshletGeneration(bool isEnabled);
+// Bytes of the persistently mapped ring uploads are staged in, see VK::StagingRing. Uploads larger
+// than a quarter of it get a temporary buffer of their own. Read by InitFramework.
+extern void SetStagingRingSize(u32 size);
+// Frames the CPU may record ahead of the GPU, clamped to [1, MAX_FRAMES_IN_FLIGHT]. SetLatencyMode
+// sets the count of its mode, call this afterwards to override it. Both can be changed at any time.
+extern void SetFramesInFlight(u32 count);
+extern void SetLatencyMode(LatencyMode mode);
+// Frame rate EndFrame paces the main loop to, 0 leaves it unlimited. Can be changed at any time.
+extern void SetTargetFrameRate(f32 framesPerSecond);
+// Draws of the swap chain render pass recorded by the job threads into secondary command buffers,
+// see VK::CommandRecorder. Read by InitFramework.
+extern void SetParallelRecording(bool isEnabled);
+// Attachments begun with vkCmdBeginRendering (Vulkan 1.3) instead of render pass and framebuffer
+// objects, when the device supports it. Read by InitFramework.
+extern void SetDynamicRendering(bool isEnabled);
 extern bool InitFramework(u32 width, u32 height);
 extern bool InitFramework(u32 width, u32 height, std::string_view title);
 extern void ShutdownFramework();
@@ -119,6 +241,25 @@ extern bool ProcessMessage();  // handle window events
 extern void BeginFrame();
 extern void EndFrame();
 
+// Headless readback, tightly packed RGBA8 of the latest frame the GPU has finished
+extern bool GetFramePixels(std::vector<u8>& pixels);
+
+// Viewpoint of the LOD selection, verticalFov in radians. Without it the full meshes are drawn.
+extern void SetLodCamera(const Vec3& position, f32 verticalFov);
+
+// Scopes nest and have to be balanced within a frame. Timings are those of the latest frame the
+// GPU has finished, which lags up to MAX_FRAMES_IN_FLIGHT frames behind.
+extern void BeginGpuScope(std::string_view name);
+extern void EndGpuScope();
+extern bool GetGpuFrameTimings(GpuFrameTimings& timings);
+
+// CPU, GPU and present timings with their percentiles, see Rava::FramePacer
+extern bool GetFramePacingStats(FramePacingStats& stats);
+extern void ResetFramePacingStats();
+
+// Chrome trace JSON (chrome://tracing, ui.perfetto.dev) of the latest CPU scopes of every thread
+extern bool SaveCpuTrace(std::string_view path);
+
 //// Simple draw API (expand later)
 // void DrawTriangle();
 // void DrawQuad(float x, float y, float w, float h);
@@ -135,5 +135,53 @@ project "RavaMain"
 		runtime "Release"
 		optimize "on"
 
+project "RavaBenchmark"
+	location "RavaBenchmark"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++latest"
+	staticruntime "off"
+
+	targetdir ("bin/" ..outputdir.. "/%{prj.name}")
+	objdir ("bin-int/" ..outputdir.. "/%{prj.name}")
+
+	files {
+		"%{prj.name}/src/**.hpp",
+		"%{prj.name}/src/**.cpp",
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.c",
+	}
+
+	includedirs {
+		"%{prj.name}/src",
+		"RavaFramework/src",
+		"%{VULKAN_SDK}/Include",
+		"%{IncludeDir.GLFW}",
+		"%{IncludeDir.glm}",
+	}
+
+	libdirs {
+		"%{VULKAN_SDK}/Lib",
+	}
+
+	links {
+		"vulkan-1.lib",
+		"GLFW",
+		"RavaFramework",
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+
+	filter "configurations:Debug"
+		defines "RV_DEBUG"
+		runtime "Debug"
+		symbols "on"
+
+	filter "configurations:Release"
+		defines {"RV_RELEASE", "NDEBUG"}
+		runtime "Release"
+		optimize "on"
+
 group "Externals"
 		include "Externals/GLFW.lua"
\ No newline at end of file